@@ -0,0 +1,57 @@
+# Copyright (c) Microsoft Corporation. All rights reserved.
+# Licensed under the MIT license.
+
+# Check that the compiler can build the in-tree AVX2, AVX-512, and AVX-512 IFMA kernels. The kernels live in their own
+# translation units, which are the only ones compiled with the flags found here.
+if(SEAL_USE_INTRIN AND NOT SEAL_ARM64 AND NOT EMSCRIPTEN)
+    cmake_push_check_state(RESET)
+    set(CMAKE_REQUIRED_QUIET TRUE)
+
+    if(MSVC)
+        set(SEAL_AVX2_FLAGS "/arch:AVX2")
+        set(SEAL_AVX512_FLAGS "/arch:AVX512")
+        set(SEAL_AVX512IFMA_FLAGS "/arch:AVX512")
+    else()
+        set(SEAL_AVX2_FLAGS "-mavx2")
+        set(SEAL_AVX512_FLAGS "-mavx512f;-mavx512dq;-mavx512vl;-mavx512bw")
+        set(SEAL_AVX512IFMA_FLAGS "${SEAL_AVX512_FLAGS};-mavx512ifma")
+    endif()
+
+    # Check for AVX2
+    string(REPLACE ";" " " CMAKE_REQUIRED_FLAGS "${SEAL_AVX2_FLAGS}")
+    check_cxx_source_compiles("
+        #include <immintrin.h>
+        int main() {
+            __m256i a = _mm256_set1_epi64x(1);
+            volatile long long b = _mm256_extract_epi64(_mm256_mul_epu32(a, a), 0);
+            return 0;
+        }"
+        SEAL_AVX2_FOUND
+    )
+
+    # Check for AVX-512F/DQ
+    string(REPLACE ";" " " CMAKE_REQUIRED_FLAGS "${SEAL_AVX512_FLAGS}")
+    check_cxx_source_compiles("
+        #include <immintrin.h>
+        int main() {
+            __m512i a = _mm512_set1_epi64(1);
+            volatile long long b = _mm512_reduce_add_epi64(_mm512_mullo_epi64(a, a));
+            return 0;
+        }"
+        SEAL_AVX512_FOUND
+    )
+
+    # Check for AVX-512 IFMA
+    string(REPLACE ";" " " CMAKE_REQUIRED_FLAGS "${SEAL_AVX512IFMA_FLAGS}")
+    check_cxx_source_compiles("
+        #include <immintrin.h>
+        int main() {
+            __m512i a = _mm512_set1_epi64(1);
+            volatile long long b = _mm512_reduce_add_epi64(_mm512_madd52hi_epu64(a, a, a));
+            return 0;
+        }"
+        SEAL_AVX512IFMA_FOUND
+    )
+
+    cmake_pop_check_state()
+endif()
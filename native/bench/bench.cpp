@@ -48,6 +48,12 @@ namespace sealbench
         parms_ckks.set_coeff_modulus(parms.second);
         shared_ptr<BMEnv> bm_env_ckks = bm_env_map.find(parms_ckks)->second;
 
+        // Key switching with keys stored in Montgomery form
+        parms_bgv.set_use_montgomery_keys(true);
+        shared_ptr<BMEnv> bm_env_bgv_montgomery = bm_env_map.find(parms_bgv)->second;
+        parms_ckks.set_use_montgomery_keys(true);
+        shared_ptr<BMEnv> bm_env_ckks_montgomery = bm_env_map.find(parms_ckks)->second;
+
         // Registration / display order:
         // 1. KeyGen
         // 2. BFV
@@ -117,6 +123,12 @@ namespace sealbench
             SEAL_BENCHMARK_REGISTER(BGV, n, log_q, EvaluateRotateRowsInplace, bm_bgv_rotate_rows_inplace, bm_env_bgv);
             SEAL_BENCHMARK_REGISTER(BGV, n, log_q, EvaluateRotateCols, bm_bgv_rotate_cols, bm_env_bgv);
             SEAL_BENCHMARK_REGISTER(BGV, n, log_q, EvaluateRotateColsInplace, bm_bgv_rotate_cols_inplace, bm_env_bgv);
+            SEAL_BENCHMARK_REGISTER(
+                BGV, n, log_q, EvaluateRelinInplaceMontgomery, bm_bgv_relin_inplace_montgomery,
+                bm_env_bgv_montgomery);
+            SEAL_BENCHMARK_REGISTER(
+                BGV, n, log_q, EvaluateRotateRowsInplaceMontgomery, bm_bgv_rotate_rows_inplace_montgomery,
+                bm_env_bgv_montgomery);
         }
         SEAL_BENCHMARK_REGISTER(BGV, n, log_q, EvaluateToNTTInplace, bm_bgv_to_ntt_inplace, bm_env_bgv);
         SEAL_BENCHMARK_REGISTER(BGV, n, log_q, EvaluateFromNTTInplace, bm_bgv_from_ntt_inplace, bm_env_bgv);
@@ -142,6 +154,11 @@ namespace sealbench
         {
             SEAL_BENCHMARK_REGISTER(CKKS, n, log_q, EvaluateRelinInplace, bm_ckks_relin_inplace, bm_env_ckks);
             SEAL_BENCHMARK_REGISTER(CKKS, n, log_q, EvaluateRotate, bm_ckks_rotate, bm_env_ckks);
+            SEAL_BENCHMARK_REGISTER(
+                CKKS, n, log_q, EvaluateRelinInplaceMontgomery, bm_ckks_relin_inplace_montgomery,
+                bm_env_ckks_montgomery);
+            SEAL_BENCHMARK_REGISTER(
+                CKKS, n, log_q, EvaluateRotateMontgomery, bm_ckks_rotate_montgomery, bm_env_ckks_montgomery);
         }
         SEAL_BENCHMARK_REGISTER(UTIL, n, log_q, NTTForward, bm_util_ntt_forward, bm_env_bfv);
         SEAL_BENCHMARK_REGISTER(UTIL, n, log_q, NTTInverse, bm_util_ntt_inverse, bm_env_bfv);
@@ -149,6 +166,14 @@ namespace sealbench
         SEAL_BENCHMARK_REGISTER(UTIL, n, 0, NTTInverseLowLevel, bm_util_ntt_inverse_low_level, bm_env_bfv);
         SEAL_BENCHMARK_REGISTER(UTIL, n, 0, NTTForwardLowLevelLazy, bm_util_ntt_forward_low_level_lazy, bm_env_bfv);
         SEAL_BENCHMARK_REGISTER(UTIL, n, 0, NTTInverseLowLevelLazy, bm_util_ntt_inverse_low_level_lazy, bm_env_bfv);
+
+        // DWTHandler with one, two, or three stages per pass over the coefficients
+        SEAL_BENCHMARK_REGISTER(UTIL, n, 0, NTTForwardRadix2, bm_util_ntt_forward_radix, bm_env_bfv, 1);
+        SEAL_BENCHMARK_REGISTER(UTIL, n, 0, NTTForwardRadix4, bm_util_ntt_forward_radix, bm_env_bfv, 2);
+        SEAL_BENCHMARK_REGISTER(UTIL, n, 0, NTTForwardRadix8, bm_util_ntt_forward_radix, bm_env_bfv, 3);
+        SEAL_BENCHMARK_REGISTER(UTIL, n, 0, NTTInverseRadix2, bm_util_ntt_inverse_radix, bm_env_bfv, 1);
+        SEAL_BENCHMARK_REGISTER(UTIL, n, 0, NTTInverseRadix4, bm_util_ntt_inverse_radix, bm_env_bfv, 2);
+        SEAL_BENCHMARK_REGISTER(UTIL, n, 0, NTTInverseRadix8, bm_util_ntt_inverse_radix, bm_env_bfv, 3);
     }
 
 } // namespace sealbench
@@ -201,6 +226,18 @@ int main(int argc, char **argv)
         {
             throw invalid_argument("duplicate parameter sets");
         }
+
+        // BGV and CKKS again with key switching keys in Montgomery form
+        parms_bgv.set_use_montgomery_keys(true);
+        parms_ckks.set_use_montgomery_keys(true);
+        if (bm_env_map.emplace(make_pair(parms_bgv, make_shared<BMEnv>(parms_bgv))).second == false)
+        {
+            throw invalid_argument("duplicate parameter sets");
+        }
+        if (bm_env_map.emplace(make_pair(parms_ckks, make_shared<BMEnv>(parms_ckks))).second == false)
+        {
+            throw invalid_argument("duplicate parameter sets");
+        }
     }
 
     // Now that precomputation have taken place, here is the total memory consumption by SEAL memory pool.
@@ -346,6 +346,8 @@ namespace sealbench
     void bm_util_ntt_inverse_low_level(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_util_ntt_forward_low_level_lazy(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_util_ntt_inverse_low_level_lazy(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+    void bm_util_ntt_forward_radix(benchmark::State &state, std::shared_ptr<BMEnv> bm_env, int log_radix);
+    void bm_util_ntt_inverse_radix(benchmark::State &state, std::shared_ptr<BMEnv> bm_env, int log_radix);
 
     // KeyGen benchmark cases
     void bm_keygen_secret(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
@@ -398,6 +400,8 @@ namespace sealbench
     void bm_bgv_rotate_cols_inplace(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_bgv_to_ntt_inplace(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_bgv_from_ntt_inplace(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+    void bm_bgv_relin_inplace_montgomery(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+    void bm_bgv_rotate_rows_inplace_montgomery(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
 
     // CKKS-specific benchmark cases
     void bm_ckks_encrypt_secret(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
@@ -416,4 +420,6 @@ namespace sealbench
     void bm_ckks_rescale_inplace(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_ckks_relin_inplace(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
     void bm_ckks_rotate(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+    void bm_ckks_relin_inplace_montgomery(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
+    void bm_ckks_rotate_montgomery(benchmark::State &state, std::shared_ptr<BMEnv> bm_env);
 } // namespace sealbench
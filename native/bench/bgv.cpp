@@ -360,4 +360,24 @@ namespace sealbench
             bm_env->evaluator()->transform_from_ntt_inplace(ct[0]);
         }
     }
+
+    // Relinearization with key switching keys in Montgomery form, to compare with bm_bgv_relin_inplace
+    void bm_bgv_relin_inplace_montgomery(State &state, shared_ptr<BMEnv> bm_env)
+    {
+        if (!bm_env->parms().use_montgomery_keys())
+        {
+            throw invalid_argument("bm_env does not use Montgomery keys");
+        }
+        bm_bgv_relin_inplace(state, move(bm_env));
+    }
+
+    // Row rotation with key switching keys in Montgomery form, to compare with bm_bgv_rotate_rows_inplace
+    void bm_bgv_rotate_rows_inplace_montgomery(State &state, shared_ptr<BMEnv> bm_env)
+    {
+        if (!bm_env->parms().use_montgomery_keys())
+        {
+            throw invalid_argument("bm_env does not use Montgomery keys");
+        }
+        bm_bgv_rotate_rows_inplace(state, move(bm_env));
+    }
 } // namespace sealbench
@@ -266,4 +266,24 @@ namespace sealbench
             bm_env->evaluator()->rotate_vector(ct[0], 1, bm_env->glk(), ct[2]);
         }
     }
+
+    // Relinearization with key switching keys in Montgomery form, to compare with bm_ckks_relin_inplace
+    void bm_ckks_relin_inplace_montgomery(State &state, shared_ptr<BMEnv> bm_env)
+    {
+        if (!bm_env->parms().use_montgomery_keys())
+        {
+            throw invalid_argument("bm_env does not use Montgomery keys");
+        }
+        bm_ckks_relin_inplace(state, move(bm_env));
+    }
+
+    // Rotation with key switching keys in Montgomery form, to compare with bm_ckks_rotate
+    void bm_ckks_rotate_montgomery(State &state, shared_ptr<BMEnv> bm_env)
+    {
+        if (!bm_env->parms().use_montgomery_keys())
+        {
+            throw invalid_argument("bm_env does not use Montgomery keys");
+        }
+        bm_ckks_rotate(state, move(bm_env));
+    }
 } // namespace sealbench
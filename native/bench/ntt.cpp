@@ -106,4 +106,66 @@ namespace sealbench
             inverse_ntt_negacyclic_harvey_lazy(ct[0].data(), small_ntt_tables[0]);
         }
     }
+
+    void bm_util_ntt_forward_radix(State &state, shared_ptr<BMEnv> bm_env, int log_radix)
+    {
+        parms_id_type parms_id = bm_env->context().first_parms_id();
+        auto context_data = bm_env->context().get_context_data(parms_id);
+        const auto &tables = context_data->small_ntt_tables()[0];
+        int coeff_count_power = tables.coeff_count_power();
+        vector<Ciphertext> &ct = bm_env->ct();
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            bm_env->randomize_ct_bfv(ct[0]);
+
+            state.ResumeTiming();
+            switch (log_radix)
+            {
+            case 2:
+                tables.ntt_handler().transform_to_rev_radix<2>(
+                    ct[0].data(), coeff_count_power, tables.get_from_root_powers());
+                break;
+            case 3:
+                tables.ntt_handler().transform_to_rev_radix<3>(
+                    ct[0].data(), coeff_count_power, tables.get_from_root_powers());
+                break;
+            default:
+                tables.ntt_handler().transform_to_rev(ct[0].data(), coeff_count_power, tables.get_from_root_powers());
+                break;
+            }
+        }
+    }
+
+    void bm_util_ntt_inverse_radix(State &state, shared_ptr<BMEnv> bm_env, int log_radix)
+    {
+        parms_id_type parms_id = bm_env->context().first_parms_id();
+        auto context_data = bm_env->context().get_context_data(parms_id);
+        const auto &tables = context_data->small_ntt_tables()[0];
+        int coeff_count_power = tables.coeff_count_power();
+        const util::MultiplyUIntModOperand &inv_degree_modulo = tables.inv_degree_modulo();
+        vector<Ciphertext> &ct = bm_env->ct();
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            bm_env->randomize_ct_bfv(ct[0]);
+
+            state.ResumeTiming();
+            switch (log_radix)
+            {
+            case 2:
+                tables.ntt_handler().transform_from_rev_radix<2>(
+                    ct[0].data(), coeff_count_power, tables.get_from_inv_root_powers(), &inv_degree_modulo);
+                break;
+            case 3:
+                tables.ntt_handler().transform_from_rev_radix<3>(
+                    ct[0].data(), coeff_count_power, tables.get_from_inv_root_powers(), &inv_degree_modulo);
+                break;
+            default:
+                tables.ntt_handler().transform_from_rev(
+                    ct[0].data(), coeff_count_power, tables.get_from_inv_root_powers(), &inv_degree_modulo);
+                break;
+            }
+        }
+    }
 } // namespace sealbench
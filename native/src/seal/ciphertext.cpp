@@ -246,7 +246,13 @@ namespace seal
         stream.exceptions(old_except_mask);
     }
 
-    void Ciphertext::load_members(const SEALContext &context, istream &stream, SEAL_MAYBE_UNUSED SEALVersion version)
+    void Ciphertext::load_members(const SEALContext &context, istream &stream, SEALVersion version)
+    {
+        load_members_internal(context, stream, version, true);
+    }
+
+    void Ciphertext::load_members_internal(
+        const SEALContext &context, istream &stream, SEALVersion version, bool expand_seed)
     {
         // Verify parameters
         if (!context.parameters_set())
@@ -347,9 +353,25 @@ namespace seal
                     throw logic_error("incompatible version");
                 }
 
-                // Set up a UniformRandomGenerator and expand
+                // Set up a UniformRandomGenerator and expand, unless the seed is to be kept and fits in the second
+                // polynomial after the marker
                 new_data.data_.resize(total_uint64_count);
-                new_data.expand_seed(context, prng_info, version);
+                size_t prng_info_byte_count =
+                    static_cast<size_t>(UniformRandomGeneratorInfo::SaveSize(compr_mode_type::none));
+                size_t prng_info_uint64_count =
+                    divide_round_up(prng_info_byte_count, static_cast<size_t>(bytes_per_uint64));
+                if (expand_seed || version.major != SEAL_VERSION_MAJOR ||
+                    seeded_uint64_count < prng_info_uint64_count + 1)
+                {
+                    new_data.expand_seed(context, prng_info, version);
+                }
+                else
+                {
+                    uint64_t *c1 = new_data.data(1);
+                    c1[0] = static_cast<uint64_t>(0xFFFFFFFFFFFFFFFFULL);
+                    prng_info.save(
+                        reinterpret_cast<seal_byte *>(c1 + 1), prng_info_byte_count, compr_mode_type::none);
+                }
             }
 
             // Verify that the buffer is correct
@@ -54,6 +54,8 @@ namespace seal
     */
     class Ciphertext
     {
+        friend class KSwitchKeys;
+
     public:
         using ct_coeff_type = std::uint64_t;
 
@@ -693,6 +695,12 @@ namespace seal
 
         void load_members(const SEALContext &context, std::istream &stream, SEALVersion version);
 
+        // Unless expand_seed is set, loads a seeded ciphertext of this version without expanding it: the second
+        // polynomial then holds the seed marker followed by the UniformRandomGeneratorInfo, as after encryption with a
+        // saved seed.
+        void load_members_internal(
+            const SEALContext &context, std::istream &stream, SEALVersion version, bool expand_seed);
+
         inline bool has_seed_marker() const noexcept
         {
             return (data_.size() && (size_ == 2)) ? (data(1)[0] == 0xFFFFFFFFFFFFFFFFULL) : false;
@@ -500,7 +500,9 @@ namespace seal
                 conj_values[matrix_reps_index_map_[i + slots_]] = std::conj(values[i]);
             }
             double fix = scale / static_cast<double>(n);
-            fft_handler_.transform_from_rev(conj_values.get(), util::get_power_of_two(n), inv_root_powers_.get(), &fix);
+            // Two stages per pass: the complex butterflies have enough registers and this saves half the loads
+            fft_handler_.transform_from_rev_radix<2>(
+                conj_values.get(), util::get_power_of_two(n), inv_root_powers_.get(), &fix);
 
             double max_coeff = 0;
             for (std::size_t i = 0; i < n; i++)
@@ -733,7 +735,7 @@ namespace seal
                 // res[i] = res_accum * inv_scale;
             }
 
-            fft_handler_.transform_to_rev(res.get(), logn, root_powers_.get());
+            fft_handler_.transform_to_rev_radix<2>(res.get(), logn, root_powers_.get());
 
             for (std::size_t i = 0; i < slots_; i++)
             {
@@ -5,6 +5,7 @@
 #include "seal/util/numth.h"
 #include "seal/util/pointer.h"
 #include "seal/util/polycore.h"
+#include "seal/util/tablecache.h"
 #include "seal/util/uintarith.h"
 #include "seal/util/uintarithsmallmod.h"
 #include <algorithm>
@@ -70,6 +71,12 @@ namespace seal
         case error_type::failed_creating_rns_tool:
             return "failed_creating_rns_tool";
 
+        case error_type::invalid_special_prime_count:
+            return "invalid_special_prime_count";
+
+        case error_type::invalid_dnum:
+            return "invalid_dnum";
+
         default:
             return "invalid parameter_error";
         }
@@ -127,6 +134,12 @@ namespace seal
         case error_type::failed_creating_rns_tool:
             return "RNSTool cannot be constructed";
 
+        case error_type::invalid_special_prime_count:
+            return "special_prime_count is zero or not smaller than coeff_modulus's primes' count";
+
+        case error_type::invalid_dnum:
+            return "dnum exceeds the count of coeff_modulus's primes that are not special primes";
+
         default:
             return "invalid parameter_error";
         }
@@ -224,10 +237,10 @@ namespace seal
         // RNSBase's constructor may fail due to:
         //   (1) coeff_mod not coprime
         //   (2) cannot find inverse of punctured products (because of (1))
-        Pointer<RNSBase> coeff_modulus_base;
+        shared_ptr<const RNSBase> coeff_modulus_base;
         try
         {
-            coeff_modulus_base = allocate<RNSBase>(pool_, coeff_modulus, pool_);
+            coeff_modulus_base = GetSharedRNSBase(coeff_modulus);
         }
         catch (const invalid_argument &)
         {
@@ -240,7 +253,7 @@ namespace seal
         context_data.qualifiers_.using_ntt = true;
         try
         {
-            CreateNTTTables(coeff_count_power, coeff_modulus, context_data.small_ntt_tables_, pool_);
+            context_data.small_ntt_tables_ = GetSharedNTTTables(coeff_count_power, coeff_modulus);
         }
         catch (const invalid_argument &)
         {
@@ -284,7 +297,7 @@ namespace seal
             context_data.qualifiers_.using_batching = true;
             try
             {
-                CreateNTTTables(coeff_count_power, { plain_modulus }, context_data.plain_ntt_tables_, pool_);
+                context_data.plain_ntt_tables_ = GetSharedNTTTables(coeff_count_power, { plain_modulus });
             }
             catch (const invalid_argument &)
             {
@@ -388,14 +401,31 @@ namespace seal
             return context_data;
         }
 
+        // Choose the BFV multiplication method
+        if (parms.scheme() == scheme_type::bfv)
+        {
+            switch (parms.bfv_mul_method())
+            {
+            case bfv_mul_method_type::hps:
+                context_data.qualifiers_.using_hps_multiply = true;
+                break;
+
+            case bfv_mul_method_type::behz:
+            default:
+                // The automatic choice keeps BEHZ, so that existing code does not change behavior; HPS is opt-in
+                context_data.qualifiers_.using_hps_multiply = false;
+                break;
+            }
+        }
+
         // Create RNSTool
         // RNSTool's constructor may fail due to:
         //   (1) auxiliary base being too large
         //   (2) cannot find inverse of punctured products in auxiliary base
         try
         {
-            context_data.rns_tool_ =
-                allocate<RNSTool>(pool_, poly_modulus_degree, *coeff_modulus_base, plain_modulus, pool_);
+            context_data.rns_tool_ = GetSharedRNSTool(
+                poly_modulus_degree, *coeff_modulus_base, plain_modulus, context_data.qualifiers_.using_hps_multiply);
         }
         catch (const exception &)
         {
@@ -413,18 +443,18 @@ namespace seal
         }
 
         // Create GaloisTool
-        context_data.galois_tool_ = allocate<GaloisTool>(pool_, coeff_count_power, pool_);
+        context_data.galois_tool_ = GetSharedGaloisTool(coeff_count_power);
 
         // Done with validation and pre-computations
         return context_data;
     }
 
-    parms_id_type SEALContext::create_next_context_data(const parms_id_type &prev_parms_id)
+    parms_id_type SEALContext::create_next_context_data(const parms_id_type &prev_parms_id, size_t drop_count)
     {
-        // Create the next set of parameters by removing last modulus
+        // Create the next set of parameters by removing the last moduli
         auto next_parms = context_data_map_.at(prev_parms_id)->parms_;
         auto next_coeff_modulus = next_parms.coeff_modulus();
-        next_coeff_modulus.pop_back();
+        next_coeff_modulus.resize(next_coeff_modulus.size() - drop_count);
         next_parms.set_coeff_modulus(next_coeff_modulus);
         auto next_parms_id = next_parms.parms_id();
 
@@ -437,6 +467,28 @@ namespace seal
             return parms_id_zero;
         }
 
+        // Every level after the key level holds ciphertexts, which need the pre-computations for key switching. The
+        // primes of the first level are split into digits of the same size at all levels.
+        auto &key_parms = context_data_map_.at(key_parms_id_)->parms_;
+        auto &key_modulus = key_parms.coeff_modulus();
+        size_t special_prime_count = key_parms.special_prime_count();
+        size_t decomp_modulus_size = key_modulus.size() - special_prime_count;
+        size_t dnum = key_parms.dnum() ? key_parms.dnum() : decomp_modulus_size;
+        size_t digit_size = (decomp_modulus_size + dnum - 1) / dnum;
+        vector<Modulus> special_primes(
+            key_modulus.cend() - static_cast<ptrdiff_t>(special_prime_count), key_modulus.cend());
+        try
+        {
+            next_context_data.kswitch_tool_ = GetSharedKSwitchTool(
+                next_parms.poly_modulus_degree(), *next_context_data.rns_tool_->base_q(),
+                *GetSharedRNSBase(special_primes), digit_size,
+                next_parms.scheme() == scheme_type::bgv ? next_parms.plain_modulus() : Modulus(0));
+        }
+        catch (const exception &)
+        {
+            return parms_id_zero;
+        }
+
         // Add them to the context_data_map_
         context_data_map_.emplace(make_pair(next_parms_id, make_shared<const ContextData>(move(next_context_data))));
 
@@ -460,6 +512,9 @@ namespace seal
             throw invalid_argument("pool is uninitialized");
         }
 
+        // Select the kernel variant for the CPU before any computation
+        SEAL_MAYBE_UNUSED auto variant = util::active_kernel_variant();
+
         // Set random generator
         if (!parms.random_generator())
         {
@@ -475,15 +530,28 @@ namespace seal
 
         // Then create first_parms_id_ if the parameters are valid and there is
         // more than one modulus in coeff_modulus. This is equivalent to expanding
-        // the chain by one step. Otherwise, we set first_parms_id_ to equal
-        // key_parms_id_.
-        if (!context_data_map_.at(key_parms_id_)->qualifiers_.parameters_set() || parms.coeff_modulus().size() == 1)
+        // the chain by special_prime_count steps. Otherwise, we set first_parms_id_
+        // to equal key_parms_id_.
+        auto &key_qualifiers = const_pointer_cast<ContextData>(context_data_map_.at(key_parms_id_))->qualifiers_;
+        size_t coeff_modulus_size = parms.coeff_modulus().size();
+        size_t special_prime_count = parms.special_prime_count();
+        if (!key_qualifiers.parameters_set() || (coeff_modulus_size == 1 && special_prime_count == 1))
+        {
+            first_parms_id_ = key_parms_id_;
+        }
+        else if (!special_prime_count || special_prime_count >= coeff_modulus_size)
+        {
+            key_qualifiers.parameter_error = error_type::invalid_special_prime_count;
+            first_parms_id_ = key_parms_id_;
+        }
+        else if (parms.dnum() > coeff_modulus_size - special_prime_count)
         {
+            key_qualifiers.parameter_error = error_type::invalid_dnum;
             first_parms_id_ = key_parms_id_;
         }
         else
         {
-            auto next_parms_id = create_next_context_data(key_parms_id_);
+            auto next_parms_id = create_next_context_data(key_parms_id_, special_prime_count);
             first_parms_id_ = (next_parms_id == parms_id_zero) ? key_parms_id_ : next_parms_id;
         }
 
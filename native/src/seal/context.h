@@ -6,6 +6,7 @@
 #include "seal/encryptionparams.h"
 #include "seal/memorymanager.h"
 #include "seal/modulus.h"
+#include "seal/util/dispatch.h"
 #include "seal/util/galois.h"
 #include "seal/util/ntt.h"
 #include "seal/util/pointer.h"
@@ -112,6 +113,16 @@ namespace seal
             RNSTool cannot be constructed
             */
             failed_creating_rns_tool = 14,
+
+            /**
+            special_prime_count is zero or not smaller than the size of coeff_modulus
+            */
+            invalid_special_prime_count = 15,
+
+            /**
+            dnum exceeds the number of primes of coeff_modulus that are not special primes
+            */
+            invalid_dnum = 16,
         };
 
         /**
@@ -193,6 +204,14 @@ namespace seal
         */
         bool using_descending_modulus_chain;
 
+        /**
+        Tells whether BFV ciphertexts are multiplied with the Halevi-Polyakov-Shoup
+        (HPS) variant rather than the Bajard-Eynard-Hasan-Zucca (BEHZ) variant. This
+        is true only if EncryptionParameters::bfv_mul_method() is bfv_mul_method_type::hps;
+        the automatic choice is BEHZ.
+        */
+        bool using_hps_multiply;
+
         /**
         Tells whether the encryption parameters are secure based on the standard
         parameters from HomomorphicEncryption.org security standard.
@@ -202,7 +221,8 @@ namespace seal
     private:
         EncryptionParameterQualifiers()
             : parameter_error(error_type::none), using_fft(false), using_ntt(false), using_batching(false),
-              using_fast_plain_lift(false), using_descending_modulus_chain(false), sec_level(sec_level_type::none)
+              using_fast_plain_lift(false), using_descending_modulus_chain(false), using_hps_multiply(false),
+              sec_level(sec_level_type::none)
         {}
 
         friend class SEALContext;
@@ -343,6 +363,15 @@ namespace seal
                 return galois_tool_.get();
             }
 
+            /**
+            Returns a constant pointer to the KSwitchTool. This is null at the key level and if the context does not
+            support key switching.
+            */
+            SEAL_NODISCARD inline const util::KSwitchTool *kswitch_tool() const noexcept
+            {
+                return kswitch_tool_.get();
+            }
+
             /**
             Return a pointer to BFV "Delta", i.e. coefficient modulus divided by
             plaintext modulus.
@@ -449,13 +478,15 @@ namespace seal
 
             EncryptionParameterQualifiers qualifiers_;
 
-            util::Pointer<util::RNSTool> rns_tool_;
+            std::shared_ptr<const util::RNSTool> rns_tool_;
+
+            std::shared_ptr<const util::NTTTables> small_ntt_tables_;
 
-            util::Pointer<util::NTTTables> small_ntt_tables_;
+            std::shared_ptr<const util::NTTTables> plain_ntt_tables_;
 
-            util::Pointer<util::NTTTables> plain_ntt_tables_;
+            std::shared_ptr<const util::GaloisTool> galois_tool_;
 
-            util::Pointer<util::GaloisTool> galois_tool_;
+            std::shared_ptr<const util::KSwitchTool> kswitch_tool_;
 
             util::Pointer<std::uint64_t> total_coeff_modulus_;
 
@@ -632,6 +663,16 @@ namespace seal
             return using_keyswitching_;
         }
 
+        /**
+        Returns the kernel variant used for the NTT, dyadic products, scalar multiplications, and RNS base
+        conversions. The variant is selected according to the CPU when the first SEALContext is created and is
+        shared by all contexts; util::set_active_kernel_variant can override it.
+        */
+        SEAL_NODISCARD inline seal::kernel_variant kernel_variant() const noexcept
+        {
+            return util::active_kernel_variant();
+        }
+
     private:
         /**
         Creates an instance of SEALContext, and performs several pre-computations
@@ -650,12 +691,12 @@ namespace seal
         ContextData validate(EncryptionParameters parms);
 
         /**
-        Create the next context_data by dropping the last element from coeff_modulus.
-        If the new encryption parameters are not valid, returns parms_id_zero.
-        Otherwise, returns the parms_id of the next parameter and appends the next
-        context_data to the chain.
+        Create the next context_data by dropping the last drop_count elements from
+        coeff_modulus. If the new encryption parameters are not valid, returns
+        parms_id_zero. Otherwise, returns the parms_id of the next parameter and
+        appends the next context_data to the chain.
         */
-        parms_id_type create_next_context_data(const parms_id_type &prev_parms);
+        parms_id_type create_next_context_data(const parms_id_type &prev_parms, std::size_t drop_count = 1);
 
         MemoryPoolHandle pool_;
 
@@ -19,6 +19,9 @@ namespace seal
 {
     namespace
     {
+        // Number of ciphertexts Decryptor::decrypt_many scales and reduces at a time
+        constexpr size_t decrypt_batch_size = 16;
+
         void poly_infty_norm_coeffmod(
             StrideIter<const uint64_t *> poly, size_t coeff_count, const uint64_t *modulus, uint64_t *result,
             MemoryPool &pool)
@@ -111,6 +114,110 @@ namespace seal
         }
     }
 
+    void Decryptor::decrypt_many(const vector<Ciphertext> &encrypteds, vector<Plaintext> &destinations)
+    {
+        // Validate every ciphertext before destinations is touched
+        bool is_ckks = context_.first_context_data()->parms().scheme() == scheme_type::ckks;
+        for (auto &encrypted : encrypteds)
+        {
+            // Verify that encrypted is valid.
+            if (!is_valid_for(encrypted, context_))
+            {
+                throw invalid_argument("encrypted is not valid for encryption parameters");
+            }
+
+            // Additionally check that ciphertext doesn't have trivial size
+            if (encrypted.size() < SEAL_CIPHERTEXT_SIZE_MIN)
+            {
+                throw invalid_argument("encrypted is empty");
+            }
+
+            if (is_ckks && !encrypted.is_ntt_form())
+            {
+                throw invalid_argument("encrypted must be in NTT form");
+            }
+            if (!is_ckks && encrypted.is_ntt_form())
+            {
+                throw invalid_argument("encrypted cannot be in NTT form");
+            }
+        }
+
+        size_t count = encrypteds.size();
+        destinations.resize(count);
+
+        if (is_ckks)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                ckks_decrypt(encrypteds[i], destinations[i], pool_);
+            }
+            return;
+        }
+
+        // Batch consecutive ciphertexts at the same level
+        size_t first = 0;
+        while (first < count)
+        {
+            size_t last = first + 1;
+            while (last < count && last - first < decrypt_batch_size &&
+                   encrypteds[last].parms_id() == encrypteds[first].parms_id())
+            {
+                last++;
+            }
+            decrypt_batch(encrypteds.data() + first, last - first, destinations.data() + first, pool_);
+            first = last;
+        }
+    }
+
+    void Decryptor::decrypt_batch(
+        const Ciphertext *encrypted, size_t count, Plaintext *destination, MemoryPoolHandle pool)
+    {
+        auto &context_data = *context_.get_context_data(encrypted[0].parms_id());
+        auto &parms = context_data.parms();
+        auto &coeff_modulus = parms.coeff_modulus();
+        auto &plain_modulus = parms.plain_modulus();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t coeff_modulus_size = coeff_modulus.size();
+
+        // Compute the phases c_0 + c_1 * s + ... + c_{count-1} * s^{count-1} mod q of all ciphertexts
+        SEAL_ALLOCATE_ZERO_GET_POLY_ITER(tmp_dest_modq, count, coeff_count, coeff_modulus_size, pool);
+        SEAL_ITERATE(iter(encrypted, tmp_dest_modq), count, [&](auto I) {
+            dot_product_ct_sk_array(get<0>(I), get<1>(I), pool);
+        });
+
+        // Scale and round (BFV) or reduce (BGV) all phases in one call
+        SEAL_ALLOCATE_GET_COEFF_ITER(tmp_dest_modt, mul_safe(count, coeff_count), pool);
+        if (parms.scheme() == scheme_type::bfv)
+        {
+            context_data.rns_tool()->decrypt_scale_and_round(tmp_dest_modq, count, tmp_dest_modt, pool);
+        }
+        else
+        {
+            context_data.rns_tool()->decrypt_modt(tmp_dest_modq, count, tmp_dest_modt, pool);
+        }
+
+        SEAL_ITERATE(iter(encrypted, destination, size_t(0)), count, [&](auto I) {
+            CoeffIter result = tmp_dest_modt + get<2>(I) * coeff_count;
+            if (get<0>(I).correction_factor() != 1)
+            {
+                uint64_t fix = 1;
+                if (!try_invert_uint_mod(get<0>(I).correction_factor(), plain_modulus, fix))
+                {
+                    throw logic_error("invalid correction factor");
+                }
+                multiply_poly_scalar_coeffmod(result, coeff_count, fix, plain_modulus, result);
+            }
+
+            // How many non-zero coefficients do we really have in the result?
+            size_t plain_coeff_count = get_significant_uint64_count_uint(result, coeff_count);
+
+            // Copy the result to a destination of appropriate size
+            get<1>(I).parms_id() = parms_id_zero;
+            get<1>(I).resize(max(plain_coeff_count, size_t(1)));
+            set_uint(result, get<1>(I).coeff_count(), get<1>(I).data());
+        });
+    }
+
     void Decryptor::bfv_decrypt(const Ciphertext &encrypted, Plaintext &destination, MemoryPoolHandle pool)
     {
         if (encrypted.is_ntt_form())
@@ -344,33 +451,40 @@ namespace seal
         else
         {
             // put < (c_1 , c_2, ... , c_{count-1}) , (s,s^2,...,s^{count-1}) > mod q in destination
-            // Now do the dot product of encrypted_copy and the secret key array using NTT.
+            // Now do the dot product of encrypted and the secret key array using NTT, one modulus at a time.
             // The secret key powers are already NTT transformed.
-            SEAL_ALLOCATE_GET_POLY_ITER(encrypted_copy, encrypted_size - 1, coeff_count, coeff_modulus_size, pool);
-            set_poly_array(encrypted.data(1), encrypted_size - 1, coeff_count, coeff_modulus_size, encrypted_copy);
-
-            // Transform c_1, c_2, ... to NTT form unless they already are
-            if (!is_ntt_form)
-            {
-                ntt_negacyclic_harvey_lazy(encrypted_copy, encrypted_size - 1, ntt_tables);
-            }
-
-            // Compute dyadic product with secret power array
-            auto secret_key_array = PolyIter(secret_key_array_.get(), coeff_count, key_coeff_modulus_size);
-            SEAL_ITERATE(iter(encrypted_copy, secret_key_array), encrypted_size - 1, [&](auto I) {
-                dyadic_product_coeffmod(get<0>(I), get<1>(I), coeff_modulus_size, coeff_modulus, get<0>(I));
-            });
-            // Aggregate all polynomials together to complete the dot product
-            set_zero_poly(coeff_count, coeff_modulus_size, destination);
-            SEAL_ITERATE(encrypted_copy, encrypted_size - 1, [&](auto I) {
-                add_poly_coeffmod(destination, I, coeff_modulus_size, coeff_modulus, destination);
-            });
-
-            if (!is_ntt_form)
-            {
-                // If the input was not in NTT form, need to transform back
-                inverse_ntt_negacyclic_harvey(destination, coeff_modulus_size, ntt_tables);
-            }
+            size_t power_count = encrypted_size - 1;
+            ConstPolyIter encrypted_iter(encrypted.data(1), coeff_count, coeff_modulus_size);
+            ConstPolyIter secret_key_array(secret_key_array_.get(), coeff_count, key_coeff_modulus_size);
+            SEAL_ALLOCATE_GET_RNS_ITER(encrypted_copy, coeff_count, power_count, pool);
+            auto ct_operands(allocate<const uint64_t *>(power_count, pool));
+            auto sk_operands(allocate<const uint64_t *>(power_count, pool));
+            SEAL_ITERATE(
+                iter(size_t(0), coeff_modulus, ntt_tables, destination), coeff_modulus_size, [&](auto I) {
+                    size_t index = get<0>(I);
+                    SEAL_ITERATE(iter(size_t(0)), power_count, [&](auto J) {
+                        if (is_ntt_form)
+                        {
+                            ct_operands[J] = encrypted_iter[J][index].ptr();
+                        }
+                        else
+                        {
+                            // Transform c_1, c_2, ... to NTT form
+                            set_uint(encrypted_iter[J][index], coeff_count, encrypted_copy[J]);
+                            ntt_negacyclic_harvey_lazy(encrypted_copy[J], get<2>(I));
+                            ct_operands[J] = encrypted_copy[J].ptr();
+                        }
+                        sk_operands[J] = secret_key_array[J][index].ptr();
+                    });
+                    dot_product_coeffmod(
+                        ct_operands.get(), sk_operands.get(), power_count, coeff_count, get<1>(I), get<3>(I));
+
+                    if (!is_ntt_form)
+                    {
+                        // If the input was not in NTT form, need to transform back
+                        inverse_ntt_negacyclic_harvey(get<3>(I), get<2>(I));
+                    }
+                });
 
             // Finally add c_0 to the result; note that destination should be in the same (NTT) form as encrypted
             add_poly_coeffmod(destination, *iter(encrypted), coeff_modulus_size, coeff_modulus, destination);
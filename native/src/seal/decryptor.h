@@ -16,6 +16,7 @@
 #include "seal/util/locks.h"
 #include "seal/util/ntt.h"
 #include "seal/util/rns.h"
+#include <vector>
 
 namespace seal
 {
@@ -73,6 +74,24 @@ namespace seal
         */
         void decrypt(const Ciphertext &encrypted, Plaintext &destination);
 
+        /*
+        Decrypts a vector of Ciphertexts and stores the results in the destination
+        parameter, which is resized to the number of ciphertexts. With the BFV and
+        BGV schemes, consecutive ciphertexts at the same level are scaled and
+        reduced modulo the plaintext modulus in batches, which is faster than
+        decrypting them one by one. All ciphertexts are validated first, so
+        destinations is left unchanged if any of them is invalid.
+
+        @param[in] encrypteds The ciphertexts to decrypt
+        @param[out] destinations The plaintexts to overwrite with the decrypted
+        ciphertexts
+        @throws std::invalid_argument if any of encrypteds is not valid for the
+        encryption parameters
+        @throws std::invalid_argument if any of encrypteds is not in the default
+        NTT form
+        */
+        void decrypt_many(const std::vector<Ciphertext> &encrypteds, std::vector<Plaintext> &destinations);
+
         /*
         Computes the invariant noise budget (in bits) of a ciphertext. The
         invariant noise budget measures the amount of room there is for the noise
@@ -106,6 +125,10 @@ namespace seal
 
         void bgv_decrypt(const Ciphertext &encrypted, Plaintext &destination, MemoryPoolHandle pool);
 
+        // Decrypts count BFV or BGV ciphertexts that are at the same level and not in NTT form
+        void decrypt_batch(
+            const Ciphertext *encrypted, std::size_t count, Plaintext *destination, MemoryPoolHandle pool);
+
         Decryptor(const Decryptor &copy) = delete;
 
         Decryptor(Decryptor &&source) = delete;
@@ -12,6 +12,17 @@ namespace seal
 {
     const parms_id_type parms_id_zero = util::HashFunction::hash_zero_block;
 
+    namespace
+    {
+        // Set in the serialized scheme identifier when key switching keys are stored in Montgomery form, so that the
+        // serialized form of other parameters does not change
+        constexpr uint8_t montgomery_keys_flag = 0x80;
+
+        // Set in the serialized scheme identifier when the key switching parameters are not the defaults; they follow
+        // the plain modulus in that case
+        constexpr uint8_t key_switching_flag = 0x40;
+    } // namespace
+
     void EncryptionParameters::save_members(ostream &stream) const
     {
         // Throw exceptions on std::ios_base::badbit and std::ios_base::failbit
@@ -23,6 +34,14 @@ namespace seal
             uint64_t poly_modulus_degree64 = static_cast<uint64_t>(poly_modulus_degree_);
             uint64_t coeff_modulus_size64 = static_cast<uint64_t>(coeff_modulus_.size());
             uint8_t scheme = static_cast<uint8_t>(scheme_);
+            if (use_montgomery_keys_)
+            {
+                scheme |= montgomery_keys_flag;
+            }
+            if (!uses_default_key_switching())
+            {
+                scheme |= key_switching_flag;
+            }
 
             stream.write(reinterpret_cast<const char *>(&scheme), sizeof(uint8_t));
             stream.write(reinterpret_cast<const char *>(&poly_modulus_degree64), sizeof(uint64_t));
@@ -34,6 +53,14 @@ namespace seal
 
             // Only BFV and BGV uses plain_modulus but save it in any case for simplicity
             plain_modulus_.save(stream, compr_mode_type::none);
+
+            if (!uses_default_key_switching())
+            {
+                uint64_t special_prime_count64 = static_cast<uint64_t>(special_prime_count_);
+                uint64_t dnum64 = static_cast<uint64_t>(dnum_);
+                stream.write(reinterpret_cast<const char *>(&special_prime_count64), sizeof(uint64_t));
+                stream.write(reinterpret_cast<const char *>(&dnum64), sizeof(uint64_t));
+            }
         }
         catch (const ios_base::failure &)
         {
@@ -61,7 +88,9 @@ namespace seal
             stream.read(reinterpret_cast<char *>(&scheme), sizeof(uint8_t));
 
             // This constructor will throw if scheme is invalid
-            EncryptionParameters parms(scheme);
+            bool use_montgomery_keys = scheme & montgomery_keys_flag;
+            bool has_key_switching = scheme & key_switching_flag;
+            EncryptionParameters parms(static_cast<uint8_t>(scheme & ~(montgomery_keys_flag | key_switching_flag)));
 
             // Read the poly_modulus_degree
             uint64_t poly_modulus_degree64 = 0;
@@ -95,6 +124,21 @@ namespace seal
             Modulus plain_modulus;
             plain_modulus.load(stream);
 
+            // Read the key switching parameters
+            uint64_t special_prime_count64 = 1;
+            uint64_t dnum64 = 0;
+            if (has_key_switching)
+            {
+                stream.read(reinterpret_cast<char *>(&special_prime_count64), sizeof(uint64_t));
+                stream.read(reinterpret_cast<char *>(&dnum64), sizeof(uint64_t));
+
+                // Neither can exceed the number of primes
+                if (special_prime_count64 > SEAL_COEFF_MOD_COUNT_MAX || dnum64 > SEAL_COEFF_MOD_COUNT_MAX)
+                {
+                    throw logic_error("key switching parameters are invalid");
+                }
+            }
+
             // Supposedly everything worked so set the values of member variables
             parms.set_poly_modulus_degree(safe_cast<size_t>(poly_modulus_degree64));
             parms.set_coeff_modulus(coeff_modulus);
@@ -102,6 +146,9 @@ namespace seal
             // Only BFV and BGV uses plain_modulus; set_plain_modulus checks that for
             // other schemes it is zero
             parms.set_plain_modulus(plain_modulus);
+            parms.set_use_montgomery_keys(use_montgomery_keys);
+            parms.set_special_prime_count(safe_cast<size_t>(special_prime_count64));
+            parms.set_dnum(safe_cast<size_t>(dnum64));
 
             // Set the loaded parameters
             swap(*this, parms);
@@ -128,7 +175,9 @@ namespace seal
         size_t total_uint64_count = add_safe(
             size_t(1), // scheme
             size_t(1), // poly_modulus_degree
-            coeff_modulus_size, plain_modulus_.uint64_count());
+            coeff_modulus_size, plain_modulus_.uint64_count(),
+            size_t(use_montgomery_keys_ ? 1 : 0), // use_montgomery_keys
+            size_t(uses_default_key_switching() ? 0 : 2)); // special_prime_count and dnum
 
         auto param_data(allocate_uint(total_uint64_count, pool_));
         uint64_t *param_data_ptr = param_data.get();
@@ -147,6 +196,17 @@ namespace seal
         set_uint(plain_modulus_.data(), plain_modulus_.uint64_count(), param_data_ptr);
         param_data_ptr += plain_modulus_.uint64_count();
 
+        // Hashed only when set so that the parms_id of other parameters does not change
+        if (use_montgomery_keys_)
+        {
+            *param_data_ptr++ = 1;
+        }
+        if (!uses_default_key_switching())
+        {
+            *param_data_ptr++ = static_cast<uint64_t>(special_prime_count_);
+            *param_data_ptr++ = static_cast<uint64_t>(dnum_);
+        }
+
         HashFunction::hash(param_data.get(), total_uint64_count, parms_id_);
 
         // Did we somehow manage to get a zero block as result? This is reserved for
@@ -37,6 +37,21 @@ namespace seal
         bgv = 0x3
     };
 
+    /**
+    Describes the algorithm used to multiply BFV ciphertexts.
+    */
+    enum class bfv_mul_method_type : std::uint8_t
+    {
+        // Use the default algorithm, which is currently BEHZ for all parameters
+        automatic = 0x0,
+
+        // Bajard-Eynard-Hasan-Zucca RNS variant
+        behz = 0x1,
+
+        // Halevi-Polyakov-Shoup RNS variant
+        hps = 0x2
+    };
+
     /**
     The data type to store unique identifiers of encryption parameters.
     */
@@ -266,6 +281,82 @@ namespace seal
             random_generator_ = std::move(random_generator);
         }
 
+        /**
+        Enables or disables storing key switching keys (relinearization and Galois keys) in Montgomery form, where each
+        coefficient modulo q is kept multiplied by 2^64 mod q. Key switching then reduces its inner products with the
+        keys by Montgomery reduction, which is cheaper than the 128-bit Barrett reduction of the default form. All
+        conversions happen in KeyGenerator, so the option is transparent to the rest of the API. Keys in Montgomery
+        form are serialized as they are; the option is part of the parms_id and is saved with the parameters, so they
+        can only be loaded with parameters that enable it too. This is off by default.
+
+        @param[in] use_montgomery_keys Whether to store key switching keys in Montgomery form
+        */
+        inline void set_use_montgomery_keys(bool use_montgomery_keys)
+        {
+            use_montgomery_keys_ = use_montgomery_keys;
+
+            // Re-compute the parms_id
+            compute_parms_id();
+        }
+
+        /**
+        Sets the algorithm Evaluator uses to multiply and square BFV ciphertexts. The BEHZ variant extends the
+        ciphertexts to an auxiliary base with fast base conversions and corrects their overflows with Montgomery
+        reduction, and divides by the coefficient modulus with a fast floor. The HPS variant extends the ciphertexts
+        exactly to an auxiliary base P with the help of floating-point arithmetic and scales the product to P and back.
+        Both compute correct products with almost the same noise. The method only affects performance: it is not part
+        of the parms_id and is not serialized, so keys and ciphertexts do not depend on it. The default is
+        bfv_mul_method_type::automatic, which currently uses BEHZ for all parameters; HPS must be chosen explicitly.
+
+        @param[in] bfv_mul_method The BFV multiplication method
+        @throws std::logic_error if scheme is not scheme_type::bfv and bfv_mul_method is not
+        bfv_mul_method_type::automatic
+        */
+        inline void set_bfv_mul_method(bfv_mul_method_type bfv_mul_method)
+        {
+            if (scheme_ != scheme_type::bfv && bfv_mul_method != bfv_mul_method_type::automatic)
+            {
+                throw std::logic_error("bfv_mul_method is not supported for this scheme");
+            }
+
+            bfv_mul_method_ = bfv_mul_method;
+        }
+
+        /**
+        Sets the number of special primes: the primes at the end of coeff_modulus that only the key level uses. Key
+        switching extends ciphertexts to the special primes, multiplies them with the keys, and divides the result by
+        the product P of the special primes, so the noise it adds shrinks as P grows compared to the digits of the
+        decomposition (see set_dnum). The default is one special prime. The value must be smaller than the size of
+        coeff_modulus, which SEALContext checks. It is part of the parms_id and is saved with the parameters.
+
+        @param[in] special_prime_count The number of special primes
+        */
+        inline void set_special_prime_count(std::size_t special_prime_count)
+        {
+            special_prime_count_ = special_prime_count;
+
+            // Re-compute the parms_id
+            compute_parms_id();
+        }
+
+        /**
+        Sets the number of digits (dnum) key switching decomposes ciphertexts into. The L primes of coeff_modulus that
+        are not special primes are split into digits of ceil(L / dnum) consecutive primes each, and key switching keys
+        hold one encryption for each digit. Fewer digits make the keys smaller and key switching faster, but the noise
+        of key switching grows with the product of the primes in a digit unless there are enough special primes to
+        match it. The default of zero uses one digit for each prime, as does dnum equal to L. The value must not exceed
+        L, which SEALContext checks. It is part of the parms_id and is saved with the parameters.
+
+        @param[in] dnum The number of digits, or zero for one digit for each prime
+        */
+        inline void set_dnum(std::size_t dnum)
+        {
+            dnum_ = dnum;
+
+            // Re-compute the parms_id
+            compute_parms_id();
+        }
+
         /**
         Returns the encryption scheme type.
         */
@@ -298,6 +389,38 @@ namespace seal
             return plain_modulus_;
         }
 
+        /**
+        Returns whether key switching keys are stored in Montgomery form.
+        */
+        SEAL_NODISCARD inline bool use_montgomery_keys() const noexcept
+        {
+            return use_montgomery_keys_;
+        }
+
+        /**
+        Returns the BFV multiplication method.
+        */
+        SEAL_NODISCARD inline bfv_mul_method_type bfv_mul_method() const noexcept
+        {
+            return bfv_mul_method_;
+        }
+
+        /**
+        Returns the number of special primes.
+        */
+        SEAL_NODISCARD inline std::size_t special_prime_count() const noexcept
+        {
+            return special_prime_count_;
+        }
+
+        /**
+        Returns the number of digits of the key switching decomposition, or zero for one digit for each prime.
+        */
+        SEAL_NODISCARD inline std::size_t dnum() const noexcept
+        {
+            return dnum_;
+        }
+
         /**
         Returns a pointer to the random number generator factory to use for encryption.
         */
@@ -363,7 +486,8 @@ namespace seal
                     sizeof(std::uint64_t), // poly_modulus_degree_
                     sizeof(std::uint64_t), // coeff_modulus_size
                     coeff_modulus_total_size,
-                    util::safe_cast<std::size_t>(plain_modulus_.save_size(compr_mode_type::none))),
+                    util::safe_cast<std::size_t>(plain_modulus_.save_size(compr_mode_type::none)),
+                    uses_default_key_switching() ? std::size_t(0) : 2 * sizeof(std::uint64_t)),
                 compr_mode);
 
             return util::safe_cast<std::streamoff>(util::add_safe(sizeof(Serialization::SEALHeader), members_size));
@@ -483,6 +607,14 @@ namespace seal
             return false;
         }
 
+        /**
+        Returns whether the key switching parameters are the defaults, which are neither hashed nor serialized.
+        */
+        SEAL_NODISCARD bool uses_default_key_switching() const noexcept
+        {
+            return special_prime_count_ == 1 && dnum_ == 0;
+        }
+
         void compute_parms_id();
 
         void save_members(std::ostream &stream) const;
@@ -499,6 +631,14 @@ namespace seal
 
         std::shared_ptr<UniformRandomGeneratorFactory> random_generator_{ nullptr };
 
+        bool use_montgomery_keys_ = false;
+
+        bfv_mul_method_type bfv_mul_method_ = bfv_mul_method_type::automatic;
+
+        std::size_t special_prime_count_ = 1;
+
+        std::size_t dnum_ = 0;
+
         Modulus plain_modulus_{};
 
         parms_id_type parms_id_ = parms_id_zero;
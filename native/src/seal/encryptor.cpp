@@ -130,13 +130,32 @@ namespace seal
                 auto &prev_parms_id = prev_context_data.parms_id();
                 auto rns_tool = prev_context_data.rns_tool();
 
+                // The public key lives at the key level, which drops all special primes at once
+                auto kswitch_tool = (prev_parms_id == context_.key_parms_id()) ? context_data.kswitch_tool() : nullptr;
+
                 // Zero encryption without modulus switching
                 Ciphertext temp(pool);
                 util::encrypt_zero_asymmetric(public_key_, context_, prev_parms_id, is_ntt_form, temp);
 
                 // Modulus switching
                 SEAL_ITERATE(iter(temp, destination), temp.size(), [&](auto I) {
-                    if (is_ntt_form)
+                    if (kswitch_tool)
+                    {
+                        if (is_ntt_form)
+                        {
+                            kswitch_tool->divide_and_round_P_ntt_inplace(
+                                get<0>(I), prev_context_data.small_ntt_tables(), pool);
+                        }
+                        else if (parms.scheme() != scheme_type::bgv)
+                        {
+                            kswitch_tool->divide_and_round_P_inplace(get<0>(I), pool);
+                        }
+                        else
+                        {
+                            kswitch_tool->mod_t_and_divide_P_inplace(get<0>(I), pool);
+                        }
+                    }
+                    else if (is_ntt_form)
                     {
                         rns_tool->divide_and_round_q_last_ntt_inplace(
                             get<0>(I), prev_context_data.small_ntt_tables(), pool);
@@ -12,6 +12,8 @@
 #include <algorithm>
 #include <cmath>
 #include <functional>
+#include <iterator>
+#include <numeric>
 
 using namespace std;
 using namespace seal::util;
@@ -116,6 +118,303 @@ namespace seal
             }
             return make_tuple(multiply_uint_mod(e1, factor1, plain_modulus), e1, e2);
         }
+        /**
+        Computes the product of two ciphertexts whose polynomials are in NTT form modulo each modulus of the base:
+        destination[i] = sum_j encrypted1[j] * encrypted2[i - j], where destination has encrypted1_size +
+        encrypted2_size - 1 polynomials and must not alias the inputs. The terms of each output polynomial are summed
+        with a single reduction by dot_product_coeffmod, so the inputs may be lazily reduced to [0, 4q).
+        */
+        void ciphertext_product(
+            ConstPolyIter encrypted1, size_t encrypted1_size, ConstPolyIter encrypted2, size_t encrypted2_size,
+            ConstModulusIter base, size_t base_size, PolyIter destination, MemoryPoolHandle pool)
+        {
+            size_t coeff_count = destination.poly_modulus_degree();
+            size_t dest_size = encrypted1_size + encrypted2_size - 1;
+            size_t max_steps = min(encrypted1_size, encrypted2_size);
+            auto operands1(allocate<const uint64_t *>(max_steps, pool));
+            auto operands2(allocate<const uint64_t *>(max_steps, pool));
+            SEAL_ITERATE(iter(size_t(0)), dest_size, [&](auto I) {
+                // We iterate over relevant components of encrypted1 and encrypted2 in increasing order for
+                // encrypted1 and reversed (decreasing) order for encrypted2. The bounds for the indices of
+                // the relevant terms are obtained as follows.
+                size_t curr_encrypted1_last = min<size_t>(I, encrypted1_size - 1);
+                size_t curr_encrypted2_first = min<size_t>(I, encrypted2_size - 1);
+                size_t curr_encrypted1_first = I - curr_encrypted2_first;
+
+                // The total number of dyadic products is now easy to compute
+                size_t steps = curr_encrypted1_last - curr_encrypted1_first + 1;
+
+                SEAL_ITERATE(iter(size_t(0)), base_size, [&](auto J) {
+                    SEAL_ITERATE(iter(size_t(0)), steps, [&](auto K) {
+                        operands1[K] = encrypted1[curr_encrypted1_first + K][J].ptr();
+                        operands2[K] = encrypted2[curr_encrypted2_first - K][J].ptr();
+                    });
+                    dot_product_coeffmod(
+                        operands1.get(), operands2.get(), steps, coeff_count, base[J], destination[I][J]);
+                });
+            });
+        }
+
+        // The number of ciphertexts whose key switchings share each pass over the rows of a key. The temporary products
+        // of each ciphertext in a tile take as much memory as a ciphertext of size 2 modulo q U P.
+        constexpr size_t key_switching_tile_size = 8;
+
+        // The number of key coefficients, over all digits and key components, that the inner products of a tile read
+        // in one block; 256 KB fit in the L2 cache of common processors
+        constexpr size_t key_switching_block_uint64_count = size_t(1) << 15;
+
+        // The smallest number of coefficients of a block
+        constexpr size_t key_switching_min_block_size = 256;
+
+        /**
+        Copies the target of a key switching to t_target in normal form and prepares it for the fast base conversion of
+        the digits.
+        */
+        void prepare_key_switching_target(
+            ConstRNSIter target_iter, const SEALContext::ContextData &context_data,
+            const SEALContext::ContextData &key_context_data, RNSIter t_target)
+        {
+            size_t coeff_count = t_target.poly_modulus_degree();
+            size_t decomp_modulus_size = context_data.parms().coeff_modulus().size();
+            set_uint(target_iter, decomp_modulus_size * coeff_count, t_target);
+
+            // In CKKS t_target is in NTT form; switch back to normal form
+            if (context_data.parms().scheme() == scheme_type::ckks)
+            {
+                inverse_ntt_negacyclic_harvey(t_target, decomp_modulus_size, iter(key_context_data.small_ntt_tables()));
+            }
+
+            // This does nothing for digits of one prime
+            context_data.kswitch_tool()->scale_digits_inplace(t_target);
+        }
+
+        /**
+        Writes the digits of a key switching target, extended to the modulus with the given index in the base q U P of
+        kswitch_tool, to the rows of destination in NTT form with values in [0, 4q). The digit containing the modulus
+        itself is the input component target_iter[modulus_index]; when target_is_ntt_form is set it is copied as it is,
+        or not written at all if skip_input_component is also set.
+        */
+        void mod_up_digits(
+            const KSwitchTool &kswitch_tool, ConstRNSIter target_iter, ConstRNSIter t_target, size_t modulus_index,
+            const NTTTables &ntt_tables, bool target_is_ntt_form, bool skip_input_component, RNSIter destination)
+        {
+            size_t coeff_count = destination.poly_modulus_degree();
+            size_t digit_count = kswitch_tool.digit_count();
+            size_t decomp_modulus_size = kswitch_tool.base_q()->size();
+            size_t own_digit =
+                (modulus_index < decomp_modulus_size ? modulus_index / kswitch_tool.digit_size() : digit_count);
+            bool own_digit_is_ntt_form = target_is_ntt_form && (own_digit < digit_count);
+
+            // Perform RNS conversion of all digits
+            SEAL_ITERATE(iter(destination, size_t(0)), digit_count, [&](auto J) {
+                if (get<1>(J) != own_digit)
+                {
+                    kswitch_tool.convert_digit(t_target, get<1>(J), modulus_index, get<0>(J));
+                }
+                else if (!(own_digit_is_ntt_form && skip_input_component))
+                {
+                    set_uint(target_iter[modulus_index], coeff_count, get<0>(J));
+                }
+            });
+
+            // Perform NTT conversion of all digits in one batch; lazy outputs in [0, 4q)
+            if (own_digit_is_ntt_form)
+            {
+                ntt_negacyclic_harvey_lazy(destination, own_digit, ntt_tables);
+                ntt_negacyclic_harvey_lazy(destination + (own_digit + 1), digit_count - own_digit - 1, ntt_tables);
+            }
+            else
+            {
+                ntt_negacyclic_harvey_lazy(destination, digit_count, ntt_tables);
+            }
+        }
+
+        /**
+        Computes the inner products of the extended digits with each component of the key switching keys modulo the
+        key modulus with the given index, and writes them to the corresponding rows of destination. Only the
+        coeff_block_count coefficients starting at coeff_offset are computed; the operands and the rows of destination
+        point to the first of them. The operands may be lazily reduced to [0, 4q); t_keys is scratch space for
+        digit_count pointers.
+        */
+        void key_inner_product(
+            const uint64_t *const *operands, size_t digit_count, const vector<PublicKey> &key_vector,
+            size_t key_index, const SEALContext::ContextData &key_context_data, size_t coeff_offset,
+            size_t coeff_block_count, PolyIter destination, const uint64_t **t_keys)
+        {
+            auto &key_parms = key_context_data.parms();
+            auto &modulus = key_parms.coeff_modulus()[key_index];
+            size_t coeff_count = key_parms.poly_modulus_degree();
+            size_t key_component_count = key_vector[0].data().size();
+            SEAL_ITERATE(iter(size_t(0)), key_component_count, [&](auto K) {
+                SEAL_ITERATE(iter(size_t(0)), digit_count, [&](auto J) {
+                    t_keys[J] = key_vector[J].data().data(K) + key_index * coeff_count + coeff_offset;
+                });
+                if (key_parms.use_montgomery_keys())
+                {
+                    dot_product_montgomery_coeffmod(
+                        operands, t_keys, digit_count, coeff_block_count, modulus, *destination[K]);
+                }
+                else
+                {
+                    dot_product_coeffmod(operands, t_keys, digit_count, coeff_block_count, modulus, *destination[K]);
+                }
+            });
+        }
+
+        /**
+        Divides the accumulated key switching products, which are in NTT form modulo q U P, by P with rounding (with a
+        correction divisible by t in BGV) and adds them to the first key_component_count polynomials of encrypted.
+        The rows of t_ntt, one for each modulus in q, are used as scratch space.
+        */
+        void mod_down_key_switching_result(
+            PolyIter t_poly_prod_iter, size_t key_component_count, const SEALContext::ContextData &context_data,
+            const SEALContext::ContextData &key_context_data, RNSIter t_ntt, Ciphertext &encrypted,
+            MemoryPoolHandle pool)
+        {
+            auto &parms = context_data.parms();
+            auto scheme = parms.scheme();
+            size_t coeff_count = parms.poly_modulus_degree();
+            size_t decomp_modulus_size = parms.coeff_modulus().size();
+            auto &key_modulus = key_context_data.parms().coeff_modulus();
+            size_t key_modulus_size = key_modulus.size();
+            size_t special_prime_count = key_context_data.parms().special_prime_count();
+            auto key_ntt_tables = iter(key_context_data.small_ntt_tables());
+            auto &kswitch_tool = *context_data.kswitch_tool();
+            auto modswitch_factors = kswitch_tool.inv_prod_P_mod_q();
+
+            auto special_ntt_tables = key_ntt_tables + (key_modulus_size - special_prime_count);
+            SEAL_ITERATE(iter(encrypted, t_poly_prod_iter), key_component_count, [&](auto I) {
+                RNSIter t_special(get<1>(I) + decomp_modulus_size);
+                if (scheme == scheme_type::bgv)
+                {
+                    // delta = c + k * P mod q_i with delta divisible by t
+                    inverse_ntt_negacyclic_harvey(t_special, special_prime_count, special_ntt_tables);
+                    kswitch_tool.mod_t_and_divide_P_delta(t_special, t_ntt, pool);
+
+                    SEAL_ITERATE(
+                        iter(I, key_modulus, modswitch_factors, key_ntt_tables, t_ntt), decomp_modulus_size,
+                        [&](auto J) {
+                            inverse_ntt_negacyclic_harvey(get<0, 1>(J), get<3>(J));
+
+                            // c_{i} = c_{i} - delta mod q_i
+                            const uint64_t Lqi = get<1>(J).value() * 2;
+                            SEAL_ITERATE(iter(get<4>(J), get<0, 1>(J)), coeff_count, [Lqi](auto K) {
+                                get<1>(K) = get<1>(K) + Lqi - get<0>(K);
+                            });
+
+                            multiply_poly_scalar_coeffmod(
+                                get<0, 1>(J), coeff_count, get<2>(J), get<1>(J), get<0, 1>(J));
+
+                            add_poly_coeffmod(get<0, 1>(J), get<0, 0>(J), coeff_count, get<1>(J), get<0, 0>(J));
+                        });
+                }
+                else
+                {
+                    // Lazy reduction; the rounding correction for each qi is in [0, 2*qi)
+                    inverse_ntt_negacyclic_harvey_lazy(t_special, special_prime_count, special_ntt_tables);
+                    kswitch_tool.divide_and_round_P_delta(t_special, t_ntt, pool);
+
+                    // Transform all components in one batch
+                    if (scheme == scheme_type::ckks)
+                    {
+                        // This ntt_negacyclic_harvey_lazy results in [0, 4*qi).
+                        ntt_negacyclic_harvey_lazy(t_ntt, decomp_modulus_size, key_ntt_tables);
+                    }
+                    else if (scheme == scheme_type::bfv)
+                    {
+                        inverse_ntt_negacyclic_harvey_lazy(get<1>(I), decomp_modulus_size, key_ntt_tables);
+                    }
+
+                    SEAL_ITERATE(iter(I, key_modulus, t_ntt, modswitch_factors), decomp_modulus_size, [&](auto J) {
+                        uint64_t qi = get<1>(J).value();
+                        uint64_t qi_lazy = qi << 1; // some multiples of qi
+                        if (scheme == scheme_type::ckks)
+                        {
+#if SEAL_USER_MOD_BIT_COUNT_MAX > 60
+                            // Reduce from [0, 4qi) to [0, 2qi)
+                            SEAL_ITERATE(get<2>(J), coeff_count, [&](auto &K) {
+                                K -= SEAL_COND_SELECT(K >= qi_lazy, qi_lazy, 0);
+                            });
+#else
+                            // Since SEAL uses at most 60bit moduli, 8*qi < 2^63.
+                            qi_lazy = qi << 2;
+#endif
+                        }
+
+                        // ((ct mod qi) - delta) mod qi with output in [0, 2 * qi_lazy)
+                        SEAL_ITERATE(iter(get<0, 1>(J), get<2>(J)), coeff_count, [&](auto K) {
+                            get<0>(K) += qi_lazy - get<1>(K);
+                        });
+
+                        // P^(-1) * ((ct mod qi) - delta) mod qi
+                        multiply_poly_scalar_coeffmod(
+                            get<0, 1>(J), coeff_count, get<3>(J), get<1>(J), get<0, 1>(J));
+                        add_poly_coeffmod(get<0, 1>(J), get<0, 0>(J), coeff_count, get<1>(J), get<0, 0>(J));
+                    });
+                }
+            });
+        }
+
+        /**
+        Returns the component with the given index of the product of two ciphertexts of size 2 written to encrypted.
+        The last component is written to last_destination instead if it is set, so that the product can be
+        relinearized without resizing encrypted to size 3.
+        */
+        RNSIter product_component(Ciphertext &encrypted, size_t index, RNSIter last_destination)
+        {
+            return (index == 2 && last_destination) ? last_destination
+                                                    : RNSIter(encrypted.data(index), encrypted.poly_modulus_degree());
+        }
+
+        /**
+        Applies the Galois automorphism to encrypted.data(0) in place, writes the automorphism of encrypted.data(1) to
+        destination, and sets encrypted.data(1) to zero, so that the key switching of destination can be added to
+        encrypted.
+        */
+        void apply_galois_before_key_switching(
+            Ciphertext &encrypted, uint32_t galois_elt, const GaloisTool &galois_tool,
+            const vector<Modulus> &coeff_modulus, RNSIter destination)
+        {
+            size_t coeff_count = encrypted.poly_modulus_degree();
+            size_t coeff_modulus_size = encrypted.coeff_modulus_size();
+
+            // DO NOT CHANGE EXECUTION ORDER OF FOLLOWING SECTION
+            // BEGIN: Apply Galois for each ciphertext
+            // Execution order is sensitive, since apply_galois is not inplace!
+            auto encrypted_iter = iter(encrypted);
+            if (encrypted.is_ntt_form())
+            {
+                // !!! DO NOT CHANGE EXECUTION ORDER!!!
+
+                // First transform encrypted.data(0)
+                galois_tool.apply_galois_ntt(encrypted_iter[0], coeff_modulus_size, galois_elt, destination);
+
+                // Copy result to encrypted.data(0)
+                set_poly(destination, coeff_count, coeff_modulus_size, encrypted.data(0));
+
+                // Next transform encrypted.data(1)
+                galois_tool.apply_galois_ntt(encrypted_iter[1], coeff_modulus_size, galois_elt, destination);
+            }
+            else
+            {
+                // !!! DO NOT CHANGE EXECUTION ORDER!!!
+
+                // First transform encrypted.data(0)
+                galois_tool.apply_galois(encrypted_iter[0], coeff_modulus_size, galois_elt, coeff_modulus, destination);
+
+                // Copy result to encrypted.data(0)
+                set_poly(destination, coeff_count, coeff_modulus_size, encrypted.data(0));
+
+                // Next transform encrypted.data(1)
+                galois_tool.apply_galois(encrypted_iter[1], coeff_modulus_size, galois_elt, coeff_modulus, destination);
+            }
+
+            // Wipe encrypted.data(1)
+            set_zero_poly(coeff_count, coeff_modulus_size, encrypted.data(1));
+
+            // END: Apply Galois for each ciphertext
+            // REORDERING IS SAFE NOW
+        }
     } // namespace
 
     Evaluator::Evaluator(const SEALContext &context) : context_(context)
@@ -392,7 +691,8 @@ namespace seal
 #endif
     }
 
-    void Evaluator::bfv_multiply(Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool) const
+    void Evaluator::bfv_multiply(
+        Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool, RNSIter last_destination) const
     {
         if (encrypted1.is_ntt_form() || encrypted2.is_ntt_form())
         {
@@ -401,6 +701,11 @@ namespace seal
 
         // Extract encryption parameters.
         auto &context_data = *context_.get_context_data(encrypted1.parms_id());
+        if (context_data.qualifiers().using_hps_multiply)
+        {
+            bfv_multiply_hps(encrypted1, encrypted2, move(pool), last_destination);
+            return;
+        }
         auto &parms = context_data.parms();
         size_t coeff_count = parms.poly_modulus_degree();
         size_t base_q_size = parms.coeff_modulus().size();
@@ -441,8 +746,11 @@ namespace seal
         // (7) Scale the result by q using a divide-and-floor algorithm, switching base to Bsk
         // (8) Use Shenoy-Kumaresan method to convert the result to base q
 
-        // Resize encrypted1 to destination size
-        encrypted1.resize(context_, context_data.parms_id(), dest_size);
+        // Resize encrypted1 to destination size, unless the last component is written elsewhere
+        if (!last_destination)
+        {
+            encrypted1.resize(context_, context_data.parms_id(), dest_size);
+        }
 
         // This lambda function takes as input an IterTuple with three components:
         //
@@ -490,55 +798,15 @@ namespace seal
 
         // Allocate temporary space for the output of step (4)
         // We allocate space separately for the base q and the base Bsk components
-        SEAL_ALLOCATE_ZERO_GET_POLY_ITER(temp_dest_q, dest_size, coeff_count, base_q_size, pool);
-        SEAL_ALLOCATE_ZERO_GET_POLY_ITER(temp_dest_Bsk, dest_size, coeff_count, base_Bsk_size, pool);
-
-        // Perform BEHZ step (4): dyadic multiplication on arbitrary size ciphertexts
-        SEAL_ITERATE(iter(size_t(0)), dest_size, [&](auto I) {
-            // We iterate over relevant components of encrypted1 and encrypted2 in increasing order for
-            // encrypted1 and reversed (decreasing) order for encrypted2. The bounds for the indices of
-            // the relevant terms are obtained as follows.
-            size_t curr_encrypted1_last = min<size_t>(I, encrypted1_size - 1);
-            size_t curr_encrypted2_first = min<size_t>(I, encrypted2_size - 1);
-            size_t curr_encrypted1_first = I - curr_encrypted2_first;
-            // size_t curr_encrypted2_last = I - curr_encrypted1_last;
-
-            // The total number of dyadic products is now easy to compute
-            size_t steps = curr_encrypted1_last - curr_encrypted1_first + 1;
-
-            // This lambda function computes the ciphertext product for BFV multiplication. Since we use the BEHZ
-            // approach, the multiplication of individual polynomials is done using a dyadic product where the inputs
-            // are already in NTT form. The arguments of the lambda function are expected to be as follows:
-            //
-            // 1. a ConstPolyIter pointing to the beginning of the first input ciphertext (in NTT form)
-            // 2. a ConstPolyIter pointing to the beginning of the second input ciphertext (in NTT form)
-            // 3. a ConstModulusIter pointing to an array of Modulus elements for the base
-            // 4. the size of the base
-            // 5. a PolyIter pointing to the beginning of the output ciphertext
-            auto behz_ciphertext_product = [&](ConstPolyIter in1_iter, ConstPolyIter in2_iter,
-                                               ConstModulusIter base_iter, size_t base_size, PolyIter out_iter) {
-                // Create a shifted iterator for the first input
-                auto shifted_in1_iter = in1_iter + curr_encrypted1_first;
-
-                // Create a shifted reverse iterator for the second input
-                auto shifted_reversed_in2_iter = reverse_iter(in2_iter + curr_encrypted2_first);
-
-                // Create a shifted iterator for the output
-                auto shifted_out_iter = out_iter[I];
-
-                SEAL_ITERATE(iter(shifted_in1_iter, shifted_reversed_in2_iter), steps, [&](auto J) {
-                    SEAL_ITERATE(iter(J, base_iter, shifted_out_iter), base_size, [&](auto K) {
-                        SEAL_ALLOCATE_GET_COEFF_ITER(temp, coeff_count, pool);
-                        dyadic_product_coeffmod(get<0, 0>(K), get<0, 1>(K), coeff_count, get<1>(K), temp);
-                        add_poly_coeffmod(temp, get<2>(K), coeff_count, get<1>(K), get<2>(K));
-                    });
-                });
-            };
+        SEAL_ALLOCATE_GET_POLY_ITER(temp_dest_q, dest_size, coeff_count, base_q_size, pool);
+        SEAL_ALLOCATE_GET_POLY_ITER(temp_dest_Bsk, dest_size, coeff_count, base_Bsk_size, pool);
 
-            // Perform the BEHZ ciphertext product both for base q and base Bsk
-            behz_ciphertext_product(encrypted1_q, encrypted2_q, base_q, base_q_size, temp_dest_q);
-            behz_ciphertext_product(encrypted1_Bsk, encrypted2_Bsk, base_Bsk, base_Bsk_size, temp_dest_Bsk);
-        });
+        // Perform BEHZ step (4): dyadic multiplication on arbitrary size ciphertexts, both for base q and base Bsk
+        ciphertext_product(
+            encrypted1_q, encrypted1_size, encrypted2_q, encrypted2_size, base_q, base_q_size, temp_dest_q, pool);
+        ciphertext_product(
+            encrypted1_Bsk, encrypted1_size, encrypted2_Bsk, encrypted2_size, base_Bsk, base_Bsk_size, temp_dest_Bsk,
+            pool);
 
         // Perform BEHZ step (5): transform data from NTT form
         // Lazy reduction here. The following multiply_poly_scalar_coeffmod will correct the value back to [0, p)
@@ -546,7 +814,7 @@ namespace seal
         inverse_ntt_negacyclic_harvey_lazy(temp_dest_Bsk, dest_size, base_Bsk_ntt_tables);
 
         // Perform BEHZ steps (6)-(8)
-        SEAL_ITERATE(iter(temp_dest_q, temp_dest_Bsk, encrypted1), dest_size, [&](auto I) {
+        SEAL_ITERATE(iter(temp_dest_q, temp_dest_Bsk, size_t(0)), dest_size, [&](auto I) {
             // Bring together the base q and base Bsk components into a single allocation
             SEAL_ALLOCATE_GET_RNS_ITER(temp_q_Bsk, coeff_count, base_q_size + base_Bsk_size, pool);
 
@@ -562,11 +830,120 @@ namespace seal
             rns_tool->fast_floor(temp_q_Bsk, temp_Bsk, pool);
 
             // Step (8): use Shenoy-Kumaresan method to convert the result to base q and write to encrypted1
-            rns_tool->fastbconv_sk(temp_Bsk, get<2>(I), pool);
+            rns_tool->fastbconv_sk(temp_Bsk, product_component(encrypted1, get<2>(I), last_destination), pool);
+        });
+    }
+
+    void Evaluator::bfv_multiply_hps(
+        Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool, RNSIter last_destination) const
+    {
+        // Extract encryption parameters.
+        auto &context_data = *context_.get_context_data(encrypted1.parms_id());
+        auto &parms = context_data.parms();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t base_q_size = parms.coeff_modulus().size();
+        size_t encrypted1_size = encrypted1.size();
+        size_t encrypted2_size = encrypted2.size();
+
+        auto rns_tool = context_data.rns_tool();
+        size_t base_P_size = rns_tool->base_P()->size();
+
+        // Determine destination.size()
+        size_t dest_size = sub_safe(add_safe(encrypted1_size, encrypted2_size), size_t(1));
+
+        // Size check
+        if (!product_fits_in(dest_size, coeff_count, add_safe(base_q_size, base_P_size)))
+        {
+            throw logic_error("invalid parameters");
+        }
+
+        // Set up iterators for bases
+        auto base_q = iter(parms.coeff_modulus());
+        auto base_P = iter(rns_tool->base_P()->base());
+
+        // Set up iterators for NTT tables
+        auto base_q_ntt_tables = iter(context_data.small_ntt_tables());
+        auto base_P_ntt_tables = iter(rns_tool->base_P_ntt_tables());
+
+        // The HPS multiplication consists of the following steps:
+        //
+        // (1) Extend encrypted1 and encrypted2 (initially in base q) exactly to base P
+        // (2) Transform the data to NTT form
+        // (3) Compute the ciphertext polynomial product using dyadic multiplication
+        // (4) Transform the data back from NTT form
+        // (5) Scale the result by t/q and round, switching base to P
+        // (6) Convert the result exactly to base q
+
+        // This lambda function takes as input an IterTuple with three components:
+        //
+        // 1. (Const)RNSIter to read an input polynomial from
+        // 2. RNSIter for the output in base q
+        // 3. RNSIter for the output in base P
+        //
+        // It performs step (1) of the HPS multiplication on the given input polynomial.
+        auto hps_extend_base = [&](auto I) {
+            // Make copy of input polynomial (in base q)
+            set_poly(get<0>(I), coeff_count, base_q_size, get<1>(I));
+
+            // (1) Convert from base q to base P
+            rns_tool->hps_extend_q_to_P(get<0>(I), get<2>(I), pool);
+        };
+
+        // Perform HPS steps (1)-(2) for encrypted1
+        SEAL_ALLOCATE_GET_POLY_ITER(encrypted1_q, encrypted1_size, coeff_count, base_q_size, pool);
+        SEAL_ALLOCATE_GET_POLY_ITER(encrypted1_P, encrypted1_size, coeff_count, base_P_size, pool);
+        SEAL_ITERATE(iter(encrypted1, encrypted1_q, encrypted1_P), encrypted1_size, hps_extend_base);
+
+        // Transform to NTT form; lazy reduction
+        ntt_negacyclic_harvey_lazy(encrypted1_q, encrypted1_size, base_q_ntt_tables);
+        ntt_negacyclic_harvey_lazy(encrypted1_P, encrypted1_size, base_P_ntt_tables);
+
+        // Repeat for encrypted2 unless squaring, in which case the extension of encrypted1 is used
+        bool squaring = &encrypted2 == &encrypted1;
+        size_t encrypted2_alloc_size = squaring ? 0 : encrypted2_size;
+        SEAL_ALLOCATE_GET_POLY_ITER(encrypted2_q, encrypted2_alloc_size, coeff_count, base_q_size, pool);
+        SEAL_ALLOCATE_GET_POLY_ITER(encrypted2_P, encrypted2_alloc_size, coeff_count, base_P_size, pool);
+        if (!squaring)
+        {
+            SEAL_ITERATE(iter(encrypted2, encrypted2_q, encrypted2_P), encrypted2_size, hps_extend_base);
+            ntt_negacyclic_harvey_lazy(encrypted2_q, encrypted2_size, base_q_ntt_tables);
+            ntt_negacyclic_harvey_lazy(encrypted2_P, encrypted2_size, base_P_ntt_tables);
+        }
+        ConstPolyIter operand2_q = squaring ? encrypted1_q : encrypted2_q;
+        ConstPolyIter operand2_P = squaring ? encrypted1_P : encrypted2_P;
+
+        // Perform HPS step (3): dyadic multiplication on arbitrary size ciphertexts, both for base q and base P
+        SEAL_ALLOCATE_GET_POLY_ITER(temp_dest_q, dest_size, coeff_count, base_q_size, pool);
+        SEAL_ALLOCATE_GET_POLY_ITER(temp_dest_P, dest_size, coeff_count, base_P_size, pool);
+        ciphertext_product(
+            encrypted1_q, encrypted1_size, operand2_q, encrypted2_size, base_q, base_q_size, temp_dest_q, pool);
+        ciphertext_product(
+            encrypted1_P, encrypted1_size, operand2_P, encrypted2_size, base_P, base_P_size, temp_dest_P, pool);
+
+        // Perform HPS step (4): transform data from NTT form
+        // Lazy reduction here; the scaling accepts values in [0, 2p)
+        inverse_ntt_negacyclic_harvey_lazy(temp_dest_q, dest_size, base_q_ntt_tables);
+        inverse_ntt_negacyclic_harvey_lazy(temp_dest_P, dest_size, base_P_ntt_tables);
+
+        // Resize encrypted1 to destination size, unless the last component is written elsewhere
+        if (!last_destination)
+        {
+            encrypted1.resize(context_, context_data.parms_id(), dest_size);
+        }
+
+        // Perform HPS steps (5)-(6)
+        SEAL_ITERATE(iter(temp_dest_q, temp_dest_P, size_t(0)), dest_size, [&](auto I) {
+            // Step (5): scale by t/q and round, producing a result in base P
+            SEAL_ALLOCATE_GET_RNS_ITER(temp_P, coeff_count, base_P_size, pool);
+            rns_tool->hps_scale_and_round(get<0>(I), get<1>(I), temp_P, pool);
+
+            // Step (6): convert the result to base q and write to encrypted1
+            rns_tool->hps_convert_P_to_q(temp_P, product_component(encrypted1, get<2>(I), last_destination), pool);
         });
     }
 
-    void Evaluator::ckks_multiply(Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool) const
+    void Evaluator::ckks_multiply(
+        Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool, RNSIter last_destination) const
     {
         if (!(encrypted1.is_ntt_form() && encrypted2.is_ntt_form()))
         {
@@ -594,8 +971,11 @@ namespace seal
         // Set up iterator for the base
         auto coeff_modulus = iter(parms.coeff_modulus());
 
-        // Prepare destination
-        encrypted1.resize(context_, context_data.parms_id(), dest_size);
+        // Prepare destination, unless the last component is written elsewhere
+        if (!last_destination)
+        {
+            encrypted1.resize(context_, context_data.parms_id(), dest_size);
+        }
 
         // Set up iterators for input ciphertexts
         PolyIter encrypted1_iter = iter(encrypted1);
@@ -603,9 +983,9 @@ namespace seal
 
         if (dest_size == 3)
         {
-            // We want to keep six polynomials in the L1 cache: x[0], x[1], x[2], y[0], y[1], temp.
-            // For a 32KiB cache, which can store 32768 / 8 = 4096 coefficients, = 682.67 coefficients per polynomial,
-            // we should keep the tile size at 682 or below. The tile size must divide coeff_count, i.e. be a power of
+            // We want to keep five polynomials in the L1 cache: x[0], x[1], x[2], y[0], y[1].
+            // For a 32KiB cache, which can store 32768 / 8 = 4096 coefficients, = 819.2 coefficients per polynomial,
+            // we should keep the tile size at 819 or below. The tile size must divide coeff_count, i.e. be a power of
             // two. Some testing shows similar performance with tile size 256 and 512, and worse performance on smaller
             // tiles. We pick the smaller of the two to prevent L1 cache misses on processors with < 32 KiB L1 cache.
             size_t tile_size = min<size_t>(coeff_count, size_t(256));
@@ -622,10 +1002,7 @@ namespace seal
             ConstRNSIter encrypted2_1_iter(*encrypted2_iter[1], tile_size);
             RNSIter encrypted1_0_iter(*encrypted1_iter[0], tile_size);
             RNSIter encrypted1_1_iter(*encrypted1_iter[1], tile_size);
-            RNSIter encrypted1_2_iter(*encrypted1_iter[2], tile_size);
-
-            // Temporary buffer to store intermediate results
-            SEAL_ALLOCATE_GET_COEFF_ITER(temp, tile_size, pool);
+            RNSIter encrypted1_2_iter(*product_component(encrypted1, 2, last_destination), tile_size);
 
             // Computes the output tile_size coefficients at a time
             // Given input tuples of polynomials x = (x[0], x[1], x[2]), y = (y[0], y[1]), computes
@@ -639,13 +1016,10 @@ namespace seal
                         encrypted1_1_iter[0], encrypted2_1_iter[0], tile_size, I, encrypted1_2_iter[0]);
 
                     // Compute second output polynomial, overwriting input
-                    // temp = x[1] * y[0]
-                    dyadic_product_coeffmod(encrypted1_1_iter[0], encrypted2_0_iter[0], tile_size, I, temp);
-                    // x[1] = x[0] * y[1]
-                    dyadic_product_coeffmod(
-                        encrypted1_0_iter[0], encrypted2_1_iter[0], tile_size, I, encrypted1_1_iter[0]);
-                    // x[1] += temp
-                    add_poly_coeffmod(encrypted1_1_iter[0], temp, tile_size, I, encrypted1_1_iter[0]);
+                    // x[1] = x[0] * y[1] + x[1] * y[0]
+                    const uint64_t *x[2]{ encrypted1_0_iter[0].ptr(), encrypted1_1_iter[0].ptr() };
+                    const uint64_t *y[2]{ encrypted2_1_iter[0].ptr(), encrypted2_0_iter[0].ptr() };
+                    dot_product_coeffmod(x, y, 2, tile_size, I, encrypted1_1_iter[0]);
 
                     // Compute first output polynomial, overwriting input
                     // x[0] = x[0] * y[0]
@@ -664,36 +1038,11 @@ namespace seal
         else
         {
             // Allocate temporary space for the result
-            SEAL_ALLOCATE_ZERO_GET_POLY_ITER(temp, dest_size, coeff_count, coeff_modulus_size, pool);
-
-            SEAL_ITERATE(iter(size_t(0)), dest_size, [&](auto I) {
-                // We iterate over relevant components of encrypted1 and encrypted2 in increasing order for
-                // encrypted1 and reversed (decreasing) order for encrypted2. The bounds for the indices of
-                // the relevant terms are obtained as follows.
-                size_t curr_encrypted1_last = min<size_t>(I, encrypted1_size - 1);
-                size_t curr_encrypted2_first = min<size_t>(I, encrypted2_size - 1);
-                size_t curr_encrypted1_first = I - curr_encrypted2_first;
-                // size_t curr_encrypted2_last = secret_power_index - curr_encrypted1_last;
-
-                // The total number of dyadic products is now easy to compute
-                size_t steps = curr_encrypted1_last - curr_encrypted1_first + 1;
-
-                // Create a shifted iterator for the first input
-                auto shifted_encrypted1_iter = encrypted1_iter + curr_encrypted1_first;
-
-                // Create a shifted reverse iterator for the second input
-                auto shifted_reversed_encrypted2_iter = reverse_iter(encrypted2_iter + curr_encrypted2_first);
+            SEAL_ALLOCATE_GET_POLY_ITER(temp, dest_size, coeff_count, coeff_modulus_size, pool);
 
-                SEAL_ITERATE(iter(shifted_encrypted1_iter, shifted_reversed_encrypted2_iter), steps, [&](auto J) {
-                    // Extra care needed here:
-                    // temp_iter must be dereferenced once to produce an appropriate RNSIter
-                    SEAL_ITERATE(iter(J, coeff_modulus, temp[I]), coeff_modulus_size, [&](auto K) {
-                        SEAL_ALLOCATE_GET_COEFF_ITER(prod, coeff_count, pool);
-                        dyadic_product_coeffmod(get<0, 0>(K), get<0, 1>(K), coeff_count, get<1>(K), prod);
-                        add_poly_coeffmod(prod, get<2>(K), coeff_count, get<1>(K), get<2>(K));
-                    });
-                });
-            });
+            ciphertext_product(
+                encrypted1_iter, encrypted1_size, encrypted2_iter, encrypted2_size, coeff_modulus, coeff_modulus_size,
+                temp, pool);
 
             // Set the final result
             set_poly_array(temp, dest_size, coeff_count, coeff_modulus_size, encrypted1.data());
@@ -707,7 +1056,8 @@ namespace seal
         }
     }
 
-    void Evaluator::bgv_multiply(Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool) const
+    void Evaluator::bgv_multiply(
+        Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool, RNSIter last_destination) const
     {
         if (encrypted1.is_ntt_form() || encrypted2.is_ntt_form())
         {
@@ -730,8 +1080,11 @@ namespace seal
         // Set up iterator for the base
         auto coeff_modulus = iter(parms.coeff_modulus());
 
-        // Prepare destination
-        encrypted1.resize(context_, context_data.parms_id(), dest_size);
+        // Prepare destination, unless the last component is written elsewhere
+        if (!last_destination)
+        {
+            encrypted1.resize(context_, context_data.parms_id(), dest_size);
+        }
 
         // Convert c0 and c1 to ntt
         // Set up iterators for input ciphertexts
@@ -751,42 +1104,18 @@ namespace seal
         }
 
         // Allocate temporary space for the result
-        SEAL_ALLOCATE_ZERO_GET_POLY_ITER(temp, dest_size, coeff_count, coeff_modulus_size, pool);
-
-        SEAL_ITERATE(iter(size_t(0)), dest_size, [&](auto I) {
-            // We iterate over relevant components of encrypted1 and encrypted2 in increasing order for
-            // encrypted1 and reversed (decreasing) order for encrypted2. The bounds for the indices of
-            // the relevant terms are obtained as follows.
-            size_t curr_encrypted1_last = min<size_t>(I, encrypted1_size - 1);
-            size_t curr_encrypted2_first = min<size_t>(I, encrypted2_size - 1);
-            size_t curr_encrypted1_first = I - curr_encrypted2_first;
-            // size_t curr_encrypted2_last = secret_power_index - curr_encrypted1_last;
-
-            // The total number of dyadic products is now easy to compute
-            size_t steps = curr_encrypted1_last - curr_encrypted1_first + 1;
-
-            // Create a shifted iterator for the first input
-            auto shifted_encrypted1_iter = encrypted1_iter + curr_encrypted1_first;
-
-            // Create a shifted reverse iterator for the second input
-            auto shifted_reversed_encrypted2_iter = reverse_iter(encrypted2_iter + curr_encrypted2_first);
-
-            SEAL_ITERATE(iter(shifted_encrypted1_iter, shifted_reversed_encrypted2_iter), steps, [&](auto J) {
-                // Extra care needed here:
-                // temp_iter must be dereferenced once to produce an appropriate RNSIter
-                SEAL_ITERATE(iter(J, coeff_modulus, temp[I]), coeff_modulus_size, [&](auto K) {
-                    SEAL_ALLOCATE_GET_COEFF_ITER(prod, coeff_count, pool);
-                    dyadic_product_coeffmod(get<0, 0>(K), get<0, 1>(K), coeff_count, get<1>(K), prod);
-                    add_poly_coeffmod(prod, get<2>(K), coeff_count, get<1>(K), get<2>(K));
-                });
-            });
-        });
+        SEAL_ALLOCATE_GET_POLY_ITER(temp, dest_size, coeff_count, coeff_modulus_size, pool);
 
-        // Set the final result
-        set_poly_array(temp, dest_size, coeff_count, coeff_modulus_size, encrypted1.data());
+        ciphertext_product(
+            encrypted1_iter, encrypted1_size, encrypted2_iter, encrypted2_size, coeff_modulus, coeff_modulus_size, temp,
+            pool);
 
-        // Convert the result (and the original ciphertext) back to non-NTT
-        inverse_ntt_negacyclic_harvey(encrypted1, encrypted1.size(), ntt_table);
+        // Set the final result and convert it back to non-NTT
+        SEAL_ITERATE(iter(temp, size_t(0)), dest_size, [&](auto I) {
+            RNSIter destination = product_component(encrypted1, get<1>(I), last_destination);
+            set_poly(get<0>(I), coeff_count, coeff_modulus_size, destination);
+            inverse_ntt_negacyclic_harvey(destination, coeff_modulus_size, ntt_table);
+        });
 
         // Set the correction factor
         encrypted1.correction_factor() =
@@ -828,7 +1157,7 @@ namespace seal
 #endif
     }
 
-    void Evaluator::bfv_square(Ciphertext &encrypted, MemoryPoolHandle pool) const
+    void Evaluator::bfv_square(Ciphertext &encrypted, MemoryPoolHandle pool, RNSIter last_destination) const
     {
         if (encrypted.is_ntt_form())
         {
@@ -847,10 +1176,11 @@ namespace seal
         size_t base_Bsk_size = rns_tool->base_Bsk()->size();
         size_t base_Bsk_m_tilde_size = rns_tool->base_Bsk_m_tilde()->size();
 
-        // Optimization implemented currently only for size 2 ciphertexts
-        if (encrypted_size != 2)
+        // Optimization implemented currently only for size 2 ciphertexts; HPS multiplication extends the ciphertext
+        // only once when squaring
+        if (encrypted_size != 2 || context_data.qualifiers().using_hps_multiply)
         {
-            bfv_multiply(encrypted, encrypted, move(pool));
+            bfv_multiply(encrypted, encrypted, move(pool), last_destination);
             return;
         }
 
@@ -875,8 +1205,11 @@ namespace seal
         // uses additionally Karatsuba multiplication to reduce the complexity of squaring a size-2 ciphertext, but the
         // steps are otherwise the same as in Evaluator::bfv_multiply.
 
-        // Resize encrypted to destination size
-        encrypted.resize(context_, context_data.parms_id(), dest_size);
+        // Resize encrypted to destination size, unless the last component is written elsewhere
+        if (!last_destination)
+        {
+            encrypted.resize(context_, context_data.parms_id(), dest_size);
+        }
 
         // This lambda function takes as input an IterTuple with three components:
         //
@@ -917,8 +1250,8 @@ namespace seal
 
         // Allocate temporary space for the output of step (4)
         // We allocate space separately for the base q and the base Bsk components
-        SEAL_ALLOCATE_ZERO_GET_POLY_ITER(temp_dest_q, dest_size, coeff_count, base_q_size, pool);
-        SEAL_ALLOCATE_ZERO_GET_POLY_ITER(temp_dest_Bsk, dest_size, coeff_count, base_Bsk_size, pool);
+        SEAL_ALLOCATE_GET_POLY_ITER(temp_dest_q, dest_size, coeff_count, base_q_size, pool);
+        SEAL_ALLOCATE_GET_POLY_ITER(temp_dest_Bsk, dest_size, coeff_count, base_Bsk_size, pool);
 
         // Perform BEHZ step (4): dyadic Karatsuba-squaring on size-2 ciphertexts
 
@@ -952,7 +1285,7 @@ namespace seal
         inverse_ntt_negacyclic_harvey(temp_dest_Bsk, dest_size, base_Bsk_ntt_tables);
 
         // Perform BEHZ steps (6)-(8)
-        SEAL_ITERATE(iter(temp_dest_q, temp_dest_Bsk, encrypted), dest_size, [&](auto I) {
+        SEAL_ITERATE(iter(temp_dest_q, temp_dest_Bsk, size_t(0)), dest_size, [&](auto I) {
             // Bring together the base q and base Bsk components into a single allocation
             SEAL_ALLOCATE_GET_RNS_ITER(temp_q_Bsk, coeff_count, base_q_size + base_Bsk_size, pool);
 
@@ -968,11 +1301,11 @@ namespace seal
             rns_tool->fast_floor(temp_q_Bsk, temp_Bsk, pool);
 
             // Step (8): use Shenoy-Kumaresan method to convert the result to base q and write to encrypted1
-            rns_tool->fastbconv_sk(temp_Bsk, get<2>(I), pool);
+            rns_tool->fastbconv_sk(temp_Bsk, product_component(encrypted, get<2>(I), last_destination), pool);
         });
     }
 
-    void Evaluator::ckks_square(Ciphertext &encrypted, MemoryPoolHandle pool) const
+    void Evaluator::ckks_square(Ciphertext &encrypted, MemoryPoolHandle pool, RNSIter last_destination) const
     {
         if (!encrypted.is_ntt_form())
         {
@@ -989,7 +1322,7 @@ namespace seal
         // Optimization implemented currently only for size 2 ciphertexts
         if (encrypted_size != 2)
         {
-            ckks_multiply(encrypted, encrypted, move(pool));
+            ckks_multiply(encrypted, encrypted, move(pool), last_destination);
             return;
         }
 
@@ -1006,15 +1339,19 @@ namespace seal
         // Set up iterator for the base
         auto coeff_modulus = iter(parms.coeff_modulus());
 
-        // Prepare destination
-        encrypted.resize(context_, context_data.parms_id(), dest_size);
+        // Prepare destination, unless the last component is written elsewhere
+        if (!last_destination)
+        {
+            encrypted.resize(context_, context_data.parms_id(), dest_size);
+        }
 
         // Set up iterators for input ciphertext
         auto encrypted_iter = iter(encrypted);
 
         // Compute c1^2
         dyadic_product_coeffmod(
-            encrypted_iter[1], encrypted_iter[1], coeff_modulus_size, coeff_modulus, encrypted_iter[2]);
+            encrypted_iter[1], encrypted_iter[1], coeff_modulus_size, coeff_modulus,
+            product_component(encrypted, 2, last_destination));
 
         // Compute 2*c0*c1
         dyadic_product_coeffmod(
@@ -1033,7 +1370,7 @@ namespace seal
         }
     }
 
-    void Evaluator::bgv_square(Ciphertext &encrypted, MemoryPoolHandle pool) const
+    void Evaluator::bgv_square(Ciphertext &encrypted, MemoryPoolHandle pool, RNSIter last_destination) const
     {
         if (encrypted.is_ntt_form())
         {
@@ -1051,7 +1388,7 @@ namespace seal
         // Optimization implemented currently only for size 2 ciphertexts
         if (encrypted_size != 2)
         {
-            bgv_multiply(encrypted, encrypted, move(pool));
+            bgv_multiply(encrypted, encrypted, move(pool), last_destination);
             return;
         }
 
@@ -1068,8 +1405,11 @@ namespace seal
         // Set up iterator for the base
         auto coeff_modulus = iter(parms.coeff_modulus());
 
-        // Prepare destination
-        encrypted.resize(context_, context_data.parms_id(), dest_size);
+        // Prepare destination, unless the last component is written elsewhere
+        if (!last_destination)
+        {
+            encrypted.resize(context_, context_data.parms_id(), dest_size);
+        }
 
         // Convert c0 and c1 to ntt
         ntt_negacyclic_harvey(encrypted, encrypted_size, ntt_table);
@@ -1090,54 +1430,153 @@ namespace seal
         // Compute c1^2
         dyadic_product_coeffmod(encrypted_iter[1], encrypted_iter[1], coeff_modulus_size, coeff_modulus, temp[2]);
 
-        // Set the final result
-        set_poly_array(temp, dest_size, coeff_count, coeff_modulus_size, encrypted.data());
-
-        // Convert the final output to Non-NTT form
-        inverse_ntt_negacyclic_harvey(encrypted, dest_size, ntt_table);
+        // Set the final result and convert it to Non-NTT form
+        SEAL_ITERATE(iter(temp, size_t(0)), dest_size, [&](auto I) {
+            RNSIter destination = product_component(encrypted, get<1>(I), last_destination);
+            set_poly(get<0>(I), coeff_count, coeff_modulus_size, destination);
+            inverse_ntt_negacyclic_harvey(destination, coeff_modulus_size, ntt_table);
+        });
 
         // Set the correction factor
         encrypted.correction_factor() =
             multiply_uint_mod(encrypted.correction_factor(), encrypted.correction_factor(), parms.plain_modulus());
     }
 
-    void Evaluator::relinearize_internal(
-        Ciphertext &encrypted, const RelinKeys &relin_keys, size_t destination_size, MemoryPoolHandle pool) const
+    void Evaluator::multiply_relin_internal(
+        Ciphertext &encrypted1, const Ciphertext &encrypted2, const RelinKeys &relin_keys, bool rescale,
+        MemoryPoolHandle pool) const
     {
         // Verify parameters.
-        auto context_data_ptr = context_.get_context_data(encrypted.parms_id());
-        if (!context_data_ptr)
+        if (!is_metadata_valid_for(encrypted1, context_) || !is_buffer_valid(encrypted1))
         {
-            throw invalid_argument("encrypted is not valid for encryption parameters");
+            throw invalid_argument("encrypted1 is not valid for encryption parameters");
+        }
+        if (!is_metadata_valid_for(encrypted2, context_) || !is_buffer_valid(encrypted2))
+        {
+            throw invalid_argument("encrypted2 is not valid for encryption parameters");
+        }
+        if (encrypted1.parms_id() != encrypted2.parms_id())
+        {
+            throw invalid_argument("encrypted1 and encrypted2 parameter mismatch");
         }
         if (relin_keys.parms_id() != context_.key_parms_id())
         {
             throw invalid_argument("relin_keys is not valid for encryption parameters");
         }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
 
-        size_t encrypted_size = encrypted.size();
+        auto &context_data = *context_.get_context_data(encrypted1.parms_id());
+        auto &parms = context_data.parms();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t coeff_modulus_size = parms.coeff_modulus().size();
+        bool squaring = &encrypted1 == &encrypted2;
 
-        // Verify parameters.
-        if (destination_size < 2 || destination_size > encrypted_size)
+        // Check that the result can be rescaled before doing any work
+        if (rescale && parms.scheme() != scheme_type::ckks)
         {
-            throw invalid_argument("destination_size must be at least 2 and less than or equal to current count");
+            throw invalid_argument("unsupported operation for scheme type");
         }
-        if (relin_keys.size() < sub_safe(encrypted_size, size_t(2)))
+        if (rescale && context_.last_parms_id() == encrypted1.parms_id())
         {
-            throw invalid_argument("not enough relinearization keys");
+            throw invalid_argument("end of modulus switching chain reached");
         }
 
-        // If encrypted is already at the desired level, return
-        if (destination_size == encrypted_size)
+        if (encrypted1.size() != 2 || encrypted2.size() != 2)
         {
-            return;
+            // Larger ciphertexts are multiplied and relinearized one after the other
+            if (squaring)
+            {
+                square_inplace(encrypted1, pool);
+            }
+            else
+            {
+                multiply_inplace(encrypted1, encrypted2, pool);
+            }
+            relinearize_internal(encrypted1, relin_keys, 2, pool);
         }
+        else
+        {
+            if (relin_keys.size() < 1)
+            {
+                throw invalid_argument("not enough relinearization keys");
+            }
 
-        // Calculate number of relinearize_one_step calls needed
-        size_t relins_needed = encrypted_size - destination_size;
+            // The last component of the product is the target of the key switching
+            SEAL_ALLOCATE_GET_RNS_ITER(t_last, coeff_count, coeff_modulus_size, pool);
+            switch (parms.scheme())
+            {
+            case scheme_type::bfv:
+                squaring ? bfv_square(encrypted1, pool, t_last) : bfv_multiply(encrypted1, encrypted2, pool, t_last);
+                break;
 
-        // Iterator pointing to the last component of encrypted
-        auto encrypted_iter = iter(encrypted);
+            case scheme_type::ckks:
+                squaring ? ckks_square(encrypted1, pool, t_last) : ckks_multiply(encrypted1, encrypted2, pool, t_last);
+                break;
+
+            case scheme_type::bgv:
+                squaring ? bgv_square(encrypted1, pool, t_last) : bgv_multiply(encrypted1, encrypted2, pool, t_last);
+                break;
+
+            default:
+                throw invalid_argument("unsupported scheme");
+            }
+            switch_key_inplace(
+                encrypted1, t_last, static_cast<const KSwitchKeys &>(relin_keys), RelinKeys::get_index(2), pool);
+        }
+
+        if (rescale)
+        {
+            mod_switch_scale_to_next(encrypted1, encrypted1, pool);
+        }
+#ifdef SEAL_THROW_ON_TRANSPARENT_CIPHERTEXT
+        // Transparent ciphertext output is not allowed.
+        if (encrypted1.is_transparent())
+        {
+            throw logic_error("result ciphertext is transparent");
+        }
+#endif
+    }
+
+    void Evaluator::relinearize_internal(
+        Ciphertext &encrypted, const RelinKeys &relin_keys, size_t destination_size, MemoryPoolHandle pool) const
+    {
+        // Verify parameters.
+        auto context_data_ptr = context_.get_context_data(encrypted.parms_id());
+        if (!context_data_ptr)
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+        if (relin_keys.parms_id() != context_.key_parms_id())
+        {
+            throw invalid_argument("relin_keys is not valid for encryption parameters");
+        }
+
+        size_t encrypted_size = encrypted.size();
+
+        // Verify parameters.
+        if (destination_size < 2 || destination_size > encrypted_size)
+        {
+            throw invalid_argument("destination_size must be at least 2 and less than or equal to current count");
+        }
+        if (relin_keys.size() < sub_safe(encrypted_size, size_t(2)))
+        {
+            throw invalid_argument("not enough relinearization keys");
+        }
+
+        // If encrypted is already at the desired level, return
+        if (destination_size == encrypted_size)
+        {
+            return;
+        }
+
+        // Calculate number of relinearize_one_step calls needed
+        size_t relins_needed = encrypted_size - destination_size;
+
+        // Iterator pointing to the last component of encrypted
+        auto encrypted_iter = iter(encrypted);
         encrypted_iter += encrypted_size - 1;
 
         SEAL_ITERATE(iter(size_t(0)), relins_needed, [&](auto I) {
@@ -1158,6 +1597,82 @@ namespace seal
 #endif
     }
 
+    void Evaluator::relinearize_many_inplace(
+        vector<Ciphertext> &encrypteds, const RelinKeys &relin_keys, MemoryPoolHandle pool) const
+    {
+        if (relin_keys.parms_id() != context_.key_parms_id())
+        {
+            throw invalid_argument("relin_keys is not valid for encryption parameters");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+
+        // Verify all ciphertexts before changing any of them
+        vector<size_t> sizes;
+        for (auto &encrypted : encrypteds)
+        {
+            if (!is_metadata_valid_for(encrypted, context_) || !is_buffer_valid(encrypted))
+            {
+                throw invalid_argument("encrypted is not valid for encryption parameters");
+            }
+            if (relin_keys.size() < sub_safe(encrypted.size(), size_t(2)))
+            {
+                throw invalid_argument("not enough relinearization keys");
+            }
+            sizes.push_back(encrypted.size());
+        }
+
+        // The ciphertexts at the same level that have a component of the same index are key switched together,
+        // starting with the last components. The sizes are decreased only at the end.
+        for (size_t first = 0; first < encrypteds.size(); first++)
+        {
+            auto parms_id = encrypteds[first].parms_id();
+            size_t coeff_count = encrypteds[first].poly_modulus_degree();
+            while (sizes[first] > 2)
+            {
+                size_t max_size = sizes[first];
+                for (size_t i = first + 1; i < encrypteds.size(); i++)
+                {
+                    max_size = encrypteds[i].parms_id() == parms_id ? max(max_size, sizes[i]) : max_size;
+                }
+
+                vector<Ciphertext *> batch;
+                vector<ConstRNSIter> target_iters;
+                for (size_t i = first; i < encrypteds.size(); i++)
+                {
+                    if (encrypteds[i].parms_id() == parms_id && sizes[i] == max_size)
+                    {
+                        batch.push_back(&encrypteds[i]);
+                        target_iters.emplace_back(encrypteds[i].data(max_size - 1), coeff_count);
+                        sizes[i]--;
+                    }
+                }
+                switch_key_many_inplace(
+                    batch, target_iters, static_cast<const KSwitchKeys &>(relin_keys),
+                    RelinKeys::get_index(max_size - 1), pool);
+            }
+        }
+
+        // Put the output of final relinearization into encrypteds.
+        // Prepare encrypteds only at this point because we are resizing down
+        for (auto &encrypted : encrypteds)
+        {
+            if (encrypted.size() > 2)
+            {
+                encrypted.resize(context_, encrypted.parms_id(), 2);
+#ifdef SEAL_THROW_ON_TRANSPARENT_CIPHERTEXT
+                // Transparent ciphertext output is not allowed.
+                if (encrypted.is_transparent())
+                {
+                    throw logic_error("result ciphertext is transparent");
+                }
+#endif
+            }
+        }
+    }
+
     void Evaluator::mod_switch_scale_to_next(
         const Ciphertext &encrypted, Ciphertext &destination, MemoryPoolHandle pool) const
     {
@@ -2266,49 +2781,13 @@ namespace seal
             throw invalid_argument("encrypted size must be 2");
         }
 
-        SEAL_ALLOCATE_GET_RNS_ITER(temp, coeff_count, coeff_modulus_size, pool);
-
-        // DO NOT CHANGE EXECUTION ORDER OF FOLLOWING SECTION
-        // BEGIN: Apply Galois for each ciphertext
-        // Execution order is sensitive, since apply_galois is not inplace!
-        if (parms.scheme() == scheme_type::bfv || parms.scheme() == scheme_type::bgv)
-        {
-            // !!! DO NOT CHANGE EXECUTION ORDER!!!
-
-            // First transform encrypted.data(0)
-            auto encrypted_iter = iter(encrypted);
-            galois_tool->apply_galois(encrypted_iter[0], coeff_modulus_size, galois_elt, coeff_modulus, temp);
-
-            // Copy result to encrypted.data(0)
-            set_poly(temp, coeff_count, coeff_modulus_size, encrypted.data(0));
-
-            // Next transform encrypted.data(1)
-            galois_tool->apply_galois(encrypted_iter[1], coeff_modulus_size, galois_elt, coeff_modulus, temp);
-        }
-        else if (parms.scheme() == scheme_type::ckks)
-        {
-            // !!! DO NOT CHANGE EXECUTION ORDER!!!
-
-            // First transform encrypted.data(0)
-            auto encrypted_iter = iter(encrypted);
-            galois_tool->apply_galois_ntt(encrypted_iter[0], coeff_modulus_size, galois_elt, temp);
-
-            // Copy result to encrypted.data(0)
-            set_poly(temp, coeff_count, coeff_modulus_size, encrypted.data(0));
-
-            // Next transform encrypted.data(1)
-            galois_tool->apply_galois_ntt(encrypted_iter[1], coeff_modulus_size, galois_elt, temp);
-        }
-        else
+        if (parms.scheme() == scheme_type::ckks ? !encrypted.is_ntt_form() : encrypted.is_ntt_form())
         {
-            throw logic_error("scheme not implemented");
+            throw invalid_argument("encrypted is not in the default NTT form");
         }
 
-        // Wipe encrypted.data(1)
-        set_zero_poly(coeff_count, coeff_modulus_size, encrypted.data(1));
-
-        // END: Apply Galois for each ciphertext
-        // REORDERING IS SAFE NOW
+        SEAL_ALLOCATE_GET_RNS_ITER(temp, coeff_count, coeff_modulus_size, pool);
+        apply_galois_before_key_switching(encrypted, galois_elt, *galois_tool, coeff_modulus, temp);
 
         // Calculate (temp * galois_key[0], temp * galois_key[1]) + (ct[0], 0)
         switch_key_inplace(
@@ -2379,300 +2858,1360 @@ namespace seal
         }
     }
 
-    void Evaluator::switch_key_inplace(
-        Ciphertext &encrypted, ConstRNSIter target_iter, const KSwitchKeys &kswitch_keys, size_t kswitch_keys_index,
-        MemoryPoolHandle pool) const
+    void Evaluator::apply_galois_many_internal(
+        const Ciphertext &encrypted, const vector<uint32_t> &galois_elts, const GaloisKeys &galois_keys,
+        const function<void(size_t, PolyIter)> &consume, MemoryPoolHandle pool) const
     {
-        auto parms_id = encrypted.parms_id();
-        auto &context_data = *context_.get_context_data(parms_id);
-        auto &parms = context_data.parms();
-        auto &key_context_data = *context_.key_context_data();
-        auto &key_parms = key_context_data.parms();
-        auto scheme = parms.scheme();
-
         // Verify parameters.
         if (!is_metadata_valid_for(encrypted, context_) || !is_buffer_valid(encrypted))
         {
             throw invalid_argument("encrypted is not valid for encryption parameters");
         }
-        if (!target_iter)
-        {
-            throw invalid_argument("target_iter");
-        }
         if (!context_.using_keyswitching())
         {
             throw logic_error("keyswitching is not supported by the context");
         }
 
-        // Don't validate all of kswitch_keys but just check the parms_id.
-        if (kswitch_keys.parms_id() != context_.key_parms_id())
-        {
-            throw invalid_argument("parameter mismatch");
-        }
-
-        if (kswitch_keys_index >= kswitch_keys.data().size())
+        // Don't validate all of galois_keys but just check the parms_id.
+        if (galois_keys.parms_id() != context_.key_parms_id())
         {
-            throw out_of_range("kswitch_keys_index");
+            throw invalid_argument("galois_keys is not valid for encryption parameters");
         }
         if (!pool)
         {
             throw invalid_argument("pool is uninitialized");
         }
-        if (scheme == scheme_type::bfv && encrypted.is_ntt_form())
-        {
-            throw invalid_argument("BFV encrypted cannot be in NTT form");
-        }
-        if (scheme == scheme_type::ckks && !encrypted.is_ntt_form())
-        {
-            throw invalid_argument("CKKS encrypted must be in NTT form");
-        }
-        if (scheme == scheme_type::bgv && encrypted.is_ntt_form())
-        {
-            throw invalid_argument("BGV encrypted cannot be in NTT form");
-        }
 
-        // Extract encryption parameters.
+        auto &context_data = *context_.get_context_data(encrypted.parms_id());
+        auto &parms = context_data.parms();
+        auto scheme = parms.scheme();
         size_t coeff_count = parms.poly_modulus_degree();
         size_t decomp_modulus_size = parms.coeff_modulus().size();
-        auto &key_modulus = key_parms.coeff_modulus();
-        size_t key_modulus_size = key_modulus.size();
-        size_t rns_modulus_size = decomp_modulus_size + 1;
+        auto &key_context_data = *context_.key_context_data();
+        auto &key_parms = key_context_data.parms();
+        size_t key_modulus_size = key_parms.coeff_modulus().size();
+        size_t special_prime_count = key_parms.special_prime_count();
+        size_t rns_modulus_size = decomp_modulus_size + special_prime_count;
         auto key_ntt_tables = iter(key_context_data.small_ntt_tables());
-        auto modswitch_factors = key_context_data.rns_tool()->inv_q_last_mod_q();
+        auto &kswitch_tool = *context_data.kswitch_tool();
+        size_t digit_count = kswitch_tool.digit_count();
+        // Use key_context_data where permutation tables exist since previous runs.
+        auto galois_tool = key_context_data.galois_tool();
 
         // Size check
-        if (!product_fits_in(coeff_count, rns_modulus_size, size_t(2)))
+        if (!product_fits_in(coeff_count, rns_modulus_size, digit_count))
         {
             throw logic_error("invalid parameters");
         }
 
-        // Prepare input
-        auto &key_vector = kswitch_keys.data()[kswitch_keys_index];
-        size_t key_component_count = key_vector[0].data().size();
-
-        // Check only the used component in KSwitchKeys.
-        for (auto &each_key : key_vector)
+        uint64_t m = mul_safe(static_cast<uint64_t>(coeff_count), uint64_t(2));
+        for (auto galois_elt : galois_elts)
         {
-            if (!is_metadata_valid_for(each_key, context_) || !is_buffer_valid(each_key))
+            if (!(galois_elt & 1) || unsigned_geq(galois_elt, m))
             {
-                throw invalid_argument("kswitch_keys is not valid for encryption parameters");
+                throw invalid_argument("Galois element is not valid");
             }
-        }
-
-        // Create a copy of target_iter
-        SEAL_ALLOCATE_GET_RNS_ITER(t_target, coeff_count, decomp_modulus_size, pool);
-        set_uint(target_iter, decomp_modulus_size * coeff_count, t_target);
 
-        // In CKKS t_target is in NTT form; switch back to normal form
-        if (scheme == scheme_type::ckks)
+            // Check if Galois key is generated or not.
+            if (!galois_keys.has_key(galois_elt))
+            {
+                throw invalid_argument("Galois key not present");
+            }
+        }
+        if (encrypted.size() > 2)
         {
-            inverse_ntt_negacyclic_harvey(t_target, decomp_modulus_size, key_ntt_tables);
+            throw invalid_argument("encrypted size must be 2");
+        }
+        if (scheme == scheme_type::ckks ? !encrypted.is_ntt_form() : encrypted.is_ntt_form())
+        {
+            throw invalid_argument("encrypted is not in the default NTT form");
+        }
+        if (galois_elts.empty())
+        {
+            return;
         }
 
-        // Temporary result
-        auto t_poly_prod(allocate_zero_poly_array(key_component_count, coeff_count, rns_modulus_size, pool));
-
-        SEAL_ITERATE(iter(size_t(0)), rns_modulus_size, [&](auto I) {
-            size_t key_index = (I == decomp_modulus_size ? key_modulus_size - 1 : I);
-
-            // Product of two numbers is up to 60 + 60 = 120 bits, so we can sum up to 256 of them without reduction.
-            size_t lazy_reduction_summand_bound = size_t(SEAL_MULTIPLY_ACCUMULATE_USER_MOD_MAX);
-            size_t lazy_reduction_counter = lazy_reduction_summand_bound;
-
-            // Allocate memory for a lazy accumulator (128-bit coefficients)
-            auto t_poly_lazy(allocate_zero_poly_array(key_component_count, coeff_count, 2, pool));
-
-            // Semantic misuse of PolyIter; this is really pointing to the data for a single RNS factor
-            PolyIter accumulator_iter(t_poly_lazy.get(), 2, coeff_count);
+        // Decompose encrypted.data(1) once: its digits extended to every modulus of q U P, in NTT form. Since the
+        // automorphisms are permutations in the NTT domain and commute with the base conversion up to multiples of the
+        // digit modulus, every key switching below starts from a permutation of these rows.
+        ConstRNSIter target_iter(encrypted.data(1), coeff_count);
+        SEAL_ALLOCATE_GET_RNS_ITER(t_target, coeff_count, decomp_modulus_size, pool);
+        prepare_key_switching_target(target_iter, context_data, key_context_data, t_target);
+        SEAL_ALLOCATE_GET_POLY_ITER(t_digits, rns_modulus_size, coeff_count, digit_count, pool);
+        SEAL_ITERATE(iter(size_t(0), t_digits), rns_modulus_size, [&](auto I) {
+            size_t key_index =
+                (get<0>(I) < decomp_modulus_size ? get<0>(I) : key_modulus_size - rns_modulus_size + get<0>(I));
+            mod_up_digits(
+                kswitch_tool, target_iter, t_target, get<0>(I), key_ntt_tables[key_index],
+                scheme == scheme_type::ckks, false, get<1>(I));
+        });
 
-            // Multiply with keys and perform lazy reduction on product's coefficients
-            SEAL_ITERATE(iter(size_t(0)), decomp_modulus_size, [&](auto J) {
-                SEAL_ALLOCATE_GET_COEFF_ITER(t_ntt, coeff_count, pool);
-                ConstCoeffIter t_operand;
+        // Temporary result and the permuted digits of one key modulus
+        auto t_poly_prod(allocate_poly_array(2, coeff_count, rns_modulus_size, pool));
+        SEAL_ALLOCATE_GET_RNS_ITER(t_permuted, coeff_count, digit_count, pool);
+        auto t_operands(allocate<const uint64_t *>(digit_count, pool));
+        auto t_keys(allocate<const uint64_t *>(digit_count, pool));
+        SEAL_ITERATE(iter(size_t(0)), digit_count, [&](auto J) { t_operands[J] = t_permuted[J].ptr(); });
 
-                // RNS-NTT form exists in input
-                if ((scheme == scheme_type::ckks) && (I == J))
-                {
-                    t_operand = target_iter[J];
-                }
-                // Perform RNS-NTT conversion
-                else
+        for (size_t i = 0; i < galois_elts.size(); i++)
+        {
+            uint32_t galois_elt = galois_elts[i];
+            auto key_vector_ptr = galois_keys.expanded_data(context_, GaloisKeys::get_index(galois_elt));
+            auto &key_vector = *key_vector_ptr;
+            for (auto &each_key : key_vector)
+            {
+                if (!is_metadata_valid_for(each_key, context_) || !is_buffer_valid(each_key))
                 {
-                    // No need to perform RNS conversion (modular reduction)
-                    if (key_modulus[J] <= key_modulus[key_index])
-                    {
-                        set_uint(t_target[J], coeff_count, t_ntt);
-                    }
-                    // Perform RNS conversion (modular reduction)
-                    else
-                    {
-                        modulo_poly_coeffs(t_target[J], coeff_count, key_modulus[key_index], t_ntt);
-                    }
-                    // NTT conversion lazy outputs in [0, 4q)
-                    ntt_negacyclic_harvey_lazy(t_ntt, key_ntt_tables[key_index]);
-                    t_operand = t_ntt;
+                    throw invalid_argument("galois_keys is not valid for encryption parameters");
                 }
+            }
 
-                // Multiply with keys and modular accumulate products in a lazy fashion
-                SEAL_ITERATE(iter(key_vector[J].data(), accumulator_iter), key_component_count, [&](auto K) {
-                    if (!lazy_reduction_counter)
-                    {
-                        SEAL_ITERATE(iter(t_operand, get<0>(K)[key_index], get<1>(K)), coeff_count, [&](auto L) {
-                            unsigned long long qword[2]{ 0, 0 };
-                            multiply_uint64(get<0>(L), get<1>(L), qword);
-
-                            // Accumulate product of t_operand and t_key_acc to t_poly_lazy and reduce
-                            add_uint128(qword, get<2>(L).ptr(), qword);
-                            get<2>(L)[0] = barrett_reduce_128(qword, key_modulus[key_index]);
-                            get<2>(L)[1] = 0;
-                        });
-                    }
-                    else
-                    {
-                        // Same as above but no reduction
-                        SEAL_ITERATE(iter(t_operand, get<0>(K)[key_index], get<1>(K)), coeff_count, [&](auto L) {
-                            unsigned long long qword[2]{ 0, 0 };
-                            multiply_uint64(get<0>(L), get<1>(L), qword);
-                            add_uint128(qword, get<2>(L).ptr(), qword);
-                            get<2>(L)[0] = qword[0];
-                            get<2>(L)[1] = qword[1];
-                        });
-                    }
-                });
-
-                if (!--lazy_reduction_counter)
-                {
-                    lazy_reduction_counter = lazy_reduction_summand_bound;
-                }
+            SEAL_ITERATE(iter(size_t(0), t_digits), rns_modulus_size, [&](auto J) {
+                size_t key_index =
+                    (get<0>(J) < decomp_modulus_size ? get<0>(J) : key_modulus_size - rns_modulus_size + get<0>(J));
+                galois_tool->apply_galois_ntt(get<1>(J), digit_count, galois_elt, t_permuted);
+                key_inner_product(
+                    t_operands.get(), digit_count, key_vector, key_index, key_context_data, 0, coeff_count,
+                    PolyIter(t_poly_prod.get() + (get<0>(J) * coeff_count), coeff_count, rns_modulus_size),
+                    t_keys.get());
             });
+            consume(i, PolyIter(t_poly_prod.get(), coeff_count, rns_modulus_size));
+        }
+    }
 
-            // PolyIter pointing to the destination t_poly_prod, shifted to the appropriate modulus
-            PolyIter t_poly_prod_iter(t_poly_prod.get() + (I * coeff_count), coeff_count, rns_modulus_size);
+    void Evaluator::apply_galois_many(
+        const Ciphertext &encrypted, const vector<uint32_t> &galois_elts, const GaloisKeys &galois_keys,
+        vector<Ciphertext> &destinations, MemoryPoolHandle pool) const
+    {
+        auto context_data_ptr = context_.get_context_data(encrypted.parms_id());
+        if (!context_data_ptr || !context_data_ptr->kswitch_tool())
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+        auto &context_data = *context_data_ptr;
+        auto &parms = context_data.parms();
+        auto &coeff_modulus = parms.coeff_modulus();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t coeff_modulus_size = coeff_modulus.size();
+        auto galois_tool = context_.key_context_data()->galois_tool();
 
-            // Final modular reduction
-            SEAL_ITERATE(iter(accumulator_iter, t_poly_prod_iter), key_component_count, [&](auto K) {
-                if (lazy_reduction_counter == lazy_reduction_summand_bound)
+        // The results are written to destinations only at the end, since encrypted may be one of them
+        vector<Ciphertext> results(galois_elts.size(), Ciphertext(pool));
+
+        // The rounding corrections of the modulus switching
+        SEAL_ALLOCATE_GET_RNS_ITER(t_ntt, coeff_count, coeff_modulus_size, pool);
+        ConstRNSIter encrypted_c0(encrypted.data(0), coeff_count);
+
+        apply_galois_many_internal(
+            encrypted, galois_elts, galois_keys,
+            [&](size_t index, PolyIter t_poly_prod_iter) {
+                uint32_t galois_elt = galois_elts[index];
+                Ciphertext &destination = results[index];
+                destination.resize(context_, encrypted.parms_id(), 2);
+                destination.is_ntt_form() = encrypted.is_ntt_form();
+                destination.scale() = encrypted.scale();
+                destination.correction_factor() = encrypted.correction_factor();
+
+                // The automorphism of encrypted.data(0); encrypted.data(1) is replaced by the key switching result
+                RNSIter destination_c0(destination.data(0), coeff_count);
+                if (parms.scheme() == scheme_type::ckks)
                 {
-                    SEAL_ITERATE(iter(get<0>(K), *get<1>(K)), coeff_count, [&](auto L) {
-                        get<1>(L) = static_cast<uint64_t>(*get<0>(L));
-                    });
+                    galois_tool->apply_galois_ntt(encrypted_c0, coeff_modulus_size, galois_elt, destination_c0);
                 }
                 else
                 {
-                    // Same as above except need to still do reduction
-                    SEAL_ITERATE(iter(get<0>(K), *get<1>(K)), coeff_count, [&](auto L) {
-                        get<1>(L) = barrett_reduce_128(get<0>(L).ptr(), key_modulus[key_index]);
-                    });
+                    galois_tool->apply_galois(
+                        encrypted_c0, coeff_modulus_size, galois_elt, coeff_modulus, destination_c0);
                 }
-            });
-        });
-        // Accumulated products are now stored in t_poly_prod
-
-        // Perform modulus switching with scaling
-        PolyIter t_poly_prod_iter(t_poly_prod.get(), coeff_count, rns_modulus_size);
-        SEAL_ITERATE(iter(encrypted, t_poly_prod_iter), key_component_count, [&](auto I) {
-            if (scheme == scheme_type::bgv)
-            {
-                const Modulus &plain_modulus = parms.plain_modulus();
-                // qk is the special prime
-                uint64_t qk = key_modulus[key_modulus_size - 1].value();
-                uint64_t qk_inv_qp = context_.key_context_data()->rns_tool()->inv_q_last_mod_t();
-
-                // Lazy reduction; this needs to be then reduced mod qi
-                CoeffIter t_last(get<1>(I)[decomp_modulus_size]);
-                inverse_ntt_negacyclic_harvey(t_last, key_ntt_tables[key_modulus_size - 1]);
-
-                SEAL_ALLOCATE_ZERO_GET_COEFF_ITER(k, coeff_count, pool);
-                modulo_poly_coeffs(t_last, coeff_count, plain_modulus, k);
-                negate_poly_coeffmod(k, coeff_count, plain_modulus, k);
-                if (qk_inv_qp != 1)
+                set_zero_poly(coeff_count, coeff_modulus_size, destination.data(1));
+
+                mod_down_key_switching_result(
+                    t_poly_prod_iter, 2, context_data, *context_.key_context_data(), t_ntt, destination, pool);
+#ifdef SEAL_THROW_ON_TRANSPARENT_CIPHERTEXT
+                // Transparent ciphertext output is not allowed.
+                if (destination.is_transparent())
                 {
-                    multiply_poly_scalar_coeffmod(k, coeff_count, qk_inv_qp, plain_modulus, k);
+                    throw logic_error("result ciphertext is transparent");
                 }
+#endif
+            },
+            pool);
+        destinations = move(results);
+    }
 
-                SEAL_ALLOCATE_ZERO_GET_COEFF_ITER(delta, coeff_count, pool);
-                SEAL_ALLOCATE_ZERO_GET_COEFF_ITER(c_mod_qi, coeff_count, pool);
-                SEAL_ITERATE(iter(I, key_modulus, modswitch_factors, key_ntt_tables), decomp_modulus_size, [&](auto J) {
-                    inverse_ntt_negacyclic_harvey(get<0, 1>(J), get<3>(J));
-                    // delta = k mod q_i
-                    modulo_poly_coeffs(k, coeff_count, get<1>(J), delta);
-                    // delta = k * q_k mod q_i
-                    multiply_poly_scalar_coeffmod(delta, coeff_count, qk, get<1>(J), delta);
-
-                    // c mod q_i
-                    modulo_poly_coeffs(t_last, coeff_count, get<1>(J), c_mod_qi);
-                    // delta = c + k * q_k mod q_i
-                    // c_{i} = c_{i} - delta mod q_i
-                    const uint64_t Lqi = get<1>(J).value() * 2;
-                    SEAL_ITERATE(iter(delta, c_mod_qi, get<0, 1>(J)), coeff_count, [Lqi](auto K) {
-                        get<2>(K) = get<2>(K) + Lqi - (get<0>(K) + get<1>(K));
-                    });
-
-                    multiply_poly_scalar_coeffmod(get<0, 1>(J), coeff_count, get<2>(J), get<1>(J), get<0, 1>(J));
+    void Evaluator::apply_galois_many_inplace(
+        vector<Ciphertext> &encrypteds, uint32_t galois_elt, const GaloisKeys &galois_keys,
+        MemoryPoolHandle pool) const
+    {
+        // Don't validate all of galois_keys but just check the parms_id.
+        if (galois_keys.parms_id() != context_.key_parms_id())
+        {
+            throw invalid_argument("galois_keys is not valid for encryption parameters");
+        }
+        if (!galois_keys.has_key(galois_elt))
+        {
+            throw invalid_argument("Galois key not present");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
 
-                    add_poly_coeffmod(get<0, 1>(J), get<0, 0>(J), coeff_count, get<1>(J), get<0, 0>(J));
-                });
+        // Verify all ciphertexts before changing any of them
+        auto &key_context_data = *context_.key_context_data();
+        uint64_t m = mul_safe(static_cast<uint64_t>(key_context_data.parms().poly_modulus_degree()), uint64_t(2));
+        if (!(galois_elt & 1) || unsigned_geq(galois_elt, m))
+        {
+            throw invalid_argument("Galois element is not valid");
+        }
+        for (auto &encrypted : encrypteds)
+        {
+            if (!is_metadata_valid_for(encrypted, context_) || !is_buffer_valid(encrypted))
+            {
+                throw invalid_argument("encrypted is not valid for encryption parameters");
             }
-            else
+            if (encrypted.size() > 2)
             {
-                // Lazy reduction; this needs to be then reduced mod qi
-                CoeffIter t_last(get<1>(I)[decomp_modulus_size]);
-                inverse_ntt_negacyclic_harvey_lazy(t_last, key_ntt_tables[key_modulus_size - 1]);
-
-                // Add (p-1)/2 to change from flooring to rounding.
-                uint64_t qk = key_modulus[key_modulus_size - 1].value();
-                uint64_t qk_half = qk >> 1;
-                SEAL_ITERATE(t_last, coeff_count, [&](auto &J) {
-                    J = barrett_reduce_64(J + qk_half, key_modulus[key_modulus_size - 1]);
-                });
-
-                SEAL_ITERATE(iter(I, key_modulus, key_ntt_tables, modswitch_factors), decomp_modulus_size, [&](auto J) {
-                    SEAL_ALLOCATE_GET_COEFF_ITER(t_ntt, coeff_count, pool);
+                throw invalid_argument("encrypted size must be 2");
+            }
+            auto scheme = context_.get_context_data(encrypted.parms_id())->parms().scheme();
+            if (scheme == scheme_type::ckks ? !encrypted.is_ntt_form() : encrypted.is_ntt_form())
+            {
+                throw invalid_argument("encrypted is not in the default NTT form");
+            }
+        }
+        if (!context_.using_keyswitching())
+        {
+            throw logic_error("keyswitching is not supported by the context");
+        }
+
+        // Use key_context_data where permutation tables exist since previous runs.
+        auto galois_tool = key_context_data.galois_tool();
+
+        // The ciphertexts at the same level are key switched together
+        vector<bool> done(encrypteds.size(), false);
+        for (size_t first = 0; first < encrypteds.size(); first++)
+        {
+            if (done[first])
+            {
+                continue;
+            }
+            auto parms_id = encrypteds[first].parms_id();
+            vector<Ciphertext *> batch;
+            for (size_t i = first; i < encrypteds.size(); i++)
+            {
+                if (!done[i] && encrypteds[i].parms_id() == parms_id)
+                {
+                    batch.push_back(&encrypteds[i]);
+                    done[i] = true;
+                }
+            }
+
+            auto &context_data = *context_.get_context_data(parms_id);
+            auto &coeff_modulus = context_data.parms().coeff_modulus();
+            size_t coeff_count = context_data.parms().poly_modulus_degree();
+            size_t coeff_modulus_size = coeff_modulus.size();
+
+            // The automorphisms of the second polynomials are the targets of the key switching
+            SEAL_ALLOCATE_GET_POLY_ITER(temps, batch.size(), coeff_count, coeff_modulus_size, pool);
+            vector<ConstRNSIter> target_iters;
+            SEAL_ITERATE(iter(batch, temps), batch.size(), [&](auto I) {
+                apply_galois_before_key_switching(*get<0>(I), galois_elt, *galois_tool, coeff_modulus, get<1>(I));
+                target_iters.push_back(get<1>(I));
+            });
+
+            switch_key_many_inplace(
+                batch, target_iters, static_cast<const KSwitchKeys &>(galois_keys), GaloisKeys::get_index(galois_elt),
+                pool);
+#ifdef SEAL_THROW_ON_TRANSPARENT_CIPHERTEXT
+            // Transparent ciphertext output is not allowed.
+            for (auto encrypted : batch)
+            {
+                if (encrypted->is_transparent())
+                {
+                    throw logic_error("result ciphertext is transparent");
+                }
+            }
+#endif
+        }
+    }
+
+    void Evaluator::apply_galois_many_extended(
+        const Ciphertext &encrypted, const vector<uint32_t> &galois_elts, const GaloisKeys &galois_keys,
+        vector<ExtendedCiphertext> &destinations, MemoryPoolHandle pool) const
+    {
+        auto context_data_ptr = context_.get_context_data(encrypted.parms_id());
+        if (!context_data_ptr || !context_data_ptr->kswitch_tool())
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+        auto &context_data = *context_data_ptr;
+        auto &parms = context_data.parms();
+        auto &coeff_modulus = parms.coeff_modulus();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t coeff_modulus_size = coeff_modulus.size();
+        auto ntt_tables = iter(context_data.small_ntt_tables());
+        auto galois_tool = context_.key_context_data()->galois_tool();
+        auto prod_P_mod_q = context_data.kswitch_tool()->prod_P_mod_q();
+
+        vector<ExtendedCiphertext> results(galois_elts.size(), ExtendedCiphertext(pool));
+
+        // P * encrypted.data(0) in NTT form; its automorphisms are permutations of it. Like the key switching
+        // results, it is divided by P only in transform_from_extended.
+        SEAL_ALLOCATE_GET_RNS_ITER(t_c0, coeff_count, coeff_modulus_size, pool);
+        SEAL_ALLOCATE_GET_RNS_ITER(t_permuted, coeff_count, coeff_modulus_size, pool);
+
+        apply_galois_many_internal(
+            encrypted, galois_elts, galois_keys,
+            [&](size_t index, PolyIter t_poly_prod_iter) {
+                if (index == 0)
+                {
+                    set_poly(encrypted.data(0), coeff_count, coeff_modulus_size, t_c0);
+                    if (!encrypted.is_ntt_form())
+                    {
+                        ntt_negacyclic_harvey(t_c0, coeff_modulus_size, ntt_tables);
+                    }
+                    SEAL_ITERATE(iter(t_c0, coeff_modulus, prod_P_mod_q), coeff_modulus_size, [&](auto I) {
+                        multiply_poly_scalar_coeffmod(get<0>(I), coeff_count, get<2>(I), get<1>(I), get<0>(I));
+                    });
+                }
+
+                ExtendedCiphertext &destination = results[index];
+                destination.resize(context_, encrypted.parms_id());
+                destination.scale() = encrypted.scale();
+                destination.correction_factor() = encrypted.correction_factor();
+                set_poly_array(
+                    t_poly_prod_iter, 2, coeff_count, destination.coeff_modulus_size(), destination.data());
+
+                galois_tool->apply_galois_ntt(t_c0, coeff_modulus_size, galois_elts[index], t_permuted);
+                RNSIter destination_c0(destination.data(0), coeff_count);
+                add_poly_coeffmod(destination_c0, t_permuted, coeff_modulus_size, coeff_modulus, destination_c0);
+            },
+            pool);
+        destinations = move(results);
+    }
+
+    void Evaluator::rotate_many_internal(
+        const Ciphertext &encrypted, const vector<int> &steps, const GaloisKeys &galois_keys,
+        vector<Ciphertext> &destinations, MemoryPoolHandle pool) const
+    {
+        auto hoisted_elts = hoisted_rotation_elts(encrypted, steps, galois_keys);
+        vector<Ciphertext> hoisted;
+        apply_galois_many(encrypted, hoisted_elts, galois_keys, hoisted, pool);
+
+        // The rotations without a Galois key of their own are composed of several rotations by rotate_internal
+        auto galois_tool = context_.key_context_data()->galois_tool();
+        vector<Ciphertext> results;
+        results.reserve(steps.size());
+        auto hoisted_iter = hoisted.begin();
+        for (auto step : steps)
+        {
+            if (step != 0 && galois_keys.has_key(galois_tool->get_elt_from_step(step)))
+            {
+                results.push_back(move(*hoisted_iter++));
+            }
+            else
+            {
+                results.push_back(encrypted);
+                rotate_internal(results.back(), step, galois_keys, pool);
+            }
+        }
+        destinations = move(results);
+    }
+
+    void Evaluator::rotate_plan_internal(
+        const Ciphertext &encrypted, const RotationPlan &plan, const GaloisKeys &galois_keys,
+        vector<Ciphertext> &destinations, MemoryPoolHandle pool) const
+    {
+        auto context_data_ptr = context_.get_context_data(encrypted.parms_id());
+        if (!context_data_ptr)
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+        if (!context_data_ptr->qualifiers().using_batching)
+        {
+            throw logic_error("encryption parameters do not support batching");
+        }
+        if (plan.poly_modulus_degree() != context_data_ptr->parms().poly_modulus_degree())
+        {
+            throw invalid_argument("plan is not valid for encryption parameters");
+        }
+        if (galois_keys.parms_id() != context_.key_parms_id())
+        {
+            throw invalid_argument("galois_keys is not valid for encryption parameters");
+        }
+        auto galois_tool = context_data_ptr->galois_tool();
+
+        // The children of a node are consecutive and share one decomposition of the node
+        auto &nodes = plan.nodes();
+        vector<Ciphertext> rotated;
+        rotated.reserve(nodes.size());
+        for (size_t first = 0; first < nodes.size();)
+        {
+            size_t parent = nodes[first].parent;
+            vector<uint32_t> galois_elts;
+            size_t last = first;
+            for (; last < nodes.size() && nodes[last].parent == parent; last++)
+            {
+                galois_elts.push_back(galois_tool->get_elt_from_step(nodes[last].key_step));
+            }
+
+            vector<Ciphertext> children;
+            apply_galois_many(
+                parent == RotationPlan::input_index ? encrypted : rotated[parent], galois_elts, galois_keys, children,
+                pool);
+            move(children.begin(), children.end(), back_inserter(rotated));
+            first = last;
+        }
+
+        vector<Ciphertext> results;
+        results.reserve(plan.outputs().size());
+        for (auto output : plan.outputs())
+        {
+            results.push_back(output == RotationPlan::input_index ? encrypted : rotated[output]);
+        }
+        destinations = move(results);
+    }
+
+    void Evaluator::rotate_many_extended_internal(
+        const Ciphertext &encrypted, const vector<int> &steps, const GaloisKeys &galois_keys,
+        vector<ExtendedCiphertext> &destinations, MemoryPoolHandle pool) const
+    {
+        auto hoisted_elts = hoisted_rotation_elts(encrypted, steps, galois_keys);
+        vector<ExtendedCiphertext> hoisted;
+        apply_galois_many_extended(encrypted, hoisted_elts, galois_keys, hoisted, pool);
+
+        // The rotations without a Galois key of their own are composed of several rotations by rotate_internal and
+        // then brought to the extended modulus
+        auto galois_tool = context_.key_context_data()->galois_tool();
+        vector<ExtendedCiphertext> results;
+        results.reserve(steps.size());
+        auto hoisted_iter = hoisted.begin();
+        for (auto step : steps)
+        {
+            if (step != 0 && galois_keys.has_key(galois_tool->get_elt_from_step(step)))
+            {
+                results.push_back(move(*hoisted_iter++));
+            }
+            else
+            {
+                Ciphertext rotated = encrypted;
+                rotate_internal(rotated, step, galois_keys, pool);
+                results.emplace_back(pool);
+                transform_to_extended(rotated, results.back(), pool);
+            }
+        }
+        destinations = move(results);
+    }
+
+    vector<uint32_t> Evaluator::hoisted_rotation_elts(
+        const Ciphertext &encrypted, const vector<int> &steps, const GaloisKeys &galois_keys) const
+    {
+        auto context_data_ptr = context_.get_context_data(encrypted.parms_id());
+        if (!context_data_ptr)
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+        if (!context_data_ptr->qualifiers().using_batching)
+        {
+            throw logic_error("encryption parameters do not support batching");
+        }
+        if (galois_keys.parms_id() != context_.key_parms_id())
+        {
+            throw invalid_argument("galois_keys is not valid for encryption parameters");
+        }
+        auto galois_tool = context_data_ptr->galois_tool();
+
+        // The rotations with a Galois key of their own share one decomposition
+        vector<uint32_t> hoisted_elts;
+        for (auto step : steps)
+        {
+            if (step != 0)
+            {
+                uint32_t galois_elt = galois_tool->get_elt_from_step(step);
+                if (galois_keys.has_key(galois_elt))
+                {
+                    hoisted_elts.push_back(galois_elt);
+                }
+            }
+        }
+        return hoisted_elts;
+    }
+
+    void Evaluator::transform_to_extended(
+        const Ciphertext &encrypted, ExtendedCiphertext &destination, MemoryPoolHandle pool) const
+    {
+        // Verify parameters.
+        if (!is_metadata_valid_for(encrypted, context_) || !is_buffer_valid(encrypted))
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+        if (encrypted.size() != 2)
+        {
+            throw invalid_argument("encrypted size must be 2");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+        auto &context_data = *context_.get_context_data(encrypted.parms_id());
+        auto &parms = context_data.parms();
+        auto scheme = parms.scheme();
+        if (scheme == scheme_type::ckks ? !encrypted.is_ntt_form() : encrypted.is_ntt_form())
+        {
+            throw invalid_argument("encrypted is not in the default NTT form");
+        }
+
+        auto &coeff_modulus = parms.coeff_modulus();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t coeff_modulus_size = coeff_modulus.size();
+        auto ntt_tables = iter(context_data.small_ntt_tables());
+        auto prod_P_mod_q = context_data.kswitch_tool()->prod_P_mod_q();
+
+        // P * encrypted modulo q, and zero modulo the special primes
+        destination.resize(context_, encrypted.parms_id());
+        destination.scale() = encrypted.scale();
+        destination.correction_factor() = encrypted.correction_factor();
+        PolyIter destination_iter(destination.data(), coeff_count, destination.coeff_modulus_size());
+        SEAL_ITERATE(iter(ConstPolyIter(encrypted), destination_iter), size_t(2), [&](auto I) {
+            set_poly(get<0>(I), coeff_count, coeff_modulus_size, get<1>(I));
+            if (scheme != scheme_type::ckks)
+            {
+                ntt_negacyclic_harvey(get<1>(I), coeff_modulus_size, ntt_tables);
+            }
+            SEAL_ITERATE(iter(get<1>(I), coeff_modulus, prod_P_mod_q), coeff_modulus_size, [&](auto J) {
+                multiply_poly_scalar_coeffmod(get<0>(J), coeff_count, get<2>(J), get<1>(J), get<0>(J));
+            });
+        });
+    }
+
+    void Evaluator::transform_from_extended(
+        const ExtendedCiphertext &encrypted, Ciphertext &destination, MemoryPoolHandle pool) const
+    {
+        // Verify parameters.
+        if (!is_extended_valid(encrypted))
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+        auto &context_data = *context_.get_context_data(encrypted.parms_id());
+        auto &parms = context_data.parms();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t coeff_modulus_size = parms.coeff_modulus().size();
+        size_t rns_modulus_size = encrypted.coeff_modulus_size();
+
+        // The modulus switching works in place
+        auto t_poly_prod(allocate_poly_array(2, coeff_count, rns_modulus_size, pool));
+        set_poly_array(encrypted.data(), 2, coeff_count, rns_modulus_size, t_poly_prod.get());
+        SEAL_ALLOCATE_GET_RNS_ITER(t_ntt, coeff_count, coeff_modulus_size, pool);
+
+        destination.resize(context_, encrypted.parms_id(), 2);
+        destination.is_ntt_form() = (parms.scheme() == scheme_type::ckks);
+        destination.scale() = encrypted.scale();
+        destination.correction_factor() = encrypted.correction_factor();
+        set_zero_poly_array(2, coeff_count, coeff_modulus_size, destination.data());
+        mod_down_key_switching_result(
+            PolyIter(t_poly_prod.get(), coeff_count, rns_modulus_size), 2, context_data, *context_.key_context_data(),
+            t_ntt, destination, pool);
+#ifdef SEAL_THROW_ON_TRANSPARENT_CIPHERTEXT
+        // Transparent ciphertext output is not allowed.
+        if (destination.is_transparent())
+        {
+            throw logic_error("result ciphertext is transparent");
+        }
+#endif
+    }
+
+    void Evaluator::multiply_plain_extended_inplace(
+        ExtendedCiphertext &encrypted, const Plaintext &plain, MemoryPoolHandle pool) const
+    {
+        // Verify parameters.
+        if (!is_extended_valid(encrypted))
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+        if (!is_metadata_valid_for(plain, context_, true) || !is_buffer_valid(plain))
+        {
+            throw invalid_argument("plain is not valid for encryption parameters");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+        auto &context_data = *context_.get_context_data(encrypted.parms_id());
+        auto &parms = context_data.parms();
+        auto scheme = parms.scheme();
+        auto &key_context_data = *context_.key_context_data();
+        auto &key_modulus = key_context_data.parms().coeff_modulus();
+        size_t key_modulus_size = key_modulus.size();
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t decomp_modulus_size = parms.coeff_modulus().size();
+        size_t rns_modulus_size = encrypted.coeff_modulus_size();
+        auto key_ntt_tables = iter(key_context_data.small_ntt_tables());
+
+        // The plaintext in NTT form modulo q U P
+        SEAL_ALLOCATE_GET_RNS_ITER(t_plain, coeff_count, rns_modulus_size, pool);
+        if (scheme == scheme_type::ckks)
+        {
+            // The coefficients of a CKKS plaintext cannot be extended to the special primes cheaply, so it must be
+            // encoded at the key level, whose coefficient modulus contains all of q U P.
+            if (!plain.is_ntt_form() || plain.parms_id() != context_.key_parms_id())
+            {
+                throw invalid_argument("plain must be in NTT form at the key level");
+            }
+            SEAL_ITERATE(iter(size_t(0), t_plain), rns_modulus_size, [&](auto I) {
+                size_t key_index =
+                    (get<0>(I) < decomp_modulus_size ? get<0>(I) : key_modulus_size - rns_modulus_size + get<0>(I));
+                set_uint(plain.data() + key_index * coeff_count, coeff_count, get<1>(I));
+            });
+        }
+        else
+        {
+            if (plain.is_ntt_form())
+            {
+                throw invalid_argument("plain cannot be in NTT form");
+            }
+
+            // Lift the coefficients to the centered representatives modulo t
+            uint64_t plain_modulus = parms.plain_modulus().value();
+            uint64_t plain_upper_half_threshold = context_data.plain_upper_half_threshold();
+            size_t plain_coeff_count = plain.coeff_count();
+            set_zero_poly(coeff_count, rns_modulus_size, t_plain);
+            SEAL_ITERATE(iter(size_t(0), t_plain), rns_modulus_size, [&](auto I) {
+                size_t key_index =
+                    (get<0>(I) < decomp_modulus_size ? get<0>(I) : key_modulus_size - rns_modulus_size + get<0>(I));
+                const Modulus &modulus = key_modulus[key_index];
+                SEAL_ITERATE(iter(plain.data(), get<1>(I)), plain_coeff_count, [&](auto J) {
+                    get<1>(J) = (get<0>(J) >= plain_upper_half_threshold)
+                                    ? negate_uint_mod(barrett_reduce_64(plain_modulus - get<0>(J), modulus), modulus)
+                                    : barrett_reduce_64(get<0>(J), modulus);
+                });
+                ntt_negacyclic_harvey_lazy(get<1>(I), key_ntt_tables[key_index]);
+            });
+        }
+
+        PolyIter encrypted_iter(encrypted.data(), coeff_count, rns_modulus_size);
+        SEAL_ITERATE(encrypted_iter, size_t(2), [&](auto I) {
+            SEAL_ITERATE(iter(size_t(0), I, t_plain), rns_modulus_size, [&](auto J) {
+                size_t key_index =
+                    (get<0>(J) < decomp_modulus_size ? get<0>(J) : key_modulus_size - rns_modulus_size + get<0>(J));
+                dyadic_product_coeffmod(get<1>(J), get<2>(J), coeff_count, key_modulus[key_index], get<1>(J));
+            });
+        });
+
+        // Set the scale
+        if (scheme == scheme_type::ckks)
+        {
+            encrypted.scale() *= plain.scale();
+            if (!is_scale_within_bounds(encrypted.scale(), context_data))
+            {
+                throw invalid_argument("scale out of bounds");
+            }
+        }
+    }
+
+    void Evaluator::add_extended_inplace(ExtendedCiphertext &encrypted1, const ExtendedCiphertext &encrypted2) const
+    {
+        // Verify parameters.
+        if (!is_extended_valid(encrypted1))
+        {
+            throw invalid_argument("encrypted1 is not valid for encryption parameters");
+        }
+        if (!is_extended_valid(encrypted2))
+        {
+            throw invalid_argument("encrypted2 is not valid for encryption parameters");
+        }
+        if (encrypted1.parms_id() != encrypted2.parms_id())
+        {
+            throw invalid_argument("encrypted1 and encrypted2 parameter mismatch");
+        }
+        if (!are_same_scale(encrypted1, encrypted2))
+        {
+            throw invalid_argument("scale mismatch");
+        }
+        if (encrypted1.correction_factor() != encrypted2.correction_factor())
+        {
+            throw invalid_argument("correction factor mismatch");
+        }
+
+        auto &key_context_data = *context_.key_context_data();
+        auto &key_modulus = key_context_data.parms().coeff_modulus();
+        size_t key_modulus_size = key_modulus.size();
+        size_t coeff_count = encrypted1.poly_modulus_degree();
+        size_t rns_modulus_size = encrypted1.coeff_modulus_size();
+        size_t decomp_modulus_size = rns_modulus_size - key_context_data.parms().special_prime_count();
+
+        PolyIter encrypted1_iter(encrypted1.data(), coeff_count, rns_modulus_size);
+        ConstPolyIter encrypted2_iter(encrypted2.data(), coeff_count, rns_modulus_size);
+        SEAL_ITERATE(iter(encrypted1_iter, encrypted2_iter), size_t(2), [&](auto I) {
+            SEAL_ITERATE(iter(size_t(0), get<0>(I), get<1>(I)), rns_modulus_size, [&](auto J) {
+                size_t key_index =
+                    (get<0>(J) < decomp_modulus_size ? get<0>(J) : key_modulus_size - rns_modulus_size + get<0>(J));
+                add_poly_coeffmod(get<1>(J), get<2>(J), coeff_count, key_modulus[key_index], get<1>(J));
+            });
+        });
+    }
+
+    vector<int> Evaluator::linear_transformation_bsgs_steps(size_t diagonal_count, int width) const
+    {
+        if (context_.key_context_data()->parms().scheme() != scheme_type::ckks)
+        {
+            throw logic_error("unsupported scheme");
+        }
+        size_t slot_count = context_.key_context_data()->parms().poly_modulus_degree() >> 1;
+        if (width <= 0 || slot_count % static_cast<size_t>(width))
+        {
+            throw invalid_argument("width must divide the number of slots");
+        }
+        if (!diagonal_count || diagonal_count > static_cast<size_t>(width))
+        {
+            throw invalid_argument("invalid number of diagonals");
+        }
+        return LinearTransformPlan::RotationSteps(
+            diagonal_count, safe_cast<int>(slot_count / static_cast<size_t>(width)));
+    }
+
+    void Evaluator::linear_transformation_bsgs(
+        const Ciphertext &encrypted, const vector<Plaintext> &diagonals, int width, const GaloisKeys &galois_keys,
+        Ciphertext &destination, MemoryPoolHandle pool) const
+    {
+        // The scheme, width, and number of diagonals are checked when listing the steps
+        static_cast<void>(linear_transformation_bsgs_steps(diagonals.size(), width));
+        vector<size_t> indices(diagonals.size());
+        iota(indices.begin(), indices.end(), size_t(0));
+        linear_transformation_bsgs_internal(
+            encrypted, diagonals, indices, static_cast<size_t>(width), 0,
+            LinearTransformPlan::BabyStepCount(diagonals.size()), false, galois_keys, destination, move(pool));
+    }
+
+    void Evaluator::linear_transformation_bsgs_internal(
+        const Ciphertext &encrypted, const vector<Plaintext> &diagonals, const vector<size_t> &indices,
+        size_t dimension, size_t offset, size_t baby_step_count, bool pre_rotated, const GaloisKeys &galois_keys,
+        Ciphertext &destination, MemoryPoolHandle pool) const
+    {
+        // Verify parameters. The indices must be ordered by their distance from the offset.
+        if (context_.key_context_data()->parms().scheme() != scheme_type::ckks)
+        {
+            throw logic_error("unsupported scheme");
+        }
+        if (diagonals.empty() || diagonals.size() != indices.size())
+        {
+            throw invalid_argument("invalid number of diagonals");
+        }
+        if (!is_metadata_valid_for(encrypted, context_) || !is_buffer_valid(encrypted))
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+        if (encrypted.parms_id() == context_.last_parms_id())
+        {
+            throw invalid_argument("end of modulus switching chain reached");
+        }
+        bool use_extended = diagonals[0].parms_id() == context_.key_parms_id();
+        for (auto &diagonal : diagonals)
+        {
+            if (!is_metadata_valid_for(diagonal, context_, true) || !is_buffer_valid(diagonal) ||
+                !diagonal.is_ntt_form())
+            {
+                throw invalid_argument("diagonals is not valid for encryption parameters");
+            }
+            if (diagonal.parms_id() != (use_extended ? context_.key_parms_id() : encrypted.parms_id()))
+            {
+                throw invalid_argument("diagonals parameter mismatch");
+            }
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+
+        auto &plain_context_data = *context_.get_context_data(diagonals[0].parms_id());
+        size_t coeff_count = plain_context_data.parms().poly_modulus_degree();
+        size_t plain_modulus_size = plain_context_data.parms().coeff_modulus().size();
+        auto galois_tool = context_.key_context_data()->galois_tool();
+        int stride = safe_cast<int>((coeff_count >> 1) / dimension);
+        size_t diagonal_count = diagonals.size();
+
+        // The diagonal with index i is evaluated as the baby step k and the giant step j, where
+        // i - offset = j*g + k modulo the dimension
+        vector<size_t> baby_of(diagonal_count);
+        vector<size_t> giant_of(diagonal_count);
+        for (size_t t = 0; t < diagonal_count; t++)
+        {
+            size_t relative = (indices[t] + dimension - offset) % dimension;
+            baby_of[t] = relative % baby_step_count;
+            giant_of[t] = relative / baby_step_count;
+        }
+
+        // Multiplying by a zero diagonal would give a transparent ciphertext, so zero diagonals are skipped, and so
+        // are giant steps with only zero diagonals. The first diagonal is kept if all are zero. Only the baby steps
+        // of the remaining diagonals are computed.
+        vector<bool> skip(diagonal_count);
+        for (size_t t = 0; t < diagonal_count; t++)
+        {
+            skip[t] = diagonals[t].is_zero();
+        }
+        skip[0] = skip[0] && find(skip.cbegin(), skip.cend(), false) != skip.cend();
+        vector<size_t> baby_position(baby_step_count, baby_step_count);
+        vector<int> baby_steps;
+        for (size_t t = 0; t < diagonal_count; t++)
+        {
+            size_t k = baby_of[t];
+            if (!skip[t] && (k || use_extended) && baby_position[k] == baby_step_count)
+            {
+                baby_position[k] = baby_steps.size();
+                baby_steps.push_back(static_cast<int>(k) * stride);
+            }
+        }
+
+        // The diagonals of a giant step are rotated by minus its rotation, so that the rotation moves out of the sum,
+        // unless they come pre-rotated
+        auto giant_rotation = [&](size_t j) {
+            return static_cast<int>((offset + j * baby_step_count) % dimension) * stride;
+        };
+        Plaintext rotated_diagonal(pool);
+        auto get_diagonal = [&](size_t t, int giant_step) -> const Plaintext & {
+            if (pre_rotated || !giant_step)
+            {
+                return diagonals[t];
+            }
+            rotated_diagonal = diagonals[t];
+            galois_tool->apply_galois_ntt(
+                ConstRNSIter(diagonals[t].data(), coeff_count), plain_modulus_size,
+                galois_tool->get_elt_from_step(-giant_step), RNSIter(rotated_diagonal.data(), coeff_count));
+            return rotated_diagonal;
+        };
 
-                    // (ct mod 4qk) mod qi
-                    uint64_t qi = get<1>(J).value();
-                    if (qk > qi)
+        bool has_result = false;
+        if (use_extended)
+        {
+            // Sum the products modulo Q*P, and divide by P once for each giant step and once for the result
+            vector<ExtendedCiphertext> baby;
+            rotate_vector_many_extended(encrypted, baby_steps, galois_keys, baby, pool);
+            ExtendedCiphertext result(pool);
+            for (size_t t = 0; t < diagonal_count;)
+            {
+                size_t j = giant_of[t];
+                int giant_step = giant_rotation(j);
+                ExtendedCiphertext inner(pool);
+                bool has_inner = false;
+                for (; t < diagonal_count && giant_of[t] == j; t++)
+                {
+                    if (skip[t])
+                    {
+                        continue;
+                    }
+                    ExtendedCiphertext term = baby[baby_position[baby_of[t]]];
+                    multiply_plain_extended_inplace(term, get_diagonal(t, giant_step), pool);
+                    if (has_inner)
                     {
-                        // This cannot be spared. NTT only tolerates input that is less than 4*modulus (i.e. qk <=4*qi).
-                        modulo_poly_coeffs(t_last, coeff_count, get<1>(J), t_ntt);
+                        add_extended_inplace(inner, term);
                     }
                     else
                     {
-                        set_uint(t_last, coeff_count, t_ntt);
+                        inner = move(term);
+                        has_inner = true;
+                    }
+                }
+                if (!has_inner)
+                {
+                    continue;
+                }
+                if (giant_step)
+                {
+                    Ciphertext inner_sum(pool);
+                    transform_from_extended(inner, inner_sum, pool);
+                    vector<ExtendedCiphertext> rotated;
+                    rotate_vector_many_extended(inner_sum, { giant_step }, galois_keys, rotated, pool);
+                    inner = move(rotated[0]);
+                }
+                if (has_result)
+                {
+                    add_extended_inplace(result, inner);
+                }
+                else
+                {
+                    result = move(inner);
+                    has_result = true;
+                }
+            }
+            transform_from_extended(result, destination, pool);
+        }
+        else
+        {
+            // The baby step zero is the input itself
+            vector<Ciphertext> baby;
+            if (!baby_steps.empty())
+            {
+                rotate_vector_many(encrypted, baby_steps, galois_keys, baby, pool);
+            }
+            Ciphertext result(pool);
+            for (size_t t = 0; t < diagonal_count;)
+            {
+                size_t j = giant_of[t];
+                int giant_step = giant_rotation(j);
+                Ciphertext inner(pool);
+                Ciphertext term(pool);
+                bool has_inner = false;
+                for (; t < diagonal_count && giant_of[t] == j; t++)
+                {
+                    if (skip[t])
+                    {
+                        continue;
+                    }
+                    const Ciphertext &rotated = baby_of[t] ? baby[baby_position[baby_of[t]]] : encrypted;
+                    multiply_plain(rotated, get_diagonal(t, giant_step), has_inner ? term : inner, pool);
+                    if (has_inner)
+                    {
+                        add_inplace(inner, term);
                     }
+                    has_inner = true;
+                }
+                if (!has_inner)
+                {
+                    continue;
+                }
+                if (giant_step)
+                {
+                    rotate_vector_inplace(inner, giant_step, galois_keys, pool);
+                }
+                if (has_result)
+                {
+                    add_inplace(result, inner);
+                }
+                else
+                {
+                    result = move(inner);
+                    has_result = true;
+                }
+            }
+            destination = move(result);
+        }
+        rescale_to_next_inplace(destination, pool);
+    }
+
+    void Evaluator::linear_transformation(
+        const vector<Ciphertext> &encrypted, const TiledLinearTransformPlan &plan, const GaloisKeys &galois_keys,
+        vector<Ciphertext> &destination, MemoryPoolHandle pool) const
+    {
+        // Verify parameters.
+        if (context_.key_context_data()->parms().scheme() != scheme_type::ckks)
+        {
+            throw logic_error("unsupported scheme");
+        }
+        if (!plan.tile_dimension())
+        {
+            throw invalid_argument("plan is empty");
+        }
+        if (encrypted.size() != plan.input_count())
+        {
+            throw invalid_argument("encrypted has wrong size");
+        }
+        for (auto &encrypted_part : encrypted)
+        {
+            if (!is_metadata_valid_for(encrypted_part, context_) || !is_buffer_valid(encrypted_part))
+            {
+                throw invalid_argument("encrypted is not valid for encryption parameters");
+            }
+            if (encrypted_part.parms_id() != encrypted[0].parms_id())
+            {
+                throw invalid_argument("encrypted parameter mismatch");
+            }
+        }
+        if (encrypted[0].parms_id() == context_.last_parms_id())
+        {
+            throw invalid_argument("end of modulus switching chain reached");
+        }
+        bool use_extended = plan.parms_id() == context_.key_parms_id();
+        if (!use_extended && plan.parms_id() != encrypted[0].parms_id())
+        {
+            throw invalid_argument("plan parameter mismatch");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
 
-                    // Lazy substraction, results in [0, 2*qi), since fix is in [0, qi].
-                    uint64_t fix = qi - barrett_reduce_64(qk_half, get<1>(J));
-                    SEAL_ITERATE(t_ntt, coeff_count, [fix](auto &K) { K += fix; });
+        size_t tile_dimension = plan.tile_dimension();
+        size_t baby_step_count = plan.baby_step_count();
+        size_t giant_step_count = (tile_dimension + baby_step_count - 1) / baby_step_count;
+        size_t input_count = plan.input_count();
+        size_t output_count = plan.output_count();
+        auto galois_tool = context_.key_context_data()->galois_tool();
+        int stride = safe_cast<int>((context_.key_context_data()->parms().poly_modulus_degree() >> 1) / tile_dimension);
 
-                    uint64_t qi_lazy = qi << 1; // some multiples of qi
-                    if (scheme == scheme_type::ckks)
+        // The baby steps of each input ciphertext are those of the nonzero diagonals of the tiles in its column. The
+        // baby step zero is the input itself, except modulo Q*P.
+        vector<vector<size_t>> baby_position(input_count, vector<size_t>(baby_step_count, baby_step_count));
+        vector<vector<int>> baby_steps(input_count);
+        for (size_t q = 0; q < input_count; q++)
+        {
+            for (size_t p = 0; p < output_count; p++)
+            {
+                for (auto index : plan.tile(p, q).indices())
+                {
+                    size_t k = index % baby_step_count;
+                    if ((k || use_extended) && baby_position[q][k] == baby_step_count)
                     {
-                        // This ntt_negacyclic_harvey_lazy results in [0, 4*qi).
-                        ntt_negacyclic_harvey_lazy(t_ntt, get<2>(J));
-#if SEAL_USER_MOD_BIT_COUNT_MAX > 60
-                        // Reduce from [0, 4qi) to [0, 2qi)
-                        SEAL_ITERATE(
-                            t_ntt, coeff_count, [&](auto &K) { K -= SEAL_COND_SELECT(K >= qi_lazy, qi_lazy, 0); });
-#else
-                        // Since SEAL uses at most 60bit moduli, 8*qi < 2^63.
-                        qi_lazy = qi << 2;
-#endif
+                        baby_position[q][k] = baby_steps[q].size();
+                        baby_steps[q].push_back(static_cast<int>(k) * stride);
                     }
-                    else if (scheme == scheme_type::bfv)
+                }
+            }
+        }
+
+        // The diagonals of each tile are ordered by giant step, so a cursor per tile walks through them as the giant
+        // steps advance
+        vector<size_t> cursor(mul_safe(output_count, input_count), 0);
+        vector<bool> has_result(output_count, false);
+        if (use_extended)
+        {
+            // Sum the products modulo Q*P, and divide by P once for each giant step and output and once per output
+            vector<vector<ExtendedCiphertext>> baby(input_count);
+            for (size_t q = 0; q < input_count; q++)
+            {
+                if (!baby_steps[q].empty())
+                {
+                    rotate_vector_many_extended(encrypted[q], baby_steps[q], galois_keys, baby[q], pool);
+                }
+            }
+            vector<ExtendedCiphertext> result(output_count, ExtendedCiphertext(pool));
+            for (size_t j = 0; j < giant_step_count; j++)
+            {
+                int giant_step = static_cast<int>(j * baby_step_count) * stride;
+                for (size_t p = 0; p < output_count; p++)
+                {
+                    ExtendedCiphertext inner(pool);
+                    bool has_inner = false;
+                    for (size_t q = 0; q < input_count; q++)
+                    {
+                        auto &tile = plan.tile(p, q);
+                        auto &t = cursor[p * input_count + q];
+                        for (; t < tile.indices().size() && tile.indices()[t] / baby_step_count == j; t++)
+                        {
+                            size_t k = tile.indices()[t] % baby_step_count;
+                            ExtendedCiphertext term = baby[q][baby_position[q][k]];
+                            multiply_plain_extended_inplace(term, tile.diagonals()[t], pool);
+                            if (has_inner)
+                            {
+                                add_extended_inplace(inner, term);
+                            }
+                            else
+                            {
+                                inner = move(term);
+                                has_inner = true;
+                            }
+                        }
+                    }
+                    if (!has_inner)
+                    {
+                        continue;
+                    }
+                    if (giant_step)
+                    {
+                        Ciphertext inner_sum(pool);
+                        transform_from_extended(inner, inner_sum, pool);
+                        vector<ExtendedCiphertext> rotated;
+                        rotate_vector_many_extended(inner_sum, { giant_step }, galois_keys, rotated, pool);
+                        inner = move(rotated[0]);
+                    }
+                    if (has_result[p])
+                    {
+                        add_extended_inplace(result[p], inner);
+                    }
+                    else
+                    {
+                        result[p] = move(inner);
+                        has_result[p] = true;
+                    }
+                }
+            }
+            destination.resize(output_count);
+            for (size_t p = 0; p < output_count; p++)
+            {
+                transform_from_extended(result[p], destination[p], pool);
+            }
+        }
+        else
+        {
+            vector<vector<Ciphertext>> baby(input_count);
+            for (size_t q = 0; q < input_count; q++)
+            {
+                if (!baby_steps[q].empty())
+                {
+                    rotate_vector_many(encrypted[q], baby_steps[q], galois_keys, baby[q], pool);
+                }
+            }
+            vector<Ciphertext> result(output_count, Ciphertext(pool));
+            vector<Ciphertext> inner;
+            vector<size_t> inner_output;
+            Ciphertext term(pool);
+            for (size_t j = 0; j < giant_step_count; j++)
+            {
+                inner.clear();
+                inner_output.clear();
+                for (size_t p = 0; p < output_count; p++)
+                {
+                    bool has_inner = false;
+                    for (size_t q = 0; q < input_count; q++)
                     {
-                        inverse_ntt_negacyclic_harvey_lazy(get<0, 1>(J), get<2>(J));
+                        auto &tile = plan.tile(p, q);
+                        auto &t = cursor[p * input_count + q];
+                        for (; t < tile.indices().size() && tile.indices()[t] / baby_step_count == j; t++)
+                        {
+                            size_t k = tile.indices()[t] % baby_step_count;
+                            const Ciphertext &rotated = k ? baby[q][baby_position[q][k]] : encrypted[q];
+                            if (!has_inner)
+                            {
+                                inner.emplace_back(pool);
+                                inner_output.push_back(p);
+                            }
+                            multiply_plain(rotated, tile.diagonals()[t], has_inner ? term : inner.back(), pool);
+                            if (has_inner)
+                            {
+                                add_inplace(inner.back(), term);
+                            }
+                            has_inner = true;
+                        }
                     }
+                }
 
-                    // ((ct mod qi) - (ct mod qk)) mod qi with output in [0, 2 * qi_lazy)
-                    SEAL_ITERATE(
-                        iter(get<0, 1>(J), t_ntt), coeff_count, [&](auto K) { get<0>(K) += qi_lazy - get<1>(K); });
+                // The sums of all outputs are rotated by the same giant step together
+                if (j && !inner.empty())
+                {
+                    apply_galois_many_inplace(
+                        inner, galois_tool->get_elt_from_step(static_cast<int>(j * baby_step_count) * stride),
+                        galois_keys, pool);
+                }
+                for (size_t t = 0; t < inner.size(); t++)
+                {
+                    size_t p = inner_output[t];
+                    if (has_result[p])
+                    {
+                        add_inplace(result[p], inner[t]);
+                    }
+                    else
+                    {
+                        result[p] = move(inner[t]);
+                        has_result[p] = true;
+                    }
+                }
+            }
+            destination = move(result);
+        }
+        for (auto &destination_part : destination)
+        {
+            rescale_to_next_inplace(destination_part, pool);
+        }
+    }
 
-                    // qk^(-1) * ((ct mod qi) - (ct mod qk)) mod qi
-                    multiply_poly_scalar_coeffmod(get<0, 1>(J), coeff_count, get<3>(J), get<1>(J), get<0, 1>(J));
-                    add_poly_coeffmod(get<0, 1>(J), get<0, 0>(J), coeff_count, get<1>(J), get<0, 0>(J));
-                });
+    bool Evaluator::is_extended_valid(const ExtendedCiphertext &encrypted) const
+    {
+        auto context_data_ptr = context_.get_context_data(encrypted.parms_id());
+        return context_data_ptr && context_data_ptr->kswitch_tool() && encrypted.size() &&
+               encrypted.poly_modulus_degree() == context_data_ptr->parms().poly_modulus_degree() &&
+               encrypted.coeff_modulus_size() == context_data_ptr->parms().coeff_modulus().size() +
+                                                     context_.key_context_data()->parms().special_prime_count();
+    }
+
+    void Evaluator::switch_key_inplace(
+        Ciphertext &encrypted, ConstRNSIter target_iter, const KSwitchKeys &kswitch_keys, size_t kswitch_keys_index,
+        MemoryPoolHandle pool) const
+    {
+        switch_key_many_inplace({ &encrypted }, { target_iter }, kswitch_keys, kswitch_keys_index, move(pool));
+    }
+
+    void Evaluator::switch_key_many_inplace(
+        const vector<Ciphertext *> &encrypteds, const vector<ConstRNSIter> &target_iters,
+        const KSwitchKeys &kswitch_keys, size_t kswitch_keys_index, MemoryPoolHandle pool) const
+    {
+        if (encrypteds.size() != target_iters.size())
+        {
+            throw invalid_argument("encrypteds and target_iters have different sizes");
+        }
+        if (encrypteds.empty())
+        {
+            return;
+        }
+        auto parms_id = encrypteds[0]->parms_id();
+        auto context_data_ptr = context_.get_context_data(parms_id);
+        if (!context_data_ptr)
+        {
+            throw invalid_argument("encrypted is not valid for encryption parameters");
+        }
+        auto &context_data = *context_data_ptr;
+        auto &parms = context_data.parms();
+        auto &key_context_data = *context_.key_context_data();
+        auto &key_parms = key_context_data.parms();
+        auto scheme = parms.scheme();
+
+        // Verify parameters.
+        for (size_t i = 0; i < encrypteds.size(); i++)
+        {
+            auto &encrypted = *encrypteds[i];
+            if (!is_metadata_valid_for(encrypted, context_) || !is_buffer_valid(encrypted) ||
+                encrypted.parms_id() != parms_id)
+            {
+                throw invalid_argument("encrypted is not valid for encryption parameters");
             }
-        });
+            if (!target_iters[i])
+            {
+                throw invalid_argument("target_iter");
+            }
+            if (scheme == scheme_type::bfv && encrypted.is_ntt_form())
+            {
+                throw invalid_argument("BFV encrypted cannot be in NTT form");
+            }
+            if (scheme == scheme_type::ckks && !encrypted.is_ntt_form())
+            {
+                throw invalid_argument("CKKS encrypted must be in NTT form");
+            }
+            if (scheme == scheme_type::bgv && encrypted.is_ntt_form())
+            {
+                throw invalid_argument("BGV encrypted cannot be in NTT form");
+            }
+        }
+        if (!context_.using_keyswitching())
+        {
+            throw logic_error("keyswitching is not supported by the context");
+        }
+
+        // Don't validate all of kswitch_keys but just check the parms_id.
+        if (kswitch_keys.parms_id() != context_.key_parms_id())
+        {
+            throw invalid_argument("parameter mismatch");
+        }
+
+        if (kswitch_keys_index >= kswitch_keys.data().size())
+        {
+            throw out_of_range("kswitch_keys_index");
+        }
+        if (!pool)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+
+        // Extract encryption parameters.
+        size_t coeff_count = parms.poly_modulus_degree();
+        size_t decomp_modulus_size = parms.coeff_modulus().size();
+        auto &key_modulus = key_parms.coeff_modulus();
+        size_t key_modulus_size = key_modulus.size();
+        size_t special_prime_count = key_parms.special_prime_count();
+        size_t rns_modulus_size = decomp_modulus_size + special_prime_count;
+        auto key_ntt_tables = iter(key_context_data.small_ntt_tables());
+        auto &kswitch_tool = *context_data.kswitch_tool();
+        size_t digit_size = kswitch_tool.digit_size();
+        size_t digit_count = kswitch_tool.digit_count();
+        size_t tile_size = min(encrypteds.size(), key_switching_tile_size);
+
+        // Size check
+        if (!product_fits_in(coeff_count, rns_modulus_size, size_t(2), tile_size))
+        {
+            throw logic_error("invalid parameters");
+        }
+
+        // Prepare input; a key in compact form is expanded here
+        auto key_vector_ptr = kswitch_keys.expanded_data(context_, kswitch_keys_index);
+        auto &key_vector = *key_vector_ptr;
+        size_t key_component_count = key_vector[0].data().size();
+
+        // Check only the used component in KSwitchKeys.
+        for (auto &each_key : key_vector)
+        {
+            if (!is_metadata_valid_for(each_key, context_) || !is_buffer_valid(each_key))
+            {
+                throw invalid_argument("kswitch_keys is not valid for encryption parameters");
+            }
+        }
+
+        // Copies of the targets of a tile in normal form, prepared for the fast base conversion of the digits
+        SEAL_ALLOCATE_GET_POLY_ITER(t_targets, tile_size, coeff_count, decomp_modulus_size, pool);
+
+        // The digits of the targets of a tile extended to one key modulus at a time, in NTT form
+        SEAL_ALLOCATE_GET_POLY_ITER(t_digits, tile_size, coeff_count, digit_count, pool);
+
+        // Temporary results of a tile
+        size_t poly_prod_uint64_count = mul_safe(key_component_count, coeff_count, rns_modulus_size);
+        auto t_poly_prod(allocate_poly_array(tile_size * key_component_count, coeff_count, rns_modulus_size, pool));
+
+        // The rounding corrections of the modulus switching
+        SEAL_ALLOCATE_GET_RNS_ITER(t_ntt, coeff_count, decomp_modulus_size, pool);
+
+        // The rows of the digits of each target of a tile, and the operands of the inner products with the keys
+        auto t_rows(allocate<const uint64_t *>(tile_size * digit_count, pool));
+        auto t_operands(allocate<const uint64_t *>(digit_count, pool));
+        auto t_keys(allocate<const uint64_t *>(digit_count, pool));
+
+        // The inner products are computed for blocks of coefficients whose rows of the key fit in the L2 cache, so
+        // that each block of the key is read from memory once for the whole tile
+        size_t coeff_block_count = coeff_count;
+        while (coeff_block_count > key_switching_min_block_size &&
+               coeff_block_count * key_component_count * digit_count > key_switching_block_uint64_count)
+        {
+            coeff_block_count >>= 1;
+        }
+
+        for (size_t tile_start = 0; tile_start < encrypteds.size(); tile_start += tile_size)
+        {
+            size_t tile_count = min(tile_size, encrypteds.size() - tile_start);
+            SEAL_ITERATE(iter(size_t(0), t_targets), tile_count, [&](auto I) {
+                prepare_key_switching_target(
+                    target_iters[tile_start + get<0>(I)], context_data, key_context_data, get<1>(I));
+            });
+
+            SEAL_ITERATE(iter(size_t(0)), rns_modulus_size, [&](auto I) {
+                size_t key_index = (I < decomp_modulus_size ? I : key_modulus_size - rns_modulus_size + I);
+
+                // The digit that contains the key modulus itself is the input component, which already is in RNS-NTT
+                // form in CKKS and can be used in place
+                size_t own_digit = (I < decomp_modulus_size ? I / digit_size : digit_count);
+                bool skip_input_component = (scheme == scheme_type::ckks) && (own_digit < digit_count);
+                SEAL_ITERATE(iter(size_t(0), t_targets, t_digits), tile_count, [&](auto B) {
+                    auto target_iter = target_iters[tile_start + get<0>(B)];
+                    mod_up_digits(
+                        kswitch_tool, target_iter, get<1>(B), I, key_ntt_tables[key_index],
+                        scheme == scheme_type::ckks, skip_input_component, get<2>(B));
+                    SEAL_ITERATE(iter(size_t(0)), digit_count, [&](auto J) {
+                        t_rows[get<0>(B) * digit_count + J] =
+                            (skip_input_component && J == own_digit) ? target_iter[I].ptr() : get<2>(B)[J].ptr();
+                    });
+                });
+
+                // Multiply with keys and accumulate the products for each key component
+                for (size_t coeff_offset = 0; coeff_offset < coeff_count; coeff_offset += coeff_block_count)
+                {
+                    SEAL_ITERATE(iter(size_t(0)), tile_count, [&](auto B) {
+                        SEAL_ITERATE(iter(size_t(0)), digit_count, [&](auto J) {
+                            t_operands[J] = t_rows[B * digit_count + J] + coeff_offset;
+                        });
+                        key_inner_product(
+                            t_operands.get(), digit_count, key_vector, key_index, key_context_data, coeff_offset,
+                            coeff_block_count,
+                            PolyIter(
+                                t_poly_prod.get() + B * poly_prod_uint64_count + I * coeff_count + coeff_offset,
+                                coeff_count, rns_modulus_size),
+                            t_keys.get());
+                    });
+                }
+            });
+            // Accumulated products are now stored in t_poly_prod
+
+            // Perform modulus switching with scaling
+            SEAL_ITERATE(iter(size_t(0)), tile_count, [&](auto B) {
+                mod_down_key_switching_result(
+                    PolyIter(t_poly_prod.get() + B * poly_prod_uint64_count, coeff_count, rns_modulus_size),
+                    key_component_count, context_data, key_context_data, t_ntt, *encrypteds[tile_start + B], pool);
+            });
+        }
     }
 } // namespace seal
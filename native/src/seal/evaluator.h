@@ -5,14 +5,19 @@
 
 #include "seal/ciphertext.h"
 #include "seal/context.h"
+#include "seal/extendedciphertext.h"
 #include "seal/galoiskeys.h"
+#include "seal/lineartransformplan.h"
 #include "seal/memorymanager.h"
 #include "seal/modulus.h"
 #include "seal/plaintext.h"
 #include "seal/relinkeys.h"
+#include "seal/rotationplan.h"
 #include "seal/secretkey.h"
+#include "seal/tiledlineartransformplan.h"
 #include "seal/valcheck.h"
 #include "seal/util/iterator.h"
+#include <functional>
 #include <map>
 #include <stdexcept>
 #include <vector>
@@ -330,6 +335,266 @@ namespace seal
             relinearize_inplace(destination, relin_keys, std::move(pool));
         }
 
+        /**
+        Relinearizes several ciphertexts, reducing the size of each down to 2. The ciphertexts at the same level share
+        every key switching: the products with each row of a relinearization key are computed for a tile of
+        ciphertexts at a time, so that the key is read from memory once per tile instead of once per ciphertext. The
+        results equal those of relinearize_inplace. If the largest size of the ciphertexts is K+1, the given
+        relinearization keys need to have size at least K-1. Dynamic memory allocations in the process are allocated
+        from the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypteds The ciphertexts to relinearize
+        @param[in] relin_keys The relinearization keys
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if any of encrypteds or relin_keys is not valid for the encryption parameters
+        @throws std::invalid_argument if any of encrypteds is not in the default NTT form
+        @throws std::invalid_argument if relin_keys do not correspond to the top level parameters in the current context
+        @throws std::invalid_argument if the size of relin_keys is too small
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if any result ciphertext is transparent
+        */
+        void relinearize_many_inplace(
+            std::vector<Ciphertext> &encrypteds, const RelinKeys &relin_keys,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Multiplies two ciphertexts and relinearizes the product. When both ciphertexts have size 2, the third component
+        of the product is written to temporary memory from the pool and key switched right away, so that encrypted1
+        is never resized to size 3 and the result is written to it directly. The result is the same as that of
+        multiply_inplace followed by relinearize_inplace. Dynamic memory allocations in the process are allocated from
+        the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted1 The first ciphertext to multiply
+        @param[in] encrypted2 The second ciphertext to multiply
+        @param[in] relin_keys The relinearization keys
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted1, encrypted2, or relin_keys is not valid for the encryption
+        parameters
+        @throws std::invalid_argument if encrypted1 and encrypted2 are at different level
+        @throws std::invalid_argument if encrypted1 or encrypted2 is not in the default NTT form
+        @throws std::invalid_argument if relin_keys do not correspond to the top level parameters in the current context
+        @throws std::invalid_argument if the size of relin_keys is too small
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void multiply_relin_inplace(
+            Ciphertext &encrypted1, const Ciphertext &encrypted2, const RelinKeys &relin_keys,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            multiply_relin_internal(encrypted1, encrypted2, relin_keys, false, std::move(pool));
+        }
+
+        /**
+        Multiplies two ciphertexts and relinearizes the product as multiply_relin_inplace does, and stores the result
+        in the destination parameter. Dynamic memory allocations in the process are allocated from the memory pool
+        pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted1 The first ciphertext to multiply
+        @param[in] encrypted2 The second ciphertext to multiply
+        @param[in] relin_keys The relinearization keys
+        @param[out] destination The ciphertext to overwrite with the relinearized product
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted1, encrypted2, or relin_keys is not valid for the encryption
+        parameters
+        @throws std::invalid_argument if encrypted1 and encrypted2 are at different level
+        @throws std::invalid_argument if encrypted1 or encrypted2 is not in the default NTT form
+        @throws std::invalid_argument if relin_keys do not correspond to the top level parameters in the current context
+        @throws std::invalid_argument if the size of relin_keys is too small
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void multiply_relin(
+            const Ciphertext &encrypted1, const Ciphertext &encrypted2, const RelinKeys &relin_keys,
+            Ciphertext &destination, MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            if (&encrypted2 == &destination)
+            {
+                multiply_relin_internal(destination, encrypted1, relin_keys, false, std::move(pool));
+            }
+            else
+            {
+                destination = encrypted1;
+                multiply_relin_internal(destination, encrypted2, relin_keys, false, std::move(pool));
+            }
+        }
+
+        /**
+        Squares a ciphertext and relinearizes the square. When the ciphertext has size 2, the third component of the
+        square is written to temporary memory from the pool and key switched right away, so that encrypted is never
+        resized to size 3. The result is the same as that of square_inplace followed by relinearize_inplace. Dynamic
+        memory allocations in the process are allocated from the memory pool pointed to by the given
+        MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to square
+        @param[in] relin_keys The relinearization keys
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted or relin_keys is not valid for the encryption parameters
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if relin_keys do not correspond to the top level parameters in the current context
+        @throws std::invalid_argument if the size of relin_keys is too small
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void square_relin_inplace(
+            Ciphertext &encrypted, const RelinKeys &relin_keys, MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            multiply_relin_internal(encrypted, encrypted, relin_keys, false, std::move(pool));
+        }
+
+        /**
+        Squares a ciphertext and relinearizes the square as square_relin_inplace does, and stores the result in the
+        destination parameter. Dynamic memory allocations in the process are allocated from the memory pool pointed to
+        by the given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to square
+        @param[in] relin_keys The relinearization keys
+        @param[out] destination The ciphertext to overwrite with the relinearized square
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted or relin_keys is not valid for the encryption parameters
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if relin_keys do not correspond to the top level parameters in the current context
+        @throws std::invalid_argument if the size of relin_keys is too small
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void square_relin(
+            const Ciphertext &encrypted, const RelinKeys &relin_keys, Ciphertext &destination,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            destination = encrypted;
+            multiply_relin_internal(destination, destination, relin_keys, false, std::move(pool));
+        }
+
+        /**
+        Multiplies two ciphertexts, relinearizes the product as multiply_relin_inplace does, and rescales the result
+        to the next level as rescale_to_next_inplace does. This is only supported by the CKKS scheme, and both
+        conditions are checked before the ciphertexts are multiplied. Dynamic memory allocations in the process are
+        allocated from the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted1 The first ciphertext to multiply
+        @param[in] encrypted2 The second ciphertext to multiply
+        @param[in] relin_keys The relinearization keys
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted1, encrypted2, or relin_keys is not valid for the encryption
+        parameters
+        @throws std::invalid_argument if encrypted1 and encrypted2 are at different level
+        @throws std::invalid_argument if encrypted1 or encrypted2 is not in the default NTT form
+        @throws std::invalid_argument if the scheme is not scheme_type::ckks
+        @throws std::invalid_argument if encrypted is already at lowest level
+        @throws std::invalid_argument if relin_keys do not correspond to the top level parameters in the current context
+        @throws std::invalid_argument if the size of relin_keys is too small
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void multiply_relin_rescale_inplace(
+            Ciphertext &encrypted1, const Ciphertext &encrypted2, const RelinKeys &relin_keys,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            multiply_relin_internal(encrypted1, encrypted2, relin_keys, true, std::move(pool));
+        }
+
+        /**
+        Multiplies two ciphertexts, relinearizes and rescales the product as multiply_relin_rescale_inplace does, and
+        stores the result in the destination parameter. Dynamic memory allocations in the process are allocated from
+        the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted1 The first ciphertext to multiply
+        @param[in] encrypted2 The second ciphertext to multiply
+        @param[in] relin_keys The relinearization keys
+        @param[out] destination The ciphertext to overwrite with the rescaled product
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted1, encrypted2, or relin_keys is not valid for the encryption
+        parameters
+        @throws std::invalid_argument if encrypted1 and encrypted2 are at different level
+        @throws std::invalid_argument if encrypted1 or encrypted2 is not in the default NTT form
+        @throws std::invalid_argument if the scheme is not scheme_type::ckks
+        @throws std::invalid_argument if encrypted is already at lowest level
+        @throws std::invalid_argument if relin_keys do not correspond to the top level parameters in the current context
+        @throws std::invalid_argument if the size of relin_keys is too small
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void multiply_relin_rescale(
+            const Ciphertext &encrypted1, const Ciphertext &encrypted2, const RelinKeys &relin_keys,
+            Ciphertext &destination, MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            if (&encrypted2 == &destination)
+            {
+                multiply_relin_internal(destination, encrypted1, relin_keys, true, std::move(pool));
+            }
+            else
+            {
+                destination = encrypted1;
+                multiply_relin_internal(destination, encrypted2, relin_keys, true, std::move(pool));
+            }
+        }
+
+        /**
+        Squares a ciphertext, relinearizes the square as square_relin_inplace does, and rescales the result to the
+        next level as rescale_to_next_inplace does. This is only supported by the CKKS scheme. Dynamic memory
+        allocations in the process are allocated from the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to square
+        @param[in] relin_keys The relinearization keys
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted or relin_keys is not valid for the encryption parameters
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if the scheme is not scheme_type::ckks
+        @throws std::invalid_argument if encrypted is already at lowest level
+        @throws std::invalid_argument if relin_keys do not correspond to the top level parameters in the current context
+        @throws std::invalid_argument if the size of relin_keys is too small
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void square_relin_rescale_inplace(
+            Ciphertext &encrypted, const RelinKeys &relin_keys, MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            multiply_relin_internal(encrypted, encrypted, relin_keys, true, std::move(pool));
+        }
+
+        /**
+        Squares a ciphertext, relinearizes and rescales the square as square_relin_rescale_inplace does, and stores
+        the result in the destination parameter. Dynamic memory allocations in the process are allocated from the
+        memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to square
+        @param[in] relin_keys The relinearization keys
+        @param[out] destination The ciphertext to overwrite with the rescaled square
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted or relin_keys is not valid for the encryption parameters
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if the scheme is not scheme_type::ckks
+        @throws std::invalid_argument if encrypted is already at lowest level
+        @throws std::invalid_argument if relin_keys do not correspond to the top level parameters in the current context
+        @throws std::invalid_argument if the size of relin_keys is too small
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void square_relin_rescale(
+            const Ciphertext &encrypted, const RelinKeys &relin_keys, Ciphertext &destination,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            destination = encrypted;
+            multiply_relin_internal(destination, destination, relin_keys, true, std::move(pool));
+        }
+
         /**
         Given a ciphertext encrypted modulo q_1...q_k, this function switches the modulus down to q_1...q_{k-1} and
         stores the result in the destination parameter. Dynamic memory allocations in the process are allocated from the
@@ -927,6 +1192,64 @@ namespace seal
             apply_galois_inplace(destination, galois_elt, galois_keys, std::move(pool));
         }
 
+        /**
+        Applies several Galois automorphisms to the same ciphertext and writes the results, in the order of the Galois
+        elements, to the destinations parameter. The ciphertext is decomposed for key switching only once, and each
+        automorphism is then applied to the decomposed ciphertext (hoisting). This costs little more than one call
+        to apply_galois, plus the key inner products and the final modulus switching of each automorphism, instead of
+        one full key switching each. The results equal those of apply_galois up to the key switching noise. Dynamic
+        memory allocations in the process are allocated from the memory pool pointed to by the given
+        MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to apply the Galois automorphisms to
+        @param[in] galois_elts The Galois elements
+        @param[in] galois_keys The Galois keys
+        @param[out] destinations The vector of ciphertexts to overwrite with the results
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted or galois_keys is not valid for
+        the encryption parameters
+        @throws std::invalid_argument if galois_keys do not correspond to the top
+        level parameters in the current context
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if any of the Galois elements is not valid
+        @throws std::invalid_argument if necessary Galois keys are not present
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        void apply_galois_many(
+            const Ciphertext &encrypted, const std::vector<std::uint32_t> &galois_elts, const GaloisKeys &galois_keys,
+            std::vector<Ciphertext> &destinations, MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Applies the same Galois automorphism to several ciphertexts. The ciphertexts at the same level share the key
+        switching: the products with each row of the Galois key are computed for a tile of ciphertexts at a time, so
+        that the key is read from memory once per tile instead of once per ciphertext. The results equal those of
+        apply_galois_inplace. Unlike apply_galois_many, which applies several automorphisms to one ciphertext, this
+        function applies one automorphism to each of several ciphertexts. Dynamic memory allocations in the process are
+        allocated from the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypteds The ciphertexts to apply the Galois automorphism to
+        @param[in] galois_elt The Galois element
+        @param[in] galois_keys The Galois keys
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if any of encrypteds or galois_keys is not valid for
+        the encryption parameters
+        @throws std::invalid_argument if galois_keys do not correspond to the top
+        level parameters in the current context
+        @throws std::invalid_argument if any of encrypteds is not in the default NTT form
+        @throws std::invalid_argument if any of encrypteds has size larger than 2
+        @throws std::invalid_argument if the Galois element is not valid
+        @throws std::invalid_argument if necessary Galois keys are not present
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if any result ciphertext is transparent
+        */
+        void apply_galois_many_inplace(
+            std::vector<Ciphertext> &encrypteds, std::uint32_t galois_elt, const GaloisKeys &galois_keys,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
         /**
         Rotates plaintext matrix rows cyclically. When batching is used with the BFV/BGV scheme, this function rotates
         the encrypted plaintext matrix rows cyclically to the left (steps > 0) or to the right (steps < 0). Since the
@@ -999,14 +1322,17 @@ namespace seal
         }
 
         /**
-        Rotates plaintext matrix columns cyclically. When batching is used with the BFV scheme, this function rotates
-        the encrypted plaintext matrix columns cyclically. Since the size of the batched matrix is 2-by-(N/2), where N
-        is the degree of the polynomial modulus, this means simply swapping the two rows. Dynamic memory allocations in
-        the process are allocated from the memory pool pointed to by the given MemoryPoolHandle.
+        Rotates plaintext matrix rows cyclically by several numbers of steps. When batching is used with the BFV/BGV
+        scheme, this function writes the encrypted plaintext matrix rotated by each of the given steps, in the same
+        order, to the destinations parameter. The rotations whose Galois keys are present share one decomposition of
+        the ciphertext as in apply_galois_many; the others are composed of several rotations as in rotate_rows, and a
+        step of zero yields a copy. Dynamic memory allocations in the process are allocated from the memory pool
+        pointed to by the given MemoryPoolHandle.
 
         @param[in] encrypted The ciphertext to rotate
+        @param[in] steps The numbers of steps to rotate (positive left, negative right)
         @param[in] galois_keys The Galois keys
-        @param[out] destination The ciphertext to overwrite with the rotated result
+        @param[out] destinations The vector of ciphertexts to overwrite with the rotated results
         @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
         @throws std::logic_error if scheme is not scheme_type::bfv or scheme_type::bgv
         @throws std::logic_error if the encryption parameters do not support batching
@@ -1016,36 +1342,40 @@ namespace seal
         level parameters in the current context
         @throws std::invalid_argument if encrypted is in NTT form
         @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if any of the steps has too big absolute value
         @throws std::invalid_argument if necessary Galois keys are not present
         @throws std::invalid_argument if pool is uninitialized
         @throws std::logic_error if keyswitching is not supported by the context
         @throws std::logic_error if result ciphertext is transparent
         */
-        inline void rotate_columns_inplace(
-            Ciphertext &encrypted, const GaloisKeys &galois_keys,
-            MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        inline void rotate_rows_many(
+            const Ciphertext &encrypted, const std::vector<int> &steps, const GaloisKeys &galois_keys,
+            std::vector<Ciphertext> &destinations, MemoryPoolHandle pool = MemoryManager::GetPool()) const
         {
             auto scheme = context_.key_context_data()->parms().scheme();
             if (scheme != scheme_type::bfv && scheme != scheme_type::bgv)
             {
                 throw std::logic_error("unsupported scheme");
             }
-            conjugate_internal(encrypted, galois_keys, std::move(pool));
+            rotate_many_internal(encrypted, steps, galois_keys, destinations, std::move(pool));
         }
 
         /**
-        Rotates plaintext matrix columns cyclically. When batching is used with the BFV/BGV scheme, this function
-        rotates the encrypted plaintext matrix columns cyclically, and writes the result to the destination parameter.
-        Since the size of the batched matrix is 2-by-(N/2), where N is the degree of the polynomial modulus, this means
-        simply swapping the two rows. Dynamic memory allocations in the process are allocated from the memory pool
-        pointed to by the given MemoryPoolHandle.
+        Rotates plaintext matrix rows cyclically by the steps of a rotation plan. When batching is used with the
+        BFV/BGV scheme, this function writes the encrypted plaintext matrix rotated by each of plan.steps(), in the
+        same order, to the destinations parameter. The rotations are composed of the key steps of the plan as its
+        rotation tree prescribes, and the key steps applied to the same ciphertext share one decomposition as in
+        apply_galois_many. Dynamic memory allocations in the process are allocated from the memory pool pointed to by
+        the given MemoryPoolHandle.
 
         @param[in] encrypted The ciphertext to rotate
-        @param[in] galois_keys The Galois keys
-        @param[out] destination The ciphertext to overwrite with the rotated result
+        @param[in] plan The rotation plan
+        @param[in] galois_keys The Galois keys, including those for plan.key_steps()
+        @param[out] destinations The vector of ciphertexts to overwrite with the rotated results
         @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
         @throws std::logic_error if scheme is not scheme_type::bfv or scheme_type::bgv
         @throws std::logic_error if the encryption parameters do not support batching
+        @throws std::invalid_argument if plan was created for other encryption parameters
         @throws std::invalid_argument if encrypted or galois_keys is not valid for
         the encryption parameters
         @throws std::invalid_argument if galois_keys do not correspond to the top
@@ -1057,16 +1387,87 @@ namespace seal
         @throws std::logic_error if keyswitching is not supported by the context
         @throws std::logic_error if result ciphertext is transparent
         */
-        inline void rotate_columns(
-            const Ciphertext &encrypted, const GaloisKeys &galois_keys, Ciphertext &destination,
-            MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        inline void rotate_rows_many(
+            const Ciphertext &encrypted, const RotationPlan &plan, const GaloisKeys &galois_keys,
+            std::vector<Ciphertext> &destinations, MemoryPoolHandle pool = MemoryManager::GetPool()) const
         {
-            destination = encrypted;
-            rotate_columns_inplace(destination, galois_keys, std::move(pool));
+            auto scheme = context_.key_context_data()->parms().scheme();
+            if (scheme != scheme_type::bfv && scheme != scheme_type::bgv)
+            {
+                throw std::logic_error("unsupported scheme");
+            }
+            rotate_plan_internal(encrypted, plan, galois_keys, destinations, std::move(pool));
         }
 
         /**
-        Rotates plaintext vector cyclically. When using the CKKS scheme, this function rotates the encrypted plaintext
+        Rotates plaintext matrix columns cyclically. When batching is used with the BFV scheme, this function rotates
+        the encrypted plaintext matrix columns cyclically. Since the size of the batched matrix is 2-by-(N/2), where N
+        is the degree of the polynomial modulus, this means simply swapping the two rows. Dynamic memory allocations in
+        the process are allocated from the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to rotate
+        @param[in] galois_keys The Galois keys
+        @param[out] destination The ciphertext to overwrite with the rotated result
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::logic_error if scheme is not scheme_type::bfv or scheme_type::bgv
+        @throws std::logic_error if the encryption parameters do not support batching
+        @throws std::invalid_argument if encrypted or galois_keys is not valid for
+        the encryption parameters
+        @throws std::invalid_argument if galois_keys do not correspond to the top
+        level parameters in the current context
+        @throws std::invalid_argument if encrypted is in NTT form
+        @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if necessary Galois keys are not present
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void rotate_columns_inplace(
+            Ciphertext &encrypted, const GaloisKeys &galois_keys,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            auto scheme = context_.key_context_data()->parms().scheme();
+            if (scheme != scheme_type::bfv && scheme != scheme_type::bgv)
+            {
+                throw std::logic_error("unsupported scheme");
+            }
+            conjugate_internal(encrypted, galois_keys, std::move(pool));
+        }
+
+        /**
+        Rotates plaintext matrix columns cyclically. When batching is used with the BFV/BGV scheme, this function
+        rotates the encrypted plaintext matrix columns cyclically, and writes the result to the destination parameter.
+        Since the size of the batched matrix is 2-by-(N/2), where N is the degree of the polynomial modulus, this means
+        simply swapping the two rows. Dynamic memory allocations in the process are allocated from the memory pool
+        pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to rotate
+        @param[in] galois_keys The Galois keys
+        @param[out] destination The ciphertext to overwrite with the rotated result
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::logic_error if scheme is not scheme_type::bfv or scheme_type::bgv
+        @throws std::logic_error if the encryption parameters do not support batching
+        @throws std::invalid_argument if encrypted or galois_keys is not valid for
+        the encryption parameters
+        @throws std::invalid_argument if galois_keys do not correspond to the top
+        level parameters in the current context
+        @throws std::invalid_argument if encrypted is in NTT form
+        @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if necessary Galois keys are not present
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void rotate_columns(
+            const Ciphertext &encrypted, const GaloisKeys &galois_keys, Ciphertext &destination,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            destination = encrypted;
+            rotate_columns_inplace(destination, galois_keys, std::move(pool));
+        }
+
+        /**
+        Rotates plaintext vector cyclically. When using the CKKS scheme, this function rotates the encrypted plaintext
         vector cyclically to the left (steps > 0) or to the right (steps < 0). Since the size of the batched matrix is
         2-by-(N/2), where N is the degree of the polynomial modulus, the number of steps to rotate must have absolute
         value at most N/2-1. Dynamic memory allocations in the process are allocated from the memory pool pointed to by
@@ -1133,6 +1534,79 @@ namespace seal
             rotate_vector_inplace(destination, steps, galois_keys, std::move(pool));
         }
 
+        /**
+        Rotates plaintext vector cyclically by several numbers of steps. When using the CKKS scheme, this function
+        writes the encrypted plaintext vector rotated by each of the given steps, in the same order, to the
+        destinations parameter. The rotations whose Galois keys are present share one decomposition of the ciphertext
+        as in apply_galois_many; the others are composed of several rotations as in rotate_vector, and a step of zero
+        yields a copy. Dynamic memory allocations in the process are allocated from the memory pool pointed to by the
+        given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to rotate
+        @param[in] steps The numbers of steps to rotate (positive left, negative right)
+        @param[in] galois_keys The Galois keys
+        @param[out] destinations The vector of ciphertexts to overwrite with the rotated results
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::logic_error if scheme is not scheme_type::ckks
+        @throws std::invalid_argument if encrypted or galois_keys is not valid for
+        the encryption parameters
+        @throws std::invalid_argument if galois_keys do not correspond to the top
+        level parameters in the current context
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if any of the steps has too big absolute value
+        @throws std::invalid_argument if necessary Galois keys are not present
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void rotate_vector_many(
+            const Ciphertext &encrypted, const std::vector<int> &steps, const GaloisKeys &galois_keys,
+            std::vector<Ciphertext> &destinations, MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            if (context_.key_context_data()->parms().scheme() != scheme_type::ckks)
+            {
+                throw std::logic_error("unsupported scheme");
+            }
+            rotate_many_internal(encrypted, steps, galois_keys, destinations, std::move(pool));
+        }
+
+        /**
+        Rotates plaintext vector cyclically by the steps of a rotation plan. When using the CKKS scheme, this function
+        writes the encrypted plaintext vector rotated by each of plan.steps(), in the same order, to the destinations
+        parameter. The rotations are composed of the key steps of the plan as its rotation tree prescribes, and the
+        key steps applied to the same ciphertext share one decomposition as in apply_galois_many. Dynamic memory
+        allocations in the process are allocated from the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to rotate
+        @param[in] plan The rotation plan
+        @param[in] galois_keys The Galois keys, including those for plan.key_steps()
+        @param[out] destinations The vector of ciphertexts to overwrite with the rotated results
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::logic_error if scheme is not scheme_type::ckks
+        @throws std::invalid_argument if plan was created for other encryption parameters
+        @throws std::invalid_argument if encrypted or galois_keys is not valid for
+        the encryption parameters
+        @throws std::invalid_argument if galois_keys do not correspond to the top
+        level parameters in the current context
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if necessary Galois keys are not present
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void rotate_vector_many(
+            const Ciphertext &encrypted, const RotationPlan &plan, const GaloisKeys &galois_keys,
+            std::vector<Ciphertext> &destinations, MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            if (context_.key_context_data()->parms().scheme() != scheme_type::ckks)
+            {
+                throw std::logic_error("unsupported scheme");
+            }
+            rotate_plan_internal(encrypted, plan, galois_keys, destinations, std::move(pool));
+        }
+
         /**
         Complex conjugates plaintext slot values. When using the CKKS scheme, this function complex conjugates all
         values in the underlying plaintext. Dynamic memory allocations in the process are allocated from the memory pool
@@ -1194,38 +1668,404 @@ namespace seal
             complex_conjugate_inplace(destination, galois_keys, std::move(pool));
         }
 
+        /**
+        Multiplies an encrypted vector by a matrix given by its diagonals. When using the CKKS scheme, this function
+        computes the sum over i < height of M[i] times the encrypted vector rotated by i times the stride N/(2*width),
+        where N is the degree of the polynomial modulus, and writes the result to the destination parameter. The
+        rotations share one decomposition as in rotate_vector_many, and the products are summed in NTT form at the
+        scale of the product and rescaled once. If all plaintexts are encoded at the key level, whose parms_id is
+        SEALContext::key_parms_id(), the products are summed modulo Q*P as with rotate_vector_many_extended and
+        divided by P only once. Plaintext products do not grow the ciphertext, so no relinearization is done. Dynamic
+        memory allocations in the process are allocated from the memory pool pointed to by the given
+        MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to multiply
+        @param[in] M The plaintext diagonals of the matrix
+        @param[in] height The number of diagonals
+        @param[in] width The width of the matrix, which determines the stride
+        @param[in] galois_keys The Galois keys
+        @param[out] result The ciphertext to overwrite with the product
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::logic_error if scheme is not scheme_type::ckks
+        @throws std::invalid_argument if height or width is not positive
+        @throws std::invalid_argument if M does not have height diagonals
+        @see linear_transformation_bsgs for the baby-step giant-step algorithm, which needs fewer key switches.
+        */
         inline void linear_transformation(
-                Ciphertext &encrypted, std::vector<Plaintext> &M, int height, int width,
-                const GaloisKeys &galois_keys, const RelinKeys &relin_keys, Ciphertext &result,
-                MemoryPoolHandle pool = MemoryManager::GetPool()) const
+            const Ciphertext &encrypted, const std::vector<Plaintext> &M, int height, int width,
+            const GaloisKeys &galois_keys, Ciphertext &result, MemoryPoolHandle pool = MemoryManager::GetPool()) const
         {
             if (context_.key_context_data()->parms().scheme() != scheme_type::ckks)
             {
                 throw std::logic_error("unsupported scheme");
             }
+            if (height <= 0 || width <= 0)
+            {
+                throw std::invalid_argument("height and width must be positive");
+            }
+            if (M.size() != static_cast<std::size_t>(height))
+            {
+                throw std::invalid_argument("M must have height diagonals");
+            }
 
             size_t coeff_count = context_.key_context_data()->parms().poly_modulus_degree();
             size_t slot_count = coeff_count >> 1;
             size_t stride = slot_count / width;
 
-            std::vector<Ciphertext> rotV(height, encrypted);
+            std::vector<int> steps(height);
             for (int i=1; i!=height; ++i)
             {
-                rotate_internal(rotV[i], i * stride, galois_keys, pool);
+                steps[i] = i * static_cast<int>(stride);
             }
-            multiply_plain_inplace(rotV[0], M[0], pool);
-            relinearize_internal(rotV[0], relin_keys, 2, pool);
-            rescale_to_next(rotV[0], rotV[0], pool);
-            result = rotV[0];
+
+            // Plaintexts encoded at the key level allow summing the terms modulo Q*P and dividing by P only once
+            bool use_extended = true;
+            for (int i=0; i!=height; ++i)
+            {
+                use_extended = use_extended && (M[i].parms_id() == context_.key_parms_id());
+            }
+            if (use_extended)
+            {
+                std::vector<ExtendedCiphertext> rotE;
+                rotate_vector_many_extended(encrypted, steps, galois_keys, rotE, pool);
+                multiply_plain_extended_inplace(rotE[0], M[0], pool);
+                for (int i=1; i!=height; ++i)
+                {
+                    multiply_plain_extended_inplace(rotE[i], M[i], pool);
+                    add_extended_inplace(rotE[0], rotE[i]);
+                }
+                transform_from_extended(rotE[0], result, pool);
+                rescale_to_next(result, result, pool);
+                return;
+            }
+
+            // The unrotated term is multiplied directly into result; only the rotations are materialized
+            steps.erase(steps.begin());
+            std::vector<Ciphertext> rotV;
+            if (!steps.empty())
+            {
+                rotate_vector_many(encrypted, steps, galois_keys, rotV, pool);
+            }
+            multiply_plain(encrypted, M[0], result, pool);
             for (int i=1; i!=height; ++i)
             {
-                multiply_plain_inplace(rotV[i], M[i], pool);
-                relinearize_internal(rotV[i], relin_keys, 2, pool);
-                rescale_to_next(rotV[i], rotV[i], pool);
-                add_inplace(result, rotV[i]);
+                multiply_plain_inplace(rotV[i - 1], M[i], pool);
+                add_inplace(result, rotV[i - 1]);
+            }
+            rescale_to_next(result, result, pool);
+        }
+
+        /**
+        Multiplies an encrypted vector by a matrix given by its diagonals as the overload without relin_keys does.
+        Plaintext products do not grow the ciphertext, so relin_keys is not used.
+        */
+        [[deprecated("relin_keys is not used; call linear_transformation without it")]] inline void
+            linear_transformation(
+                const Ciphertext &encrypted, const std::vector<Plaintext> &M, int height, int width,
+                const GaloisKeys &galois_keys, SEAL_MAYBE_UNUSED const RelinKeys &relin_keys, Ciphertext &result,
+                MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            linear_transformation(encrypted, M, height, width, galois_keys, result, std::move(pool));
+        }
+
+        /**
+        Returns the rotation steps whose Galois keys linear_transformation_bsgs needs for the given number of diagonals
+        and width: the baby steps, which are the multiples of the stride N/(2*width) below g times the stride, and the
+        giant steps, which are the multiples of g times the stride below diagonal_count times the stride, where g is
+        the smallest integer at least the square root of diagonal_count.
+
+        @param[in] diagonal_count The number of diagonals
+        @param[in] width The width of the matrix, which divides the number of slots
+        @throws std::logic_error if scheme is not scheme_type::ckks
+        @throws std::invalid_argument if width does not divide the number of slots
+        @throws std::invalid_argument if diagonal_count is zero or larger than width
+        */
+        SEAL_NODISCARD std::vector<int> linear_transformation_bsgs_steps(std::size_t diagonal_count, int width) const;
+
+        /**
+        Multiplies an encrypted vector by a matrix given by its diagonals with the baby-step giant-step algorithm of
+        Halevi and Shoup. When using the CKKS scheme, this function computes the sum over i of diagonals[i] times the
+        encrypted vector rotated by i times the stride N/(2*width), where N is the degree of the polynomial modulus,
+        rescales it once, and writes the result to the destination parameter. This is the same sum that
+        linear_transformation computes for height equal to the number of diagonals.
+
+        With g baby steps and about d/g giant steps for d diagonals, the index i is split as i = j*g + k and the
+        rotation by j*g*stride is moved out of the inner sum over k, after pre-rotating the diagonals by -j*g*stride.
+        The g - 1 baby-step rotations of the input share one decomposition as in rotate_vector_many, and each giant
+        step costs one more key switch, so that about 2*sqrt(d) key switches replace d - 1. The diagonals are rotated
+        as plaintexts in NTT form, which needs no keys. If all diagonals are encoded at the key level, whose parms_id
+        is SEALContext::key_parms_id(), the products are summed modulo Q*P as with rotate_vector_many_extended, and
+        the giant-step sums are divided by P only once. Otherwise the diagonals must be at the level of encrypted.
+        Diagonals that are zero are skipped. All diagonals must have the same scale. Dynamic memory allocations in
+        the process are allocated from the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to multiply
+        @param[in] diagonals The diagonals of the matrix in NTT form
+        @param[in] width The width of the matrix, which divides the number of slots
+        @param[in] galois_keys The Galois keys, including those for linear_transformation_bsgs_steps
+        @param[out] destination The ciphertext to overwrite with the result
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::logic_error if scheme is not scheme_type::ckks
+        @throws std::invalid_argument if width does not divide the number of slots
+        @throws std::invalid_argument if diagonals is empty or has more elements than width
+        @throws std::invalid_argument if encrypted, galois_keys, or any of the diagonals is not valid for the
+        encryption parameters
+        @throws std::invalid_argument if the diagonals are neither all at the level of encrypted nor all at the key
+        level
+        @throws std::invalid_argument if encrypted is at the last level
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        void linear_transformation_bsgs(
+            const Ciphertext &encrypted, const std::vector<Plaintext> &diagonals, int width,
+            const GaloisKeys &galois_keys, Ciphertext &destination,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Multiplies an encrypted vector by the matrix of a LinearTransformPlan. When using the CKKS scheme, this
+        function evaluates the pre-rotated diagonals of the plan with the baby-step giant-step algorithm of
+        linear_transformation_bsgs, rescales the result once, and writes it to the destination parameter. The input
+        and output vectors have the layout that LinearTransformPlan describes. No diagonal is encoded or rotated in
+        the process. Dynamic memory allocations in the process are allocated from the memory pool pointed to by the
+        given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to multiply
+        @param[in] plan The plan of the matrix
+        @param[in] galois_keys The Galois keys, including those for plan.steps()
+        @param[out] destination The ciphertext to overwrite with the result
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::logic_error if scheme is not scheme_type::ckks
+        @throws std::invalid_argument if plan is empty
+        @throws std::invalid_argument if encrypted, galois_keys, or plan is not valid for the encryption parameters
+        @throws std::invalid_argument if plan is neither at the level of encrypted nor at the key level
+        @throws std::invalid_argument if encrypted is at the last level
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        inline void linear_transformation(
+            const Ciphertext &encrypted, const LinearTransformPlan &plan, const GaloisKeys &galois_keys,
+            Ciphertext &destination, MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            if (!plan.dimension())
+            {
+                throw std::invalid_argument("plan is empty");
+            }
+            linear_transformation_bsgs_internal(
+                encrypted, plan.diagonals(), plan.indices(), plan.dimension(), plan.offset(), plan.baby_step_count(),
+                true, galois_keys, destination, std::move(pool));
+        }
+
+        /**
+        Multiplies an encrypted vector that is split into several ciphertexts by the matrix of a
+        TiledLinearTransformPlan, which may be larger than the number of slots. When using the CKKS scheme, this
+        function evaluates every tile with the baby-step giant-step algorithm of linear_transformation, rescales every
+        output ciphertext once, and writes the output ciphertexts to the destination parameter. The input and output
+        vectors have the layout that TiledLinearTransformPlan describes. The baby-step rotations of each input
+        ciphertext are computed once for all tiles of its column, and the products of all tiles of a row are summed
+        for each giant step, whose rotations of all output ciphertexts share the key switching as in
+        apply_galois_many_inplace. Dynamic memory allocations in the process are allocated from the memory pool
+        pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertexts holding the parts of the input vector
+        @param[in] plan The plan of the matrix
+        @param[in] galois_keys The Galois keys, including those for plan.steps()
+        @param[out] destination The ciphertexts to overwrite with the parts of the output vector
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::logic_error if scheme is not scheme_type::ckks
+        @throws std::invalid_argument if plan is empty
+        @throws std::invalid_argument if the size of encrypted differs from plan.input_count()
+        @throws std::invalid_argument if encrypted, galois_keys, or plan is not valid for the encryption parameters
+        @throws std::invalid_argument if the ciphertexts in encrypted are at different levels
+        @throws std::invalid_argument if plan is neither at the level of encrypted nor at the key level
+        @throws std::invalid_argument if encrypted is at the last level
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if the output scale is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        @throws std::logic_error if any result ciphertext is transparent
+        */
+        void linear_transformation(
+            const std::vector<Ciphertext> &encrypted, const TiledLinearTransformPlan &plan,
+            const GaloisKeys &galois_keys, std::vector<Ciphertext> &destination,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Applies several Galois automorphisms to the same ciphertext as apply_galois_many does, but stops before the
+        final division by the product P of the special primes. The results are written, in the order of the Galois
+        elements, to the destinations parameter as extended ciphertexts modulo Q*P. They can be multiplied by
+        plaintexts with multiply_plain_extended_inplace and summed with add_extended_inplace, and the sum is divided by
+        P only once by transform_from_extended (double hoisting). This saves the NTTs of the modulus switching of every
+        term but one, at the cost of multiplications modulo the special primes. Dynamic memory allocations in the
+        process are allocated from the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to apply the Galois automorphisms to
+        @param[in] galois_elts The Galois elements
+        @param[in] galois_keys The Galois keys
+        @param[out] destinations The vector of extended ciphertexts to overwrite with the results
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted or galois_keys is not valid for
+        the encryption parameters
+        @throws std::invalid_argument if galois_keys do not correspond to the top
+        level parameters in the current context
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if any of the Galois elements is not valid
+        @throws std::invalid_argument if necessary Galois keys are not present
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        */
+        void apply_galois_many_extended(
+            const Ciphertext &encrypted, const std::vector<std::uint32_t> &galois_elts, const GaloisKeys &galois_keys,
+            std::vector<ExtendedCiphertext> &destinations, MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Rotates plaintext matrix rows cyclically by several numbers of steps as rotate_rows_many does, but writes the
+        results as extended ciphertexts modulo Q*P as apply_galois_many_extended does. The rotations that are not
+        hoisted and a step of zero are computed as in rotate_rows_many and transformed with transform_to_extended.
+        Dynamic memory allocations in the process are allocated from the memory pool pointed to by the given
+        MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to rotate
+        @param[in] steps The numbers of steps to rotate (positive left, negative right)
+        @param[in] galois_keys The Galois keys
+        @param[out] destinations The vector of extended ciphertexts to overwrite with the rotated results
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::logic_error if scheme is not scheme_type::bfv or scheme_type::bgv
+        @throws std::logic_error if the encryption parameters do not support batching
+        @throws std::invalid_argument if encrypted or galois_keys is not valid for
+        the encryption parameters
+        @throws std::invalid_argument if galois_keys do not correspond to the top
+        level parameters in the current context
+        @throws std::invalid_argument if encrypted is in NTT form
+        @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if any of the steps has too big absolute value
+        @throws std::invalid_argument if necessary Galois keys are not present
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        */
+        inline void rotate_rows_many_extended(
+            const Ciphertext &encrypted, const std::vector<int> &steps, const GaloisKeys &galois_keys,
+            std::vector<ExtendedCiphertext> &destinations, MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            auto scheme = context_.key_context_data()->parms().scheme();
+            if (scheme != scheme_type::bfv && scheme != scheme_type::bgv)
+            {
+                throw std::logic_error("unsupported scheme");
+            }
+            rotate_many_extended_internal(encrypted, steps, galois_keys, destinations, std::move(pool));
+        }
+
+        /**
+        Rotates plaintext vector cyclically by several numbers of steps as rotate_vector_many does, but writes the
+        results as extended ciphertexts modulo Q*P as apply_galois_many_extended does. The rotations that are not
+        hoisted and a step of zero are computed as in rotate_vector_many and transformed with transform_to_extended.
+        Dynamic memory allocations in the process are allocated from the memory pool pointed to by the given
+        MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to rotate
+        @param[in] steps The numbers of steps to rotate (positive left, negative right)
+        @param[in] galois_keys The Galois keys
+        @param[out] destinations The vector of extended ciphertexts to overwrite with the rotated results
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::logic_error if scheme is not scheme_type::ckks
+        @throws std::invalid_argument if encrypted or galois_keys is not valid for
+        the encryption parameters
+        @throws std::invalid_argument if galois_keys do not correspond to the top
+        level parameters in the current context
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if encrypted has size larger than 2
+        @throws std::invalid_argument if any of the steps has too big absolute value
+        @throws std::invalid_argument if necessary Galois keys are not present
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        */
+        inline void rotate_vector_many_extended(
+            const Ciphertext &encrypted, const std::vector<int> &steps, const GaloisKeys &galois_keys,
+            std::vector<ExtendedCiphertext> &destinations, MemoryPoolHandle pool = MemoryManager::GetPool()) const
+        {
+            if (context_.key_context_data()->parms().scheme() != scheme_type::ckks)
+            {
+                throw std::logic_error("unsupported scheme");
             }
+            rotate_many_extended_internal(encrypted, steps, galois_keys, destinations, std::move(pool));
         }
 
+        /**
+        Transforms a ciphertext to an extended ciphertext modulo Q*P, by multiplying it by the product P of the special
+        primes, so that it can be added to the results of apply_galois_many_extended. Dynamic memory allocations in the
+        process are allocated from the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted The ciphertext to transform
+        @param[out] destination The extended ciphertext to overwrite with the result
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted is not valid for the encryption parameters
+        @throws std::invalid_argument if encrypted is not in the default NTT form
+        @throws std::invalid_argument if encrypted has size other than 2
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if keyswitching is not supported by the context
+        */
+        void transform_to_extended(
+            const Ciphertext &encrypted, ExtendedCiphertext &destination,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Divides an extended ciphertext modulo Q*P by the product P of the special primes with rounding, and writes the
+        resulting ciphertext modulo Q, in the default NTT form of the scheme, to the destination parameter. Dynamic
+        memory allocations in the process are allocated from the memory pool pointed to by the given
+        MemoryPoolHandle.
+
+        @param[in] encrypted The extended ciphertext to transform
+        @param[out] destination The ciphertext to overwrite with the result
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted is not valid for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        @throws std::logic_error if result ciphertext is transparent
+        */
+        void transform_from_extended(
+            const ExtendedCiphertext &encrypted, Ciphertext &destination,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Multiplies an extended ciphertext with a plaintext. The plaintext is needed modulo the special primes too: in
+        CKKS it must be encoded at the key level, whose parms_id is SEALContext::key_parms_id(), and in BFV and BGV it
+        is lifted like in multiply_plain. Dynamic memory allocations in the process are allocated from the memory pool
+        pointed to by the given MemoryPoolHandle.
+
+        @param[in] encrypted The extended ciphertext to multiply
+        @param[in] plain The plaintext to multiply
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if encrypted or plain is not valid for the encryption parameters
+        @throws std::invalid_argument if plain is not in NTT form at the key level in CKKS
+        @throws std::invalid_argument if plain is in NTT form in BFV or BGV
+        @throws std::invalid_argument if, when using scheme_type::ckks, the output scale is too large for the
+        encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        void multiply_plain_extended_inplace(
+            ExtendedCiphertext &encrypted, const Plaintext &plain,
+            MemoryPoolHandle pool = MemoryManager::GetPool()) const;
+
+        /**
+        Adds two extended ciphertexts. This function adds together encrypted1 and encrypted2 and stores the result in
+        encrypted1.
+
+        @param[in] encrypted1 The first extended ciphertext to add
+        @param[in] encrypted2 The second extended ciphertext to add
+        @throws std::invalid_argument if encrypted1 or encrypted2 is not valid for the encryption parameters
+        @throws std::invalid_argument if encrypted1 and encrypted2 are at different level or scale
+        @throws std::invalid_argument if encrypted1 and encrypted2 have different correction factors
+        */
+        void add_extended_inplace(ExtendedCiphertext &encrypted1, const ExtendedCiphertext &encrypted2) const;
+
         /**
         Enables access to private members of seal::Evaluator for SEAL_C.
         */
@@ -1240,17 +2080,39 @@ namespace seal
 
         Evaluator &operator=(Evaluator &&assign) = delete;
 
-        void bfv_multiply(Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool) const;
+        // The functions below multiply ciphertexts into encrypted1 or encrypted. If last_destination is set, both
+        // ciphertexts must have size 2; the last component of the product is then written to last_destination, and
+        // the product is not resized to size 3.
+        void bfv_multiply(
+            Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool,
+            util::RNSIter last_destination = util::RNSIter()) const;
+
+        void bfv_multiply_hps(
+            Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool,
+            util::RNSIter last_destination = util::RNSIter()) const;
 
-        void ckks_multiply(Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool) const;
+        void ckks_multiply(
+            Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool,
+            util::RNSIter last_destination = util::RNSIter()) const;
 
-        void bgv_multiply(Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool) const;
+        void bgv_multiply(
+            Ciphertext &encrypted1, const Ciphertext &encrypted2, MemoryPoolHandle pool,
+            util::RNSIter last_destination = util::RNSIter()) const;
 
-        void bfv_square(Ciphertext &encrypted, MemoryPoolHandle pool) const;
+        void bfv_square(
+            Ciphertext &encrypted, MemoryPoolHandle pool, util::RNSIter last_destination = util::RNSIter()) const;
 
-        void ckks_square(Ciphertext &encrypted, MemoryPoolHandle pool) const;
+        void ckks_square(
+            Ciphertext &encrypted, MemoryPoolHandle pool, util::RNSIter last_destination = util::RNSIter()) const;
 
-        void bgv_square(Ciphertext &encrypted, MemoryPoolHandle pool) const;
+        void bgv_square(
+            Ciphertext &encrypted, MemoryPoolHandle pool, util::RNSIter last_destination = util::RNSIter()) const;
+
+        // Multiplies encrypted1 by encrypted2, or squares it if they are the same object, relinearizes the product
+        // without resizing encrypted1 to size 3, and rescales the result if rescale is set.
+        void multiply_relin_internal(
+            Ciphertext &encrypted1, const Ciphertext &encrypted2, const RelinKeys &relin_keys, bool rescale,
+            MemoryPoolHandle pool) const;
 
         void relinearize_internal(
             Ciphertext &encrypted, const RelinKeys &relin_keys, std::size_t destination_size,
@@ -1266,6 +2128,38 @@ namespace seal
         void rotate_internal(
             Ciphertext &encrypted, int steps, const GaloisKeys &galois_keys, MemoryPoolHandle pool) const;
 
+        void rotate_many_internal(
+            const Ciphertext &encrypted, const std::vector<int> &steps, const GaloisKeys &galois_keys,
+            std::vector<Ciphertext> &destinations, MemoryPoolHandle pool) const;
+
+        void rotate_plan_internal(
+            const Ciphertext &encrypted, const RotationPlan &plan, const GaloisKeys &galois_keys,
+            std::vector<Ciphertext> &destinations, MemoryPoolHandle pool) const;
+
+        void rotate_many_extended_internal(
+            const Ciphertext &encrypted, const std::vector<int> &steps, const GaloisKeys &galois_keys,
+            std::vector<ExtendedCiphertext> &destinations, MemoryPoolHandle pool) const;
+
+        std::vector<std::uint32_t> hoisted_rotation_elts(
+            const Ciphertext &encrypted, const std::vector<int> &steps, const GaloisKeys &galois_keys) const;
+
+        // Computes the key switching products of the Galois automorphisms of encrypted.data(1), sharing one
+        // decomposition, and passes them in NTT form modulo q U P to consume together with the index of the element.
+        void apply_galois_many_internal(
+            const Ciphertext &encrypted, const std::vector<std::uint32_t> &galois_elts, const GaloisKeys &galois_keys,
+            const std::function<void(std::size_t, util::PolyIter)> &consume, MemoryPoolHandle pool) const;
+
+        SEAL_NODISCARD bool is_extended_valid(const ExtendedCiphertext &encrypted) const;
+
+        // Evaluates the diagonals with the given indices, ordered by giant step, with the baby-step giant-step
+        // algorithm for the given offset and number of baby steps. If pre_rotated is set, the diagonals of each giant
+        // step are already rotated by minus its rotation, as in LinearTransformPlan.
+        void linear_transformation_bsgs_internal(
+            const Ciphertext &encrypted, const std::vector<Plaintext> &diagonals,
+            const std::vector<std::size_t> &indices, std::size_t dimension, std::size_t offset,
+            std::size_t baby_step_count, bool pre_rotated, const GaloisKeys &galois_keys, Ciphertext &destination,
+            MemoryPoolHandle pool) const;
+
         inline void conjugate_internal(
             Ciphertext &encrypted, const GaloisKeys &galois_keys, MemoryPoolHandle pool) const
         {
@@ -1293,6 +2187,13 @@ namespace seal
             Ciphertext &encrypted, util::ConstRNSIter target_iter, const KSwitchKeys &kswitch_keys,
             std::size_t key_index, MemoryPoolHandle pool = MemoryManager::GetPool()) const;
 
+        // Key switches the targets of several ciphertexts at the same level with the same key and adds the results to
+        // the ciphertexts. The moduli are iterated outside of the ciphertexts of a tile, so that the rows of the key
+        // for each modulus are read once per tile.
+        void switch_key_many_inplace(
+            const std::vector<Ciphertext *> &encrypteds, const std::vector<util::ConstRNSIter> &target_iters,
+            const KSwitchKeys &kswitch_keys, std::size_t key_index, MemoryPoolHandle pool) const;
+
         void multiply_plain_normal(Ciphertext &encrypted, const Plaintext &plain, MemoryPoolHandle pool) const;
 
         void multiply_plain_ntt(Ciphertext &encrypted_ntt, const Plaintext &plain_ntt) const;
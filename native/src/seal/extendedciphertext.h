@@ -0,0 +1,246 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/context.h"
+#include "seal/dynarray.h"
+#include "seal/encryptionparams.h"
+#include "seal/memorymanager.h"
+#include "seal/util/common.h"
+#include "seal/util/defines.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace seal
+{
+    /**
+    Class to store a ciphertext of size 2 in the extended coefficient modulus Q*P, where Q is the coefficient modulus
+    of the ciphertext's level and P is the product of the special primes. Key switching computes its result modulo Q*P
+    and divides it by P with rounding only at the end (ModDown). The Evaluator functions that produce an
+    ExtendedCiphertext, such as Evaluator::apply_galois_many_extended, stop before this division, so that several
+    key switching results can be multiplied by plaintexts and summed modulo Q*P, and divided by P only once with
+    Evaluator::transform_from_extended. An ExtendedCiphertext stands for the ciphertext obtained by this division.
+
+    The polynomials are always in NTT form, modulo the primes of Q followed by the special primes; the parms_id is
+    that of the level of Q. The data is not meant to be modified directly by the user, and is not serializable.
+
+    @par Thread Safety
+    In general, reading from an ExtendedCiphertext is thread-safe as long as no other thread is concurrently mutating
+    it.
+
+    @see Ciphertext for the class that stores ciphertexts.
+    */
+    class ExtendedCiphertext
+    {
+    public:
+        using ct_coeff_type = std::uint64_t;
+
+        /**
+        Constructs an empty extended ciphertext allocating no memory.
+
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        ExtendedCiphertext(MemoryPoolHandle pool = MemoryManager::GetPool()) : data_(std::move(pool))
+        {}
+
+        /**
+        Creates a new extended ciphertext by copying a given one.
+
+        @param[in] copy The extended ciphertext to copy from
+        */
+        ExtendedCiphertext(const ExtendedCiphertext &copy) = default;
+
+        /**
+        Creates a new extended ciphertext by moving a given one.
+
+        @param[in] source The extended ciphertext to move from
+        */
+        ExtendedCiphertext(ExtendedCiphertext &&source) = default;
+
+        /**
+        Copies a given extended ciphertext to the current one.
+
+        @param[in] assign The extended ciphertext to copy from
+        */
+        ExtendedCiphertext &operator=(const ExtendedCiphertext &assign) = default;
+
+        /**
+        Moves a given extended ciphertext to the current one.
+
+        @param[in] assign The extended ciphertext to move from
+        */
+        ExtendedCiphertext &operator=(ExtendedCiphertext &&assign) = default;
+
+        /**
+        Allocates the extended ciphertext for the level given by parms_id, sets all its coefficients to zero, and
+        resets the scale and the correction factor to one.
+
+        @param[in] context The SEALContext
+        @param[in] parms_id The parms_id of the level of Q
+        @throws std::invalid_argument if the encryption parameters are not valid
+        @throws std::invalid_argument if parms_id is not valid for the encryption parameters or is the key level
+        @throws std::logic_error if keyswitching is not supported by the context
+        */
+        inline void resize(const SEALContext &context, const parms_id_type &parms_id)
+        {
+            if (!context.parameters_set())
+            {
+                throw std::invalid_argument("encryption parameters are not set correctly");
+            }
+            if (!context.using_keyswitching())
+            {
+                throw std::logic_error("keyswitching is not supported by the context");
+            }
+            auto context_data_ptr = context.get_context_data(parms_id);
+            if (!context_data_ptr || !context_data_ptr->kswitch_tool())
+            {
+                throw std::invalid_argument("parms_id is not valid for encryption parameters");
+            }
+
+            poly_modulus_degree_ = context_data_ptr->parms().poly_modulus_degree();
+            coeff_modulus_size_ = util::add_safe(
+                context_data_ptr->parms().coeff_modulus().size(),
+                context.key_context_data()->parms().special_prime_count());
+            data_.resize(util::mul_safe(std::size_t(2), poly_modulus_degree_, coeff_modulus_size_), false);
+            std::fill(data_.begin(), data_.end(), ct_coeff_type(0));
+            parms_id_ = parms_id;
+            scale_ = 1.0;
+            correction_factor_ = 1;
+        }
+
+        /**
+        Returns a pointer to the beginning of the extended ciphertext data.
+        */
+        SEAL_NODISCARD inline ct_coeff_type *data() noexcept
+        {
+            return data_.begin();
+        }
+
+        /**
+        Returns a const pointer to the beginning of the extended ciphertext data.
+        */
+        SEAL_NODISCARD inline const ct_coeff_type *data() const noexcept
+        {
+            return data_.cbegin();
+        }
+
+        /**
+        Returns a pointer to a particular polynomial in the extended ciphertext data, modulo the first prime.
+
+        @param[in] poly_index The index of the polynomial in the extended ciphertext
+        @throws std::out_of_range if poly_index is not 0 or 1
+        */
+        SEAL_NODISCARD inline ct_coeff_type *data(std::size_t poly_index)
+        {
+            if (poly_index >= size())
+            {
+                throw std::out_of_range("poly_index must be within [0, size)");
+            }
+            return data_.begin() + poly_index * poly_modulus_degree_ * coeff_modulus_size_;
+        }
+
+        /**
+        Returns a const pointer to a particular polynomial in the extended ciphertext data, modulo the first prime.
+
+        @param[in] poly_index The index of the polynomial in the extended ciphertext
+        @throws std::out_of_range if poly_index is not 0 or 1
+        */
+        SEAL_NODISCARD inline const ct_coeff_type *data(std::size_t poly_index) const
+        {
+            if (poly_index >= size())
+            {
+                throw std::out_of_range("poly_index must be within [0, size)");
+            }
+            return data_.cbegin() + poly_index * poly_modulus_degree_ * coeff_modulus_size_;
+        }
+
+        /**
+        Returns the number of primes of Q*P, or zero if no memory is allocated.
+        */
+        SEAL_NODISCARD inline std::size_t coeff_modulus_size() const noexcept
+        {
+            return coeff_modulus_size_;
+        }
+
+        /**
+        Returns the degree of the polynomial modulus, or zero if no memory is allocated.
+        */
+        SEAL_NODISCARD inline std::size_t poly_modulus_degree() const noexcept
+        {
+            return poly_modulus_degree_;
+        }
+
+        /**
+        Returns the number of polynomials: 2, or zero if no memory is allocated.
+        */
+        SEAL_NODISCARD inline std::size_t size() const noexcept
+        {
+            return data_.size() ? std::size_t(2) : std::size_t(0);
+        }
+
+        /**
+        Returns a const reference to the parms_id of the level of Q.
+        */
+        SEAL_NODISCARD inline const parms_id_type &parms_id() const noexcept
+        {
+            return parms_id_;
+        }
+
+        /**
+        Returns a reference to the scale. This is only needed when using the CKKS encryption scheme.
+        */
+        SEAL_NODISCARD inline double &scale() noexcept
+        {
+            return scale_;
+        }
+
+        /**
+        Returns a constant reference to the scale. This is only needed when using the CKKS encryption scheme.
+        */
+        SEAL_NODISCARD inline const double &scale() const noexcept
+        {
+            return scale_;
+        }
+
+        /**
+        Returns a reference to the correction factor. This is only needed when using the BGV encryption scheme.
+        */
+        SEAL_NODISCARD inline std::uint64_t &correction_factor() noexcept
+        {
+            return correction_factor_;
+        }
+
+        /**
+        Returns a constant reference to the correction factor. This is only needed when using the BGV encryption scheme.
+        */
+        SEAL_NODISCARD inline const std::uint64_t &correction_factor() const noexcept
+        {
+            return correction_factor_;
+        }
+
+        /**
+        Returns the currently used MemoryPoolHandle.
+        */
+        SEAL_NODISCARD inline MemoryPoolHandle pool() const noexcept
+        {
+            return data_.pool();
+        }
+
+    private:
+        parms_id_type parms_id_ = parms_id_zero;
+
+        std::size_t poly_modulus_degree_ = 0;
+
+        std::size_t coeff_modulus_size_ = 0;
+
+        double scale_ = 1.0;
+
+        std::uint64_t correction_factor_ = 1;
+
+        DynArray<ct_coeff_type> data_;
+    };
+} // namespace seal
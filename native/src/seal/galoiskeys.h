@@ -59,15 +59,17 @@ namespace seal
         SEAL_NODISCARD inline bool has_key(std::uint32_t galois_elt) const
         {
             std::size_t index = get_index(galois_elt);
-            return data().size() > index && !data()[index].empty();
+            return data().size() > index && (!data()[index].empty() || is_compact(index));
         }
 
         /**
         Returns a const reference to a Galois key. The returned Galois key corresponds
-        to the given Galois element.
+        to the given Galois element. A key in compact form is accessed with
+        KSwitchKeys::expanded_data instead.
 
         @param[in] galois_elt The Galois element
-        @throws std::invalid_argument if the key corresponding to galois_elt does not exist
+        @throws std::invalid_argument if the key corresponding to galois_elt does not
+        exist or is in compact form
         */
         SEAL_NODISCARD inline const auto &key(std::uint32_t galois_elt) const
         {
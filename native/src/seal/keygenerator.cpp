@@ -306,7 +306,10 @@ namespace seal
         }
 
         size_t coeff_count = context_.key_context_data()->parms().poly_modulus_degree();
+        auto &kswitch_tool = *context_.first_context_data()->kswitch_tool();
         size_t decomp_mod_count = context_.first_context_data()->parms().coeff_modulus().size();
+        size_t digit_size = kswitch_tool.digit_size();
+        size_t digit_count = kswitch_tool.digit_count();
         auto &key_context_data = *context_.key_context_data();
         auto &key_parms = key_context_data.parms();
         auto &key_modulus = key_parms.coeff_modulus();
@@ -318,18 +321,55 @@ namespace seal
         }
 
         // KSwitchKeys data allocated from pool given by MemoryManager::GetPool.
-        destination.resize(decomp_mod_count);
+        destination.resize(digit_count);
+
+        // Keys in Montgomery form are the encryptions (c0, c1) multiplied by R = 2^64. Encrypting with the secret key
+        // multiplied by R^(-1) and multiplying only c0 by R yields them with c1 still sampled from the public seed, so
+        // that they can be saved with the seed.
+        bool use_montgomery_keys = key_parms.use_montgomery_keys();
+        size_t key_modulus_size = key_modulus.size();
+        auto montgomery_factors(allocate<MultiplyUIntModOperand>(key_modulus_size, pool_));
+        SecretKey montgomery_secret_key;
+        if (use_montgomery_keys)
+        {
+            montgomery_secret_key = secret_key_;
+            RNSIter montgomery_secret_key_iter(montgomery_secret_key.data().data(), coeff_count);
+            SEAL_ITERATE(
+                iter(montgomery_secret_key_iter, key_modulus, montgomery_factors), key_modulus_size, [&](auto I) {
+                    unsigned long long r[2]{ 0, 1 };
+                    uint64_t r_mod = barrett_reduce_128(r, get<1>(I));
+                    uint64_t r_inverse = 0;
+                    try_invert_uint_mod(r_mod, get<1>(I), r_inverse);
+                    multiply_poly_scalar_coeffmod(get<0>(I), coeff_count, r_inverse, get<1>(I), get<0>(I));
+                    get<2>(I).set(r_mod, get<1>(I));
+                });
+        }
+        const SecretKey &encryption_key = use_montgomery_keys ? montgomery_secret_key : secret_key_;
 
-        SEAL_ITERATE(iter(new_key, key_modulus, destination, size_t(0)), decomp_mod_count, [&](auto I) {
-            SEAL_ALLOCATE_GET_COEFF_ITER(temp, coeff_count, pool_);
+        // The key for digit j encrypts P * new_key modulo the primes of the digit and zero modulo all other primes
+        SEAL_ALLOCATE_GET_COEFF_ITER(temp, coeff_count, pool_);
+        SEAL_ITERATE(iter(destination, size_t(0)), digit_count, [&](auto I) {
             encrypt_zero_symmetric(
-                secret_key_, context_, key_context_data.parms_id(), true, save_seed, get<2>(I).data());
-            uint64_t factor = barrett_reduce_64(key_modulus.back().value(), get<1>(I));
-            multiply_poly_scalar_coeffmod(get<0>(I), coeff_count, factor, get<1>(I), temp);
-
-            // We use the SeqIter at get<3>(I) to find the i-th RNS factor of the first destination polynomial.
-            CoeffIter destination_iter = (*iter(get<2>(I).data()))[get<3>(I)];
-            add_poly_coeffmod(destination_iter, temp, coeff_count, get<1>(I), destination_iter);
+                encryption_key, context_, key_context_data.parms_id(), true, save_seed, get<0>(I).data());
+
+            size_t digit_first = get<1>(I) * digit_size;
+            size_t digit_length = min(digit_size, decomp_mod_count - digit_first);
+            RNSIter destination_iter(get<0>(I).data().data(0), coeff_count);
+            SEAL_ITERATE(
+                iter(new_key + digit_first, destination_iter + digit_first, key_modulus.data() + digit_first,
+                     kswitch_tool.prod_P_mod_q() + digit_first),
+                digit_length, [&](auto J) {
+                    multiply_poly_scalar_coeffmod(get<0>(J), coeff_count, get<3>(J), get<2>(J), temp);
+                    add_poly_coeffmod(get<1>(J), temp, coeff_count, get<2>(J), get<1>(J));
+                });
+
+            if (use_montgomery_keys)
+            {
+                RNSIter c0(get<0>(I).data().data(0), coeff_count);
+                SEAL_ITERATE(iter(c0, key_modulus, montgomery_factors), key_modulus_size, [&](auto J) {
+                    multiply_poly_scalar_coeffmod(get<0>(J), coeff_count, get<2>(J), get<1>(J), get<0>(J));
+                });
+            }
         });
     }
 
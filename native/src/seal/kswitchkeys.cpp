@@ -2,6 +2,9 @@
 // Licensed under the MIT license.
 
 #include "seal/kswitchkeys.h"
+#include "seal/util/common.h"
+#include <algorithm>
+#include <functional>
 #include <stdexcept>
 
 using namespace std;
@@ -35,10 +38,118 @@ namespace seal
                 keys_[i][j] = assign.keys_[i][j];
             }
         }
+        compact_keys_ = assign.compact_keys_;
+        expansion_cache_ = assign.expansion_cache_;
 
         return *this;
     }
 
+    shared_ptr<const vector<PublicKey>> KSwitchKeys::expanded_data(const SEALContext &context, size_t index) const
+    {
+        if (index < keys_.size() && !keys_[index].empty())
+        {
+            // Alias the stored key without owning it
+            return shared_ptr<const vector<PublicKey>>(shared_ptr<const vector<PublicKey>>(), &keys_[index]);
+        }
+        if (!is_compact(index))
+        {
+            throw invalid_argument("keyswitching key does not exist");
+        }
+        {
+            lock_guard<mutex> lock(expansion_cache_.mutex);
+            auto found = expansion_cache_.entries.find(index);
+            if (found != expansion_cache_.entries.end())
+            {
+                auto &order = expansion_cache_.order;
+                order.splice(order.begin(), order, found->second.second);
+                return found->second.first;
+            }
+        }
+
+        if (!context.parameters_set() || context.key_parms_id() != parms_id_)
+        {
+            throw invalid_argument("KSwitchKeys is not valid for encryption parameters");
+        }
+        auto &key_parms = context.key_context_data()->parms();
+        size_t coeff_count = key_parms.poly_modulus_degree();
+        size_t coeff_modulus_size = key_parms.coeff_modulus().size();
+
+        // Sample the second polynomial of each component from its seed
+        auto expanded = make_shared<vector<PublicKey>>();
+        expanded->reserve(compact_keys_[index].size());
+        for (auto &component : compact_keys_[index])
+        {
+            if (component.poly_modulus_degree != coeff_count || component.coeff_modulus_size != coeff_modulus_size ||
+                component.data.size() != mul_safe(coeff_count, coeff_modulus_size))
+            {
+                throw logic_error("KSwitchKeys data is invalid");
+            }
+            PublicKey key(pool_);
+            key.pk_ = seeded_component(component);
+            key.pk_.expand_seed(context, component.prng_info, component.version);
+            expanded->push_back(move(key));
+        }
+        size_t byte_count = mul_safe(expanded->size(), size_t(2), coeff_count, coeff_modulus_size, sizeof(uint64_t));
+
+        lock_guard<mutex> lock(expansion_cache_.mutex);
+        auto found = expansion_cache_.entries.find(index);
+        if (found != expansion_cache_.entries.end())
+        {
+            // Another thread expanded the key in the meantime
+            return found->second.first;
+        }
+        if (byte_count <= expansion_cache_.byte_count)
+        {
+            expansion_cache_.order.push_front(index);
+            expansion_cache_.entries[index] = make_pair(expanded, expansion_cache_.order.begin());
+            expansion_cache_.used_byte_count += byte_count;
+            expansion_cache_.evict();
+        }
+        return expanded;
+    }
+
+    void KSwitchKeys::set_expansion_cache_byte_count(size_t byte_count)
+    {
+        lock_guard<mutex> lock(expansion_cache_.mutex);
+        expansion_cache_.byte_count = byte_count;
+        expansion_cache_.evict();
+    }
+
+    void KSwitchKeys::ExpansionCache::evict()
+    {
+        while (used_byte_count > byte_count)
+        {
+            auto found = entries.find(order.back());
+            for (auto &key : *found->second.first)
+            {
+                used_byte_count -= key.data().dyn_array().size() * sizeof(uint64_t);
+            }
+            entries.erase(found);
+            order.pop_back();
+        }
+    }
+
+    Ciphertext KSwitchKeys::seeded_component(const CompactKeyComponent &component) const
+    {
+        size_t poly_uint64_count = component.data.size();
+        Ciphertext seeded(pool_);
+        seeded.parms_id_ = parms_id_;
+        seeded.is_ntt_form_ = true;
+        seeded.size_ = 2;
+        seeded.poly_modulus_degree_ = component.poly_modulus_degree;
+        seeded.coeff_modulus_size_ = component.coeff_modulus_size;
+        seeded.data_.resize(mul_safe(poly_uint64_count, size_t(2)), false);
+        copy_n(component.data.cbegin(), poly_uint64_count, seeded.data_.begin());
+
+        // Write the UniformRandomGeneratorInfo after an indicator word, as encrypt_zero_symmetric does
+        uint64_t *c1 = seeded.data_.begin() + poly_uint64_count;
+        c1[0] = static_cast<uint64_t>(0xFFFFFFFFFFFFFFFFULL);
+        component.prng_info.save(
+            reinterpret_cast<seal_byte *>(c1 + 1),
+            static_cast<size_t>(UniformRandomGeneratorInfo::SaveSize(compr_mode_type::none)), compr_mode_type::none);
+        return seeded;
+    }
+
     void KSwitchKeys::save_members(ostream &stream) const
     {
         auto old_except_mask = stream.exceptions();
@@ -58,15 +169,33 @@ namespace seal
             // Now loop again over keys_dim1
             for (size_t index = 0; index < keys_dim1; index++)
             {
-                // Save second dimension of keys_
-                uint64_t keys_dim2 = static_cast<uint64_t>(keys_[index].size());
+                // Save second dimension of keys_; compact keys are saved with their seeds
+                bool compact = is_compact(index);
+                uint64_t keys_dim2 =
+                    static_cast<uint64_t>(compact ? compact_keys_[index].size() : keys_[index].size());
                 stream.write(reinterpret_cast<const char *>(&keys_dim2), sizeof(uint64_t));
 
                 // Loop over keys_dim2 and save all (or none)
                 for (size_t j = 0; j < keys_dim2; j++)
                 {
                     // Save the key
-                    keys_[index][j].save(stream, compr_mode_type::none);
+                    if (compact)
+                    {
+                        // Write the version that the seed was loaded from, so that it is sampled the same way again;
+                        // compact keys are only kept from versions with the current serialization format
+                        auto &component = compact_keys_[index][j];
+                        auto seeded = seeded_component(component);
+                        Serialization::SEALHeader header;
+                        header.version_major = component.version.major;
+                        header.version_minor = component.version.minor;
+                        header.size = safe_cast<uint64_t>(seeded.save_size(compr_mode_type::none));
+                        Serialization::SaveHeader(header, stream);
+                        seeded.save_members(stream);
+                    }
+                    else
+                    {
+                        keys_[index][j].save(stream, compr_mode_type::none);
+                    }
                 }
             }
         }
@@ -83,7 +212,7 @@ namespace seal
         stream.exceptions(old_except_mask);
     }
 
-    void KSwitchKeys::load_members(const SEALContext &context, istream &stream, SEAL_MAYBE_UNUSED SEALVersion version)
+    void KSwitchKeys::load_members(const SEALContext &context, istream &stream, SEALVersion version, bool compact)
     {
         // Verify parameters
         if (!context.parameters_set())
@@ -93,6 +222,7 @@ namespace seal
 
         // Create new keys
         vector<vector<PublicKey>> new_keys;
+        vector<vector<CompactKeyComponent>> new_compact_keys;
 
         auto old_except_mask = stream.exceptions();
         try
@@ -120,12 +250,55 @@ namespace seal
                 // Don't resize; only reserve
                 new_keys.emplace_back();
                 new_keys.back().reserve(safe_cast<size_t>(keys_dim2));
+                new_compact_keys.emplace_back();
+                vector<SEALVersion> key_versions;
                 for (size_t j = 0; j < keys_dim2; j++)
                 {
+                    // Keep the seeds when loading compact keys
                     PublicKey key(pool_);
-                    key.unsafe_load(context, stream);
+                    Serialization::Load(
+                        [&](istream &in, SEALVersion key_version) {
+                            key.pk_.load_members_internal(context, in, key_version, !compact);
+                            key_versions.push_back(key_version);
+                        },
+                        stream, false);
                     new_keys[index].emplace_back(move(key));
                 }
+
+                // A key is compact if all of its components were saved with a seed; otherwise the seeds are expanded
+                bool all_seeded = all_of(new_keys[index].cbegin(), new_keys[index].cend(), [](const PublicKey &key) {
+                    return key.pk_.has_seed_marker();
+                });
+                size_t prng_info_byte_count =
+                    static_cast<size_t>(UniformRandomGeneratorInfo::SaveSize(compr_mode_type::none));
+                for (size_t j = 0; j < new_keys[index].size(); j++)
+                {
+                    auto &key = new_keys[index][j];
+                    if (!key.pk_.has_seed_marker())
+                    {
+                        continue;
+                    }
+                    UniformRandomGeneratorInfo prng_info;
+                    prng_info.load(reinterpret_cast<const seal_byte *>(key.pk_.data(1) + 1), prng_info_byte_count);
+                    if (all_seeded)
+                    {
+                        CompactKeyComponent component{ DynArray<uint64_t>(pool_), key.pk_.poly_modulus_degree(),
+                                                       key.pk_.coeff_modulus_size(), prng_info, key_versions[j] };
+                        size_t poly_uint64_count =
+                            mul_safe(component.poly_modulus_degree, component.coeff_modulus_size);
+                        component.data.resize(poly_uint64_count, false);
+                        copy_n(key.pk_.data(0), poly_uint64_count, component.data.begin());
+                        new_compact_keys[index].push_back(move(component));
+                    }
+                    else
+                    {
+                        key.pk_.expand_seed(context, prng_info, key_versions[j]);
+                    }
+                }
+                if (all_seeded)
+                {
+                    new_keys[index].clear();
+                }
             }
         }
         catch (const ios_base::failure &)
@@ -141,5 +314,13 @@ namespace seal
         stream.exceptions(old_except_mask);
 
         swap(keys_, new_keys);
+        if (none_of(new_compact_keys.cbegin(), new_compact_keys.cend(), [](auto &key) { return !key.empty(); }))
+        {
+            new_compact_keys.clear();
+        }
+        swap(compact_keys_, new_compact_keys);
+
+        // Drop the expanded keys of the previous data
+        expansion_cache_ = ExpansionCache(expansion_cache_);
     }
 } // namespace seal
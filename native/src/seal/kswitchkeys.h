@@ -3,12 +3,18 @@
 
 #pragma once
 
+#include "seal/dynarray.h"
 #include "seal/encryptionparams.h"
 #include "seal/memorymanager.h"
 #include "seal/publickey.h"
+#include "seal/randomgen.h"
 #include "seal/valcheck.h"
 #include "seal/version.h"
 #include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace seal
@@ -25,10 +31,20 @@ namespace seal
     (vector) of keys. In RelinKeys, each key is an encryption of a power of the
     secret key. In GaloisKeys, each key corresponds to a type of rotation.
 
+    @par Compact Keys
+    The second polynomial of each component of a keyswitching key is sampled
+    uniformly at random from a seed, which is why keys created with a saved seed
+    serialize to about half their size. When such keys are loaded with the compact
+    flag set, only the first polynomials and the seeds are kept in memory, and a
+    key is expanded by expanded_data when it is used. The most recently used
+    expanded keys are cached up to expansion_cache_byte_count bytes, which trades
+    memory for the time of sampling the second polynomials again.
+
     @par Thread Safety
     In general, reading from KSwitchKeys is thread-safe as long as no
     other thread is concurrently mutating it. This is due to the underlying
-    data structure storing the keyswitching keys not being thread-safe.
+    data structure storing the keyswitching keys not being thread-safe. Expanding
+    compact keys with expanded_data is thread-safe.
 
     @see RelinKeys for the class that stores the relinearization keys.
     @see GaloisKeys for the class that stores the Galois keys.
@@ -39,6 +55,10 @@ namespace seal
         friend class RelinKeys;
         friend class GaloisKeys;
 
+        friend bool is_metadata_valid_for(const KSwitchKeys &in, const SEALContext &context);
+
+        friend bool is_data_valid_for(const KSwitchKeys &in, const SEALContext &context);
+
     public:
         /**
         Creates an empty KSwitchKeys.
@@ -79,11 +99,57 @@ namespace seal
         */
         SEAL_NODISCARD inline std::size_t size() const noexcept
         {
-            return std::accumulate(keys_.cbegin(), keys_.cend(), std::size_t(0), [](std::size_t res, auto &next_key) {
-                return res + (next_key.empty() ? 0 : 1);
-            });
+            std::size_t count = std::accumulate(
+                keys_.cbegin(), keys_.cend(), std::size_t(0),
+                [](std::size_t res, auto &next_key) { return res + (next_key.empty() ? 0 : 1); });
+            return std::accumulate(
+                compact_keys_.cbegin(), compact_keys_.cend(), count,
+                [](std::size_t res, auto &next_key) { return res + (next_key.empty() ? 0 : 1); });
+        }
+
+        /**
+        Returns whether the keyswitching key at a given index is stored in compact
+        form. Such a key is empty in data() and is accessed with expanded_data.
+
+        @param[in] index The index of the keyswitching key
+        */
+        SEAL_NODISCARD inline bool is_compact(std::size_t index) const noexcept
+        {
+            return index < compact_keys_.size() && !compact_keys_[index].empty();
+        }
+
+        /**
+        Returns the keyswitching key at a given index with all components expanded.
+        A key stored in compact form is expanded, or taken from the cache of expanded
+        keys; the returned pointer keeps it alive even if it is evicted from the cache.
+        A key that is not compact is returned without copying.
+
+        @param[in] context The SEALContext
+        @param[in] index The index of the keyswitching key
+        @throws std::invalid_argument if the key at the given index does not exist
+        @throws std::invalid_argument if the KSwitchKeys is not valid for the context
+        @throws std::logic_error if the compact key data is invalid
+        */
+        SEAL_NODISCARD std::shared_ptr<const std::vector<PublicKey>> expanded_data(
+            const SEALContext &context, std::size_t index) const;
+
+        /**
+        Returns the maximum number of bytes of expanded compact keys that are cached.
+        */
+        SEAL_NODISCARD inline std::size_t expansion_cache_byte_count() const noexcept
+        {
+            return expansion_cache_.byte_count;
         }
 
+        /**
+        Sets the maximum number of bytes of expanded compact keys that are cached.
+        When the cache is full, the least recently used keys are evicted. The default
+        of zero expands a compact key anew every time it is used.
+
+        @param[in] byte_count The maximum number of bytes
+        */
+        void set_expansion_cache_byte_count(std::size_t byte_count);
+
         /**
         Returns a reference to the KSwitchKeys data.
         */
@@ -170,6 +236,15 @@ namespace seal
                         total_key_size, util::safe_cast<std::size_t>(key_dim2.save_size(compr_mode_type::none)));
                 }
             }
+            for (auto &key_dim1 : compact_keys_)
+            {
+                for (auto &key_dim2 : key_dim1)
+                {
+                    total_key_size = util::add_safe(
+                        total_key_size,
+                        util::safe_cast<std::size_t>(seeded_component(key_dim2).save_size(compr_mode_type::none)));
+                }
+            }
 
             std::size_t members_size = Serialization::ComprSizeEstimate(
                 util::add_safe(
@@ -210,15 +285,17 @@ namespace seal
 
         @param[in] context The SEALContext
         @param[in] stream The stream to load the KSwitchKeys from
+        @param[in] compact Whether to keep the keys that were saved with a seed in compact form
         @throws std::invalid_argument if the encryption parameters are not valid
         @throws std::logic_error if the data cannot be loaded by this version of
         Microsoft SEAL, if the loaded data is invalid, or if decompression failed
         @throws std::runtime_error if I/O operations failed
         */
-        inline std::streamoff unsafe_load(const SEALContext &context, std::istream &stream)
+        inline std::streamoff unsafe_load(const SEALContext &context, std::istream &stream, bool compact = false)
         {
             using namespace std::placeholders;
-            return Serialization::Load(std::bind(&KSwitchKeys::load_members, this, context, _1, _2), stream, false);
+            return Serialization::Load(
+                std::bind(&KSwitchKeys::load_members, this, context, _1, _2, compact), stream, false);
         }
 
         /**
@@ -227,16 +304,18 @@ namespace seal
 
         @param[in] context The SEALContext
         @param[in] stream The stream to load the KSwitchKeys from
+        @param[in] compact Whether to keep the keys that were saved with a seed in compact form
         @throws std::invalid_argument if the encryption parameters are not valid
         @throws std::logic_error if the data cannot be loaded by this version of
         Microsoft SEAL, if the loaded data is invalid, or if decompression failed
         @throws std::runtime_error if I/O operations failed
         */
-        inline std::streamoff load(const SEALContext &context, std::istream &stream)
+        inline std::streamoff load(const SEALContext &context, std::istream &stream, bool compact = false)
         {
             KSwitchKeys new_keys;
             new_keys.pool_ = pool_;
-            auto in_size = new_keys.unsafe_load(context, stream);
+            new_keys.expansion_cache_.byte_count = expansion_cache_.byte_count;
+            auto in_size = new_keys.unsafe_load(context, stream, compact);
             if (!is_valid_for(new_keys, context))
             {
                 throw std::logic_error("KSwitchKeys data is invalid");
@@ -276,6 +355,7 @@ namespace seal
         @param[in] context The SEALContext
         @param[in] in The memory location to load the KSwitchKeys from
         @param[in] size The number of bytes available in the given memory location
+        @param[in] compact Whether to keep the keys that were saved with a seed in compact form
         @throws std::invalid_argument if the encryption parameters are not valid
         @throws std::invalid_argument if in is null or if size is too small to
         contain a SEALHeader
@@ -283,10 +363,12 @@ namespace seal
         Microsoft SEAL, if the loaded data is invalid, or if decompression failed
         @throws std::runtime_error if I/O operations failed
         */
-        inline std::streamoff unsafe_load(const SEALContext &context, const seal_byte *in, std::size_t size)
+        inline std::streamoff unsafe_load(
+            const SEALContext &context, const seal_byte *in, std::size_t size, bool compact = false)
         {
             using namespace std::placeholders;
-            return Serialization::Load(std::bind(&KSwitchKeys::load_members, this, context, _1, _2), in, size, false);
+            return Serialization::Load(
+                std::bind(&KSwitchKeys::load_members, this, context, _1, _2, compact), in, size, false);
         }
 
         /**
@@ -297,6 +379,7 @@ namespace seal
         @param[in] context The SEALContext
         @param[in] in The memory location to load the KSwitchKeys from
         @param[in] size The number of bytes available in the given memory location
+        @param[in] compact Whether to keep the keys that were saved with a seed in compact form
         @throws std::invalid_argument if the encryption parameters are not valid
         @throws std::invalid_argument if in is null or if size is too small to
         contain a SEALHeader
@@ -304,11 +387,13 @@ namespace seal
         Microsoft SEAL, if the loaded data is invalid, or if decompression failed
         @throws std::runtime_error if I/O operations failed
         */
-        inline std::streamoff load(const SEALContext &context, const seal_byte *in, std::size_t size)
+        inline std::streamoff load(
+            const SEALContext &context, const seal_byte *in, std::size_t size, bool compact = false)
         {
             KSwitchKeys new_keys;
             new_keys.pool_ = pool_;
-            auto in_size = new_keys.unsafe_load(context, in, size);
+            new_keys.expansion_cache_.byte_count = expansion_cache_.byte_count;
+            auto in_size = new_keys.unsafe_load(context, in, size, compact);
             if (!is_valid_for(new_keys, context))
             {
                 throw std::logic_error("KSwitchKeys data is invalid");
@@ -326,9 +411,62 @@ namespace seal
         }
 
     private:
+        // A component of a compact key: the first polynomial, and the PRNG that samples the second
+        struct CompactKeyComponent
+        {
+            DynArray<std::uint64_t> data;
+
+            std::size_t poly_modulus_degree = 0;
+
+            std::size_t coeff_modulus_size = 0;
+
+            UniformRandomGeneratorInfo prng_info;
+
+            // The version of the serialization that the seed was loaded from, which determines the sampling
+            SEALVersion version;
+        };
+
+        // Least recently used expanded compact keys; copies start empty
+        struct ExpansionCache
+        {
+            ExpansionCache() = default;
+
+            ExpansionCache(const ExpansionCache &copy) : byte_count(copy.byte_count)
+            {}
+
+            ExpansionCache &operator=(const ExpansionCache &assign)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                byte_count = assign.byte_count;
+                used_byte_count = 0;
+                order.clear();
+                entries.clear();
+                return *this;
+            }
+
+            std::size_t byte_count = 0;
+
+            std::size_t used_byte_count = 0;
+
+            using Entry = std::pair<std::shared_ptr<const std::vector<PublicKey>>, std::list<std::size_t>::iterator>;
+
+            // Key indices from the most to the least recently used
+            std::list<std::size_t> order{};
+
+            std::map<std::size_t, Entry> entries{};
+
+            std::mutex mutex{};
+
+            // Evicts the least recently used keys until the cache fits in byte_count; requires the mutex to be locked
+            void evict();
+        };
+
+        // Returns the component as a ciphertext that holds the seed in its second polynomial
+        Ciphertext seeded_component(const CompactKeyComponent &component) const;
+
         void save_members(std::ostream &stream) const;
 
-        void load_members(const SEALContext &context, std::istream &stream, SEALVersion version);
+        void load_members(const SEALContext &context, std::istream &stream, SEALVersion version, bool compact);
 
         MemoryPoolHandle pool_ = MemoryManager::GetPool();
 
@@ -338,5 +476,12 @@ namespace seal
         The vector of keyswitching keys.
         */
         std::vector<std::vector<PublicKey>> keys_{};
+
+        /**
+        The keyswitching keys in compact form, at the same indices as the empty entries of keys_.
+        */
+        std::vector<std::vector<CompactKeyComponent>> compact_keys_{};
+
+        mutable ExpansionCache expansion_cache_{};
     };
 } // namespace seal
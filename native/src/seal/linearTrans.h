@@ -4,6 +4,7 @@
 #pragma once
 
 #include "seal/seal.h"
+#include <algorithm>
 #include <map>
 #include <stdexcept>
 #include <vector>
@@ -44,6 +45,26 @@ namespace seal
         return tiled_matrix;
     }
 
+    // nonzeroDiagonals()
+    // indices of the first count tiled diagonals that are not all zero; the first diagonal is kept for a zero matrix
+    inline std::vector<int> nonzeroDiagonals(const std::vector<std::vector<double>> &tiled_matrix, int count)
+    {
+        std::vector<int> indices;
+        for (int i = 0; i < count && i < static_cast<int>(tiled_matrix.size()); ++i)
+        {
+            const std::vector<double> &diagonal = tiled_matrix[i];
+            if (std::any_of(diagonal.cbegin(), diagonal.cend(), [](double value) { return value != 0.0; }))
+            {
+                indices.push_back(i);
+            }
+        }
+        if (indices.empty())
+        {
+            indices.push_back(0);
+        }
+        return indices;
+    }
+
     // repeat-padding vectors
     // spread values
     inline std::vector<double> repeatpaddingVector(std::vector<double> raw_vector, int slot_count,
@@ -69,7 +90,7 @@ namespace seal
 
     // ntEncoding type A
     // do padding
-    void ntEncoding(seal::CKKSEncoder &ckks_encoder, const double &scale,
+    inline void ntEncoding(seal::CKKSEncoder &ckks_encoder, const double &scale,
             std::vector<double> &raw_vector, seal::Plaintext &destination,
             bool ifPadding = true)
     {
@@ -80,7 +101,7 @@ namespace seal
 
     // ntEncoding type B
     // do repeat padding
-    void ntEncoding(seal::CKKSEncoder& ckks_encoder, const double& scale,
+    inline void ntEncoding(seal::CKKSEncoder& ckks_encoder, const double& scale,
             std::vector<double>& raw_vector, seal::Plaintext& destination,
             int height, int width)
     {
@@ -89,132 +110,156 @@ namespace seal
     }
 
     // main LT function
-    seal::Ciphertext lt(
-            int method;
-            seal::Ciphertext v, std::vector<std::vector<double>> &M, int height, int width,
-            seal::CKKSEncoder &ckks_encoder, const double &scale,
-            seal::Encryptor &encryptor, seal::Evaluator &evaluator,
-            seal::GaloisKeys &galois_keys, seal::RelinKeys &relin__keys)
+    inline seal::Ciphertext lt(
+            int method,
+            const seal::Ciphertext &v, const std::vector<std::vector<double>> &M, int height, int width,
+            seal::CKKSEncoder &ckks_encoder, const double &scale, seal::Evaluator &evaluator,
+            const seal::GaloisKeys &galois_keys)
     {
-        seal::Ciphertext encryptedu = v;
+        // Plaintext products do not grow the ciphertext, so the terms are summed at the scale of the product without
+        // relinearization and rescaled once
 
+        // Only the diagonals that are not zero are rotated to, encoded, and multiplied. The input and the diagonals
+        // are padded to the larger of the height and the width, as repeatpaddingVector and paddingVector do.
+        int stride = static_cast<int>(ckks_encoder.slot_count()) / std::max(height, width);
         int idx = 0;
         if (method == 1 || method == 2) // decomposing matrix & hybrid
         {
-            int stride = ckks_encoder.slot_count() / v.size();
-            std::vector<seal::Ciphertext> rotedu(height);
-            for (idx = 0; idx < height; ++idx)
-			{
-				evaluator.rotate_vector(encryptedu, idx * stride, galois_keys, rotedu[idx]);
-			}
             std::vector<std::vector<double>> tiledM = tillingMatrix(M, height, width);
+            std::vector<int> nonzero = nonzeroDiagonals(tiledM, height);
+            std::vector<int> steps;
+            for (int i : nonzero)
+            {
+                steps.push_back(i * stride);
+            }
+            std::vector<seal::Ciphertext> rotedu;
+            evaluator.rotate_vector_many(v, steps, galois_keys, rotedu);
             std::vector<seal::Plaintext> encodedM;
-			for (auto v : tiledM)
-			{
-				seal::Plaintext temp;
-				ntEncoding(ckks_encoder, scale, v, temp);
-				encodedM.push_back(temp);
-			}
+            for (int i : nonzero)
+            {
+                seal::Plaintext temp;
+                ntEncoding(ckks_encoder, scale, tiledM[i], temp);
+                encodedM.push_back(temp);
+            }
             seal::Ciphertext enc_result;
-			evaluator.multiply_plain(rotedu[0], encodedM[0], enc_result);
-			evaluator.relinearize_inplace(enc_result, relin_keys);
-			evaluator.rescale_to_next_inplace(enc_result);
-			for (idx = 1; idx < height; ++idx)
-			{
-				seal::Ciphertext temp;
-				evaluator.multiply_plain(rotedu[idx], encodedM[idx], temp);
-				evaluator.relinearize_inplace(temp, relin_keys);
-				evaluator.rescale_to_next_inplace(temp);
-				evaluator.add_inplace(enc_result, temp);
-			}         
+            evaluator.multiply_plain(rotedu[0], encodedM[0], enc_result);
+            for (idx = 1; idx < static_cast<int>(nonzero.size()); ++idx)
+            {
+                evaluator.multiply_plain_inplace(rotedu[idx], encodedM[idx]);
+                evaluator.add_inplace(enc_result, rotedu[idx]);
+            }
+            evaluator.rescale_to_next_inplace(enc_result);
             if (method == 2) // additional R&S
-			{
-				int num = ckks_encoder.slot_count();
-				while (num != height * stride)
-				{
-					Ciphertext temp;
-					evaluator.rotate_vector(enc_result, num / 2, galois_keys, temp);
-					evaluator.add_inplace(enc_result, temp);
-					num /= 2;
-				}
-			}
+            {
+                int num = ckks_encoder.slot_count();
+                while (num != height * stride)
+                {
+                    Ciphertext temp;
+                    evaluator.rotate_vector(enc_result, num / 2, galois_keys, temp);
+                    evaluator.add_inplace(enc_result, temp);
+                    num /= 2;
+                }
+            }
             return enc_result;
         }
         else if (method == 3) // bsgs
         {
             // BSGS parameters
-			int max_len = std::max(height, width);
-			int min_len = std::min(height, width);
-			double n_ddot = (double)min_len;
-			int g_tilde = (int)ceil(sqrt(n_ddot));
-			int b_tilde = (int)ceil(n_ddot / g_tilde);
-			// preprocessing matrix
-			std::vector<seal::Plaintext> encodedM(min_len);
-			std::vector<std::vector<double>> tiledM = tilingMatrix(M, height, width);
-			for (int b = 0; b < b_tilde; ++b)
-			{
-				for (int g = 0; g < g_tilde && b * g_tilde + g < min_len; ++g)
-				{
-					std::vector<double>& temp = tiledM[b * g_tilde + g];
-					std::rotate(temp.rbegin(), temp.rbegin() + b * g_tilde, temp.rend());
-					Plaintext coded_temp;
-					ntEncoding(ckks_encoder, scale, temp, coded_temp);
-					encodedM[b * g_tilde + g] = coded_temp;
-				}
-			}
-			encodedM.shrink_to_fit();
-			// rotate ciphertext
-			vector<seal::Ciphertext> rotedu(g_tilde);
-			rotedu[0] = encryptedu;
-			for (idx = 1; idx < g_tilde; ++idx)
-			{
-				evaluator.rotate_vector(encryptedu, idx * stride, galois_keys, rotedu[idx]);
-			}
-			// evaluate
-			Ciphertext res;
-			int g, b;
-			// b=0, g=0
-			evaluator.multiply_plain(rotedu[0], encodedM[0], res);
-			evaluator.relinearize_inplace(res, relin_keys);
-			evaluator.rescale_to_next_inplace(res);
-			// b=0, g>=1
-			for (g = 1; g < g_tilde; ++g)
-			{
-				Ciphertext temp = rotedu[g];
-				evaluator.multiply_plain_inplace(temp, encodedM[g]);
-				evaluator.relinearize_inplace(temp, relin_keys);
-				evaluator.rescale_to_next_inplace(temp);
-				evaluator.add_inplace(res, temp);
-			}
-			//b>=1
-			for (b = 1; b < b_tilde; ++b)
-			{
-				Ciphertext temp_res;
-				for (size_t g = 0; g != g_tilde && b * g_tilde + g != min_len; ++g)
-				{
-					Ciphertext temp = rotedu[g];
-					evaluator.multiply_plain_inplace(temp, encodedM[b * g_tilde + g]);
-					evaluator.relinearize_inplace(temp, relin_keys);
-					evaluator.rescale_to_next_inplace(temp);
-					if (g == 0) temp_res = temp;
-					else evaluator.add_inplace(temp_res, temp);
-				}
-				evaluator.rotate_vector_inplace(temp_res, b * g_tilde * stride, galois_keys);
-				evaluator.add_inplace(res, temp_res);
-			}
-			if (height < width) // additional R&S
-			{
-				int num = width / height;
-				while (num != 1)
-				{
-					Ciphertext temp = res;
-					evaluator.rotate_vector_inplace(res, height * num * stride / 2, galois_keys);
-					evaluator.add_inplace(res, temp);
-					num /= 2;
-				}
-			}
+            int min_len = std::min(height, width);
+            double n_ddot = (double)min_len;
+            int g_tilde = (int)ceil(sqrt(n_ddot));
+            int b_tilde = (int)ceil(n_ddot / g_tilde);
+            // preprocessing matrix
+            std::vector<seal::Plaintext> encodedM(min_len);
+            std::vector<std::vector<double>> tiledM = tillingMatrix(M, height, width);
+            std::vector<int> nonzero = nonzeroDiagonals(tiledM, min_len);
+            std::vector<bool> is_nonzero(min_len, false);
+            for (int i : nonzero)
+            {
+                is_nonzero[i] = true;
+                std::vector<double> &temp = tiledM[i];
+                std::rotate(temp.rbegin(), temp.rbegin() + i / g_tilde * g_tilde, temp.rend());
+                ntEncoding(ckks_encoder, scale, temp, encodedM[i]);
+            }
+            // rotate ciphertext by the baby steps of the nonzero diagonals
+            std::vector<int> position(g_tilde, -1);
+            std::vector<int> steps;
+            for (int i : nonzero)
+            {
+                if (position[i % g_tilde] < 0)
+                {
+                    position[i % g_tilde] = static_cast<int>(steps.size());
+                    steps.push_back(i % g_tilde * stride);
+                }
+            }
+            std::vector<seal::Ciphertext> rotedu;
+            evaluator.rotate_vector_many(v, steps, galois_keys, rotedu);
+            // evaluate, skipping giant steps whose diagonals are all zero
+            Ciphertext res;
+            Ciphertext temp;
+            bool has_res = false;
+            for (int b = 0; b < b_tilde; ++b)
+            {
+                Ciphertext temp_res;
+                bool has_temp_res = false;
+                for (int g = 0; g < g_tilde && b * g_tilde + g < min_len; ++g)
+                {
+                    if (!is_nonzero[b * g_tilde + g])
+                    {
+                        continue;
+                    }
+                    evaluator.multiply_plain(
+                        rotedu[position[g]], encodedM[b * g_tilde + g], has_temp_res ? temp : temp_res);
+                    if (has_temp_res)
+                    {
+                        evaluator.add_inplace(temp_res, temp);
+                    }
+                    has_temp_res = true;
+                }
+                if (!has_temp_res)
+                {
+                    continue;
+                }
+                if (b)
+                {
+                    evaluator.rotate_vector_inplace(temp_res, b * g_tilde * stride, galois_keys);
+                }
+                if (has_res)
+                {
+                    evaluator.add_inplace(res, temp_res);
+                }
+                else
+                {
+                    res = temp_res;
+                    has_res = true;
+                }
+            }
+            evaluator.rescale_to_next_inplace(res);
+            if (height < width) // additional R&S
+            {
+                int num = width / height;
+                while (num != 1)
+                {
+                    Ciphertext temp = res;
+                    evaluator.rotate_vector_inplace(res, height * num * stride / 2, galois_keys);
+                    evaluator.add_inplace(res, temp);
+                    num /= 2;
+                }
+            }
             return res;
         }
+        throw std::invalid_argument("method must be 1, 2, or 3");
+    }
+
+    // main LT function with the former parameters; encryptor and relin_keys are not used
+    [[deprecated("encryptor and relin_keys are not used; call lt without them")]] inline seal::Ciphertext lt(
+            int method,
+            const seal::Ciphertext &v, const std::vector<std::vector<double>> &M, int height, int width,
+            seal::CKKSEncoder &ckks_encoder, const double &scale,
+            SEAL_MAYBE_UNUSED seal::Encryptor &encryptor, seal::Evaluator &evaluator,
+            const seal::GaloisKeys &galois_keys, SEAL_MAYBE_UNUSED seal::RelinKeys &relin_keys)
+    {
+        return lt(method, v, M, height, width, ckks_encoder, scale, evaluator, galois_keys);
     }
 
 } // namespace seal
@@ -0,0 +1,536 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/lineartransformplan.h"
+#include "seal/valcheck.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+using namespace seal::util;
+
+namespace seal
+{
+    LinearTransformPlan::LinearTransformPlan(MemoryPoolHandle pool) : pool_(move(pool))
+    {
+        if (!pool_)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+    }
+
+    namespace
+    {
+        // Returns the smallest power of two at least size, which must be nonzero and fit in the slots
+        size_t padded_dimension(size_t size, size_t slot_count)
+        {
+            size_t dimension = 1;
+            while (dimension < size)
+            {
+                dimension <<= 1;
+            }
+            if (!size || dimension > slot_count)
+            {
+                throw invalid_argument("matrix is too large for the encryption parameters");
+            }
+            return dimension;
+        }
+
+        // Returns the entries of the diagonal with the given index, creating it with zeros if needed
+        vector<double> &diagonal_at(map<size_t, vector<double>> &diagonals, size_t index, size_t dimension)
+        {
+            auto &diagonal = diagonals[index];
+            diagonal.resize(dimension, 0.0);
+            return diagonal;
+        }
+    } // namespace
+
+    LinearTransformPlan::LinearTransformPlan(
+        CKKSEncoder &encoder, const vector<vector<double>> &matrix, parms_id_type parms_id, double scale,
+        MemoryPoolHandle pool)
+        : LinearTransformPlan(move(pool))
+    {
+        height_ = matrix.size();
+        width_ = height_ ? matrix[0].size() : 0;
+        if (!width_ || any_of(matrix.cbegin(), matrix.cend(), [&](auto &row) { return row.size() != width_; }))
+        {
+            throw invalid_argument("matrix must have rows of the same nonzero size");
+        }
+        dimension_ = padded_dimension(max(height_, width_), encoder.slot_count());
+
+        // Only the diagonals with nonzero entries are materialized
+        map<size_t, vector<double>> diagonals;
+        for (size_t r = 0; r < height_; r++)
+        {
+            for (size_t c = 0; c < width_; c++)
+            {
+                if (matrix[r][c] != 0.0)
+                {
+                    diagonal_at(diagonals, (c + dimension_ - r) % dimension_, dimension_)[r] = matrix[r][c];
+                }
+            }
+        }
+        create(encoder, diagonals, parms_id, scale);
+    }
+
+    LinearTransformPlan LinearTransformPlan::Diagonals(
+        CKKSEncoder &encoder, size_t dimension, const map<int, vector<double>> &diagonals, parms_id_type parms_id,
+        double scale, MemoryPoolHandle pool)
+    {
+        if (!dimension || (dimension & (dimension - 1)) || dimension > encoder.slot_count())
+        {
+            throw invalid_argument("dimension must be a power of two at most the number of slots");
+        }
+        LinearTransformPlan plan(move(pool));
+        plan.height_ = dimension;
+        plan.width_ = dimension;
+        plan.dimension_ = dimension;
+        map<size_t, vector<double>> indexed_diagonals;
+        for (auto &diagonal : diagonals)
+        {
+            long long index = diagonal.first;
+            if (index <= -static_cast<long long>(dimension) || index >= static_cast<long long>(dimension))
+            {
+                throw invalid_argument("diagonal index is out of range");
+            }
+            if (diagonal.second.size() != dimension)
+            {
+                throw invalid_argument("diagonal has wrong size");
+            }
+            size_t residue = static_cast<size_t>(index < 0 ? index + static_cast<long long>(dimension) : index);
+            if (!indexed_diagonals.emplace(residue, diagonal.second).second)
+            {
+                throw invalid_argument("diagonal is given twice");
+            }
+        }
+        plan.create(encoder, indexed_diagonals, parms_id, scale);
+        return plan;
+    }
+
+    LinearTransformPlan LinearTransformPlan::Toeplitz(
+        CKKSEncoder &encoder, size_t dimension, const vector<double> &values, parms_id_type parms_id, double scale,
+        MemoryPoolHandle pool)
+    {
+        LinearTransformPlan plan(move(pool));
+        plan.height_ = dimension;
+        plan.width_ = dimension;
+        plan.dimension_ = padded_dimension(dimension, encoder.slot_count());
+        if (values.size() != 2 * dimension - 1)
+        {
+            throw invalid_argument("values has wrong size");
+        }
+
+        // The diagonal i holds values[dimension - 1 + i] above the main diagonal and, after wrapping around the
+        // padded dimension, values[dimension - 1 + i - padded dimension] below it
+        size_t padded = plan.dimension_;
+        map<size_t, vector<double>> diagonals;
+        for (size_t i = 0; i < padded; i++)
+        {
+            for (size_t r = 0; r < dimension; r++)
+            {
+                size_t c = (r + i) % padded;
+                double value = c < dimension ? values[dimension - 1 + c - r] : 0.0;
+                if (value != 0.0)
+                {
+                    diagonal_at(diagonals, i, padded)[r] = value;
+                }
+            }
+        }
+        plan.create(encoder, diagonals, parms_id, scale);
+        return plan;
+    }
+
+    LinearTransformPlan LinearTransformPlan::Circulant(
+        CKKSEncoder &encoder, const vector<double> &first_row, parms_id_type parms_id, double scale,
+        MemoryPoolHandle pool)
+    {
+        size_t dimension = first_row.size();
+        if (!dimension || (dimension & (dimension - 1)) || dimension > encoder.slot_count())
+        {
+            throw invalid_argument("first_row must have a power of two size at most the number of slots");
+        }
+        LinearTransformPlan plan(move(pool));
+        plan.height_ = dimension;
+        plan.width_ = dimension;
+        plan.dimension_ = dimension;
+
+        // Every diagonal is constant
+        map<size_t, vector<double>> diagonals;
+        for (size_t i = 0; i < dimension; i++)
+        {
+            if (first_row[i] != 0.0)
+            {
+                diagonals[i].assign(dimension, first_row[i]);
+            }
+        }
+        plan.create(encoder, diagonals, parms_id, scale);
+        return plan;
+    }
+
+    LinearTransformPlan LinearTransformPlan::BlockDiagonal(
+        CKKSEncoder &encoder, const vector<vector<vector<double>>> &blocks, parms_id_type parms_id, double scale,
+        MemoryPoolHandle pool)
+    {
+        size_t size = 0;
+        for (auto &block : blocks)
+        {
+            if (block.empty() ||
+                any_of(block.cbegin(), block.cend(), [&](auto &row) { return row.size() != block.size(); }))
+            {
+                throw invalid_argument("blocks must be square and not empty");
+            }
+            size = add_safe(size, block.size());
+        }
+        LinearTransformPlan plan(move(pool));
+        plan.height_ = size;
+        plan.width_ = size;
+        plan.dimension_ = padded_dimension(size, encoder.slot_count());
+
+        size_t padded = plan.dimension_;
+        map<size_t, vector<double>> diagonals;
+        size_t block_start = 0;
+        for (auto &block : blocks)
+        {
+            for (size_t r = 0; r < block.size(); r++)
+            {
+                for (size_t c = 0; c < block.size(); c++)
+                {
+                    if (block[r][c] != 0.0)
+                    {
+                        diagonal_at(diagonals, (c + padded - r) % padded, padded)[block_start + r] = block[r][c];
+                    }
+                }
+            }
+            block_start += block.size();
+        }
+        plan.create(encoder, diagonals, parms_id, scale);
+        return plan;
+    }
+
+    void LinearTransformPlan::create(
+        CKKSEncoder &encoder, map<size_t, vector<double>> &diagonals, parms_id_type parms_id, double scale,
+        size_t baby_step_count)
+    {
+        // Diagonals with only zeros are dropped, but the main diagonal is kept for a zero matrix
+        for (auto it = diagonals.begin(); it != diagonals.end();)
+        {
+            bool is_zero = all_of(it->second.cbegin(), it->second.cend(), [](double value) { return value == 0.0; });
+            it = is_zero ? diagonals.erase(it) : next(it);
+        }
+        if (diagonals.empty())
+        {
+            diagonals[0].assign(dimension_, 0.0);
+        }
+        indices_.clear();
+        for (auto &diagonal : diagonals)
+        {
+            indices_.push_back(diagonal.first);
+        }
+
+        if (baby_step_count)
+        {
+            offset_ = 0;
+            baby_step_count_ = baby_step_count;
+        }
+        else
+        {
+            // The offset is either zero or the first index after the largest cyclic gap between the indices, so that a
+            // band around the main diagonal becomes contiguous; the number of baby steps ranges over the span of the
+            // indices from the offset
+            vector<size_t> offsets{ 0 };
+            size_t largest_gap = 0;
+            for (size_t t = 0; t < indices_.size(); t++)
+            {
+                size_t next_index = t + 1 < indices_.size() ? indices_[t + 1] : indices_[0] + dimension_;
+                if (next_index - indices_[t] > largest_gap)
+                {
+                    largest_gap = next_index - indices_[t];
+                    offsets.resize(1);
+                    offsets.push_back(next_index % dimension_);
+                }
+            }
+
+            key_switch_count_ = numeric_limits<size_t>::max();
+            vector<bool> used_baby(dimension_);
+            vector<bool> used_giant(dimension_);
+            for (auto offset : offsets)
+            {
+                size_t span = 0;
+                for (auto index : indices_)
+                {
+                    span = max(span, (index + dimension_ - offset) % dimension_ + 1);
+                }
+                for (size_t step_count = 1; step_count <= span; step_count++)
+                {
+                    fill(used_baby.begin(), used_baby.end(), false);
+                    fill(used_giant.begin(), used_giant.end(), false);
+                    size_t key_switch_count = 0;
+                    for (auto index : indices_)
+                    {
+                        size_t relative = (index + dimension_ - offset) % dimension_;
+                        size_t k = relative % step_count;
+                        size_t j = relative / step_count;
+                        if (k && !used_baby[k])
+                        {
+                            used_baby[k] = true;
+                            key_switch_count++;
+                        }
+                        if ((offset + j * step_count) % dimension_ && !used_giant[j])
+                        {
+                            used_giant[j] = true;
+                            key_switch_count++;
+                        }
+                    }
+                    if (key_switch_count < key_switch_count_)
+                    {
+                        key_switch_count_ = key_switch_count;
+                        offset_ = offset;
+                        baby_step_count_ = step_count;
+                    }
+                }
+            }
+        }
+
+        // Encode the diagonals rotated right by their giant steps
+        auto giant_steps = set_order(encoder.slot_count());
+        size_t slot_count = encoder.slot_count();
+        size_t stride = slot_count / dimension_;
+        diagonals_.clear();
+        diagonals_.reserve(indices_.size());
+        vector<double> values(slot_count);
+        for (size_t t = 0; t < indices_.size(); t++)
+        {
+            auto &diagonal = diagonals[indices_[t]];
+            fill(values.begin(), values.end(), 0.0);
+            for (size_t r = 0; r < dimension_; r++)
+            {
+                values[(r + giant_steps[t]) * stride % slot_count] = diagonal[r];
+            }
+            diagonals_.emplace_back(pool_);
+            encoder.encode(values, parms_id, scale, diagonals_.back(), pool_);
+        }
+        parms_id_ = parms_id;
+        scale_ = scale;
+    }
+
+    vector<size_t> LinearTransformPlan::set_order(size_t slot_count)
+    {
+        auto relative = [&](size_t index) { return (index + dimension_ - offset_) % dimension_; };
+        sort(indices_.begin(), indices_.end(), [&](size_t a, size_t b) { return relative(a) < relative(b); });
+
+        int stride = safe_cast<int>(slot_count / dimension_);
+        vector<size_t> giant_steps;
+        vector<int> baby_step_list;
+        vector<int> giant_step_list;
+        for (auto index : indices_)
+        {
+            size_t k = relative(index) % baby_step_count_;
+            size_t giant_step = (offset_ + relative(index) - k) % dimension_;
+            giant_steps.push_back(giant_step);
+            int baby_step = mul_safe(safe_cast<int>(k), stride);
+            if (k && find(baby_step_list.cbegin(), baby_step_list.cend(), baby_step) == baby_step_list.cend())
+            {
+                baby_step_list.push_back(baby_step);
+            }
+
+            // The indices are ordered by giant step, so equal giant steps are adjacent
+            int giant_step_rotation = mul_safe(safe_cast<int>(giant_step), stride);
+            if (giant_step && (giant_step_list.empty() || giant_step_list.back() != giant_step_rotation))
+            {
+                giant_step_list.push_back(giant_step_rotation);
+            }
+        }
+        key_switch_count_ = baby_step_list.size() + giant_step_list.size();
+
+        // A giant step may need the same Galois key as a baby step
+        steps_ = baby_step_list;
+        steps_.insert(steps_.end(), giant_step_list.cbegin(), giant_step_list.cend());
+        sort(steps_.begin(), steps_.end());
+        steps_.erase(unique(steps_.begin(), steps_.end()), steps_.end());
+        return giant_steps;
+    }
+
+    size_t LinearTransformPlan::BabyStepCount(size_t diagonal_count)
+    {
+        size_t baby_step_count = static_cast<size_t>(sqrt(static_cast<double>(diagonal_count)));
+        while (baby_step_count * baby_step_count < diagonal_count)
+        {
+            baby_step_count++;
+        }
+        return baby_step_count;
+    }
+
+    vector<int> LinearTransformPlan::RotationSteps(size_t diagonal_count, int stride)
+    {
+        size_t baby_step_count = BabyStepCount(diagonal_count);
+        vector<int> steps;
+        for (size_t k = 1; k < baby_step_count; k++)
+        {
+            steps.push_back(mul_safe(safe_cast<int>(k), stride));
+        }
+        for (size_t j = baby_step_count; j < diagonal_count; j += baby_step_count)
+        {
+            steps.push_back(mul_safe(safe_cast<int>(j), stride));
+        }
+        return steps;
+    }
+
+    streamoff LinearTransformPlan::save_size(compr_mode_type compr_mode) const
+    {
+        size_t diagonals_size = 0;
+        for (auto &diagonal : diagonals_)
+        {
+            diagonals_size =
+                add_safe(diagonals_size, safe_cast<size_t>(diagonal.save_size(compr_mode_type::none)));
+        }
+        size_t members_size = Serialization::ComprSizeEstimate(
+            add_safe(
+                sizeof(uint64_t), // height_
+                sizeof(uint64_t), // width_
+                sizeof(uint64_t), // dimension_
+                sizeof(uint64_t), // offset_
+                sizeof(uint64_t), // baby_step_count_
+                sizeof(parms_id_type), sizeof(double),
+                sizeof(uint64_t), // indices_.size()
+                mul_safe(indices_.size(), sizeof(uint64_t)), diagonals_size),
+            compr_mode);
+
+        return safe_cast<streamoff>(add_safe(sizeof(Serialization::SEALHeader), members_size));
+    }
+
+    void LinearTransformPlan::save_members(ostream &stream) const
+    {
+        auto old_except_mask = stream.exceptions();
+        try
+        {
+            // Throw exceptions on ios_base::badbit and ios_base::failbit
+            stream.exceptions(ios_base::badbit | ios_base::failbit);
+
+            uint64_t header[5]{ static_cast<uint64_t>(height_), static_cast<uint64_t>(width_),
+                                static_cast<uint64_t>(dimension_), static_cast<uint64_t>(offset_),
+                                static_cast<uint64_t>(baby_step_count_) };
+            stream.write(reinterpret_cast<const char *>(header), sizeof(header));
+            stream.write(reinterpret_cast<const char *>(&parms_id_), sizeof(parms_id_type));
+            stream.write(reinterpret_cast<const char *>(&scale_), sizeof(double));
+            uint64_t diagonal_count64 = static_cast<uint64_t>(indices_.size());
+            stream.write(reinterpret_cast<const char *>(&diagonal_count64), sizeof(uint64_t));
+            for (auto index : indices_)
+            {
+                uint64_t index64 = static_cast<uint64_t>(index);
+                stream.write(reinterpret_cast<const char *>(&index64), sizeof(uint64_t));
+            }
+            for (auto &diagonal : diagonals_)
+            {
+                diagonal.save(stream, compr_mode_type::none);
+            }
+        }
+        catch (const ios_base::failure &)
+        {
+            stream.exceptions(old_except_mask);
+            throw runtime_error("I/O error");
+        }
+        catch (...)
+        {
+            stream.exceptions(old_except_mask);
+            throw;
+        }
+        stream.exceptions(old_except_mask);
+    }
+
+    void LinearTransformPlan::load_members(
+        const SEALContext &context, istream &stream, SEAL_MAYBE_UNUSED SEALVersion version)
+    {
+        // Verify parameters
+        if (!context.parameters_set())
+        {
+            throw invalid_argument("encryption parameters are not set correctly");
+        }
+
+        LinearTransformPlan new_plan(pool_);
+
+        auto old_except_mask = stream.exceptions();
+        try
+        {
+            // Throw exceptions on ios_base::badbit and ios_base::failbit
+            stream.exceptions(ios_base::badbit | ios_base::failbit);
+
+            uint64_t header[5]{};
+            stream.read(reinterpret_cast<char *>(header), sizeof(header));
+            stream.read(reinterpret_cast<char *>(&new_plan.parms_id_), sizeof(parms_id_type));
+            stream.read(reinterpret_cast<char *>(&new_plan.scale_), sizeof(double));
+            uint64_t diagonal_count64 = 0;
+            stream.read(reinterpret_cast<char *>(&diagonal_count64), sizeof(uint64_t));
+
+            // The dimension is the smallest power of two at least the height and the width, and at most the number
+            // of slots; this also bounds the memory allocated for the diagonals
+            auto context_data_ptr = context.get_context_data(new_plan.parms_id_);
+            if (!context_data_ptr || context_data_ptr->parms().scheme() != scheme_type::ckks)
+            {
+                throw logic_error("LinearTransformPlan data is invalid");
+            }
+            size_t slot_count = context_data_ptr->parms().poly_modulus_degree() >> 1;
+            uint64_t height64 = header[0];
+            uint64_t width64 = header[1];
+            uint64_t dimension64 = header[2];
+            if (!height64 || !width64 || dimension64 > slot_count || (dimension64 & (dimension64 - 1)) ||
+                max(height64, width64) > dimension64 || max(height64, width64) <= (dimension64 >> 1) ||
+                header[3] >= dimension64 || !header[4] || header[4] > dimension64 || !diagonal_count64 ||
+                diagonal_count64 > dimension64)
+            {
+                throw logic_error("LinearTransformPlan data is invalid");
+            }
+            new_plan.height_ = safe_cast<size_t>(height64);
+            new_plan.width_ = safe_cast<size_t>(width64);
+            new_plan.dimension_ = safe_cast<size_t>(dimension64);
+            new_plan.offset_ = safe_cast<size_t>(header[3]);
+            new_plan.baby_step_count_ = safe_cast<size_t>(header[4]);
+
+            // The indices are distinct and ordered by their distance from the offset
+            size_t diagonal_count = safe_cast<size_t>(diagonal_count64);
+            for (size_t t = 0; t < diagonal_count; t++)
+            {
+                uint64_t index64 = 0;
+                stream.read(reinterpret_cast<char *>(&index64), sizeof(uint64_t));
+                size_t relative = safe_cast<size_t>((index64 + dimension64 - header[3]) % dimension64);
+                if (index64 >= dimension64 ||
+                    (t && relative <= (new_plan.indices_.back() + new_plan.dimension_ - new_plan.offset_) %
+                                          new_plan.dimension_))
+                {
+                    throw logic_error("LinearTransformPlan data is invalid");
+                }
+                new_plan.indices_.push_back(safe_cast<size_t>(index64));
+            }
+
+            new_plan.diagonals_.reserve(diagonal_count);
+            for (size_t t = 0; t < diagonal_count; t++)
+            {
+                new_plan.diagonals_.emplace_back(pool_);
+                auto &diagonal = new_plan.diagonals_.back();
+                diagonal.unsafe_load(context, stream);
+                if (!is_valid_for(diagonal, context, true) || !diagonal.is_ntt_form() ||
+                    diagonal.parms_id() != new_plan.parms_id_ || diagonal.scale() != new_plan.scale_)
+                {
+                    throw logic_error("LinearTransformPlan data is invalid");
+                }
+            }
+            new_plan.set_order(slot_count);
+        }
+        catch (const ios_base::failure &)
+        {
+            stream.exceptions(old_except_mask);
+            throw runtime_error("I/O error");
+        }
+        catch (...)
+        {
+            stream.exceptions(old_except_mask);
+            throw;
+        }
+        stream.exceptions(old_except_mask);
+
+        swap(*this, new_plan);
+    }
+} // namespace seal
@@ -0,0 +1,415 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/ckks.h"
+#include "seal/context.h"
+#include "seal/encryptionparams.h"
+#include "seal/memorymanager.h"
+#include "seal/plaintext.h"
+#include "seal/serialization.h"
+#include "seal/util/common.h"
+#include "seal/util/defines.h"
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace seal
+{
+    /**
+    Class to store a matrix encoded for Evaluator::linear_transformation with the CKKS scheme.
+
+    @par Layout
+    A matrix with height rows and width columns is padded with zeros to a square matrix of dimension n, the smallest
+    power of two at least as large as both height and width. Its input vector holds element c in slot c*stride and its
+    output vector holds element r in slot r*stride, where stride is the number of slots divided by n; the other slots
+    of the output are zero. This is the layout of paddingVector in linearTrans.h for vectors of n elements.
+
+    @par Precomputation
+    The generalized diagonal i of the matrix holds the entries (r, r + i mod n). The plan stores only the diagonals
+    that are not zero, already pre-rotated for the baby-step giant-step algorithm of
+    Evaluator::linear_transformation_bsgs, encoded once as plaintexts in NTT form at the given parms_id and scale.
+    Evaluating the plan therefore does no encoding and no NTTs of the diagonals. The parms_id must be that of the
+    ciphertexts the plan is applied to, or SEALContext::key_parms_id() to sum the products modulo Q*P.
+
+    @par Sparse and Structured Matrices
+    Zero diagonals cost neither a product nor a rotation nor a Galois key. The diagonal i is evaluated as the baby
+    step k and the giant step o + j*g with i = o + j*g + k modulo n, where the number of baby steps g and the offset o
+    are chosen to minimize the number of key switches for the nonzero diagonals. The offset lets a band of diagonals
+    that wraps around the main diagonal, as in banded and block-diagonal matrices, be evaluated as one contiguous
+    range. The factories Diagonals, Toeplitz, Circulant, and BlockDiagonal create plans from the nonzero structure
+    directly, without a dense matrix. The rotation steps whose Galois keys the evaluation needs are recorded in
+    steps().
+
+    @par Serialization
+    A plan can be saved and loaded like other SEAL objects, so that it is created once for fixed weights. Each
+    diagonal takes as much memory as a plaintext at the plan's level.
+
+    @par Thread Safety
+    A LinearTransformPlan is immutable after construction and can be used concurrently by several threads, except
+    while it is being loaded.
+
+    @see Evaluator::linear_transformation for evaluating a plan.
+    */
+    class LinearTransformPlan
+    {
+    public:
+        /**
+        Creates an empty plan that cannot be evaluated.
+
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        LinearTransformPlan(MemoryPoolHandle pool = MemoryManager::GetPool());
+
+        /**
+        Creates a plan for the given matrix. Dynamic memory allocations in the process are allocated from the memory
+        pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encoder The CKKSEncoder of the SEALContext the plan is used with
+        @param[in] matrix The rows of the matrix, which must all have the same size
+        @param[in] parms_id The parms_id of the diagonals
+        @param[in] scale The scale of the diagonals
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if matrix is empty or its rows have different or zero sizes
+        @throws std::invalid_argument if the padded dimension of the matrix exceeds the number of slots
+        @throws std::invalid_argument if parms_id is not valid for the encryption parameters
+        @throws std::invalid_argument if scale is not strictly positive or is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        LinearTransformPlan(
+            CKKSEncoder &encoder, const std::vector<std::vector<double>> &matrix, parms_id_type parms_id, double scale,
+            MemoryPoolHandle pool = MemoryManager::GetPool());
+
+        /**
+        Creates a plan for a square matrix of the given dimension from its generalized diagonals. Each diagonal is
+        given by its index in (-dimension, dimension), where negative indices count from dimension, and its entries
+        for the rows 0 to dimension - 1. Diagonals that are not given are zero, so a banded matrix is given by the
+        diagonals from -l to u. Dynamic memory allocations in the process are allocated from the memory pool pointed
+        to by the given MemoryPoolHandle.
+
+        @param[in] encoder The CKKSEncoder of the SEALContext the plan is used with
+        @param[in] dimension The dimension of the matrix, a power of two at most the number of slots
+        @param[in] diagonals The entries of the diagonals by index
+        @param[in] parms_id The parms_id of the diagonals
+        @param[in] scale The scale of the diagonals
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if dimension is not a power of two or exceeds the number of slots
+        @throws std::invalid_argument if any index is out of range or two indices give the same diagonal
+        @throws std::invalid_argument if any diagonal does not have dimension entries
+        @throws std::invalid_argument if parms_id is not valid for the encryption parameters
+        @throws std::invalid_argument if scale is not strictly positive or is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        SEAL_NODISCARD static LinearTransformPlan Diagonals(
+            CKKSEncoder &encoder, std::size_t dimension, const std::map<int, std::vector<double>> &diagonals,
+            parms_id_type parms_id, double scale, MemoryPoolHandle pool = MemoryManager::GetPool());
+
+        /**
+        Creates a plan for a Toeplitz matrix of the given dimension, whose entry (r, c) is
+        values[dimension - 1 + c - r]. The matrix is padded with zeros to a power of two. Dynamic memory allocations in
+        the process are allocated from the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encoder The CKKSEncoder of the SEALContext the plan is used with
+        @param[in] dimension The dimension of the matrix
+        @param[in] values The 2*dimension - 1 entries of the matrix from the bottom left to the top right corner
+        @param[in] parms_id The parms_id of the diagonals
+        @param[in] scale The scale of the diagonals
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if dimension is zero or the padded dimension exceeds the number of slots
+        @throws std::invalid_argument if values does not have 2*dimension - 1 entries
+        @throws std::invalid_argument if parms_id is not valid for the encryption parameters
+        @throws std::invalid_argument if scale is not strictly positive or is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        SEAL_NODISCARD static LinearTransformPlan Toeplitz(
+            CKKSEncoder &encoder, std::size_t dimension, const std::vector<double> &values, parms_id_type parms_id,
+            double scale, MemoryPoolHandle pool = MemoryManager::GetPool());
+
+        /**
+        Creates a plan for a circulant matrix, whose entry (r, c) is first_row[c - r mod n] for the size n of
+        first_row. Every generalized diagonal of a circulant matrix is constant. Dynamic memory allocations in the
+        process are allocated from the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encoder The CKKSEncoder of the SEALContext the plan is used with
+        @param[in] first_row The first row of the matrix
+        @param[in] parms_id The parms_id of the diagonals
+        @param[in] scale The scale of the diagonals
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if the size of first_row is not a power of two or exceeds the number of slots
+        @throws std::invalid_argument if parms_id is not valid for the encryption parameters
+        @throws std::invalid_argument if scale is not strictly positive or is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        SEAL_NODISCARD static LinearTransformPlan Circulant(
+            CKKSEncoder &encoder, const std::vector<double> &first_row, parms_id_type parms_id, double scale,
+            MemoryPoolHandle pool = MemoryManager::GetPool());
+
+        /**
+        Creates a plan for a block-diagonal matrix, whose square blocks are placed one after the other along the main
+        diagonal. Only the diagonals that the blocks touch are nonzero. Dynamic memory allocations in the process are
+        allocated from the memory pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encoder The CKKSEncoder of the SEALContext the plan is used with
+        @param[in] blocks The blocks, each given by its rows
+        @param[in] parms_id The parms_id of the diagonals
+        @param[in] scale The scale of the diagonals
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if blocks is empty or any block is empty or not square
+        @throws std::invalid_argument if the padded dimension of the matrix exceeds the number of slots
+        @throws std::invalid_argument if parms_id is not valid for the encryption parameters
+        @throws std::invalid_argument if scale is not strictly positive or is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        SEAL_NODISCARD static LinearTransformPlan BlockDiagonal(
+            CKKSEncoder &encoder, const std::vector<std::vector<std::vector<double>>> &blocks, parms_id_type parms_id,
+            double scale, MemoryPoolHandle pool = MemoryManager::GetPool());
+
+        /**
+        Returns the number of baby steps with which the baby-step giant-step algorithm evaluates the given number of
+        diagonals: the smallest integer at least the square root of diagonal_count.
+
+        @param[in] diagonal_count The number of diagonals
+        */
+        SEAL_NODISCARD static std::size_t BabyStepCount(std::size_t diagonal_count);
+
+        /**
+        Returns the rotation steps whose Galois keys the baby-step giant-step algorithm needs for the given number of
+        diagonals that are stride slots apart: the baby steps k*stride for k in [1, g) and the giant steps j*stride
+        for the multiples j of g in [g, diagonal_count), where g is BabyStepCount(diagonal_count).
+
+        @param[in] diagonal_count The number of diagonals
+        @param[in] stride The number of slots between consecutive diagonals
+        */
+        SEAL_NODISCARD static std::vector<int> RotationSteps(std::size_t diagonal_count, int stride);
+
+        /**
+        Returns the number of rows of the matrix.
+        */
+        SEAL_NODISCARD inline std::size_t height() const noexcept
+        {
+            return height_;
+        }
+
+        /**
+        Returns the number of columns of the matrix.
+        */
+        SEAL_NODISCARD inline std::size_t width() const noexcept
+        {
+            return width_;
+        }
+
+        /**
+        Returns the dimension of the padded square matrix, which is zero for an empty plan.
+        */
+        SEAL_NODISCARD inline std::size_t dimension() const noexcept
+        {
+            return dimension_;
+        }
+
+        /**
+        Returns the indices of the stored diagonals, in the order of diagonals(). All other diagonals are zero.
+        */
+        SEAL_NODISCARD inline const std::vector<std::size_t> &indices() const noexcept
+        {
+            return indices_;
+        }
+
+        /**
+        Returns the offset o of the giant steps.
+        */
+        SEAL_NODISCARD inline std::size_t offset() const noexcept
+        {
+            return offset_;
+        }
+
+        /**
+        Returns the number of baby steps g.
+        */
+        SEAL_NODISCARD inline std::size_t baby_step_count() const noexcept
+        {
+            return baby_step_count_;
+        }
+
+        /**
+        Returns the number of key switches needed to evaluate the plan: one for every nonzero baby step and one for
+        every nonzero giant step.
+        */
+        SEAL_NODISCARD inline std::size_t key_switch_count() const noexcept
+        {
+            return key_switch_count_;
+        }
+
+        /**
+        Returns the parms_id of the diagonals.
+        */
+        SEAL_NODISCARD inline const parms_id_type &parms_id() const noexcept
+        {
+            return parms_id_;
+        }
+
+        /**
+        Returns the scale of the diagonals.
+        */
+        SEAL_NODISCARD inline double scale() const noexcept
+        {
+            return scale_;
+        }
+
+        /**
+        Returns the pre-rotated nonzero diagonals in NTT form, ordered by giant step and then by baby step.
+        */
+        SEAL_NODISCARD inline const std::vector<Plaintext> &diagonals() const noexcept
+        {
+            return diagonals_;
+        }
+
+        /**
+        Returns the rotation steps for which Galois keys must be created to evaluate the plan.
+        */
+        SEAL_NODISCARD inline const std::vector<int> &steps() const noexcept
+        {
+            return steps_;
+        }
+
+        /**
+        Returns an upper bound on the size of the LinearTransformPlan, as if it was written to an output stream.
+
+        @param[in] compr_mode The compression mode
+        @throws std::invalid_argument if the compression mode is not supported
+        @throws std::logic_error if the size does not fit in the return type
+        */
+        SEAL_NODISCARD std::streamoff save_size(compr_mode_type compr_mode = Serialization::compr_mode_default) const;
+
+        /**
+        Saves the LinearTransformPlan to an output stream. The output is in binary format and not human-readable. The
+        output stream must have the "binary" flag set.
+
+        @param[out] stream The stream to save the LinearTransformPlan to
+        @param[in] compr_mode The desired compression mode
+        @throws std::invalid_argument if the compression mode is not supported
+        @throws std::logic_error if the data to be saved is invalid, or if compression failed
+        @throws std::runtime_error if I/O operations failed
+        */
+        inline std::streamoff save(
+            std::ostream &stream, compr_mode_type compr_mode = Serialization::compr_mode_default) const
+        {
+            using namespace std::placeholders;
+            return Serialization::Save(
+                std::bind(&LinearTransformPlan::save_members, this, _1), save_size(compr_mode_type::none), stream,
+                compr_mode, false);
+        }
+
+        /**
+        Loads a LinearTransformPlan from an input stream overwriting the current one. The loaded plan is verified to be
+        valid for the given SEALContext.
+
+        @param[in] context The SEALContext
+        @param[in] stream The stream to load the LinearTransformPlan from
+        @throws std::invalid_argument if the encryption parameters are not valid
+        @throws std::logic_error if the data cannot be loaded by this version of Microsoft SEAL, if the loaded data is
+        invalid, or if decompression failed
+        @throws std::runtime_error if I/O operations failed
+        */
+        inline std::streamoff load(const SEALContext &context, std::istream &stream)
+        {
+            using namespace std::placeholders;
+            return Serialization::Load(
+                std::bind(&LinearTransformPlan::load_members, this, context, _1, _2), stream, false);
+        }
+
+        /**
+        Saves the LinearTransformPlan to a given memory location. The output is in binary format and not
+        human-readable.
+
+        @param[out] out The memory location to write the LinearTransformPlan to
+        @param[in] size The number of bytes available in the given memory location
+        @param[in] compr_mode The desired compression mode
+        @throws std::invalid_argument if out is null or if size is too small to contain a SEALHeader, or if the
+        compression mode is not supported
+        @throws std::logic_error if the data to be saved is invalid, or if compression failed
+        @throws std::runtime_error if I/O operations failed
+        */
+        inline std::streamoff save(
+            seal_byte *out, std::size_t size, compr_mode_type compr_mode = Serialization::compr_mode_default) const
+        {
+            using namespace std::placeholders;
+            return Serialization::Save(
+                std::bind(&LinearTransformPlan::save_members, this, _1), save_size(compr_mode_type::none), out, size,
+                compr_mode, false);
+        }
+
+        /**
+        Loads a LinearTransformPlan from a given memory location overwriting the current one. The loaded plan is
+        verified to be valid for the given SEALContext.
+
+        @param[in] context The SEALContext
+        @param[in] in The memory location to load the LinearTransformPlan from
+        @param[in] size The number of bytes available in the given memory location
+        @throws std::invalid_argument if the encryption parameters are not valid
+        @throws std::invalid_argument if in is null or if size is too small to contain a SEALHeader
+        @throws std::logic_error if the data cannot be loaded by this version of Microsoft SEAL, if the loaded data is
+        invalid, or if decompression failed
+        @throws std::runtime_error if I/O operations failed
+        */
+        inline std::streamoff load(const SEALContext &context, const seal_byte *in, std::size_t size)
+        {
+            using namespace std::placeholders;
+            return Serialization::Load(
+                std::bind(&LinearTransformPlan::load_members, this, context, _1, _2), in, size, false);
+        }
+
+        /**
+        Returns the currently used MemoryPoolHandle.
+        */
+        SEAL_NODISCARD inline MemoryPoolHandle pool() const noexcept
+        {
+            return pool_;
+        }
+
+    private:
+        friend class TiledLinearTransformPlan;
+
+        void save_members(std::ostream &stream) const;
+
+        void load_members(const SEALContext &context, std::istream &stream, SEALVersion version);
+
+        // Chooses the offset and the number of baby steps for the given nonzero diagonals, orders the diagonals by
+        // giant step and baby step, and encodes them pre-rotated. A nonzero baby_step_count is used with offset zero
+        // instead of the best choice, as for the tiles of a TiledLinearTransformPlan.
+        void create(
+            CKKSEncoder &encoder, std::map<std::size_t, std::vector<double>> &diagonals, parms_id_type parms_id,
+            double scale, std::size_t baby_step_count = 0);
+
+        // Sets the order of the diagonals and the rotation steps for the current indices, offset, and number of baby
+        // steps, and returns the giant step of each diagonal in order
+        std::vector<std::size_t> set_order(std::size_t slot_count);
+
+        MemoryPoolHandle pool_;
+
+        std::size_t height_ = 0;
+
+        std::size_t width_ = 0;
+
+        std::size_t dimension_ = 0;
+
+        std::size_t offset_ = 0;
+
+        std::size_t baby_step_count_ = 0;
+
+        std::size_t key_switch_count_ = 0;
+
+        std::vector<std::size_t> indices_{};
+
+        parms_id_type parms_id_ = parms_id_zero;
+
+        double scale_ = 1.0;
+
+        std::vector<Plaintext> diagonals_{};
+
+        std::vector<int> steps_{};
+    };
+} // namespace seal
@@ -227,4 +227,21 @@ namespace seal
         }
         return result;
     }
+
+    vector<Modulus> CoeffModulus::CreateSmall(size_t poly_modulus_degree, int bit_count)
+    {
+        if (bit_count <= 0 || bit_count > SEAL_COEFF_MOD_COUNT_MAX * SEAL_SMALL_MOD_BIT_COUNT_MAX)
+        {
+            throw invalid_argument("bit_count is invalid");
+        }
+
+        // Split bit_count as evenly as possible over the fewest primes
+        int count = (bit_count + SEAL_SMALL_MOD_BIT_COUNT_MAX - 1) / SEAL_SMALL_MOD_BIT_COUNT_MAX;
+        vector<int> bit_sizes(static_cast<size_t>(count), bit_count / count);
+        for (int i = 0; i < bit_count % count; i++)
+        {
+            bit_sizes[static_cast<size_t>(i)]++;
+        }
+        return Create(poly_modulus_degree, move(bit_sizes));
+    }
 } // namespace seal
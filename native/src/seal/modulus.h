@@ -515,6 +515,24 @@ namespace seal
         */
         SEAL_NODISCARD static std::vector<Modulus> Create(
             std::size_t poly_modulus_degree, const Modulus &plain_modulus, std::vector<int> bit_sizes);
+
+        /**
+        Returns a custom coefficient modulus suitable for use with the specified
+        poly_modulus_degree, with a total bit-length of bit_count split over as
+        few primes of at most SEAL_SMALL_MOD_BIT_COUNT_MAX (30) bits as possible.
+        The bit-lengths of the primes differ by at most one. Such primes have NTT
+        tables and dyadic products computed in 32-bit vector lanes, which process
+        twice as many coefficients per instruction as for larger primes.
+
+        @param[in] poly_modulus_degree The value of the poly_modulus_degree
+        encryption parameter
+        @param[in] bit_count The total bit-length of the primes to be generated
+        @throws std::invalid_argument if poly_modulus_degree is not a power-of-two
+        or is too large
+        @throws std::invalid_argument if bit_count is not positive or too large
+        @throws std::logic_error if not enough suitable primes could be found
+        */
+        SEAL_NODISCARD static std::vector<Modulus> CreateSmall(std::size_t poly_modulus_degree, int bit_count);
     };
 
     /**
@@ -74,15 +74,17 @@ namespace seal
         SEAL_NODISCARD inline bool has_key(std::size_t key_power) const
         {
             std::size_t index = get_index(key_power);
-            return data().size() > index && !data()[index].empty();
+            return data().size() > index && (!data()[index].empty() || is_compact(index));
         }
 
         /**
         Returns a const reference to a relinearization key. The returned
         relinearization key corresponds to the given power of the secret key.
+        A key in compact form is accessed with KSwitchKeys::expanded_data instead.
 
         @param[in] key_power The power of the secret key
-        @throws std::invalid_argument if the key corresponding to key_power does not exist
+        @throws std::invalid_argument if the key corresponding to key_power does not
+        exist or is in compact form
         */
         SEAL_NODISCARD inline auto &key(std::size_t key_power) const
         {
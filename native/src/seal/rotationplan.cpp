@@ -0,0 +1,290 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/rotationplan.h"
+#include "seal/util/common.h"
+#include "seal/util/numth.h"
+#include "seal/util/rns.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+using namespace std;
+using namespace seal::util;
+
+namespace seal
+{
+    namespace
+    {
+        constexpr size_t unreached = numeric_limits<size_t>::max();
+
+        // Returns the left rotation modulo the row size equivalent to step
+        size_t rotation_residue(int step, size_t row_size)
+        {
+            size_t abs_step = static_cast<size_t>(abs(static_cast<long long>(step)));
+            if (abs_step >= row_size)
+            {
+                throw invalid_argument("step count too large");
+            }
+            return step < 0 ? row_size - abs_step : abs_step;
+        }
+
+        // Adds a key step to the distances, which are the smallest numbers of key steps that compose each rotation.
+        // Rotations commute, so the new distance of r is the minimum over j of distance[r - j * key] + j, which two
+        // passes around each cycle of r -> r + key compute in time proportional to the row size.
+        void add_key_distances(const vector<size_t> &distance, size_t key, vector<size_t> &result)
+        {
+            size_t row_size = distance.size();
+            size_t cycle_count = static_cast<size_t>(gcd(static_cast<uint64_t>(key), static_cast<uint64_t>(row_size)));
+            size_t cycle_length = row_size / cycle_count;
+            result = distance;
+            for (size_t start = 0; start < cycle_count; start++)
+            {
+                size_t from = start;
+                for (size_t i = 0; i < 2 * cycle_length; i++)
+                {
+                    size_t to = from + key;
+                    to -= to >= row_size ? row_size : 0;
+                    if (result[from] != unreached && result[from] + 1 < result[to])
+                    {
+                        result[to] = result[from] + 1;
+                    }
+                    from = to;
+                }
+            }
+        }
+
+        // Shortest compositions of the key steps that reach the targets. The rotation r is reached from parent[r] with
+        // the first key step, of index via[r], that leads from a rotation one step closer; nodes lists the rotations on
+        // the paths to the targets. Only these are touched, so a tree is rebuilt in time proportional to the number of
+        // key switches times the number of keys.
+        class RotationTree
+        {
+        public:
+            RotationTree(size_t row_size)
+                : parent(row_size, unreached), via(row_size, unreached), used_(row_size, false),
+                  has_children_(row_size, false)
+            {}
+
+            // Marks the rotations on the paths to the targets and returns, in order of importance, the number of
+            // unreached targets, the number of marked rotations, which is the number of key switches, the number of
+            // rotations with marked children, which is the number of decompositions, and the sum of the distances of
+            // the targets, which accounts for the noise growth and the latency of chained key switches.
+            tuple<size_t, size_t, size_t, size_t> build(
+                const vector<size_t> &distance, const vector<size_t> &keys, const vector<size_t> &targets)
+            {
+                size_t row_size = distance.size();
+                for (auto rotation : nodes)
+                {
+                    used_[rotation] = false;
+                    has_children_[parent[rotation]] = false;
+                }
+                nodes.clear();
+
+                size_t unreached_count = 0;
+                size_t decomposition_count = 0;
+                size_t distance_sum = 0;
+                for (auto target : targets)
+                {
+                    if (distance[target] == unreached)
+                    {
+                        unreached_count++;
+                        continue;
+                    }
+                    distance_sum += distance[target];
+                    for (size_t r = target; r && !used_[r]; r = parent[r])
+                    {
+                        size_t k = 0;
+                        size_t from = 0;
+                        for (; k < keys.size(); k++)
+                        {
+                            from = r >= keys[k] ? r - keys[k] : r + row_size - keys[k];
+                            if (distance[from] + 1 == distance[r])
+                            {
+                                break;
+                            }
+                        }
+                        used_[r] = true;
+                        parent[r] = from;
+                        via[r] = k;
+                        nodes.push_back(r);
+                        if (!has_children_[from])
+                        {
+                            has_children_[from] = true;
+                            decomposition_count++;
+                        }
+                    }
+                }
+                return make_tuple(unreached_count, nodes.size(), decomposition_count, distance_sum);
+            }
+
+            vector<size_t> parent;
+
+            vector<size_t> via;
+
+            vector<size_t> nodes;
+
+        private:
+            vector<bool> used_;
+
+            vector<bool> has_children_;
+        };
+    } // namespace
+
+    RotationPlan::RotationPlan(const SEALContext &context, const vector<int> &steps, size_t max_key_count)
+    {
+        if (!context.parameters_set())
+        {
+            throw invalid_argument("encryption parameters are not set correctly");
+        }
+        if (!context.first_context_data()->qualifiers().using_batching)
+        {
+            throw logic_error("encryption parameters do not support batching");
+        }
+        poly_modulus_degree_ = context.first_context_data()->parms().poly_modulus_degree();
+        size_t row_size = poly_modulus_degree_ >> 1;
+
+        // The distinct rotations needed, as residues modulo the row size
+        vector<size_t> targets;
+        for (auto step : steps)
+        {
+            size_t target = rotation_residue(step, row_size);
+            if (target && find(targets.cbegin(), targets.cend(), target) == targets.cend())
+            {
+                targets.push_back(target);
+            }
+        }
+        if (!max_key_count && !targets.empty())
+        {
+            throw invalid_argument("max_key_count is too small");
+        }
+
+        vector<size_t> keys;
+        if (targets.size() <= max_key_count)
+        {
+            keys = targets;
+        }
+        else
+        {
+            // Add the candidate that saves the most key switches, or else decompositions or chained key switches, until
+            // the budget is exhausted or no candidate helps. The first pick reaches all targets, since an odd step
+            // generates all rotations.
+            vector<size_t> candidates = targets;
+            for (size_t power = 1; power < row_size; power <<= 1)
+            {
+                for (auto candidate : { power, row_size - power })
+                {
+                    if (find(candidates.cbegin(), candidates.cend(), candidate) == candidates.cend())
+                    {
+                        candidates.push_back(candidate);
+                    }
+                }
+            }
+
+            // Each candidate is tried by adding it to the distances of the keys picked so far
+            vector<size_t> distance(row_size, unreached);
+            distance[0] = 0;
+            vector<size_t> trial;
+            vector<size_t> best_distance;
+            RotationTree tree(row_size);
+            auto best_cost = make_tuple(targets.size(), size_t(0), size_t(0), size_t(0));
+            while (keys.size() < max_key_count)
+            {
+                auto best_candidate = candidates.cend();
+                keys.push_back(0);
+                for (auto it = candidates.cbegin(); it != candidates.cend(); ++it)
+                {
+                    if (find(keys.cbegin(), keys.cend() - 1, *it) != keys.cend() - 1)
+                    {
+                        continue;
+                    }
+                    keys.back() = *it;
+                    add_key_distances(distance, *it, trial);
+                    auto cost = tree.build(trial, keys, targets);
+                    if (cost < best_cost)
+                    {
+                        best_cost = cost;
+                        best_candidate = it;
+                        swap(best_distance, trial);
+                    }
+                }
+                if (best_candidate == candidates.cend())
+                {
+                    keys.pop_back();
+                    break;
+                }
+                keys.back() = *best_candidate;
+                swap(distance, best_distance);
+            }
+        }
+
+        // Key steps are stored with the smallest absolute value
+        for (auto key : keys)
+        {
+            key_steps_.push_back(key > (row_size >> 1) ? -static_cast<int>(row_size - key) : static_cast<int>(key));
+        }
+
+        vector<size_t> distance(row_size, unreached);
+        distance[0] = 0;
+        vector<size_t> next_distance;
+        for (auto key : keys)
+        {
+            add_key_distances(distance, key, next_distance);
+            swap(distance, next_distance);
+        }
+        RotationTree tree(row_size);
+        tree.build(distance, keys, targets);
+        for (auto target : targets)
+        {
+            depth_ = max(depth_, distance[target]);
+        }
+
+        // Keep the rotations on the paths to the targets level by level, and within a level by parent, so that every
+        // node follows its parent and the children of a node are consecutive
+        vector<size_t> node_index(row_size, input_index);
+        auto &order = tree.nodes;
+        sort(order.begin(), order.end(), [&](size_t a, size_t b) { return distance[a] < distance[b]; });
+        for (auto level_begin = order.begin(); level_begin != order.end();)
+        {
+            auto level_end = find_if(
+                level_begin, order.end(), [&](size_t r) { return distance[r] != distance[*level_begin]; });
+            sort(level_begin, level_end, [&](size_t a, size_t b) {
+                auto parent_a = node_index[tree.parent[a]];
+                auto parent_b = node_index[tree.parent[b]];
+                return parent_a != parent_b ? parent_a < parent_b : tree.via[a] < tree.via[b];
+            });
+            for (auto it = level_begin; it != level_end; ++it)
+            {
+                node_index[*it] = nodes_.size();
+                nodes_.push_back({ static_cast<int>(*it), node_index[tree.parent[*it]], key_steps_[tree.via[*it]] });
+            }
+            level_begin = level_end;
+        }
+
+        steps_ = steps;
+        for (auto step : steps)
+        {
+            outputs_.push_back(node_index[rotation_residue(step, row_size)]);
+        }
+    }
+
+    size_t RotationPlan::GaloisKeyByteCount(const SEALContext &context)
+    {
+        if (!context.parameters_set())
+        {
+            throw invalid_argument("encryption parameters are not set correctly");
+        }
+        if (!context.using_keyswitching())
+        {
+            throw logic_error("keyswitching is not supported by the context");
+        }
+
+        // One encryption of size 2 modulo all primes of the key level for each digit of the decomposition
+        auto &key_parms = context.key_context_data()->parms();
+        return mul_safe(
+            context.first_context_data()->kswitch_tool()->digit_count(), size_t(2), key_parms.coeff_modulus().size(),
+            key_parms.poly_modulus_degree(), sizeof(uint64_t));
+    }
+} // namespace seal
@@ -0,0 +1,190 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/context.h"
+#include "seal/util/defines.h"
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace seal
+{
+    /**
+    Class to plan the rotations of a computation and the Galois keys needed for them.
+
+    @par Key Memory Versus Key Switches
+    Every Galois key takes as much memory as GaloisKeyByteCount reports, and every rotation whose key is not present
+    is composed of several rotations that each cost a full key switch. A RotationPlan is created for the set of
+    rotation steps that a computation needs and a maximum number of Galois keys. If the budget admits a key for every
+    step, each step costs one key switch and all of them share one decomposition of the input ciphertext. Otherwise
+    the planner greedily picks a smaller set of key steps among the requested steps and the powers of two, so that
+    the rotations composed of them take as few key switches as possible; among equally many key switches it prefers
+    fewer decompositions and shorter chains of key switches. Each pick updates the distances of all N/2 rotations for
+    every candidate, of which there are at most the number of steps plus 2*log2(N/2), and walks the paths to the
+    targets, so creating a plan takes O(budget * candidates * (N/2 + key switches * budget)) time and O(N/2) memory.
+    The resulting key set, the number of key switches, and the longest chain are exposed, so the trade-off can be
+    tuned by creating plans for several budgets.
+
+    @par Executing a Plan
+    The rotations are computed as a tree rooted at the input ciphertext: each node is obtained from its parent by one
+    key switch with the Galois key of the node's key step. Evaluator::rotate_rows_many and
+    Evaluator::rotate_vector_many execute a plan and apply all key steps of the same parent with one decomposition,
+    as Evaluator::apply_galois_many does. Intermediate nodes are shared by all requested steps that go through them.
+    The Galois keys must be created with KeyGenerator::create_galois_keys for key_steps().
+
+    Rotation steps are taken modulo N/2, where N is the degree of the polynomial modulus, so the same plan serves the
+    rotation of the rows of a BFV/BGV plaintext matrix and of a CKKS plaintext vector.
+
+    @par Thread Safety
+    A RotationPlan is immutable after construction and can be used concurrently by several threads.
+
+    @see Evaluator::rotate_vector_many for executing a plan with the CKKS scheme.
+    @see Evaluator::rotate_rows_many for executing a plan with the BFV/BGV schemes.
+    */
+    class RotationPlan
+    {
+    public:
+        /**
+        The index of the input ciphertext in place of a node index.
+        */
+        static constexpr std::size_t input_index = std::numeric_limits<std::size_t>::max();
+
+        /**
+        A node of the rotation tree.
+        */
+        struct Node
+        {
+            /**
+            The total rotation of the node, in [1, N/2).
+            */
+            int step;
+
+            /**
+            The index of the parent node, which precedes the node, or input_index.
+            */
+            std::size_t parent;
+
+            /**
+            The step of the Galois key that rotates the parent into the node; one of key_steps().
+            */
+            int key_step;
+        };
+
+        /**
+        Creates a rotation plan for the given steps that uses at most max_key_count Galois keys.
+
+        @param[in] context The SEALContext
+        @param[in] steps The numbers of steps to rotate (positive left, negative right)
+        @param[in] max_key_count The maximum number of Galois keys
+        @throws std::invalid_argument if the encryption parameters are not valid
+        @throws std::logic_error if the encryption parameters do not support batching
+        @throws std::invalid_argument if any of the steps has too big absolute value
+        @throws std::invalid_argument if max_key_count is zero while a step is not zero
+        */
+        RotationPlan(const SEALContext &context, const std::vector<int> &steps, std::size_t max_key_count);
+
+        /**
+        Returns the number of bytes of one Galois key for the given context, without serialization overhead.
+
+        @param[in] context The SEALContext
+        @throws std::invalid_argument if the encryption parameters are not valid
+        @throws std::logic_error if keyswitching is not supported by the context
+        */
+        SEAL_NODISCARD static std::size_t GaloisKeyByteCount(const SEALContext &context);
+
+        /**
+        Returns the number of Galois keys that fit in the given number of bytes, for use as max_key_count.
+
+        @param[in] context The SEALContext
+        @param[in] byte_count The memory budget in bytes
+        @throws std::invalid_argument if the encryption parameters are not valid
+        @throws std::logic_error if keyswitching is not supported by the context
+        */
+        SEAL_NODISCARD inline static std::size_t MaxKeyCount(const SEALContext &context, std::size_t byte_count)
+        {
+            return byte_count / GaloisKeyByteCount(context);
+        }
+
+        /**
+        Returns the requested steps, in the order given to the constructor.
+        */
+        SEAL_NODISCARD inline const std::vector<int> &steps() const noexcept
+        {
+            return steps_;
+        }
+
+        /**
+        Returns the steps for which Galois keys must be created, each in (-N/4, N/4].
+        */
+        SEAL_NODISCARD inline const std::vector<int> &key_steps() const noexcept
+        {
+            return key_steps_;
+        }
+
+        /**
+        Returns the number of Galois keys the plan needs.
+        */
+        SEAL_NODISCARD inline std::size_t key_count() const noexcept
+        {
+            return key_steps_.size();
+        }
+
+        /**
+        Returns the nodes of the rotation tree. Every node follows its parent, and the nodes with the same parent are
+        consecutive.
+        */
+        SEAL_NODISCARD inline const std::vector<Node> &nodes() const noexcept
+        {
+            return nodes_;
+        }
+
+        /**
+        Returns for each requested step the index of the node holding its rotation, or input_index if the step is
+        zero.
+        */
+        SEAL_NODISCARD inline const std::vector<std::size_t> &outputs() const noexcept
+        {
+            return outputs_;
+        }
+
+        /**
+        Returns the number of key switches needed to execute the plan, which is the number of nodes.
+        */
+        SEAL_NODISCARD inline std::size_t key_switch_count() const noexcept
+        {
+            return nodes_.size();
+        }
+
+        /**
+        Returns the largest number of consecutive key switches that any requested rotation goes through. Each of them
+        adds key switching noise to the result.
+        */
+        SEAL_NODISCARD inline std::size_t depth() const noexcept
+        {
+            return depth_;
+        }
+
+        /**
+        Returns the degree of the polynomial modulus the plan was created for.
+        */
+        SEAL_NODISCARD inline std::size_t poly_modulus_degree() const noexcept
+        {
+            return poly_modulus_degree_;
+        }
+
+    private:
+        std::size_t poly_modulus_degree_ = 0;
+
+        std::vector<int> steps_{};
+
+        std::vector<int> key_steps_{};
+
+        std::vector<Node> nodes_{};
+
+        std::vector<std::size_t> outputs_{};
+
+        std::size_t depth_ = 0;
+    };
+} // namespace seal
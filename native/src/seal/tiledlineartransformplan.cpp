@@ -0,0 +1,168 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/tiledlineartransformplan.h"
+#include "seal/util/common.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+using namespace seal::util;
+
+namespace seal
+{
+    TiledLinearTransformPlan::TiledLinearTransformPlan(MemoryPoolHandle pool) : pool_(move(pool))
+    {
+        if (!pool_)
+        {
+            throw invalid_argument("pool is uninitialized");
+        }
+    }
+
+    TiledLinearTransformPlan::TiledLinearTransformPlan(
+        CKKSEncoder &encoder, const vector<vector<double>> &matrix, parms_id_type parms_id, double scale,
+        MemoryPoolHandle pool)
+        : TiledLinearTransformPlan(move(pool))
+    {
+        height_ = matrix.size();
+        width_ = height_ ? matrix[0].size() : 0;
+        if (!width_ || any_of(matrix.cbegin(), matrix.cend(), [&](auto &row) { return row.size() != width_; }))
+        {
+            throw invalid_argument("matrix must have rows of the same nonzero size");
+        }
+        size_t slot_count = encoder.slot_count();
+        size_t n = 1;
+        while (n < max(height_, width_) && n < slot_count)
+        {
+            n <<= 1;
+        }
+        tile_dimension_ = n;
+        output_count_ = (height_ + n - 1) / n;
+        input_count_ = (width_ + n - 1) / n;
+
+        // Mark the nonzero diagonals of every tile; tiles that are zero stay empty
+        vector<vector<bool>> nonzero(mul_safe(output_count_, input_count_));
+        for (size_t r = 0; r < height_; r++)
+        {
+            for (size_t c = 0; c < width_; c++)
+            {
+                if (matrix[r][c] != 0.0)
+                {
+                    auto &tile_nonzero = nonzero[(r / n) * input_count_ + c / n];
+                    tile_nonzero.resize(n, false);
+                    tile_nonzero[(c % n + n - r % n) % n] = true;
+                }
+            }
+        }
+
+        // An output ciphertext whose row of tiles is zero would be transparent
+        for (size_t p = 0; p < output_count_; p++)
+        {
+            if (all_of(
+                    nonzero.cbegin() + static_cast<ptrdiff_t>(p * input_count_),
+                    nonzero.cbegin() + static_cast<ptrdiff_t>((p + 1) * input_count_),
+                    [](auto &tile_nonzero) { return tile_nonzero.empty(); }))
+            {
+                throw invalid_argument("matrix has a row of tiles that is zero");
+            }
+        }
+
+        // Choose the number of baby steps among the powers of two, counting the distinct baby steps of every column
+        // of tiles and the distinct giant steps of every row of tiles
+        key_switch_count_ = numeric_limits<size_t>::max();
+        vector<bool> used(n);
+        for (size_t g = 1; g <= n; g <<= 1)
+        {
+            size_t key_switch_count = 0;
+            for (size_t q = 0; q < input_count_; q++)
+            {
+                fill(used.begin(), used.end(), false);
+                for (size_t p = 0; p < output_count_; p++)
+                {
+                    auto &tile_nonzero = nonzero[p * input_count_ + q];
+                    for (size_t i = 0; i < tile_nonzero.size(); i++)
+                    {
+                        if (tile_nonzero[i] && i % g && !used[i % g])
+                        {
+                            used[i % g] = true;
+                            key_switch_count++;
+                        }
+                    }
+                }
+            }
+            for (size_t p = 0; p < output_count_; p++)
+            {
+                fill(used.begin(), used.end(), false);
+                for (size_t q = 0; q < input_count_; q++)
+                {
+                    auto &tile_nonzero = nonzero[p * input_count_ + q];
+                    for (size_t i = 0; i < tile_nonzero.size(); i++)
+                    {
+                        if (tile_nonzero[i] && i / g && !used[i / g])
+                        {
+                            used[i / g] = true;
+                            key_switch_count++;
+                        }
+                    }
+                }
+            }
+            if (key_switch_count < key_switch_count_)
+            {
+                key_switch_count_ = key_switch_count;
+                baby_step_count_ = g;
+            }
+        }
+
+        // Encode the nonzero tiles
+        tiles_.reserve(nonzero.size());
+        for (size_t t = 0; t < nonzero.size(); t++)
+        {
+            tiles_.emplace_back(pool_);
+        }
+        for (size_t p = 0; p < output_count_; p++)
+        {
+            for (size_t q = 0; q < input_count_; q++)
+            {
+                if (nonzero[p * input_count_ + q].empty())
+                {
+                    continue;
+                }
+                map<size_t, vector<double>> diagonals;
+                for (size_t r = p * n; r < min(height_, (p + 1) * n); r++)
+                {
+                    for (size_t c = q * n; c < min(width_, (q + 1) * n); c++)
+                    {
+                        if (matrix[r][c] != 0.0)
+                        {
+                            auto &diagonal = diagonals[(c % n + n - r % n) % n];
+                            diagonal.resize(n, 0.0);
+                            diagonal[r % n] = matrix[r][c];
+                        }
+                    }
+                }
+                auto &tile = tiles_[p * input_count_ + q];
+                tile.height_ = n;
+                tile.width_ = n;
+                tile.dimension_ = n;
+                tile.create(encoder, diagonals, parms_id, scale, baby_step_count_);
+                steps_.insert(steps_.end(), tile.steps_.cbegin(), tile.steps_.cend());
+            }
+        }
+        sort(steps_.begin(), steps_.end());
+        steps_.erase(unique(steps_.begin(), steps_.end()), steps_.end());
+        parms_id_ = parms_id;
+        scale_ = scale;
+    }
+
+    const LinearTransformPlan &TiledLinearTransformPlan::tile(size_t output_index, size_t input_index) const
+    {
+        if (output_index >= output_count_ || input_index >= input_count_)
+        {
+            throw out_of_range("tile index is out of range");
+        }
+        return tiles_[output_index * input_count_ + input_index];
+    }
+} // namespace seal
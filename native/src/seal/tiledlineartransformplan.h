@@ -0,0 +1,201 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/ckks.h"
+#include "seal/encryptionparams.h"
+#include "seal/lineartransformplan.h"
+#include "seal/memorymanager.h"
+#include "seal/util/defines.h"
+#include <cstddef>
+#include <vector>
+
+namespace seal
+{
+    /**
+    Class to store a matrix that may be larger than the number of slots, encoded in tiles for
+    Evaluator::linear_transformation with the CKKS scheme.
+
+    @par Layout
+    The tile dimension n is the number of slots, or the smallest power of two at least as large as both the height and
+    the width of the matrix if that is smaller. The input vector of width elements is split into input_count()
+    ciphertexts, where ciphertext q holds element q*n + c in slot c*stride, and the output vector of height elements
+    is split into output_count() ciphertexts in the same way, where stride is the number of slots divided by n. The
+    matrix is padded with zeros to output_count()*n rows and input_count()*n columns, and its tile (p, q) of n rows
+    and n columns maps input ciphertext q to a part of output ciphertext p.
+
+    @par Shared Rotations
+    Every tile is stored as a LinearTransformPlan with the same number of baby steps g and offset zero, so that the
+    baby-step rotations of an input ciphertext are computed once and shared by all tiles of its column, and the
+    products of all tiles of a row are summed for each giant step before its rotation. The output ciphertext p
+    therefore needs one rotation per giant step instead of one per giant step and tile, and the partial sums of the
+    tiles are added without any rotations. The number of baby steps is chosen to minimize the total number of key
+    switches, and tiles and diagonals that are zero cost nothing. Every row of tiles must have a nonzero entry, since
+    the output ciphertext of a zero row of tiles would be transparent; rows of the matrix that are zero and come after
+    its last nonzero row can be left out instead, which reduces the height.
+
+    @par Memory
+    Each nonzero diagonal of each tile takes as much memory as a plaintext at the plan's level.
+
+    @par Thread Safety
+    A TiledLinearTransformPlan is immutable after construction and can be used concurrently by several threads.
+
+    @see LinearTransformPlan for matrices that fit in the slots of one ciphertext.
+    @see Evaluator::linear_transformation for evaluating a plan.
+    */
+    class TiledLinearTransformPlan
+    {
+    public:
+        /**
+        Creates an empty plan that cannot be evaluated.
+
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        TiledLinearTransformPlan(MemoryPoolHandle pool = MemoryManager::GetPool());
+
+        /**
+        Creates a plan for the given matrix. Dynamic memory allocations in the process are allocated from the memory
+        pool pointed to by the given MemoryPoolHandle.
+
+        @param[in] encoder The CKKSEncoder of the SEALContext the plan is used with
+        @param[in] matrix The rows of the matrix, which must all have the same size
+        @param[in] parms_id The parms_id of the diagonals
+        @param[in] scale The scale of the diagonals
+        @param[in] pool The MemoryPoolHandle pointing to a valid memory pool
+        @throws std::invalid_argument if matrix is empty or its rows have different or zero sizes
+        @throws std::invalid_argument if the n rows of the matrix in any row of tiles are all zero
+        @throws std::invalid_argument if parms_id is not valid for the encryption parameters
+        @throws std::invalid_argument if scale is not strictly positive or is too large for the encryption parameters
+        @throws std::invalid_argument if pool is uninitialized
+        */
+        TiledLinearTransformPlan(
+            CKKSEncoder &encoder, const std::vector<std::vector<double>> &matrix, parms_id_type parms_id, double scale,
+            MemoryPoolHandle pool = MemoryManager::GetPool());
+
+        /**
+        Returns the number of rows of the matrix.
+        */
+        SEAL_NODISCARD inline std::size_t height() const noexcept
+        {
+            return height_;
+        }
+
+        /**
+        Returns the number of columns of the matrix.
+        */
+        SEAL_NODISCARD inline std::size_t width() const noexcept
+        {
+            return width_;
+        }
+
+        /**
+        Returns the dimension of the square tiles, which is zero for an empty plan.
+        */
+        SEAL_NODISCARD inline std::size_t tile_dimension() const noexcept
+        {
+            return tile_dimension_;
+        }
+
+        /**
+        Returns the number of input ciphertexts, which is the number of columns of tiles.
+        */
+        SEAL_NODISCARD inline std::size_t input_count() const noexcept
+        {
+            return input_count_;
+        }
+
+        /**
+        Returns the number of output ciphertexts, which is the number of rows of tiles.
+        */
+        SEAL_NODISCARD inline std::size_t output_count() const noexcept
+        {
+            return output_count_;
+        }
+
+        /**
+        Returns the number of baby steps g shared by all tiles.
+        */
+        SEAL_NODISCARD inline std::size_t baby_step_count() const noexcept
+        {
+            return baby_step_count_;
+        }
+
+        /**
+        Returns the number of key switches needed to evaluate the plan: one for every nonzero baby step of every
+        input ciphertext and one for every nonzero giant step of every output ciphertext.
+        */
+        SEAL_NODISCARD inline std::size_t key_switch_count() const noexcept
+        {
+            return key_switch_count_;
+        }
+
+        /**
+        Returns the tile in the given row and column of tiles. A tile that is zero is an empty plan, whose dimension is
+        zero.
+
+        @param[in] output_index The row of the tile, which is the index of its output ciphertext
+        @param[in] input_index The column of the tile, which is the index of its input ciphertext
+        @throws std::out_of_range if output_index or input_index is out of range
+        */
+        SEAL_NODISCARD const LinearTransformPlan &tile(std::size_t output_index, std::size_t input_index) const;
+
+        /**
+        Returns the parms_id of the diagonals.
+        */
+        SEAL_NODISCARD inline const parms_id_type &parms_id() const noexcept
+        {
+            return parms_id_;
+        }
+
+        /**
+        Returns the scale of the diagonals.
+        */
+        SEAL_NODISCARD inline double scale() const noexcept
+        {
+            return scale_;
+        }
+
+        /**
+        Returns the rotation steps whose Galois keys are needed to evaluate the plan.
+        */
+        SEAL_NODISCARD inline const std::vector<int> &steps() const noexcept
+        {
+            return steps_;
+        }
+
+        /**
+        Returns the currently used MemoryPoolHandle.
+        */
+        SEAL_NODISCARD inline MemoryPoolHandle pool() const noexcept
+        {
+            return pool_;
+        }
+
+    private:
+        MemoryPoolHandle pool_;
+
+        std::size_t height_ = 0;
+
+        std::size_t width_ = 0;
+
+        std::size_t tile_dimension_ = 0;
+
+        std::size_t input_count_ = 0;
+
+        std::size_t output_count_ = 0;
+
+        std::size_t baby_step_count_ = 0;
+
+        std::size_t key_switch_count_ = 0;
+
+        parms_id_type parms_id_ = parms_id_zero;
+
+        double scale_ = 1.0;
+
+        std::vector<LinearTransformPlan> tiles_{};
+
+        std::vector<int> steps_{};
+    };
+} // namespace seal
@@ -0,0 +1,159 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/util/dispatch.h"
+#include <atomic>
+#include <stdexcept>
+#ifdef SEAL_USE_AVX2
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace
+        {
+#ifdef SEAL_USE_AVX2
+            struct CPUFeatures
+            {
+                bool avx2 = false;
+
+                bool avx512 = false;
+
+                bool avx512ifma = false;
+            };
+
+            void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+            {
+#ifdef _MSC_VER
+                int info[4];
+                __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+                for (int i = 0; i < 4; i++)
+                {
+                    regs[i] = static_cast<uint32_t>(info[i]);
+                }
+#else
+                if (!__get_cpuid_count(leaf, subleaf, &regs[0], &regs[1], &regs[2], &regs[3]))
+                {
+                    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+                }
+#endif
+            }
+
+            // The register state enabled by the operating system
+            uint64_t xgetbv()
+            {
+#ifdef _MSC_VER
+                return _xgetbv(0);
+#else
+                uint32_t eax, edx;
+                __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+                return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+            }
+
+            CPUFeatures detect_cpu_features() noexcept
+            {
+                CPUFeatures features;
+                uint32_t regs[4];
+                cpuid(0, 0, regs);
+                if (regs[0] < 7)
+                {
+                    return features;
+                }
+
+                // The operating system must save the YMM (and for AVX-512 also the opmask and ZMM) registers
+                cpuid(1, 0, regs);
+                bool osxsave = (regs[2] >> 27) & 1;
+                bool avx = (regs[2] >> 28) & 1;
+                if (!osxsave || !avx)
+                {
+                    return features;
+                }
+                uint64_t xcr0 = xgetbv();
+                bool ymm_state = (xcr0 & 0x6) == 0x6;
+                bool zmm_state = (xcr0 & 0xE6) == 0xE6;
+
+                cpuid(7, 0, regs);
+                uint32_t ebx = regs[1];
+                features.avx2 = ymm_state && ((ebx >> 5) & 1);
+
+                // AVX-512F, DQ, BW, and VL
+                const uint32_t avx512_bits = (1U << 16) | (1U << 17) | (1U << 30) | (1U << 31);
+                features.avx512 = features.avx2 && zmm_state && ((ebx & avx512_bits) == avx512_bits);
+                features.avx512ifma = features.avx512 && ((ebx >> 21) & 1);
+                return features;
+            }
+
+            const CPUFeatures &cpu_features() noexcept
+            {
+                static const CPUFeatures features = detect_cpu_features();
+                return features;
+            }
+#endif
+
+            atomic<kernel_variant> &active_variant() noexcept
+            {
+                static atomic<kernel_variant> variant(best_kernel_variant());
+                return variant;
+            }
+        } // namespace
+
+        bool is_kernel_variant_supported(kernel_variant variant) noexcept
+        {
+            switch (variant)
+            {
+            case kernel_variant::scalar:
+                return true;
+#ifdef SEAL_USE_AVX2
+            case kernel_variant::avx2:
+                return cpu_features().avx2;
+#endif
+#ifdef SEAL_USE_AVX512
+            case kernel_variant::avx512:
+                return cpu_features().avx512;
+#endif
+#ifdef SEAL_USE_AVX512IFMA
+            case kernel_variant::avx512ifma:
+                return cpu_features().avx512ifma;
+#endif
+            default:
+                return false;
+            }
+        }
+
+        kernel_variant best_kernel_variant() noexcept
+        {
+            for (kernel_variant variant :
+                 { kernel_variant::avx512ifma, kernel_variant::avx512, kernel_variant::avx2 })
+            {
+                if (is_kernel_variant_supported(variant))
+                {
+                    return variant;
+                }
+            }
+            return kernel_variant::scalar;
+        }
+
+        kernel_variant active_kernel_variant() noexcept
+        {
+            return active_variant().load(memory_order_relaxed);
+        }
+
+        void set_active_kernel_variant(kernel_variant variant)
+        {
+            if (!is_kernel_variant_supported(variant))
+            {
+                throw invalid_argument("kernel variant is not supported");
+            }
+            active_variant().store(variant, memory_order_relaxed);
+        }
+    } // namespace util
+} // namespace seal
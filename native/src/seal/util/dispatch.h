@@ -0,0 +1,92 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+#include <cstdint>
+
+namespace seal
+{
+    /**
+    Identifies the family of kernels used for the negacyclic NTT, dyadic products, scalar multiplications, and RNS
+    base conversions. The best variant supported by both the build and the CPU is selected once per process, when the
+    first SEALContext is created or a kernel is first used. All variants compute the same results; lazily reduced NTT
+    outputs may differ by a multiple of the modulus. When Microsoft SEAL is built with Intel HEXL, HEXL is used for
+    the operations it covers regardless of the variant.
+    */
+    enum class kernel_variant : std::uint8_t
+    {
+        /**
+        Portable C++ implementation.
+        */
+        scalar = 0,
+
+        /**
+        AVX2 kernels.
+        */
+        avx2 = 1,
+
+        /**
+        AVX-512F/DQ/VL/BW kernels.
+        */
+        avx512 = 2,
+
+        /**
+        AVX-512 kernels with the 52-bit integer fused multiply-add instructions (IFMA) for moduli of at most 50 bits.
+        */
+        avx512ifma = 3
+    };
+
+    namespace util
+    {
+        /**
+        Returns true if the library was built with the given kernel variant and the CPU supports it.
+        */
+        SEAL_NODISCARD bool is_kernel_variant_supported(kernel_variant variant) noexcept;
+
+        /**
+        Returns the most capable kernel variant supported by the build and the CPU.
+        */
+        SEAL_NODISCARD kernel_variant best_kernel_variant() noexcept;
+
+        /**
+        Returns the kernel variant currently in use. The first call selects best_kernel_variant().
+        */
+        SEAL_NODISCARD kernel_variant active_kernel_variant() noexcept;
+
+        /**
+        Overrides the kernel variant, e.g., to compare variants in benchmarks. This must not be called while other
+        threads are running computations.
+
+        @param[in] variant The kernel variant to use
+        @throws std::invalid_argument if variant is not supported
+        */
+        void set_active_kernel_variant(kernel_variant variant);
+
+        /**
+        Restores the kernel variant that was active when the guard was created once the guard goes out of scope, so
+        that an override with set_active_kernel_variant stays local even if the scope is left early or by an exception.
+        The same restrictions on other threads as for set_active_kernel_variant apply.
+        */
+        class KernelVariantGuard
+        {
+        public:
+            KernelVariantGuard() noexcept : variant_(active_kernel_variant())
+            {}
+
+            ~KernelVariantGuard()
+            {
+                // The saved variant was active, so it is supported and this does not throw
+                set_active_kernel_variant(variant_);
+            }
+
+            KernelVariantGuard(const KernelVariantGuard &copy) = delete;
+
+            KernelVariantGuard &operator=(const KernelVariantGuard &assign) = delete;
+
+        private:
+            kernel_variant variant_;
+        };
+    } // namespace util
+} // namespace seal
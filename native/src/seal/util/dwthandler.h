@@ -10,7 +10,9 @@
 #include "seal/util/pointer.h"
 #include "seal/util/uintarithsmallmod.h"
 #include "seal/util/uintcore.h"
+#include <algorithm>
 #include <stdexcept>
+#include <type_traits>
 
 namespace seal
 {
@@ -355,7 +357,527 @@ namespace seal
                 }
             }
 
+            /**
+            Performs the same butterflies as transform_to_rev in a cache-friendly order and produces identical outputs.
+            The stages whose butterflies span more than a block of 2^log_block values are applied to narrow column
+            tiles of values at stride 2^log_block, so that every tile stays in the L1 cache through all of them. Each
+            block then goes through all remaining stages before the next block is touched. Every value is thus read
+            from memory twice instead of once per stage.
+
+            @param[values] inputs in normal order, outputs in bit-reversed order
+            @param[log_n] log 2 of the DWT size
+            @param[roots] powers of a root in bit-reversed order
+            @param[log_block] log 2 of the number of values in a block
+            @param[scalar] an optional scalar that is multiplied to all output values
+            */
+            void transform_to_rev_blocked(
+                ValueType *values, int log_n, const RootType *roots, int log_block,
+                const ScalarType *scalar = nullptr) const
+            {
+                if (log_block < 2 || log_block >= log_n)
+                {
+                    transform_to_rev(values, log_n, roots, scalar);
+                    return;
+                }
+
+                // constant transform size
+                std::size_t n = std::size_t(1) << log_n;
+                std::size_t block_size = std::size_t(1) << log_block;
+                std::size_t block_count = n >> log_block;
+                std::size_t tile_size = std::min(block_size, blocked_tile_size);
+
+                // The i-th group of the stage with m groups uses roots[m + i]
+                for (std::size_t col = 0; col < block_size; col += tile_size)
+                {
+                    std::size_t gap = n >> 1;
+                    for (std::size_t m = 1; m < block_count; m <<= 1, gap >>= 1)
+                    {
+                        for (std::size_t i = 0; i < m; i++)
+                        {
+                            for (std::size_t offset = col; offset < gap; offset += block_size)
+                            {
+                                forward_butterflies(values + 2 * gap * i + offset, gap, tile_size, roots[m + i]);
+                            }
+                        }
+                    }
+                }
+
+                // Block b holds the groups [b * m / block_count, (b + 1) * m / block_count) of the remaining stages
+                for (std::size_t b = 0; b < block_count; b++)
+                {
+                    std::size_t m = block_count;
+                    std::size_t gap = block_size >> 1;
+                    for (; m < (n >> 1); m <<= 1, gap >>= 1)
+                    {
+                        std::size_t group_count = m >> (log_n - log_block);
+                        for (std::size_t i = b * group_count; i < (b + 1) * group_count; i++)
+                        {
+                            forward_butterflies(values + 2 * gap * i, gap, gap, roots[m + i]);
+                        }
+                    }
+
+                    RootType r;
+                    ValueType u;
+                    ValueType v;
+                    ValueType *x = values + b * block_size;
+                    const RootType *last_roots = roots + m + b * (block_size >> 1);
+                    if (scalar != nullptr)
+                    {
+                        for (std::size_t i = 0; i < (block_size >> 1); i++)
+                        {
+                            r = arithmetic_.mul_root_scalar(last_roots[i], *scalar);
+                            u = arithmetic_.mul_scalar(arithmetic_.guard(x[0]), *scalar);
+                            v = arithmetic_.mul_root(x[1], r);
+                            x[0] = arithmetic_.add(u, v);
+                            x[1] = arithmetic_.sub(u, v);
+                            x += 2;
+                        }
+                    }
+                    else
+                    {
+                        for (std::size_t i = 0; i < (block_size >> 1); i++)
+                        {
+                            r = last_roots[i];
+                            u = arithmetic_.guard(x[0]);
+                            v = arithmetic_.mul_root(x[1], r);
+                            x[0] = arithmetic_.add(u, v);
+                            x[1] = arithmetic_.sub(u, v);
+                            x += 2;
+                        }
+                    }
+                }
+            }
+
+            /**
+            Performs the same butterflies as transform_from_rev in a cache-friendly order and produces identical
+            outputs. Each block of 2^log_block values first goes through all stages whose butterflies stay within it.
+            The remaining stages are then applied to narrow column tiles of values at stride 2^log_block.
+
+            @param[values] inputs in bit-reversed order, outputs in normal order
+            @param[log_n] log 2 of the DWT size
+            @param[roots] powers of a root in scrambled order
+            @param[log_block] log 2 of the number of values in a block
+            @param[scalar] an optional scalar that is multiplied to all output values
+            */
+            void transform_from_rev_blocked(
+                ValueType *values, int log_n, const RootType *roots, int log_block,
+                const ScalarType *scalar = nullptr) const
+            {
+                if (log_block < 2 || log_block >= log_n)
+                {
+                    transform_from_rev(values, log_n, roots, scalar);
+                    return;
+                }
+
+                // constant transform size
+                std::size_t n = std::size_t(1) << log_n;
+                std::size_t block_size = std::size_t(1) << log_block;
+                std::size_t block_count = n >> log_block;
+                std::size_t tile_size = std::min(block_size, blocked_tile_size);
+
+                // The i-th group of the stage with m groups uses roots[n - 2 * m + 1 + i]
+                for (std::size_t b = 0; b < block_count; b++)
+                {
+                    std::size_t gap = 1;
+                    for (std::size_t m = n >> 1; m >= block_count; m >>= 1, gap <<= 1)
+                    {
+                        std::size_t group_count = m >> (log_n - log_block);
+                        const RootType *stage_roots = roots + (n - 2 * m + 1);
+                        for (std::size_t i = b * group_count; i < (b + 1) * group_count; i++)
+                        {
+                            inverse_butterflies(values + 2 * gap * i, gap, gap, stage_roots[i]);
+                        }
+                    }
+                }
+
+                RootType r = roots[n - 1];
+                RootType scaled_r;
+                if (scalar != nullptr)
+                {
+                    scaled_r = arithmetic_.mul_root_scalar(r, *scalar);
+                }
+                for (std::size_t col = 0; col < block_size; col += tile_size)
+                {
+                    std::size_t gap = block_size;
+                    for (std::size_t m = block_count >> 1; m > 1; m >>= 1, gap <<= 1)
+                    {
+                        const RootType *stage_roots = roots + (n - 2 * m + 1);
+                        for (std::size_t i = 0; i < m; i++)
+                        {
+                            for (std::size_t offset = col; offset < gap; offset += block_size)
+                            {
+                                inverse_butterflies(values + 2 * gap * i + offset, gap, tile_size, stage_roots[i]);
+                            }
+                        }
+                    }
+
+                    for (std::size_t offset = col; offset < gap; offset += block_size)
+                    {
+                        if (scalar != nullptr)
+                        {
+                            ValueType u;
+                            ValueType v;
+                            ValueType *x = values + offset;
+                            ValueType *y = x + gap;
+                            for (std::size_t j = 0; j < tile_size; j++)
+                            {
+                                u = arithmetic_.guard(*x);
+                                v = *y;
+                                *x++ = arithmetic_.mul_scalar(arithmetic_.guard(arithmetic_.add(u, v)), *scalar);
+                                *y++ = arithmetic_.mul_root(arithmetic_.sub(u, v), scaled_r);
+                            }
+                        }
+                        else
+                        {
+                            inverse_butterflies(values + offset, gap, tile_size, r);
+                        }
+                    }
+                }
+            }
+
+            /**
+            Performs the same butterflies as transform_to_rev and produces identical outputs, but merges LogRadix
+            consecutive stages into one pass over the values (a radix-2^LogRadix transform). Each pass loads 2^LogRadix
+            values, applies all butterflies of the merged stages to them in registers, and stores them back, so every
+            butterfly still guards its inputs and the outputs stay within the same lazy bounds. Stages that remain when
+            log_n is not a multiple of LogRadix are performed one at a time.
+
+            @param[values] inputs in normal order, outputs in bit-reversed order
+            @param[log_n] log 2 of the DWT size
+            @param[roots] powers of a root in bit-reversed order
+            @param[scalar] an optional scalar that is multiplied to all output values
+            */
+            template <int LogRadix>
+            void transform_to_rev_radix(
+                ValueType *values, int log_n, const RootType *roots, const ScalarType *scalar = nullptr) const
+            {
+                static_assert(LogRadix >= 1 && LogRadix <= 3, "LogRadix must be 1, 2, or 3");
+                constexpr std::size_t radix = std::size_t(1) << LogRadix;
+
+                // constant transform size
+                std::size_t n = std::size_t(1) << log_n;
+                // registers to hold temporary values
+                RootType r[radix - 1];
+                ValueType v[radix];
+                ValueType u;
+                ValueType w;
+                // the last stage merges the multiplication by the scalar
+                int stage_count = (scalar != nullptr) ? log_n - 1 : log_n;
+                int stage = 0;
+                std::size_t m = 1;
+                std::size_t gap = n >> 1;
+
+                // The i-th group of the stage with m groups uses roots[m + i]
+                for (; stage + LogRadix <= stage_count; stage += LogRadix, m <<= LogRadix, gap >>= LogRadix)
+                {
+                    std::size_t stride = gap >> (LogRadix - 1);
+                    for (std::size_t i = 0; i < m; i++)
+                    {
+                        // The merged stage t uses 2^t roots, stored from r[2^t - 1] on
+                        for (int t = 0; t < LogRadix; t++)
+                        {
+                            for (std::size_t g = 0; g < (std::size_t(1) << t); g++)
+                            {
+                                r[(std::size_t(1) << t) - 1 + g] = roots[(m << t) + (i << t) + g];
+                            }
+                        }
+
+                        ValueType *x = values + 2 * gap * i;
+                        for (std::size_t j = 0; j < stride; j++, x++)
+                        {
+                            for (std::size_t k = 0; k < radix; k++)
+                            {
+                                v[k] = x[k * stride];
+                            }
+                            forward_merged(v, r, std::integral_constant<int, LogRadix>{});
+                            for (std::size_t k = 0; k < radix; k++)
+                            {
+                                x[k * stride] = v[k];
+                            }
+                        }
+                    }
+                }
+
+                for (; stage < stage_count; stage++, m <<= 1, gap >>= 1)
+                {
+                    for (std::size_t i = 0; i < m; i++)
+                    {
+                        forward_butterflies(values + 2 * gap * i, gap, gap, roots[m + i]);
+                    }
+                }
+
+                if (scalar != nullptr)
+                {
+                    RootType scaled_r;
+                    for (std::size_t i = 0; i < m; i++)
+                    {
+                        scaled_r = arithmetic_.mul_root_scalar(roots[m + i], *scalar);
+                        u = arithmetic_.mul_scalar(arithmetic_.guard(values[0]), *scalar);
+                        w = arithmetic_.mul_root(values[1], scaled_r);
+                        values[0] = arithmetic_.add(u, w);
+                        values[1] = arithmetic_.sub(u, w);
+                        values += 2;
+                    }
+                }
+            }
+
+            /**
+            Performs the same butterflies as transform_from_rev and produces identical outputs, but merges LogRadix
+            consecutive stages into one pass over the values (a radix-2^LogRadix transform). Stages that remain when
+            log_n is not a multiple of LogRadix are performed one at a time.
+
+            @param[values] inputs in bit-reversed order, outputs in normal order
+            @param[log_n] log 2 of the DWT size
+            @param[roots] powers of a root in scrambled order
+            @param[scalar] an optional scalar that is multiplied to all output values
+            */
+            template <int LogRadix>
+            void transform_from_rev_radix(
+                ValueType *values, int log_n, const RootType *roots, const ScalarType *scalar = nullptr) const
+            {
+                static_assert(LogRadix >= 1 && LogRadix <= 3, "LogRadix must be 1, 2, or 3");
+                constexpr std::size_t radix = std::size_t(1) << LogRadix;
+
+                // constant transform size
+                std::size_t n = std::size_t(1) << log_n;
+                // registers to hold temporary values
+                RootType r[radix - 1];
+                ValueType v[radix];
+                ValueType u;
+                ValueType w;
+                // the last stage merges the multiplication by the scalar
+                int stage_count = (scalar != nullptr) ? log_n - 1 : log_n;
+                int stage = 0;
+                std::size_t m = n >> 1;
+                std::size_t gap = 1;
+
+                // The i-th group of the stage with m groups uses roots[n - 2 * m + 1 + i]
+                for (; stage + LogRadix <= stage_count; stage += LogRadix, m >>= LogRadix, gap <<= LogRadix)
+                {
+                    std::size_t group_count = m >> (LogRadix - 1);
+                    for (std::size_t i = 0; i < group_count; i++)
+                    {
+                        // The merged stage t uses radix / 2^(t + 1) roots, stored from r[radix - radix / 2^t] on
+                        for (int t = 0; t < LogRadix; t++)
+                        {
+                            const RootType *stage_roots = roots + (n - 2 * (m >> t) + 1);
+                            for (std::size_t g = 0; g < (radix >> (t + 1)); g++)
+                            {
+                                r[radix - (radix >> t) + g] = stage_roots[i * (radix >> (t + 1)) + g];
+                            }
+                        }
+
+                        ValueType *x = values + radix * gap * i;
+                        for (std::size_t j = 0; j < gap; j++, x++)
+                        {
+                            for (std::size_t k = 0; k < radix; k++)
+                            {
+                                v[k] = x[k * gap];
+                            }
+                            inverse_merged(v, r, std::integral_constant<int, LogRadix>{});
+                            for (std::size_t k = 0; k < radix; k++)
+                            {
+                                x[k * gap] = v[k];
+                            }
+                        }
+                    }
+                }
+
+                for (; stage < stage_count; stage++, m >>= 1, gap <<= 1)
+                {
+                    const RootType *stage_roots = roots + (n - 2 * m + 1);
+                    for (std::size_t i = 0; i < m; i++)
+                    {
+                        inverse_butterflies(values + 2 * gap * i, gap, gap, stage_roots[i]);
+                    }
+                }
+
+                if (scalar != nullptr)
+                {
+                    RootType scaled_r = arithmetic_.mul_root_scalar(roots[n - 1], *scalar);
+                    ValueType *x = values;
+                    ValueType *y = x + gap;
+                    for (std::size_t j = 0; j < gap; j++)
+                    {
+                        u = arithmetic_.guard(*x);
+                        w = *y;
+                        *x++ = arithmetic_.mul_scalar(arithmetic_.guard(arithmetic_.add(u, w)), *scalar);
+                        *y++ = arithmetic_.mul_root(arithmetic_.sub(u, w), scaled_r);
+                    }
+                }
+            }
+
         private:
+            // Number of consecutive values processed together in the stages that span more than a block
+            static constexpr std::size_t blocked_tile_size = 16;
+
+            inline void forward_butterfly(ValueType &x, ValueType &y, const RootType &r) const
+            {
+                ValueType u = arithmetic_.guard(x);
+                ValueType v = arithmetic_.mul_root(y, r);
+                x = arithmetic_.add(u, v);
+                y = arithmetic_.sub(u, v);
+            }
+
+            inline void inverse_butterfly(ValueType &x, ValueType &y, const RootType &r) const
+            {
+                ValueType u = x;
+                ValueType v = y;
+                x = arithmetic_.guard(arithmetic_.add(u, v));
+                y = arithmetic_.mul_root(arithmetic_.sub(u, v), r);
+            }
+
+            // The merged forward stages of transform_to_rev_radix; the roots of stage t start at r[2^t - 1]
+            inline void forward_merged(ValueType *v, const RootType *r, std::integral_constant<int, 1>) const
+            {
+                forward_butterfly(v[0], v[1], r[0]);
+            }
+
+            inline void forward_merged(ValueType *v, const RootType *r, std::integral_constant<int, 2>) const
+            {
+                forward_butterfly(v[0], v[2], r[0]);
+                forward_butterfly(v[1], v[3], r[0]);
+                forward_butterfly(v[0], v[1], r[1]);
+                forward_butterfly(v[2], v[3], r[2]);
+            }
+
+            inline void forward_merged(ValueType *v, const RootType *r, std::integral_constant<int, 3>) const
+            {
+                forward_butterfly(v[0], v[4], r[0]);
+                forward_butterfly(v[1], v[5], r[0]);
+                forward_butterfly(v[2], v[6], r[0]);
+                forward_butterfly(v[3], v[7], r[0]);
+                forward_butterfly(v[0], v[2], r[1]);
+                forward_butterfly(v[1], v[3], r[1]);
+                forward_butterfly(v[4], v[6], r[2]);
+                forward_butterfly(v[5], v[7], r[2]);
+                forward_butterfly(v[0], v[1], r[3]);
+                forward_butterfly(v[2], v[3], r[4]);
+                forward_butterfly(v[4], v[5], r[5]);
+                forward_butterfly(v[6], v[7], r[6]);
+            }
+
+            // The merged inverse stages of transform_from_rev_radix; the roots of stage t start at
+            // r[radix - radix / 2^t]
+            inline void inverse_merged(ValueType *v, const RootType *r, std::integral_constant<int, 1>) const
+            {
+                inverse_butterfly(v[0], v[1], r[0]);
+            }
+
+            inline void inverse_merged(ValueType *v, const RootType *r, std::integral_constant<int, 2>) const
+            {
+                inverse_butterfly(v[0], v[1], r[0]);
+                inverse_butterfly(v[2], v[3], r[1]);
+                inverse_butterfly(v[0], v[2], r[2]);
+                inverse_butterfly(v[1], v[3], r[2]);
+            }
+
+            inline void inverse_merged(ValueType *v, const RootType *r, std::integral_constant<int, 3>) const
+            {
+                inverse_butterfly(v[0], v[1], r[0]);
+                inverse_butterfly(v[2], v[3], r[1]);
+                inverse_butterfly(v[4], v[5], r[2]);
+                inverse_butterfly(v[6], v[7], r[3]);
+                inverse_butterfly(v[0], v[2], r[4]);
+                inverse_butterfly(v[1], v[3], r[4]);
+                inverse_butterfly(v[4], v[6], r[5]);
+                inverse_butterfly(v[5], v[7], r[5]);
+                inverse_butterfly(v[0], v[4], r[6]);
+                inverse_butterfly(v[1], v[5], r[6]);
+                inverse_butterfly(v[2], v[6], r[6]);
+                inverse_butterfly(v[3], v[7], r[6]);
+            }
+
+            // Applies count forward butterflies with the given root to values[j] and values[j + gap] for j < count
+            inline void forward_butterflies(
+                ValueType *values, std::size_t gap, std::size_t count, const RootType &r) const
+            {
+                ValueType u;
+                ValueType v;
+                ValueType *x = values;
+                ValueType *y = x + gap;
+                if (count < 4)
+                {
+                    for (std::size_t j = 0; j < count; j++)
+                    {
+                        u = arithmetic_.guard(*x);
+                        v = arithmetic_.mul_root(*y, r);
+                        *x++ = arithmetic_.add(u, v);
+                        *y++ = arithmetic_.sub(u, v);
+                    }
+                }
+                else
+                {
+                    for (std::size_t j = 0; j < count; j += 4)
+                    {
+                        u = arithmetic_.guard(*x);
+                        v = arithmetic_.mul_root(*y, r);
+                        *x++ = arithmetic_.add(u, v);
+                        *y++ = arithmetic_.sub(u, v);
+
+                        u = arithmetic_.guard(*x);
+                        v = arithmetic_.mul_root(*y, r);
+                        *x++ = arithmetic_.add(u, v);
+                        *y++ = arithmetic_.sub(u, v);
+
+                        u = arithmetic_.guard(*x);
+                        v = arithmetic_.mul_root(*y, r);
+                        *x++ = arithmetic_.add(u, v);
+                        *y++ = arithmetic_.sub(u, v);
+
+                        u = arithmetic_.guard(*x);
+                        v = arithmetic_.mul_root(*y, r);
+                        *x++ = arithmetic_.add(u, v);
+                        *y++ = arithmetic_.sub(u, v);
+                    }
+                }
+            }
+
+            // Applies count inverse butterflies with the given root to values[j] and values[j + gap] for j < count
+            inline void inverse_butterflies(
+                ValueType *values, std::size_t gap, std::size_t count, const RootType &r) const
+            {
+                ValueType u;
+                ValueType v;
+                ValueType *x = values;
+                ValueType *y = x + gap;
+                if (count < 4)
+                {
+                    for (std::size_t j = 0; j < count; j++)
+                    {
+                        u = *x;
+                        v = *y;
+                        *x++ = arithmetic_.guard(arithmetic_.add(u, v));
+                        *y++ = arithmetic_.mul_root(arithmetic_.sub(u, v), r);
+                    }
+                }
+                else
+                {
+                    for (std::size_t j = 0; j < count; j += 4)
+                    {
+                        u = *x;
+                        v = *y;
+                        *x++ = arithmetic_.guard(arithmetic_.add(u, v));
+                        *y++ = arithmetic_.mul_root(arithmetic_.sub(u, v), r);
+
+                        u = *x;
+                        v = *y;
+                        *x++ = arithmetic_.guard(arithmetic_.add(u, v));
+                        *y++ = arithmetic_.mul_root(arithmetic_.sub(u, v), r);
+
+                        u = *x;
+                        v = *y;
+                        *x++ = arithmetic_.guard(arithmetic_.add(u, v));
+                        *y++ = arithmetic_.mul_root(arithmetic_.sub(u, v), r);
+
+                        u = *x;
+                        v = *y;
+                        *x++ = arithmetic_.guard(arithmetic_.add(u, v));
+                        *y++ = arithmetic_.mul_root(arithmetic_.sub(u, v), r);
+                    }
+                }
+            }
+
             Arithmetic<ValueType, RootType, ScalarType> arithmetic_;
         };
     } // namespace util
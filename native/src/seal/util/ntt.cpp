@@ -1,7 +1,9 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+#include "seal/util/dispatch.h"
 #include "seal/util/ntt.h"
+#include "seal/util/simd.h"
 #include "seal/util/uintarith.h"
 #include "seal/util/uintarithsmallmod.h"
 #include <algorithm>
@@ -286,6 +288,20 @@ namespace seal
             }
             inv_root_powers_[0].set(static_cast<uint64_t>(1), modulus_);
 
+            // The 32-bit Shoup quotients floor(w * 2^32 / q) are the high words of the 64-bit ones.
+            if (modulus_.bit_count() <= SEAL_SMALL_MOD_BIT_COUNT_MAX)
+            {
+                root_powers32_ = allocate<uint32_t>(coeff_count_ << 1, pool_);
+                inv_root_powers32_ = allocate<uint32_t>(coeff_count_ << 1, pool_);
+                for (size_t i = 0; i < coeff_count_; i++)
+                {
+                    root_powers32_[i] = static_cast<uint32_t>(root_powers_[i].operand);
+                    root_powers32_[coeff_count_ + i] = static_cast<uint32_t>(root_powers_[i].quotient >> 32);
+                    inv_root_powers32_[i] = static_cast<uint32_t>(inv_root_powers_[i].operand);
+                    inv_root_powers32_[coeff_count_ + i] = static_cast<uint32_t>(inv_root_powers_[i].quotient >> 32);
+                }
+            }
+
             // Compute n^(-1) modulo q.
             uint64_t degree_uint = static_cast<uint64_t>(coeff_count_);
             if (!try_invert_uint_mod(degree_uint, modulus_, inv_degree_modulo_.operand))
@@ -399,8 +415,7 @@ namespace seal
 
             intel::seal_ext::compute_forward_ntt(operand, N, p, root, 4, 4);
 #else
-            tables.ntt_handler().transform_to_rev(
-                operand.ptr(), tables.coeff_count_power(), tables.get_from_root_powers());
+            ntt_negacyclic_harvey_new(operand, tables);
 #endif
         }
 
@@ -443,9 +458,7 @@ namespace seal
             uint64_t root = tables.get_root();
             intel::seal_ext::compute_inverse_ntt(operand, N, p, root, 2, 2);
 #else
-            MultiplyUIntModOperand inv_degree_modulo = tables.inv_degree_modulo();
-            tables.ntt_handler().transform_from_rev(
-                operand.ptr(), tables.coeff_count_power(), tables.get_from_inv_root_powers(), &inv_degree_modulo);
+            inverse_ntt_negacyclic_harvey_new(operand, tables);
 #endif
         }
 
@@ -472,5 +485,352 @@ namespace seal
             });
 #endif
         }
+
+        namespace
+        {
+            using ForwardKernel = void (*)(uint64_t *, int, const MultiplyUIntModOperand *, uint64_t);
+
+            using InverseKernel = void (*)(
+                uint64_t *, int, const MultiplyUIntModOperand *, MultiplyUIntModOperand, MultiplyUIntModOperand,
+                uint64_t);
+
+            using ForwardKernel32 = void (*)(uint64_t *, int, const uint32_t *, uint32_t);
+
+            using InverseKernel32 = void (*)(
+                uint64_t *, int, const uint32_t *, MultiplyUIntModOperand, MultiplyUIntModOperand, uint32_t);
+
+            // Returns the 32-bit lane forward kernel of the active kernel variant if the modulus is small enough, or
+            // nullptr otherwise. These kernels process twice as many values per vector as the 64-bit ones.
+            ForwardKernel32 select_forward_kernel32(const NTTTables &tables)
+            {
+                if (!tables.get_from_root_powers32())
+                {
+                    return nullptr;
+                }
+                SEAL_MAYBE_UNUSED int coeff_count_power = tables.coeff_count_power();
+                SEAL_MAYBE_UNUSED kernel_variant variant = active_kernel_variant();
+#ifdef SEAL_USE_AVX512
+                if (variant >= kernel_variant::avx512 && coeff_count_power >= avx512::ntt32_min_coeff_count_power)
+                {
+                    return avx512::ntt_negacyclic_harvey_lazy32;
+                }
+#endif
+#ifdef SEAL_USE_AVX2
+                if (variant >= kernel_variant::avx2 && coeff_count_power >= avx2::ntt32_min_coeff_count_power)
+                {
+                    return avx2::ntt_negacyclic_harvey_lazy32;
+                }
+#endif
+                return nullptr;
+            }
+
+            InverseKernel32 select_inverse_kernel32(const NTTTables &tables)
+            {
+                if (!tables.get_from_inv_root_powers32())
+                {
+                    return nullptr;
+                }
+                SEAL_MAYBE_UNUSED int coeff_count_power = tables.coeff_count_power();
+                SEAL_MAYBE_UNUSED kernel_variant variant = active_kernel_variant();
+#ifdef SEAL_USE_AVX512
+                if (variant >= kernel_variant::avx512 && coeff_count_power >= avx512::ntt32_min_coeff_count_power)
+                {
+                    return avx512::inverse_ntt_negacyclic_harvey_lazy32;
+                }
+#endif
+#ifdef SEAL_USE_AVX2
+                if (variant >= kernel_variant::avx2 && coeff_count_power >= avx2::ntt32_min_coeff_count_power)
+                {
+                    return avx2::inverse_ntt_negacyclic_harvey_lazy32;
+                }
+#endif
+                return nullptr;
+            }
+
+            // Returns the vectorized forward kernel of the active kernel variant, or nullptr if the transform must
+            // use the scalar DWTHandler
+            ForwardKernel select_forward_kernel(const NTTTables &tables)
+            {
+                SEAL_MAYBE_UNUSED int coeff_count_power = tables.coeff_count_power();
+                SEAL_MAYBE_UNUSED kernel_variant variant = active_kernel_variant();
+#ifdef SEAL_USE_AVX512IFMA
+                if (variant == kernel_variant::avx512ifma &&
+                    coeff_count_power >= avx512ifma::ntt_min_coeff_count_power &&
+                    tables.modulus().bit_count() <= avx512ifma::max_modulus_bit_count)
+                {
+                    return avx512ifma::ntt_negacyclic_harvey_lazy;
+                }
+#endif
+#ifdef SEAL_USE_AVX512
+                if (variant >= kernel_variant::avx512 && coeff_count_power >= avx512::ntt_min_coeff_count_power)
+                {
+                    return avx512::ntt_negacyclic_harvey_lazy;
+                }
+#endif
+#ifdef SEAL_USE_AVX2
+                if (variant >= kernel_variant::avx2 && coeff_count_power >= avx2::ntt_min_coeff_count_power)
+                {
+                    return avx2::ntt_negacyclic_harvey_lazy;
+                }
+#endif
+                return nullptr;
+            }
+
+            InverseKernel select_inverse_kernel(const NTTTables &tables)
+            {
+                SEAL_MAYBE_UNUSED int coeff_count_power = tables.coeff_count_power();
+                SEAL_MAYBE_UNUSED kernel_variant variant = active_kernel_variant();
+#ifdef SEAL_USE_AVX512IFMA
+                if (variant == kernel_variant::avx512ifma &&
+                    coeff_count_power >= avx512ifma::ntt_min_coeff_count_power &&
+                    tables.modulus().bit_count() <= avx512ifma::max_modulus_bit_count)
+                {
+                    return avx512ifma::inverse_ntt_negacyclic_harvey_lazy;
+                }
+#endif
+#ifdef SEAL_USE_AVX512
+                if (variant >= kernel_variant::avx512 && coeff_count_power >= avx512::ntt_min_coeff_count_power)
+                {
+                    return avx512::inverse_ntt_negacyclic_harvey_lazy;
+                }
+#endif
+#ifdef SEAL_USE_AVX2
+                if (variant >= kernel_variant::avx2 && coeff_count_power >= avx2::ntt_min_coeff_count_power)
+                {
+                    return avx2::inverse_ntt_negacyclic_harvey_lazy;
+                }
+#endif
+                return nullptr;
+            }
+
+            // Computes the forward NTT of count polynomials modulo the modulus of tables, the i-th one starting at
+            // operand + i * stride. The kernel is selected once for the whole batch and each polynomial is fully
+            // reduced, if requested, while it is still in the cache.
+            void forward_limbs_new(
+                uint64_t *operand, size_t count, size_t stride, const NTTTables &tables, bool reduce)
+            {
+                int coeff_count_power = tables.coeff_count_power();
+                size_t coeff_count = tables.coeff_count();
+                const MultiplyUIntModOperand *root_powers = tables.get_from_root_powers();
+                uint64_t modulus = tables.modulus().value();
+                uint64_t two_times_modulus = modulus << 1;
+                ForwardKernel32 kernel32 = select_forward_kernel32(tables);
+                ForwardKernel kernel = kernel32 ? nullptr : select_forward_kernel(tables);
+                for (size_t i = 0; i < count; i++, operand += stride)
+                {
+                    if (kernel32)
+                    {
+                        kernel32(
+                            operand, coeff_count_power, tables.get_from_root_powers32(),
+                            static_cast<uint32_t>(modulus));
+                    }
+                    else if (kernel)
+                    {
+                        kernel(operand, coeff_count_power, root_powers, modulus);
+                    }
+                    else
+                    {
+                        // Scalar kernels, or too small for the vectorized ones
+                        tables.ntt_handler().transform_to_rev_blocked(
+                            operand, coeff_count_power, root_powers, ntt_block_coeff_count_power);
+                    }
+                    if (reduce)
+                    {
+                        SEAL_ITERATE(operand, coeff_count, [&](auto &I) {
+                            I -= SEAL_COND_SELECT(I >= two_times_modulus, two_times_modulus, 0);
+                            I -= SEAL_COND_SELECT(I >= modulus, modulus, 0);
+                        });
+                    }
+                }
+            }
+
+            void inverse_limbs_new(
+                uint64_t *operand, size_t count, size_t stride, const NTTTables &tables, bool reduce)
+            {
+                int coeff_count_power = tables.coeff_count_power();
+                size_t coeff_count = tables.coeff_count();
+                const Modulus &modulus = tables.modulus();
+                const MultiplyUIntModOperand *inv_root_powers = tables.get_from_inv_root_powers();
+                MultiplyUIntModOperand inv_degree_modulo = tables.inv_degree_modulo();
+                InverseKernel32 kernel32 = select_inverse_kernel32(tables);
+                InverseKernel kernel = kernel32 ? nullptr : select_inverse_kernel(tables);
+
+                // The vectorized kernels merge n^(-1) into the root of the last stage
+                MultiplyUIntModOperand scaled_inv_root;
+                if (kernel32 || kernel)
+                {
+                    scaled_inv_root.set(
+                        multiply_uint_mod(inv_root_powers[coeff_count - 1].operand, inv_degree_modulo, modulus),
+                        modulus);
+                }
+                for (size_t i = 0; i < count; i++, operand += stride)
+                {
+                    if (kernel32)
+                    {
+                        kernel32(
+                            operand, coeff_count_power, tables.get_from_inv_root_powers32(), inv_degree_modulo,
+                            scaled_inv_root, static_cast<uint32_t>(modulus.value()));
+                    }
+                    else if (kernel)
+                    {
+                        kernel(
+                            operand, coeff_count_power, inv_root_powers, inv_degree_modulo, scaled_inv_root,
+                            modulus.value());
+                    }
+                    else
+                    {
+                        // Scalar kernels, or too small for the vectorized ones
+                        tables.ntt_handler().transform_from_rev_blocked(
+                            operand, coeff_count_power, inv_root_powers, ntt_block_coeff_count_power,
+                            &inv_degree_modulo);
+                    }
+                    if (reduce)
+                    {
+                        uint64_t q = modulus.value();
+                        SEAL_ITERATE(operand, coeff_count, [&](auto &I) { I -= SEAL_COND_SELECT(I >= q, q, 0); });
+                    }
+                }
+            }
+
+            // The batched transforms, using Intel HEXL if enabled
+            void forward_limbs(uint64_t *operand, size_t count, size_t stride, const NTTTables &tables, bool reduce)
+            {
+#ifdef SEAL_USE_INTEL_HEXL
+                for (size_t i = 0; i < count; i++, operand += stride)
+                {
+                    if (reduce)
+                    {
+                        util::ntt_negacyclic_harvey(CoeffIter(operand), tables);
+                    }
+                    else
+                    {
+                        util::ntt_negacyclic_harvey_lazy(CoeffIter(operand), tables);
+                    }
+                }
+#else
+                forward_limbs_new(operand, count, stride, tables, reduce);
+#endif
+            }
+
+            void inverse_limbs(uint64_t *operand, size_t count, size_t stride, const NTTTables &tables, bool reduce)
+            {
+#ifdef SEAL_USE_INTEL_HEXL
+                for (size_t i = 0; i < count; i++, operand += stride)
+                {
+                    if (reduce)
+                    {
+                        util::inverse_ntt_negacyclic_harvey(CoeffIter(operand), tables);
+                    }
+                    else
+                    {
+                        util::inverse_ntt_negacyclic_harvey_lazy(CoeffIter(operand), tables);
+                    }
+                }
+#else
+                inverse_limbs_new(operand, count, stride, tables, reduce);
+#endif
+            }
+
+            using LimbTransform = void (*)(uint64_t *, size_t, size_t, const NTTTables &, bool);
+
+            // Transforms all polynomials one RNS component at a time, so that each batch shares one kernel selection
+            // and the tables of each modulus stay in the cache
+            void transform_rns_components(
+                PolyIter operand, size_t size, ConstNTTTablesIter tables, bool reduce, LimbTransform transform)
+            {
+#ifdef SEAL_DEBUG
+                if (!operand && size > 0)
+                {
+                    throw invalid_argument("operand");
+                }
+                if (!tables)
+                {
+                    throw invalid_argument("tables");
+                }
+#endif
+                size_t coeff_count = operand.poly_modulus_degree();
+                size_t coeff_modulus_size = operand.coeff_modulus_size();
+                size_t poly_stride = coeff_count * coeff_modulus_size;
+                uint64_t *data = operand;
+                SEAL_ITERATE(iter(size_t(0), tables), coeff_modulus_size, [&](auto I) {
+                    transform(data + get<0>(I) * coeff_count, size, poly_stride, get<1>(I), reduce);
+                });
+            }
+
+        } // namespace
+
+        void ntt_negacyclic_harvey_lazy(RNSIter operand, size_t count, const NTTTables &tables)
+        {
+#ifdef SEAL_DEBUG
+            if (!operand && count > 0)
+            {
+                throw invalid_argument("operand");
+            }
+#endif
+            forward_limbs(operand, count, operand.poly_modulus_degree(), tables, false);
+        }
+
+        void ntt_negacyclic_harvey(RNSIter operand, size_t count, const NTTTables &tables)
+        {
+#ifdef SEAL_DEBUG
+            if (!operand && count > 0)
+            {
+                throw invalid_argument("operand");
+            }
+#endif
+            forward_limbs(operand, count, operand.poly_modulus_degree(), tables, true);
+        }
+
+        void inverse_ntt_negacyclic_harvey_lazy(RNSIter operand, size_t count, const NTTTables &tables)
+        {
+#ifdef SEAL_DEBUG
+            if (!operand && count > 0)
+            {
+                throw invalid_argument("operand");
+            }
+#endif
+            inverse_limbs(operand, count, operand.poly_modulus_degree(), tables, false);
+        }
+
+        void inverse_ntt_negacyclic_harvey(RNSIter operand, size_t count, const NTTTables &tables)
+        {
+#ifdef SEAL_DEBUG
+            if (!operand && count > 0)
+            {
+                throw invalid_argument("operand");
+            }
+#endif
+            inverse_limbs(operand, count, operand.poly_modulus_degree(), tables, true);
+        }
+
+        void ntt_negacyclic_harvey_lazy(PolyIter operand, size_t size, ConstNTTTablesIter tables)
+        {
+            transform_rns_components(operand, size, tables, false, forward_limbs);
+        }
+
+        void ntt_negacyclic_harvey(PolyIter operand, size_t size, ConstNTTTablesIter tables)
+        {
+            transform_rns_components(operand, size, tables, true, forward_limbs);
+        }
+
+        void inverse_ntt_negacyclic_harvey_lazy(PolyIter operand, size_t size, ConstNTTTablesIter tables)
+        {
+            transform_rns_components(operand, size, tables, false, inverse_limbs);
+        }
+
+        void inverse_ntt_negacyclic_harvey(PolyIter operand, size_t size, ConstNTTTablesIter tables)
+        {
+            transform_rns_components(operand, size, tables, true, inverse_limbs);
+        }
+
+        void ntt_negacyclic_harvey_new(CoeffIter operand, const NTTTables &tables)
+        {
+            forward_limbs_new(operand, 1, 0, tables, false);
+        }
+
+        void inverse_ntt_negacyclic_harvey_new(CoeffIter operand, const NTTTables &tables)
+        {
+            inverse_limbs_new(operand, 1, 0, tables, false);
+        }
     } // namespace util
 } // namespace seal
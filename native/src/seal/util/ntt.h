@@ -83,6 +83,15 @@ namespace seal
 
                 std::copy_n(copy.root_powers_.get(), coeff_count_, root_powers_.get());
                 std::copy_n(copy.inv_root_powers_.get(), coeff_count_, inv_root_powers_.get());
+
+                if (copy.root_powers32_)
+                {
+                    root_powers32_ = allocate<std::uint32_t>(coeff_count_ << 1, pool_);
+                    inv_root_powers32_ = allocate<std::uint32_t>(coeff_count_ << 1, pool_);
+
+                    std::copy_n(copy.root_powers32_.get(), coeff_count_ << 1, root_powers32_.get());
+                    std::copy_n(copy.inv_root_powers32_.get(), coeff_count_ << 1, inv_root_powers32_.get());
+                }
             }
 
             NTTTables(int coeff_count_power, const Modulus &modulus, MemoryPoolHandle pool = MemoryManager::GetPool());
@@ -102,6 +111,25 @@ namespace seal
                 return inv_root_powers_.get();
             }
 
+            /**
+            Returns the root powers for 32-bit arithmetic, or nullptr if the modulus has more than
+            SEAL_SMALL_MOD_BIT_COUNT_MAX bits. The n operands are in the same order as get_from_root_powers() and are
+            followed by the n quotients floor(w * 2^32 / q).
+            */
+            SEAL_NODISCARD inline const std::uint32_t *get_from_root_powers32() const
+            {
+                return root_powers32_.get();
+            }
+
+            /**
+            Returns the inverse root powers for 32-bit arithmetic, laid out as in get_from_root_powers32(), or nullptr
+            if the modulus has more than SEAL_SMALL_MOD_BIT_COUNT_MAX bits.
+            */
+            SEAL_NODISCARD inline const std::uint32_t *get_from_inv_root_powers32() const
+            {
+                return inv_root_powers32_.get();
+            }
+
             SEAL_NODISCARD inline MultiplyUIntModOperand get_from_root_powers(std::size_t index) const
             {
 #ifdef SEAL_DEBUG
@@ -177,6 +205,12 @@ namespace seal
             // Holds 1~(n-1)-th powers of inv_root_ in scrambled order, the 0-th power is left unset.
             Pointer<MultiplyUIntModOperand> inv_root_powers_;
 
+            // For small moduli, the operands of root_powers_ followed by their 32-bit quotients.
+            Pointer<std::uint32_t> root_powers32_;
+
+            // For small moduli, the operands of inv_root_powers_ followed by their 32-bit quotients.
+            Pointer<std::uint32_t> inv_root_powers32_;
+
             ModArithLazy mod_arith_lazy_;
 
             NTTHandler ntt_handler_;
@@ -212,21 +246,12 @@ namespace seal
             });
         }
 
-        inline void ntt_negacyclic_harvey_lazy(PolyIter operand, std::size_t size, ConstNTTTablesIter tables)
-        {
-#ifdef SEAL_DEBUG
-            if (!operand)
-            {
-                throw std::invalid_argument("operand");
-            }
-            if (!tables)
-            {
-                throw std::invalid_argument("tables");
-            }
-#endif
-            SEAL_ITERATE(
-                operand, size, [&](auto I) { ntt_negacyclic_harvey_lazy(I, operand.coeff_modulus_size(), tables); });
-        }
+        /**
+        Transforms size polynomials one RNS component at a time, so that the kernel is selected once per modulus and
+        the tables of each modulus stay in the cache while they are applied to all polynomials. This holds for all
+        PolyIter overloads below.
+        */
+        void ntt_negacyclic_harvey_lazy(PolyIter operand, std::size_t size, ConstNTTTablesIter tables);
 
         void ntt_negacyclic_harvey(CoeffIter operand, const NTTTables &tables);
 
@@ -247,21 +272,7 @@ namespace seal
             });
         }
 
-        inline void ntt_negacyclic_harvey(PolyIter operand, std::size_t size, ConstNTTTablesIter tables)
-        {
-#ifdef SEAL_DEBUG
-            if (!operand)
-            {
-                throw std::invalid_argument("operand");
-            }
-            if (!tables)
-            {
-                throw std::invalid_argument("tables");
-            }
-#endif
-            SEAL_ITERATE(
-                operand, size, [&](auto I) { ntt_negacyclic_harvey(I, operand.coeff_modulus_size(), tables); });
-        }
+        void ntt_negacyclic_harvey(PolyIter operand, std::size_t size, ConstNTTTablesIter tables);
 
         void inverse_ntt_negacyclic_harvey_lazy(CoeffIter operand, const NTTTables &tables);
 
@@ -283,22 +294,7 @@ namespace seal
             });
         }
 
-        inline void inverse_ntt_negacyclic_harvey_lazy(PolyIter operand, std::size_t size, ConstNTTTablesIter tables)
-        {
-#ifdef SEAL_DEBUG
-            if (!operand)
-            {
-                throw std::invalid_argument("operand");
-            }
-            if (!tables)
-            {
-                throw std::invalid_argument("tables");
-            }
-#endif
-            SEAL_ITERATE(operand, size, [&](auto I) {
-                inverse_ntt_negacyclic_harvey_lazy(I, operand.coeff_modulus_size(), tables);
-            });
-        }
+        void inverse_ntt_negacyclic_harvey_lazy(PolyIter operand, std::size_t size, ConstNTTTablesIter tables);
 
         void inverse_ntt_negacyclic_harvey(CoeffIter operand, const NTTTables &tables);
 
@@ -320,23 +316,47 @@ namespace seal
             });
         }
 
-        inline void inverse_ntt_negacyclic_harvey(PolyIter operand, std::size_t size, ConstNTTTablesIter tables)
-        {
-#ifdef SEAL_DEBUG
-            if (!operand)
-            {
-                throw std::invalid_argument("operand");
-            }
-            if (!tables)
-            {
-                throw std::invalid_argument("tables");
-            }
-#endif
-            SEAL_ITERATE(
-                operand, size, [&](auto I) { inverse_ntt_negacyclic_harvey(I, operand.coeff_modulus_size(), tables); });
-        }
+        void inverse_ntt_negacyclic_harvey(PolyIter operand, std::size_t size, ConstNTTTablesIter tables);
+
+        /**
+        Computes the forward negacyclic NTT of count consecutive polynomials that are all reduced modulo the modulus of
+        tables, e.g., the decomposition of a polynomial that key switching multiplies with one RNS component of the
+        keys. The kernel is selected once for the whole batch. The output is in [0, 4q).
+        */
+        void ntt_negacyclic_harvey_lazy(RNSIter operand, std::size_t count, const NTTTables &tables);
+
+        /**
+        Same as above, but the output is fully reduced modulo q.
+        */
+        void ntt_negacyclic_harvey(RNSIter operand, std::size_t count, const NTTTables &tables);
+
+        /**
+        Computes the inverse negacyclic NTT of count consecutive polynomials that are all reduced modulo the modulus of
+        tables. The kernel is selected once for the whole batch. The output is in [0, 2q).
+        */
+        void inverse_ntt_negacyclic_harvey_lazy(RNSIter operand, std::size_t count, const NTTTables &tables);
+
+        /**
+        Same as above, but the output is fully reduced modulo q.
+        */
+        void inverse_ntt_negacyclic_harvey(RNSIter operand, std::size_t count, const NTTTables &tables);
 
+        /**
+        Computes the forward negacyclic NTT with the in-tree kernels of the active kernel variant, falling back to the
+        scalar DWTHandler when the transform is too small for the vectorized kernels. Transforms of more than
+        2^ntt_block_coeff_count_power coefficients are computed block by block to stay in the L1 cache. The output is in
+        [0, 4q) and is congruent to that of DWTHandler::transform_to_rev; it is identical unless the AVX-512 IFMA
+        kernels are used.
+        */
         void ntt_negacyclic_harvey_new(CoeffIter operand, const NTTTables &tables);
+
+        /**
+        Computes the inverse negacyclic NTT with the in-tree kernels of the active kernel variant, falling back to the
+        scalar DWTHandler when the transform is too small for the vectorized kernels. Transforms of more than
+        2^ntt_block_coeff_count_power coefficients are computed block by block to stay in the L1 cache. The output is in
+        [0, 2q) and is congruent to that of DWTHandler::transform_from_rev; it is identical unless the AVX-512 IFMA
+        kernels are used.
+        */
         void inverse_ntt_negacyclic_harvey_new(CoeffIter operand, const NTTTables &tables);
     } // namespace util
 } // namespace seal
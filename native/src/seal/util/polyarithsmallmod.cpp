@@ -1,9 +1,12 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+#include "seal/util/dispatch.h"
 #include "seal/util/polyarithsmallmod.h"
+#include "seal/util/simd.h"
 #include "seal/util/uintarith.h"
 #include "seal/util/uintcore.h"
+#include <algorithm>
 
 #ifdef SEAL_USE_INTEL_HEXL
 #include "hexl/hexl.hpp"
@@ -40,6 +43,54 @@ namespace seal
 #endif
         }
 
+        void negate_poly_coeffmod(ConstCoeffIter poly, size_t coeff_count, const Modulus &modulus, CoeffIter result)
+        {
+#ifdef SEAL_DEBUG
+            if (!poly && coeff_count > 0)
+            {
+                throw invalid_argument("poly");
+            }
+            if (modulus.is_zero())
+            {
+                throw invalid_argument("modulus");
+            }
+            if (!result && coeff_count > 0)
+            {
+                throw invalid_argument("result");
+            }
+#endif
+            const uint64_t modulus_value = modulus.value();
+#ifndef SEAL_DEBUG
+            // Debug builds use the scalar loop, which checks that the inputs are reduced
+            SEAL_MAYBE_UNUSED kernel_variant variant = active_kernel_variant();
+#ifdef SEAL_USE_AVX512
+            if (variant >= kernel_variant::avx512)
+            {
+                avx512::negate_poly_coeffmod(poly.ptr(), coeff_count, modulus_value, result.ptr());
+                return;
+            }
+#endif
+#ifdef SEAL_USE_AVX2
+            if (variant >= kernel_variant::avx2)
+            {
+                avx2::negate_poly_coeffmod(poly.ptr(), coeff_count, modulus_value, result.ptr());
+                return;
+            }
+#endif
+#endif
+            SEAL_ITERATE(iter(poly, result), coeff_count, [&](auto I) {
+                auto coeff = get<0>(I);
+#ifdef SEAL_DEBUG
+                if (coeff >= modulus_value)
+                {
+                    throw out_of_range("poly");
+                }
+#endif
+                int64_t non_zero = (coeff != 0);
+                get<1>(I) = (modulus_value - coeff) & static_cast<uint64_t>(-non_zero);
+            });
+        }
+
         void add_poly_coeffmod(
             ConstCoeffIter operand1, ConstCoeffIter operand2, std::size_t coeff_count, const Modulus &modulus,
             CoeffIter result)
@@ -67,7 +118,24 @@ namespace seal
 #ifdef SEAL_USE_INTEL_HEXL
             intel::hexl::EltwiseAddMod(&result[0], &operand1[0], &operand2[0], coeff_count, modulus_value);
 #else
-
+#ifndef SEAL_DEBUG
+            // Debug builds use the scalar loop, which checks that the inputs are reduced
+            SEAL_MAYBE_UNUSED kernel_variant variant = active_kernel_variant();
+#ifdef SEAL_USE_AVX512
+            if (variant >= kernel_variant::avx512)
+            {
+                avx512::add_poly_coeffmod(operand1.ptr(), operand2.ptr(), coeff_count, modulus_value, result.ptr());
+                return;
+            }
+#endif
+#ifdef SEAL_USE_AVX2
+            if (variant >= kernel_variant::avx2)
+            {
+                avx2::add_poly_coeffmod(operand1.ptr(), operand2.ptr(), coeff_count, modulus_value, result.ptr());
+                return;
+            }
+#endif
+#endif
             SEAL_ITERATE(iter(operand1, operand2, result), coeff_count, [&](auto I) {
 #ifdef SEAL_DEBUG
                 if (get<0>(I) >= modulus_value)
@@ -112,6 +180,24 @@ namespace seal
 #ifdef SEAL_USE_INTEL_HEXL
             intel::hexl::EltwiseSubMod(result, operand1, operand2, coeff_count, modulus_value);
 #else
+#ifndef SEAL_DEBUG
+            // Debug builds use the scalar loop, which checks that the inputs are reduced
+            SEAL_MAYBE_UNUSED kernel_variant variant = active_kernel_variant();
+#ifdef SEAL_USE_AVX512
+            if (variant >= kernel_variant::avx512)
+            {
+                avx512::sub_poly_coeffmod(operand1.ptr(), operand2.ptr(), coeff_count, modulus_value, result.ptr());
+                return;
+            }
+#endif
+#ifdef SEAL_USE_AVX2
+            if (variant >= kernel_variant::avx2)
+            {
+                avx2::sub_poly_coeffmod(operand1.ptr(), operand2.ptr(), coeff_count, modulus_value, result.ptr());
+                return;
+            }
+#endif
+#endif
             SEAL_ITERATE(iter(operand1, operand2, result), coeff_count, [&](auto I) {
 #ifdef SEAL_DEBUG
                 if (get<0>(I) >= modulus_value)
@@ -216,6 +302,21 @@ namespace seal
 #ifdef SEAL_USE_INTEL_HEXL
             intel::hexl::EltwiseFMAMod(&result[0], &poly[0], scalar.operand, nullptr, coeff_count, modulus.value(), 8);
 #else
+            SEAL_MAYBE_UNUSED kernel_variant variant = active_kernel_variant();
+#ifdef SEAL_USE_AVX512
+            if (variant >= kernel_variant::avx512)
+            {
+                avx512::multiply_poly_scalar_coeffmod(poly.ptr(), coeff_count, scalar, modulus.value(), result.ptr());
+                return;
+            }
+#endif
+#ifdef SEAL_USE_AVX2
+            if (variant >= kernel_variant::avx2)
+            {
+                avx2::multiply_poly_scalar_coeffmod(poly.ptr(), coeff_count, scalar, modulus.value(), result.ptr());
+                return;
+            }
+#endif
             SEAL_ITERATE(iter(poly, result), coeff_count, [&](auto I) {
                 const uint64_t x = get<0>(I);
                 get<1>(I) = multiply_uint_mod(x, scalar, modulus);
@@ -252,6 +353,39 @@ namespace seal
 #ifdef SEAL_USE_INTEL_HEXL
             intel::hexl::EltwiseMultMod(&result[0], &operand1[0], &operand2[0], coeff_count, modulus.value(), 4);
 #else
+#ifdef SEAL_USE_AVX2
+            // The kernels use Barrett reduction with floor(2^(2k) / q) for the bit count k of q
+            kernel_variant variant = active_kernel_variant();
+            int bit_count = modulus.bit_count();
+            uint64_t barrett_ratio[2];
+            right_shift_uint128(modulus.const_ratio().data(), 128 - 2 * bit_count, barrett_ratio);
+#ifdef SEAL_USE_AVX512IFMA
+            if (variant == kernel_variant::avx512ifma && bit_count > SEAL_SMALL_MOD_BIT_COUNT_MAX &&
+                bit_count <= avx512ifma::max_modulus_bit_count)
+            {
+                avx512ifma::dyadic_product_coeffmod(
+                    operand1.ptr(), operand2.ptr(), coeff_count, modulus.value(), bit_count, barrett_ratio[0],
+                    result.ptr());
+                return;
+            }
+#endif
+#ifdef SEAL_USE_AVX512
+            if (variant >= kernel_variant::avx512 && bit_count <= SEAL_SMALL_MOD_BIT_COUNT_MAX)
+            {
+                avx512::dyadic_product_coeffmod32(
+                    operand1.ptr(), operand2.ptr(), coeff_count, modulus.value(), bit_count, barrett_ratio[0],
+                    result.ptr());
+                return;
+            }
+#endif
+            if (variant >= kernel_variant::avx2 && bit_count <= SEAL_SMALL_MOD_BIT_COUNT_MAX)
+            {
+                avx2::dyadic_product_coeffmod32(
+                    operand1.ptr(), operand2.ptr(), coeff_count, modulus.value(), bit_count, barrett_ratio[0],
+                    result.ptr());
+                return;
+            }
+#endif
             const uint64_t modulus_value = modulus.value();
             const uint64_t const_ratio_0 = modulus.const_ratio()[0];
             const uint64_t const_ratio_1 = modulus.const_ratio()[1];
@@ -283,6 +417,223 @@ namespace seal
 #endif
         }
 
+        namespace
+        {
+            // Computes the dot product with a vectorized kernel if one is available for the modulus
+            bool dot_product_coeffmod_vector(
+                SEAL_MAYBE_UNUSED const uint64_t *const *operand1, SEAL_MAYBE_UNUSED const uint64_t *const *operand2,
+                SEAL_MAYBE_UNUSED size_t count, SEAL_MAYBE_UNUSED size_t coeff_count,
+                SEAL_MAYBE_UNUSED const Modulus &modulus, SEAL_MAYBE_UNUSED CoeffIter result)
+            {
+#ifdef SEAL_USE_AVX2
+                kernel_variant variant = active_kernel_variant();
+                int bit_count = modulus.bit_count();
+                uint64_t barrett_ratio[2];
+                right_shift_uint128(modulus.const_ratio().data(), 128 - 2 * bit_count, barrett_ratio);
+#ifdef SEAL_USE_AVX512IFMA
+                if (variant == kernel_variant::avx512ifma && bit_count > SEAL_SMALL_MOD_BIT_COUNT_MAX &&
+                    bit_count <= avx512ifma::max_modulus_bit_count)
+                {
+                    avx512ifma::dot_product_coeffmod(
+                        operand1, operand2, count, coeff_count, modulus.value(), bit_count, barrett_ratio[0],
+                        result.ptr());
+                    return true;
+                }
+#endif
+#ifdef SEAL_USE_AVX512
+                if (variant >= kernel_variant::avx512 && bit_count <= SEAL_SMALL_MOD_BIT_COUNT_MAX)
+                {
+                    avx512::dot_product_coeffmod32(
+                        operand1, operand2, count, coeff_count, modulus.value(), bit_count, barrett_ratio[0],
+                        result.ptr());
+                    return true;
+                }
+#endif
+                if (variant >= kernel_variant::avx2 && bit_count <= SEAL_SMALL_MOD_BIT_COUNT_MAX)
+                {
+                    avx2::dot_product_coeffmod32(
+                        operand1, operand2, count, coeff_count, modulus.value(), bit_count, barrett_ratio[0],
+                        result.ptr());
+                    return true;
+                }
+#endif
+                return false;
+            }
+
+            inline uint64_t reduce_lazy(uint64_t value, uint64_t modulus, uint64_t two_modulus)
+            {
+                value = SEAL_COND_SELECT(value >= two_modulus, value - two_modulus, value);
+                return SEAL_COND_SELECT(value >= modulus, value - modulus, value);
+            }
+        } // namespace
+
+        void dot_product_coeffmod(
+            const uint64_t *const *operand1, const uint64_t *const *operand2, size_t count, size_t coeff_count,
+            const Modulus &modulus, CoeffIter result)
+        {
+#ifdef SEAL_DEBUG
+            if (!operand1 && count > 0)
+            {
+                throw invalid_argument("operand1");
+            }
+            if (!operand2 && count > 0)
+            {
+                throw invalid_argument("operand2");
+            }
+            if (!result && coeff_count > 0)
+            {
+                throw invalid_argument("result");
+            }
+            if (modulus.is_zero())
+            {
+                throw invalid_argument("modulus");
+            }
+#endif
+            if (!count)
+            {
+                set_zero_uint(coeff_count, result);
+                return;
+            }
+
+            if (dot_product_coeffmod_vector(operand1, operand2, count, coeff_count, modulus, result))
+            {
+                return;
+            }
+
+            // The products of reduced operands are below 2^(2k) for the bit count k of the modulus, so 2^(128 - 2k)
+            // of them fit in the 128-bit accumulators; a reduced partial sum counts as one of them
+            const int headroom = 128 - 2 * modulus.bit_count();
+            const size_t max_terms = headroom < 63 ? size_t(1) << headroom : count;
+            const uint64_t modulus_value = modulus.value();
+            const uint64_t two_modulus_value = modulus_value << 1;
+
+            // The sums for a tile of coefficients stay in the L1 cache while the operands are streamed through
+            constexpr size_t tile_size = 64;
+            unsigned long long acc[tile_size][2];
+            for (size_t offset = 0; offset < coeff_count; offset += tile_size)
+            {
+                size_t tile_count = min(tile_size, coeff_count - offset);
+                fill_n(&acc[0][0], 2 * tile_count, 0ULL);
+                size_t terms = 0;
+                for (size_t j = 0; j < count; j++)
+                {
+                    if (terms == max_terms)
+                    {
+                        for (size_t i = 0; i < tile_count; i++)
+                        {
+                            acc[i][0] = barrett_reduce_128(acc[i], modulus);
+                            acc[i][1] = 0;
+                        }
+                        terms = 1;
+                    }
+                    const uint64_t *x = operand1[j] + offset;
+                    const uint64_t *y = operand2[j] + offset;
+                    for (size_t i = 0; i < tile_count; i++)
+                    {
+                        unsigned long long product[2];
+                        multiply_uint64(
+                            reduce_lazy(x[i], modulus_value, two_modulus_value),
+                            reduce_lazy(y[i], modulus_value, two_modulus_value), product);
+                        add_uint128(product, acc[i], acc[i]);
+                    }
+                    terms++;
+                }
+                for (size_t i = 0; i < tile_count; i++)
+                {
+                    result[offset + i] = barrett_reduce_128(acc[i], modulus);
+                }
+            }
+        }
+
+        void dot_product_montgomery_coeffmod(
+            const uint64_t *const *operand1, const uint64_t *const *operand2, size_t count, size_t coeff_count,
+            const Modulus &modulus, CoeffIter result)
+        {
+#ifdef SEAL_DEBUG
+            if (!operand1 && count > 0)
+            {
+                throw invalid_argument("operand1");
+            }
+            if (!operand2 && count > 0)
+            {
+                throw invalid_argument("operand2");
+            }
+            if (!result && coeff_count > 0)
+            {
+                throw invalid_argument("result");
+            }
+            if (modulus.is_zero())
+            {
+                throw invalid_argument("modulus");
+            }
+#endif
+            if (!count)
+            {
+                set_zero_uint(coeff_count, result);
+                return;
+            }
+
+            // The vectorized kernels use Barrett reduction; one more multiplication removes the factor 2^64. Even with
+            // that multiplication they are faster than the scalar Montgomery loop below for every modulus size.
+            if (dot_product_coeffmod_vector(operand1, operand2, count, coeff_count, modulus, result))
+            {
+                unsigned long long r[2]{ 0, 1 };
+                uint64_t r_inverse = 0;
+                try_invert_uint_mod(barrett_reduce_128(r, modulus), modulus, r_inverse);
+                MultiplyUIntModOperand scalar;
+                scalar.set(r_inverse, modulus);
+                multiply_poly_scalar_coeffmod(result, coeff_count, scalar, modulus, result);
+                return;
+            }
+
+            // The products of reduced operands are below modulus^2, so floor((2^64 - 1) / modulus) of them sum to less
+            // than modulus * 2^64, which is the input bound of Montgomery reduction
+            const uint64_t modulus_value = modulus.value();
+            const uint64_t two_modulus_value = modulus_value << 1;
+            const uint64_t neg_inverse = montgomery_neg_inverse(modulus_value);
+            const size_t max_terms = static_cast<size_t>(min<uint64_t>(~uint64_t(0) / modulus_value, count));
+
+            constexpr size_t tile_size = 64;
+            unsigned long long acc[tile_size][2];
+            uint64_t sum[tile_size];
+            for (size_t offset = 0; offset < coeff_count; offset += tile_size)
+            {
+                size_t tile_count = min(tile_size, coeff_count - offset);
+                fill_n(&acc[0][0], 2 * tile_count, 0ULL);
+                fill_n(sum, tile_count, uint64_t(0));
+                size_t terms = 0;
+                for (size_t j = 0; j < count; j++)
+                {
+                    if (terms == max_terms)
+                    {
+                        for (size_t i = 0; i < tile_count; i++)
+                        {
+                            sum[i] = add_uint_mod(sum[i], montgomery_reduce_128(acc[i], modulus, neg_inverse), modulus);
+                            acc[i][0] = 0;
+                            acc[i][1] = 0;
+                        }
+                        terms = 0;
+                    }
+                    const uint64_t *x = operand1[j] + offset;
+                    const uint64_t *y = operand2[j] + offset;
+                    for (size_t i = 0; i < tile_count; i++)
+                    {
+                        unsigned long long product[2];
+                        multiply_uint64(
+                            reduce_lazy(x[i], modulus_value, two_modulus_value),
+                            reduce_lazy(y[i], modulus_value, two_modulus_value), product);
+                        add_uint128(product, acc[i], acc[i]);
+                    }
+                    terms++;
+                }
+                for (size_t i = 0; i < tile_count; i++)
+                {
+                    result[offset + i] =
+                        add_uint_mod(sum[i], montgomery_reduce_128(acc[i], modulus, neg_inverse), modulus);
+                }
+            }
+        }
+
         uint64_t poly_infty_norm_coeffmod(ConstCoeffIter operand, size_t coeff_count, const Modulus &modulus)
         {
 #ifdef SEAL_DEBUG
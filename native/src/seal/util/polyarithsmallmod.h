@@ -74,36 +74,8 @@ namespace seal
             });
         }
 
-        inline void negate_poly_coeffmod(
-            ConstCoeffIter poly, std::size_t coeff_count, const Modulus &modulus, CoeffIter result)
-        {
-#ifdef SEAL_DEBUG
-            if (!poly && coeff_count > 0)
-            {
-                throw std::invalid_argument("poly");
-            }
-            if (modulus.is_zero())
-            {
-                throw std::invalid_argument("modulus");
-            }
-            if (!result && coeff_count > 0)
-            {
-                throw std::invalid_argument("result");
-            }
-#endif
-            const uint64_t modulus_value = modulus.value();
-            SEAL_ITERATE(iter(poly, result), coeff_count, [&](auto I) {
-                auto coeff = get<0>(I);
-#ifdef SEAL_DEBUG
-                if (coeff >= modulus_value)
-                {
-                    throw std::out_of_range("poly");
-                }
-#endif
-                std::int64_t non_zero = (coeff != 0);
-                get<1>(I) = (modulus_value - coeff) & static_cast<std::uint64_t>(-non_zero);
-            });
-        }
+        void negate_poly_coeffmod(
+            ConstCoeffIter poly, std::size_t coeff_count, const Modulus &modulus, CoeffIter result);
 
         inline void negate_poly_coeffmod(
             ConstRNSIter poly, std::size_t coeff_modulus_size, ConstModulusIter modulus, RNSIter result)
@@ -571,6 +543,40 @@ namespace seal
             });
         }
 
+        /**
+        Computes result[i] = sum_j operand1[j][i] * operand2[j][i] mod modulus, the inner products of the count pairs of
+        polynomials that key switching and ciphertext tensoring accumulate. The operands may be lazily reduced to
+        [0, 4 * modulus), as output by ntt_negacyclic_harvey_lazy; the result is fully reduced. The products are
+        accumulated in 128 bits and reduced only when the sum could overflow, or by the vectorized kernels when
+        available. The result may alias any of the operands; if count is zero the result is set to zero.
+
+        @param[in] operand1 Pointers to count polynomials of coeff_count coefficients
+        @param[in] operand2 Pointers to count polynomials of coeff_count coefficients
+        @param[in] count The number of products to sum
+        @param[in] coeff_count The number of coefficients of each polynomial
+        @param[in] modulus The modulus
+        @param[out] result The polynomial to overwrite with the sum
+        */
+        void dot_product_coeffmod(
+            const std::uint64_t *const *operand1, const std::uint64_t *const *operand2, std::size_t count,
+            std::size_t coeff_count, const Modulus &modulus, CoeffIter result);
+
+        /**
+        Computes result[i] = sum_j operand1[j][i] * operand2[j][i] * 2^(-64) mod modulus; that is, the same as
+        dot_product_coeffmod when the polynomials operand2 are in Montgomery form, multiplied by 2^64 mod modulus. The
+        sums are reduced by Montgomery instead of Barrett reduction. The modulus must be odd.
+
+        @param[in] operand1 Pointers to count polynomials of coeff_count coefficients
+        @param[in] operand2 Pointers to count polynomials of coeff_count coefficients in Montgomery form
+        @param[in] count The number of products to sum
+        @param[in] coeff_count The number of coefficients of each polynomial
+        @param[in] modulus The modulus
+        @param[out] result The polynomial to overwrite with the sum
+        */
+        void dot_product_montgomery_coeffmod(
+            const std::uint64_t *const *operand1, const std::uint64_t *const *operand2, std::size_t count,
+            std::size_t coeff_count, const Modulus &modulus, CoeffIter result);
+
         std::uint64_t poly_infty_norm_coeffmod(ConstCoeffIter operand, std::size_t coeff_count, const Modulus &modulus);
 
         void negacyclic_shift_poly_coeffmod(
@@ -227,23 +227,23 @@ namespace seal
             sample_poly_ternary(prng, parms, u.get());
 
             // c[j] = u * public_key[j]
+            ntt_negacyclic_harvey(RNSIter(u.get(), coeff_count), coeff_modulus_size, ntt_tables);
             for (size_t i = 0; i < coeff_modulus_size; i++)
             {
-                ntt_negacyclic_harvey(u.get() + i * coeff_count, ntt_tables[i]);
                 for (size_t j = 0; j < encrypted_size; j++)
                 {
                     dyadic_product_coeffmod(
                         u.get() + i * coeff_count, public_key.data().data(j) + i * coeff_count, coeff_count,
                         coeff_modulus[i], destination.data(j) + i * coeff_count);
-
-                    // Addition with e_0, e_1 is in non-NTT form
-                    if (!is_ntt_form)
-                    {
-                        inverse_ntt_negacyclic_harvey(destination.data(j) + i * coeff_count, ntt_tables[i]);
-                    }
                 }
             }
 
+            // Addition with e_0, e_1 is in non-NTT form
+            if (!is_ntt_form)
+            {
+                inverse_ntt_negacyclic_harvey(destination, encrypted_size, ntt_tables);
+            }
+
             // Generate e_j <-- chi
             // c[j] = public_key[j] * u + e[j] in BFV/CKKS, = public_key[j] * u + p * e[j] in BGV,
             for (size_t j = 0; j < encrypted_size; j++)
@@ -342,11 +342,9 @@ namespace seal
             {
                 // Sample non-NTT form and store the seed
                 sample_poly_uniform(ciphertext_prng, parms, c1);
-                for (size_t i = 0; i < coeff_modulus_size; i++)
-                {
-                    // Transform the c1 into NTT representation
-                    ntt_negacyclic_harvey(c1 + i * coeff_count, ntt_tables[i]);
-                }
+
+                // Transform the c1 into NTT representation
+                ntt_negacyclic_harvey(RNSIter(c1, coeff_count), coeff_modulus_size, ntt_tables);
             }
 
             // Sample e <-- chi
@@ -360,16 +358,18 @@ namespace seal
                 dyadic_product_coeffmod(
                     secret_key.data().data() + i * coeff_count, c1 + i * coeff_count, coeff_count, coeff_modulus[i],
                     c0 + i * coeff_count);
-                if (is_ntt_form)
-                {
-                    // Transform the noise e into NTT representation
-                    ntt_negacyclic_harvey(noise.get() + i * coeff_count, ntt_tables[i]);
-                }
-                else
-                {
-                    inverse_ntt_negacyclic_harvey(c0 + i * coeff_count, ntt_tables[i]);
-                }
-
+            }
+            if (is_ntt_form)
+            {
+                // Transform the noise e into NTT representation
+                ntt_negacyclic_harvey(RNSIter(noise.get(), coeff_count), coeff_modulus_size, ntt_tables);
+            }
+            else
+            {
+                inverse_ntt_negacyclic_harvey(RNSIter(c0, coeff_count), coeff_modulus_size, ntt_tables);
+            }
+            for (size_t i = 0; i < coeff_modulus_size; i++)
+            {
                 if (type == scheme_type::bgv)
                 {
                     // noise = pe instead of e in BGV
@@ -388,11 +388,8 @@ namespace seal
 
             if (!is_ntt_form && !save_seed)
             {
-                for (size_t i = 0; i < coeff_modulus_size; i++)
-                {
-                    // Transform the c1 into non-NTT representation
-                    inverse_ntt_negacyclic_harvey(c1 + i * coeff_count, ntt_tables[i]);
-                }
+                // Transform the c1 into non-NTT representation
+                inverse_ntt_negacyclic_harvey(RNSIter(c1, coeff_count), coeff_modulus_size, ntt_tables);
             }
 
             if (save_seed)
@@ -2,9 +2,12 @@
 // Licensed under the MIT license.
 
 #include "seal/util/common.h"
+#include "seal/util/dispatch.h"
 #include "seal/util/numth.h"
 #include "seal/util/polyarithsmallmod.h"
 #include "seal/util/rns.h"
+#include "seal/util/simd.h"
+#include "seal/util/tablecache.h"
 #include "seal/util/uintarithmod.h"
 #include "seal/util/uintarithsmallmod.h"
 #include <algorithm>
@@ -15,6 +18,71 @@ namespace seal
 {
     namespace util
     {
+        namespace
+        {
+            // Number of coefficients BaseConverter::fast_convert_array converts at a time
+            constexpr size_t base_conversion_tile_size = 256;
+
+            // Computes result[j] = sum_i rows[i * coeff_count + j] * weights[i] mod modulus for rows below 2^62
+            void multiply_accumulate_coeffmod(
+                const uint64_t *rows, size_t row_count, size_t coeff_count, const MultiplyUIntModOperand *weights,
+                const Modulus &modulus, uint64_t *result)
+            {
+#ifdef SEAL_USE_AVX2
+                kernel_variant variant = active_kernel_variant();
+#ifdef SEAL_USE_AVX512
+                if (variant >= kernel_variant::avx512)
+                {
+                    avx512::multiply_accumulate_coeffmod(
+                        rows, row_count, coeff_count, weights, modulus.value(), result);
+                    return;
+                }
+#endif
+                if (variant >= kernel_variant::avx2)
+                {
+                    avx2::multiply_accumulate_coeffmod(rows, row_count, coeff_count, weights, modulus.value(), result);
+                    return;
+                }
+#endif
+                // The products are below 2^(62 + k) for the bit count k of the modulus, so 2^(66 - k) of them fit in
+                // the 128-bit accumulators; a reduced partial sum counts as one of them
+                const size_t max_terms = size_t(1) << min(66 - modulus.bit_count(), 62);
+
+                constexpr size_t tile_size = 64;
+                unsigned long long acc[tile_size][2];
+                for (size_t offset = 0; offset < coeff_count; offset += tile_size)
+                {
+                    size_t tile_count = min(tile_size, coeff_count - offset);
+                    fill_n(&acc[0][0], 2 * tile_count, 0ULL);
+                    size_t terms = 0;
+                    for (size_t i = 0; i < row_count; i++)
+                    {
+                        if (terms == max_terms)
+                        {
+                            for (size_t j = 0; j < tile_count; j++)
+                            {
+                                acc[j][0] = barrett_reduce_128(acc[j], modulus);
+                                acc[j][1] = 0;
+                            }
+                            terms = 1;
+                        }
+                        const uint64_t *row = rows + i * coeff_count + offset;
+                        for (size_t j = 0; j < tile_count; j++)
+                        {
+                            unsigned long long product[2];
+                            multiply_uint64(row[j], weights[i].operand, product);
+                            add_uint128(product, acc[j], acc[j]);
+                        }
+                        terms++;
+                    }
+                    for (size_t j = 0; j < tile_count; j++)
+                    {
+                        result[offset + j] = barrett_reduce_128(acc[j], modulus);
+                    }
+                }
+            }
+        } // namespace
+
         RNSBase::RNSBase(const vector<Modulus> &rnsbase, MemoryPoolHandle pool)
             : pool_(move(pool)), size_(rnsbase.size())
         {
@@ -427,115 +495,169 @@ namespace seal
             size_t obase_size = obase_.size();
             size_t count = in.poly_modulus_degree();
 
+            // The coefficients are converted one tile at a time so that the scaled input of a tile stays in the cache
+            // while every row of the base change matrix is applied to it
+            size_t tile_size = min(count, base_conversion_tile_size);
+
+#ifdef SEAL_USE_AVX2
+            kernel_variant variant = active_kernel_variant();
+            if (variant >= kernel_variant::avx2)
+            {
+                // The vectorized kernels sum whole rows, so temp holds one row of the tile per ibase element
+                auto temp_rows(allocate_uint(mul_safe(tile_size, ibase_size), pool));
+                for (size_t offset = 0; offset < count; offset += tile_size)
+                {
+                    size_t tile_count = min(tile_size, count - offset);
+                    SEAL_ITERATE(
+                        iter(in, ibase_.inv_punctured_prod_mod_base_array(), ibase_.base(), size_t(0)), ibase_size,
+                        [&](auto I) {
+                            CoeffIter temp_row(temp_rows.get() + get<3>(I) * tile_count);
+                            if (get<1>(I).operand == 1)
+                            {
+                                modulo_poly_coeffs(get<0>(I) + offset, tile_count, get<2>(I), temp_row);
+                            }
+                            else
+                            {
+                                multiply_poly_scalar_coeffmod(
+                                    get<0>(I) + offset, tile_count, get<1>(I), get<2>(I), temp_row);
+                            }
+                        });
+
+                    SEAL_ITERATE(iter(out, base_change_matrix_shoup_, obase_.base()), obase_size, [&](auto I) {
+#ifdef SEAL_USE_AVX512
+                        if (variant >= kernel_variant::avx512)
+                        {
+                            avx512::multiply_accumulate_coeffmod(
+                                temp_rows.get(), ibase_size, tile_count, get<1>(I).get(), get<2>(I).value(),
+                                get<0>(I).ptr() + offset);
+                            return;
+                        }
+#endif
+                        avx2::multiply_accumulate_coeffmod(
+                            temp_rows.get(), ibase_size, tile_count, get<1>(I).get(), get<2>(I).value(),
+                            get<0>(I).ptr() + offset);
+                    });
+                }
+                return;
+            }
+#endif
+
             // Note that the stride size is ibase_size
-            SEAL_ALLOCATE_GET_STRIDE_ITER(temp, uint64_t, count, ibase_size, pool);
+            SEAL_ALLOCATE_GET_STRIDE_ITER(temp, uint64_t, tile_size, ibase_size, pool);
 
-            SEAL_ITERATE(
-                iter(in, ibase_.inv_punctured_prod_mod_base_array(), ibase_.base(), size_t(0)), ibase_size,
-                [&](auto I) {
-                    // The current ibase index
-                    size_t ibase_index = get<3>(I);
+            for (size_t offset = 0; offset < count; offset += tile_size)
+            {
+                size_t tile_count = min(tile_size, count - offset);
+                SEAL_ITERATE(
+                    iter(in, ibase_.inv_punctured_prod_mod_base_array(), ibase_.base(), size_t(0)), ibase_size,
+                    [&](auto I) {
+                        // The current ibase index
+                        size_t ibase_index = get<3>(I);
 
-                    if (get<1>(I).operand == 1)
-                    {
-                        // No multiplication needed
-                        SEAL_ITERATE(iter(get<0>(I), temp), count, [&](auto J) {
-                            // Reduce modulo ibase element
-                            get<1>(J)[ibase_index] = barrett_reduce_64(get<0>(J), get<2>(I));
-                        });
-                    }
-                    else
-                    {
-                        // Multiplication needed
-                        SEAL_ITERATE(iter(get<0>(I), temp), count, [&](auto J) {
-                            // Multiply coefficient of in with ibase_.inv_punctured_prod_mod_base_array_ element
-                            get<1>(J)[ibase_index] = multiply_uint_mod(get<0>(J), get<1>(I), get<2>(I));
-                        });
-                    }
-                });
+                        if (get<1>(I).operand == 1)
+                        {
+                            // No multiplication needed
+                            SEAL_ITERATE(iter(get<0>(I) + offset, temp), tile_count, [&](auto J) {
+                                // Reduce modulo ibase element
+                                get<1>(J)[ibase_index] = barrett_reduce_64(get<0>(J), get<2>(I));
+                            });
+                        }
+                        else
+                        {
+                            // Multiplication needed
+                            SEAL_ITERATE(iter(get<0>(I) + offset, temp), tile_count, [&](auto J) {
+                                // Multiply coefficient of in with ibase_.inv_punctured_prod_mod_base_array_ element
+                                get<1>(J)[ibase_index] = multiply_uint_mod(get<0>(J), get<1>(I), get<2>(I));
+                            });
+                        }
+                    });
 
-            SEAL_ITERATE(iter(out, base_change_matrix_, obase_.base()), obase_size, [&](auto I) {
-                SEAL_ITERATE(iter(get<0>(I), temp), count, [&](auto J) {
-                    // Compute the base conversion sum modulo obase element
-                    get<0>(J) = dot_product_mod(get<1>(J), get<1>(I).get(), ibase_size, get<2>(I));
+                SEAL_ITERATE(iter(out, base_change_matrix_, obase_.base()), obase_size, [&](auto I) {
+                    SEAL_ITERATE(iter(get<0>(I) + offset, temp), tile_count, [&](auto J) {
+                        // Compute the base conversion sum modulo obase element; the products are accumulated in 128
+                        // bits and reduced once
+                        get<0>(J) = dot_product_mod(get<1>(J), get<1>(I).get(), ibase_size, get<2>(I));
+                    });
                 });
-            });
+            }
         }
 
         // See "An Improved RNS Variant of the BFV Homomorphic Encryption Scheme" (CT-RSA 2019) for details
         void BaseConverter::exact_convert_array(ConstRNSIter in, CoeffIter out, MemoryPoolHandle pool) const
         {
-            size_t ibase_size = ibase_.size();
-            size_t obase_size = obase_.size();
-            size_t count = in.poly_modulus_degree();
-
-            if (obase_size != 1)
+            if (obase_.size() != 1)
             {
                 throw invalid_argument("out base in exact_convert_array must be one.");
             }
 
-            // Note that the stride size is ibase_size
-            SEAL_ALLOCATE_GET_STRIDE_ITER(temp, uint64_t, count, ibase_size, pool);
+            exact_convert_array(in, RNSIter(out, in.poly_modulus_degree()), move(pool));
+        }
 
-            // The iterator storing v
-            SEAL_ALLOCATE_GET_STRIDE_ITER(v, double_t, count, ibase_size, pool);
+        void BaseConverter::exact_convert_array(ConstRNSIter in, RNSIter out, MemoryPoolHandle pool) const
+        {
+#ifdef SEAL_DEBUG
+            if (in.poly_modulus_degree() != out.poly_modulus_degree())
+            {
+                throw invalid_argument("in and out are incompatible");
+            }
+#endif
+            size_t ibase_size = ibase_.size();
+            size_t obase_size = obase_.size();
+            size_t count = in.poly_modulus_degree();
 
-            // Aggregated rounded v
-            SEAL_ALLOCATE_GET_PTR_ITER(aggregated_rounded_v, uint64_t, count, pool);
+            // The fast conversion computes sum_i [x_{i} * \hat{q_{i}}^(-1)]_{q_{i}} * \hat{q_{i}}, which exceeds the
+            // centered representative of the input by v * prod(ibase) for v = round(sum_i [x_{i} *
+            // \hat{q_{i}}^(-1)]_{q_{i}} / q_{i}). Both sums are computed from the same scaled input, one tile of
+            // coefficients at a time.
+            size_t tile_size = min(count, base_conversion_tile_size);
+            auto temp_rows(allocate_uint(mul_safe(tile_size, ibase_size), pool));
+            auto v(allocate<double_t>(tile_size, pool));
+
+            // [prod(ibase)]_{p} for each obase element p
+            auto prod_mod_obase(allocate<MultiplyUIntModOperand>(obase_size, pool));
+            SEAL_ITERATE(iter(prod_mod_obase, obase_.base()), obase_size, [&](auto I) {
+                get<0>(I).set(modulo_uint(ibase_.base_prod(), ibase_size, get<1>(I)), get<1>(I));
+            });
 
-            // Calculate [x_{i} * \hat{q_{i}}]_{q_{i}}
-            SEAL_ITERATE(
-                iter(in, ibase_.inv_punctured_prod_mod_base_array(), ibase_.base(), size_t(0)), ibase_size,
-                [&](auto I) {
-                    // The current ibase index
-                    size_t ibase_index = get<3>(I);
-                    double_t divisor = static_cast<double_t>(get<2>(I).value());
+            for (size_t offset = 0; offset < count; offset += tile_size)
+            {
+                size_t tile_count = min(tile_size, count - offset);
 
-                    if (get<1>(I).operand == 1)
-                    {
-                        // No multiplication needed
-                        SEAL_ITERATE(iter(get<0>(I), temp, v), count, [&](auto J) {
-                            // Reduce modulo ibase element
-                            get<1>(J)[ibase_index] = barrett_reduce_64(get<0>(J), get<2>(I));
-                            double_t dividend = static_cast<double_t>(get<1>(J)[ibase_index]);
-                            get<2>(J)[ibase_index] = dividend / divisor;
-                        });
-                    }
-                    else
-                    {
-                        // Multiplication needed
-                        SEAL_ITERATE(iter(get<0>(I), temp, v), count, [&](auto J) {
-                            // Multiply coefficient of in with ibase_.inv_punctured_prod_mod_base_array_ element
-                            get<1>(J)[ibase_index] = multiply_uint_mod(get<0>(J), get<1>(I), get<2>(I));
-                            double_t dividend = static_cast<double_t>(get<1>(J)[ibase_index]);
-                            get<2>(J)[ibase_index] = dividend / divisor;
-                        });
-                    }
-                });
+                // Calculate [x_{i} * \hat{q_{i}}^(-1)]_{q_{i}} and aggregate v
+                fill_n(v.get(), tile_count, 0.0);
+                SEAL_ITERATE(
+                    iter(in, ibase_.inv_punctured_prod_mod_base_array(), ibase_.base(), size_t(0)), ibase_size,
+                    [&](auto I) {
+                        CoeffIter temp_row(temp_rows.get() + get<3>(I) * tile_count);
+                        if (get<1>(I).operand == 1)
+                        {
+                            modulo_poly_coeffs(get<0>(I) + offset, tile_count, get<2>(I), temp_row);
+                        }
+                        else
+                        {
+                            multiply_poly_scalar_coeffmod(
+                                get<0>(I) + offset, tile_count, get<1>(I), get<2>(I), temp_row);
+                        }
 
-            // Aggrate v and rounding
-            SEAL_ITERATE(iter(v, aggregated_rounded_v), count, [&](auto I) {
-                // Otherwise a memory space of the last execution will be used.
-                double_t aggregated_v = 0.0;
-                for (size_t i = 0; i < ibase_size; ++i)
-                {
-                    aggregated_v += get<0>(I)[i];
-                }
-                aggregated_v += 0.5;
-                get<1>(I) = static_cast<uint64_t>(aggregated_v);
-            });
+                        double_t divisor = static_cast<double_t>(get<2>(I).value());
+                        SEAL_ITERATE(iter(temp_row, v.get()), tile_count, [&](auto J) {
+                            get<1>(J) += static_cast<double_t>(get<0>(J)) / divisor;
+                        });
+                    });
 
-            auto p = obase_.base()[0];
-            auto q_mod_p = modulo_uint(ibase_.base_prod(), ibase_size, p);
-            auto base_change_matrix_first = base_change_matrix_[0].get();
-            // Final multiplication
-            SEAL_ITERATE(iter(out, temp, aggregated_rounded_v), count, [&](auto J) {
-                // Compute the base conversion sum modulo obase element
-                auto sum_mod_obase = dot_product_mod(get<1>(J), base_change_matrix_first, ibase_size, p);
-                // Minus v*[q]_{p} mod p
-                auto v_q_mod_p = multiply_uint_mod(get<2>(J), q_mod_p, p);
-                get<0>(J) = sub_uint_mod(sum_mod_obase, v_q_mod_p, p);
-            });
+                // Compute the fast conversion and subtract v * [prod(ibase)]_{p} mod p for each obase element p
+                SEAL_ITERATE(
+                    iter(out, base_change_matrix_shoup_, prod_mod_obase, obase_.base()), obase_size, [&](auto I) {
+                        multiply_accumulate_coeffmod(
+                            temp_rows.get(), ibase_size, tile_count, get<1>(I).get(), get<3>(I),
+                            get<0>(I).ptr() + offset);
+                        SEAL_ITERATE(iter(get<0>(I) + offset, v.get()), tile_count, [&](auto J) {
+                            uint64_t rounded_v = static_cast<uint64_t>(get<1>(J) + 0.5);
+                            get<0>(J) = sub_uint_mod(
+                                get<0>(J), multiply_uint_mod(rounded_v, get<2>(I), get<3>(I)), get<3>(I));
+                        });
+                    });
+            }
         }
 
         void BaseConverter::initialize()
@@ -548,22 +670,30 @@ namespace seal
 
             // Create the base-change matrix rows
             base_change_matrix_ = allocate<Pointer<uint64_t>>(obase_.size(), pool_);
+            base_change_matrix_shoup_ = allocate<Pointer<MultiplyUIntModOperand>>(obase_.size(), pool_);
+
+            SEAL_ITERATE(
+                iter(base_change_matrix_, base_change_matrix_shoup_, obase_.base()), obase_.size(), [&](auto I) {
+                    // Create the base-change matrix columns
+                    get<0>(I) = allocate_uint(ibase_.size(), pool_);
+                    get<1>(I) = allocate<MultiplyUIntModOperand>(ibase_.size(), pool_);
 
-            SEAL_ITERATE(iter(base_change_matrix_, obase_.base()), obase_.size(), [&](auto I) {
-                // Create the base-change matrix columns
-                get<0>(I) = allocate_uint(ibase_.size(), pool_);
+                    StrideIter<const uint64_t *> ibase_punctured_prod_array(
+                        ibase_.punctured_prod_array(), ibase_.size());
+                    SEAL_ITERATE(
+                        iter(get<0>(I), get<1>(I), ibase_punctured_prod_array), ibase_.size(), [&](auto J) {
+                            // Base-change matrix contains the punctured products of ibase elements modulo the obase
+                            get<0>(J) = modulo_uint(get<2>(J), ibase_.size(), get<2>(I));
 
-                StrideIter<const uint64_t *> ibase_punctured_prod_array(ibase_.punctured_prod_array(), ibase_.size());
-                SEAL_ITERATE(iter(get<0>(I), ibase_punctured_prod_array), ibase_.size(), [&](auto J) {
-                    // Base-change matrix contains the punctured products of ibase elements modulo the obase
-                    get<0>(J) = modulo_uint(get<1>(J), ibase_.size(), get<1>(I));
+                            // The vectorized kernels use the same entries with precomputed quotients
+                            get<1>(J).set(get<0>(J), get<2>(I));
+                        });
                 });
-            });
         }
 
         RNSTool::RNSTool(
             size_t poly_modulus_degree, const RNSBase &coeff_modulus, const Modulus &plain_modulus,
-            MemoryPoolHandle pool)
+            MemoryPoolHandle pool, bool use_hps)
             : pool_(move(pool))
         {
 #ifdef SEAL_DEBUG
@@ -573,6 +703,10 @@ namespace seal
             }
 #endif
             initialize(poly_modulus_degree, coeff_modulus, plain_modulus);
+            if (use_hps && !t_.is_zero())
+            {
+                initialize_hps();
+            }
         }
 
         void RNSTool::initialize(size_t poly_modulus_degree, const RNSBase &q, const Modulus &t)
@@ -650,9 +784,8 @@ namespace seal
             // Generate the Bsk NTTTables; these are used for NTT after base extension to Bsk
             try
             {
-                CreateNTTTables(
-                    coeff_count_power, vector<Modulus>(base_Bsk_->base(), base_Bsk_->base() + base_Bsk_size),
-                    base_Bsk_ntt_tables_, pool_);
+                base_Bsk_ntt_tables_ = GetSharedNTTTables(
+                    coeff_count_power, vector<Modulus>(base_Bsk_->base(), base_Bsk_->base() + base_Bsk_size));
             }
             catch (const logic_error &)
             {
@@ -677,12 +810,6 @@ namespace seal
             // Set up BaseConverter for B --> {m_sk}
             base_B_to_m_sk_conv_ = allocate<BaseConverter>(pool_, *base_B_, RNSBase({ m_sk_ }, pool_), pool_);
 
-            if (base_t_gamma_)
-            {
-                // Set up BaseConverter for q --> {t, gamma}
-                base_q_to_t_gamma_conv_ = allocate<BaseConverter>(pool_, *base_q_, *base_t_gamma_, pool_);
-            }
-
             // Compute prod(B) mod q
             prod_B_mod_q_ = allocate_uint(base_q_size, pool_);
             SEAL_ITERATE(iter(prod_B_mod_q_, base_q_->base()), base_q_size, [&](auto I) {
@@ -744,23 +871,32 @@ namespace seal
                 }
                 inv_gamma_mod_t_.set(temp, t_);
 
-                // Compute prod({t, gamma}) mod q
-                prod_t_gamma_mod_q_ = allocate<MultiplyUIntModOperand>(base_q_size, pool_);
-                SEAL_ITERATE(iter(prod_t_gamma_mod_q_, base_q_->base()), base_q_size, [&](auto I) {
-                    get<0>(I).set(
-                        multiply_uint_mod((*base_t_gamma_)[0].value(), (*base_t_gamma_)[1].value(), get<1>(I)),
-                        get<1>(I));
-                });
+                // The fast base conversion of |t * gamma * x|_q to {t, gamma} followed by the multiplication with
+                // -prod(q)^(-1) is a single product with the matrix (q / q_i) * -prod(q)^(-1) = -q_i^(-1) mod {t,
+                // gamma}, applied to the input multiplied with prod({t, gamma}) * (q / q_i)^(-1) mod q_i
+
+                // Compute prod({t, gamma}) * (q / q_i)^(-1) mod q_i
+                prod_t_gamma_inv_punctured_q_mod_q_ = allocate<MultiplyUIntModOperand>(base_q_size, pool_);
+                SEAL_ITERATE(
+                    iter(prod_t_gamma_inv_punctured_q_mod_q_, base_q_->inv_punctured_prod_mod_base_array(),
+                         base_q_->base()),
+                    base_q_size, [&](auto I) {
+                        uint64_t prod_t_gamma =
+                            multiply_uint_mod((*base_t_gamma_)[0].value(), (*base_t_gamma_)[1].value(), get<2>(I));
+                        get<0>(I).set(multiply_uint_mod(prod_t_gamma, get<1>(I), get<2>(I)), get<2>(I));
+                    });
 
-                // Compute -prod(q)^(-1) mod {t, gamma}
-                neg_inv_q_mod_t_gamma_ = allocate<MultiplyUIntModOperand>(base_t_gamma_size, pool_);
+                // Compute -q_i^(-1) mod {t, gamma}
+                neg_inv_q_mod_t_gamma_ = allocate<Pointer<MultiplyUIntModOperand>>(base_t_gamma_size, pool_);
                 SEAL_ITERATE(iter(neg_inv_q_mod_t_gamma_, base_t_gamma_->base()), base_t_gamma_size, [&](auto I) {
-                    get<0>(I).operand = modulo_uint(base_q_->base_prod(), base_q_size, get<1>(I));
-                    if (!try_invert_uint_mod(get<0>(I).operand, get<1>(I), get<0>(I).operand))
-                    {
-                        throw logic_error("invalid rns bases");
-                    }
-                    get<0>(I).set(negate_uint_mod(get<0>(I).operand, get<1>(I)), get<1>(I));
+                    get<0>(I) = allocate<MultiplyUIntModOperand>(base_q_size, pool_);
+                    SEAL_ITERATE(iter(get<0>(I), base_q_->base()), base_q_size, [&](auto J) {
+                        if (!try_invert_uint_mod(barrett_reduce_64(get<1>(J).value(), get<1>(I)), get<1>(I), temp))
+                        {
+                            throw logic_error("invalid rns bases");
+                        }
+                        get<0>(J).set(negate_uint_mod(temp, get<1>(I)), get<1>(I));
+                    });
                 });
             }
 
@@ -786,6 +922,95 @@ namespace seal
             }
         }
 
+        // See "An Improved RNS Variant of the BFV Homomorphic Encryption Scheme" (CT-RSA 2019) for details
+        void RNSTool::initialize_hps()
+        {
+            size_t base_q_size = base_q_->size();
+            int coeff_count_power = get_power_of_two(coeff_count_);
+
+            // The tensor product of two ciphertexts has coefficients of absolute value at most K * n * q^2 / 4, where
+            // K takes into account cross terms when larger size ciphertexts are used, and scaling it by t / q must give
+            // a value of absolute value less than prod(P) / 2. As for the base B, we reserve 32 bits for K * n. The
+            // primes in P are SEAL_INTERNAL_MOD_BIT_COUNT (61) bits, hence larger than 2^60, and distinct from the
+            // coefficient modulus primes, which are at most SEAL_USER_MOD_BIT_COUNT_MAX (60) bits.
+            int total_coeff_bit_count = get_significant_bit_count_uint(base_q_->base_prod(), base_q_size);
+            int base_P_bit_count = 32 + t_.bit_count() + total_coeff_bit_count;
+            size_t base_P_size = safe_cast<size_t>(
+                (base_P_bit_count + SEAL_INTERNAL_MOD_BIT_COUNT - 2) / (SEAL_INTERNAL_MOD_BIT_COUNT - 1));
+
+            // Size check
+            if (!product_fits_in(coeff_count_, add_safe(base_q_size, base_P_size)))
+            {
+                throw logic_error("invalid parameters");
+            }
+
+            base_P_ = allocate<RNSBase>(
+                pool_, get_primes(mul_safe(size_t(2), coeff_count_), SEAL_INTERNAL_MOD_BIT_COUNT, base_P_size), pool_);
+
+            // Generate the P NTTTables; these are used for NTT after base extension to P
+            try
+            {
+                base_P_ntt_tables_ = GetSharedNTTTables(
+                    coeff_count_power, vector<Modulus>(base_P_->base(), base_P_->base() + base_P_size));
+            }
+            catch (const logic_error &)
+            {
+                throw logic_error("invalid rns bases");
+            }
+
+            // Set up BaseConverters for q --> P and P --> q
+            base_q_to_P_conv_ = allocate<BaseConverter>(pool_, *base_q_, *base_P_, pool_);
+            base_P_to_q_conv_ = allocate<BaseConverter>(pool_, *base_P_, *base_q_, pool_);
+
+            // For input x in base q U P, t * x / q is congruent modulo P to
+            //
+            //     sum_i x_i * (t * P * (q * P / q_i)^(-1)) / q_i + y_j * t * q^(-1)
+            //
+            // modulo p_j, up to multiples of t * P, where x_i and y_j are the residues of x modulo q_i and p_j. Since
+            // P * (q * P / q_i)^(-1) = (q / q_i)^(-1) mod q_i, the numerator of the i-th fraction is r_i plus a
+            // multiple of q_i for r_i = t * (q / q_i)^(-1) mod q_i, and the integer part of the fraction is congruent
+            // to -r_i * q_i^(-1) modulo p_j.
+            r_div_q_frac_ = allocate_uint(base_q_size, pool_);
+            auto r_mod_q(allocate_uint(base_q_size, pool_));
+            SEAL_ITERATE(
+                iter(base_q_->inv_punctured_prod_mod_base_array(), base_q_->base(), r_div_q_frac_, r_mod_q),
+                base_q_size, [&](auto I) {
+                    uint64_t r = multiply_uint_mod(barrett_reduce_64(t_.value(), get<1>(I)), get<0>(I), get<1>(I));
+
+                    // Compute round(r_i * 2^64 / q_i), which is less than 2^64 since r_i < q_i
+                    uint64_t numerator[2]{ get<1>(I).value() >> 1, r };
+                    uint64_t quotient[2]{ 0, 0 };
+                    divide_uint128_inplace(numerator, get<1>(I).value(), quotient);
+                    get<2>(I) = quotient[0];
+                    get<3>(I) = r;
+                });
+
+            neg_r_inv_q_mod_P_ = allocate<Pointer<MultiplyUIntModOperand>>(base_P_size, pool_);
+            t_inv_prod_q_mod_P_ = allocate<MultiplyUIntModOperand>(base_P_size, pool_);
+            SEAL_ITERATE(
+                iter(neg_r_inv_q_mod_P_, t_inv_prod_q_mod_P_, base_P_->base()), base_P_size, [&](auto I) {
+                    uint64_t temp;
+                    get<0>(I) = allocate<MultiplyUIntModOperand>(base_q_size, pool_);
+                    for (size_t i = 0; i < base_q_size; i++)
+                    {
+                        if (!try_invert_uint_mod(barrett_reduce_64((*base_q_)[i].value(), get<2>(I)), get<2>(I), temp))
+                        {
+                            throw logic_error("invalid rns bases");
+                        }
+                        uint64_t r = barrett_reduce_64(r_mod_q[i], get<2>(I));
+                        get<0>(I)[i].set(multiply_uint_mod(negate_uint_mod(r, get<2>(I)), temp, get<2>(I)), get<2>(I));
+                    }
+
+                    temp = modulo_uint(base_q_->base_prod(), base_q_size, get<2>(I));
+                    if (!try_invert_uint_mod(temp, get<2>(I), temp))
+                    {
+                        throw logic_error("invalid rns bases");
+                    }
+                    get<1>(I).set(
+                        multiply_uint_mod(temp, barrett_reduce_64(t_.value(), get<2>(I)), get<2>(I)), get<2>(I));
+                });
+        }
+
         void RNSTool::divide_and_round_q_last_inplace(RNSIter input, MemoryPoolHandle pool) const
         {
 #ifdef SEAL_DEBUG
@@ -1130,6 +1355,87 @@ namespace seal
             base_q_to_m_tilde_conv_->fast_convert_array(temp, destination + base_Bsk_size, pool);
         }
 
+        void RNSTool::hps_extend_q_to_P(ConstRNSIter input, RNSIter destination, MemoryPoolHandle pool) const
+        {
+#ifdef SEAL_DEBUG
+            if (!base_P_)
+            {
+                throw logic_error("HPS is not enabled");
+            }
+            if (input.poly_modulus_degree() != coeff_count_ || destination.poly_modulus_degree() != coeff_count_)
+            {
+                throw invalid_argument("input or destination is not valid for encryption parameters");
+            }
+#endif
+            base_q_to_P_conv_->exact_convert_array(input, destination, pool);
+        }
+
+        void RNSTool::hps_scale_and_round(
+            ConstRNSIter input_q, ConstRNSIter input_P, RNSIter destination, MemoryPoolHandle pool) const
+        {
+#ifdef SEAL_DEBUG
+            if (!base_P_)
+            {
+                throw logic_error("HPS is not enabled");
+            }
+            if (input_q.poly_modulus_degree() != coeff_count_ || input_P.poly_modulus_degree() != coeff_count_ ||
+                destination.poly_modulus_degree() != coeff_count_)
+            {
+                throw invalid_argument("input or destination is not valid for encryption parameters");
+            }
+            if (!pool)
+            {
+                throw invalid_argument("pool is uninitialized");
+            }
+#endif
+            size_t base_q_size = base_q_->size();
+            size_t base_P_size = base_P_->size();
+
+            // Round sum_i x_i * r_i / q_i. The products with the 64-bit fixed-point fractions are below 2^125 and
+            // their sum is accumulated in three words; the rounded sum occupies the upper two words.
+            const uint64_t *input_q_ptr = (*input_q).ptr();
+            SEAL_ALLOCATE_GET_STRIDE_ITER(rounded_frac_sum, uint64_t, coeff_count_, size_t(2), pool);
+            SEAL_ITERATE(iter(rounded_frac_sum, size_t(0)), coeff_count_, [&](auto I) {
+                unsigned long long sum[3]{ uint64_t(1) << 63, 0, 0 };
+                for (size_t i = 0; i < base_q_size; i++)
+                {
+                    unsigned long long product[2];
+                    multiply_uint64(input_q_ptr[i * coeff_count_ + get<1>(I)], r_div_q_frac_[i], product);
+                    sum[2] += add_uint128(product, sum, sum);
+                }
+                get<0>(I)[0] = sum[1];
+                get<0>(I)[1] = sum[2];
+            });
+
+            // Add the integer parts and y_j * t * q^(-1)
+            SEAL_ITERATE(
+                iter(destination, input_P, neg_r_inv_q_mod_P_, t_inv_prod_q_mod_P_, base_P_->base()), base_P_size,
+                [&](auto I) {
+                    multiply_accumulate_coeffmod(
+                        input_q_ptr, base_q_size, coeff_count_, get<2>(I).get(), get<4>(I), get<0>(I).ptr());
+                    SEAL_ITERATE(iter(get<0>(I), get<1>(I), rounded_frac_sum), coeff_count_, [&](auto J) {
+                        uint64_t rounded = barrett_reduce_128(get<2>(J).ptr(), get<4>(I));
+                        uint64_t scaled = multiply_uint_mod(get<1>(J), get<3>(I), get<4>(I));
+                        get<0>(J) = add_uint_mod(add_uint_mod(get<0>(J), rounded, get<4>(I)), scaled, get<4>(I));
+                    });
+                });
+        }
+
+        void RNSTool::hps_convert_P_to_q(ConstRNSIter input, RNSIter destination, MemoryPoolHandle pool) const
+        {
+#ifdef SEAL_DEBUG
+            if (!base_P_)
+            {
+                throw logic_error("HPS is not enabled");
+            }
+            if (input.poly_modulus_degree() != coeff_count_ || destination.poly_modulus_degree() != coeff_count_)
+            {
+                throw invalid_argument("input or destination is not valid for encryption parameters");
+            }
+#endif
+            base_P_to_q_conv_->exact_convert_array(input, destination, pool);
+        }
+
         void RNSTool::decrypt_scale_and_round(ConstRNSIter input, CoeffIter destination, MemoryPoolHandle pool) const
         {
 #ifdef SEAL_DEBUG
@@ -1141,7 +1447,23 @@ namespace seal
             {
                 throw invalid_argument("input is not valid for encryption parameters");
             }
-            if (!destination)
+#endif
+            decrypt_scale_and_round(ConstPolyIter((*input).ptr(), coeff_count_, base_q_->size()), 1, destination, pool);
+        }
+
+        void RNSTool::decrypt_scale_and_round(
+            ConstPolyIter input, size_t count, CoeffIter destination, MemoryPoolHandle pool) const
+        {
+#ifdef SEAL_DEBUG
+            if (input == nullptr && count)
+            {
+                throw invalid_argument("input cannot be null");
+            }
+            if (input.poly_modulus_degree() != coeff_count_ || input.coeff_modulus_size() != base_q_->size())
+            {
+                throw invalid_argument("input is not valid for encryption parameters");
+            }
+            if (!destination && count)
             {
                 throw invalid_argument("destination cannot be null");
             }
@@ -1151,51 +1473,50 @@ namespace seal
             }
 #endif
             size_t base_q_size = base_q_->size();
-            size_t base_t_gamma_size = base_t_gamma_->size();
-
-            // Compute |gamma * t|_qi * ct(s)
-            SEAL_ALLOCATE_GET_RNS_ITER(temp, coeff_count_, base_q_size, pool);
-            SEAL_ITERATE(iter(input, prod_t_gamma_mod_q_, base_q_->base(), temp), base_q_size, [&](auto I) {
-                multiply_poly_scalar_coeffmod(get<0>(I), coeff_count_, get<1>(I), get<2>(I), get<3>(I));
-            });
+            const Modulus &gamma = (*base_t_gamma_)[1];
 
-            // Make another temp destination to get the poly in mod {t, gamma}
-            SEAL_ALLOCATE_GET_RNS_ITER(temp_t_gamma, coeff_count_, base_t_gamma_size, pool);
+            // Need to correct values in the gamma component which are larger than floor(gamma/2)
+            uint64_t gamma_div_2 = gamma.value() >> 1;
 
-            // Convert from q to {t, gamma}
-            base_q_to_t_gamma_conv_->fast_convert_array(temp, temp_t_gamma, pool);
+            // The coefficients are processed one tile at a time; the rows of |gamma * t * (q / q_i)^(-1) * ct(s)|_qi
+            // of a tile stay in the cache while both rows of -q_i^(-1) mod {t, gamma} are applied to them
+            size_t tile_size = min(coeff_count_, base_conversion_tile_size);
+            auto temp_rows(allocate_uint(mul_safe(tile_size, base_q_size), pool));
+            SEAL_ALLOCATE_GET_RNS_ITER(temp_t_gamma, tile_size, size_t(2), pool);
 
-            // Multiply by -prod(q)^(-1) mod {t, gamma}
-            SEAL_ITERATE(
-                iter(temp_t_gamma, neg_inv_q_mod_t_gamma_, base_t_gamma_->base(), temp_t_gamma), base_t_gamma_size,
-                [&](auto I) {
-                    multiply_poly_scalar_coeffmod(get<0>(I), coeff_count_, get<1>(I), get<2>(I), get<3>(I));
-                });
+            SEAL_ITERATE(iter(input, size_t(0)), count, [&](auto I) {
+                CoeffIter phase_destination = destination + get<1>(I) * coeff_count_;
+                for (size_t offset = 0; offset < coeff_count_; offset += tile_size)
+                {
+                    size_t tile_count = min(tile_size, coeff_count_ - offset);
 
-            // Need to correct values in temp_t_gamma (gamma component only) which are
-            // larger than floor(gamma/2)
-            uint64_t gamma_div_2 = (*base_t_gamma_)[1].value() >> 1;
+                    // Compute |gamma * t * (q / q_i)^(-1)|_qi * ct(s)
+                    SEAL_ITERATE(
+                        iter(get<0>(I), prod_t_gamma_inv_punctured_q_mod_q_, base_q_->base(), size_t(0)), base_q_size,
+                        [&](auto J) {
+                            multiply_poly_scalar_coeffmod(
+                                get<0>(J) + offset, tile_count, get<1>(J), get<2>(J),
+                                temp_rows.get() + get<3>(J) * tile_count);
+                        });
 
-            // Now compute the subtraction to remove error and perform final multiplication by
-            // gamma inverse mod t
-            SEAL_ITERATE(iter(temp_t_gamma[0], temp_t_gamma[1], destination), coeff_count_, [&](auto I) {
-                // Need correction because of centered mod
-                if (get<1>(I) > gamma_div_2)
-                {
-                    // Compute -(gamma - a) instead of (a - gamma)
-                    get<2>(I) = add_uint_mod(get<0>(I), barrett_reduce_64(gamma_.value() - get<1>(I), t_), t_);
-                }
-                // No correction needed
-                else
-                {
-                    get<2>(I) = sub_uint_mod(get<0>(I), barrett_reduce_64(get<1>(I), t_), t_);
-                }
+                    // Convert to {t, gamma} and multiply by -prod(q)^(-1) in one pass
+                    SEAL_ITERATE(iter(temp_t_gamma, neg_inv_q_mod_t_gamma_, base_t_gamma_->base()), 2, [&](auto J) {
+                        multiply_accumulate_coeffmod(
+                            temp_rows.get(), base_q_size, tile_count, get<1>(J).get(), get<2>(J), get<0>(J).ptr());
+                    });
 
-                // If this coefficient was non-zero, multiply by gamma^(-1)
-                if (0 != get<2>(I))
-                {
-                    // Perform final multiplication by gamma inverse mod t
-                    get<2>(I) = multiply_uint_mod(get<2>(I), inv_gamma_mod_t_, t_);
+                    // Now compute the subtraction to remove error and perform final multiplication by gamma inverse
+                    // mod t; the correction is computed without branches
+                    SEAL_ITERATE(
+                        iter(temp_t_gamma[0], temp_t_gamma[1], phase_destination + offset), tile_count, [&](auto J) {
+                            // Need correction because of centered mod: compute -(gamma - a) instead of (a - gamma)
+                            bool negative = get<1>(J) > gamma_div_2;
+                            uint64_t magnitude =
+                                barrett_reduce_64(negative ? gamma.value() - get<1>(J) : get<1>(J), t_);
+                            uint64_t difference = negative ? add_uint_mod(get<0>(J), magnitude, t_)
+                                                           : sub_uint_mod(get<0>(J), magnitude, t_);
+                            get<2>(J) = multiply_uint_mod(difference, inv_gamma_mod_t_, t_);
+                        });
                 }
             });
         }
@@ -1239,10 +1560,432 @@ namespace seal
             });
         }
 
-        void RNSTool::decrypt_modt(RNSIter phase, CoeffIter destination, MemoryPoolHandle pool) const
+        void RNSTool::decrypt_modt(ConstRNSIter phase, CoeffIter destination, MemoryPoolHandle pool) const
         {
             // Use exact base convension rather than convert the base through the compose API
             base_q_to_t_conv_->exact_convert_array(phase, destination, pool);
         }
+
+        void RNSTool::decrypt_modt(
+            ConstPolyIter phase, size_t count, CoeffIter destination, MemoryPoolHandle pool) const
+        {
+#ifdef SEAL_DEBUG
+            if (phase.poly_modulus_degree() != coeff_count_ || phase.coeff_modulus_size() != base_q_->size())
+            {
+                throw invalid_argument("phase is not valid for encryption parameters");
+            }
+#endif
+            SEAL_ITERATE(iter(phase, size_t(0)), count, [&](auto I) {
+                base_q_to_t_conv_->exact_convert_array(get<0>(I), destination + get<1>(I) * coeff_count_, pool);
+            });
+        }
+
+        KSwitchTool::KSwitchTool(
+            size_t poly_modulus_degree, const RNSBase &base_q, const RNSBase &base_P, size_t digit_size,
+            const Modulus &plain_modulus, MemoryPoolHandle pool)
+            : pool_(move(pool)), coeff_count_(poly_modulus_degree), digit_size_(digit_size), t_(plain_modulus)
+        {
+            if (!pool_)
+            {
+                throw invalid_argument("pool is uninitialized");
+            }
+
+            // Return if coeff_count is not a power of two or out of bounds
+            int coeff_count_power = get_power_of_two(poly_modulus_degree);
+            if (coeff_count_power < 0 || poly_modulus_degree > SEAL_POLY_MOD_DEGREE_MAX ||
+                poly_modulus_degree < SEAL_POLY_MOD_DEGREE_MIN)
+            {
+                throw invalid_argument("poly_modulus_degree is invalid");
+            }
+            if (!digit_size_)
+            {
+                throw invalid_argument("digit_size cannot be zero");
+            }
+
+            // This throws if the bases are not coprime
+            RNSBase base_qP = base_q.extend(base_P);
+
+            size_t base_q_size = base_q.size();
+            size_t base_P_size = base_P.size();
+            size_t base_qP_size = base_qP.size();
+            digit_count_ = base_q_size / digit_size_ + (base_q_size % digit_size_ != 0);
+
+            // Size check
+            if (!product_fits_in(coeff_count_, base_qP_size))
+            {
+                throw logic_error("invalid parameters");
+            }
+
+            base_q_ = allocate<RNSBase>(pool_, base_q, pool_);
+            base_P_ = allocate<RNSBase>(pool_, base_P, pool_);
+
+            // With one special prime the conversions from P are reductions
+            if (base_P_size > 1)
+            {
+                base_P_to_q_conv_ = allocate<BaseConverter>(pool_, *base_P_, *base_q_, pool_);
+            }
+
+            // Compute Q_j / q_i mod m for every modulus m of q U P
+            punctured_digit_prod_mod_qP_ = allocate<Pointer<MultiplyUIntModOperand>>(base_qP_size, pool_);
+            for (size_t r = 0; r < base_qP_size; r++)
+            {
+                const Modulus &modulus = base_qP[r];
+                punctured_digit_prod_mod_qP_[r] = allocate<MultiplyUIntModOperand>(base_q_size, pool_);
+                for (size_t i = 0; i < base_q_size; i++)
+                {
+                    size_t digit_first = i - i % digit_size_;
+                    size_t digit_end = min(digit_first + digit_size_, base_q_size);
+                    uint64_t prod = 1;
+                    for (size_t j = digit_first; j < digit_end; j++)
+                    {
+                        if (j != i)
+                        {
+                            prod = multiply_uint_mod(prod, barrett_reduce_64(base_q[j].value(), modulus), modulus);
+                        }
+                    }
+                    punctured_digit_prod_mod_qP_[r][i].set(prod, modulus);
+                }
+            }
+
+            // Compute (Q_j / q_i)^(-1) mod q_i
+            inv_punctured_digit_prod_mod_q_ = allocate<MultiplyUIntModOperand>(base_q_size, pool_);
+            for (size_t i = 0; i < base_q_size; i++)
+            {
+                uint64_t temp = 0;
+                if (!try_invert_uint_mod(punctured_digit_prod_mod_qP_[i][i].operand, base_q[i], temp))
+                {
+                    throw logic_error("invalid rns bases in computing inv_punctured_digit_prod_mod_q");
+                }
+                inv_punctured_digit_prod_mod_q_[i].set(temp, base_q[i]);
+            }
+
+            // Compute prod(P) mod q and its inverse
+            prod_P_mod_q_ = allocate_uint(base_q_size, pool_);
+            inv_prod_P_mod_q_ = allocate<MultiplyUIntModOperand>(base_q_size, pool_);
+            SEAL_ITERATE(iter(prod_P_mod_q_, inv_prod_P_mod_q_, base_q.base()), base_q_size, [&](auto I) {
+                get<0>(I) = modulo_uint(base_P.base_prod(), base_P_size, get<2>(I));
+                uint64_t temp = 0;
+                if (!try_invert_uint_mod(get<0>(I), get<2>(I), temp))
+                {
+                    throw logic_error("invalid rns bases in computing inv_prod_P_mod_q");
+                }
+                get<1>(I).set(temp, get<2>(I));
+            });
+
+            // Compute floor(prod(P) / 2) mod P and mod q
+            auto half_prod_P(allocate_uint(base_P_size, pool_));
+            right_shift_uint(base_P.base_prod(), 1, base_P_size, half_prod_P.get());
+            half_prod_P_mod_P_ = allocate_uint(base_P_size, pool_);
+            SEAL_ITERATE(iter(half_prod_P_mod_P_, base_P.base()), base_P_size, [&](auto I) {
+                get<0>(I) = modulo_uint(half_prod_P.get(), base_P_size, get<1>(I));
+            });
+            half_prod_P_mod_q_ = allocate_uint(base_q_size, pool_);
+            SEAL_ITERATE(iter(half_prod_P_mod_q_, base_q.base()), base_q_size, [&](auto I) {
+                get<0>(I) = modulo_uint(half_prod_P.get(), base_P_size, get<1>(I));
+            });
+
+            // Compute -prod(P)^(-1) mod t for BGV
+            if (!t_.is_zero())
+            {
+                if (base_P_size > 1)
+                {
+                    base_P_to_t_conv_ = allocate<BaseConverter>(pool_, *base_P_, RNSBase({ t_ }, pool_), pool_);
+                }
+
+                uint64_t temp = 0;
+                if (!try_invert_uint_mod(modulo_uint(base_P.base_prod(), base_P_size, t_), t_, temp))
+                {
+                    throw logic_error("invalid rns bases in computing neg_inv_prod_P_mod_t");
+                }
+                neg_inv_prod_P_mod_t_.set(negate_uint_mod(temp, t_), t_);
+            }
+        }
+
+        void KSwitchTool::scale_digits_inplace(RNSIter input) const
+        {
+#ifdef SEAL_DEBUG
+            if (!input)
+            {
+                throw invalid_argument("input cannot be null");
+            }
+            if (input.poly_modulus_degree() != coeff_count_)
+            {
+                throw invalid_argument("input is not valid for encryption parameters");
+            }
+#endif
+            if (digit_size_ == 1)
+            {
+                return;
+            }
+
+            SEAL_ITERATE(
+                iter(input, inv_punctured_digit_prod_mod_q_, base_q_->base()), base_q_->size(), [&](auto I) {
+                    if (get<1>(I).operand != 1)
+                    {
+                        multiply_poly_scalar_coeffmod(get<0>(I), coeff_count_, get<1>(I), get<2>(I), get<0>(I));
+                    }
+                });
+        }
+
+        void KSwitchTool::convert_digit(
+            ConstRNSIter input, size_t digit_index, size_t modulus_index, CoeffIter destination) const
+        {
+            size_t base_q_size = base_q_->size();
+#ifdef SEAL_DEBUG
+            if (!input || !destination)
+            {
+                throw invalid_argument("input and destination cannot be null");
+            }
+            if (input.poly_modulus_degree() != coeff_count_)
+            {
+                throw invalid_argument("input is not valid for encryption parameters");
+            }
+            if (digit_index >= digit_count_ || modulus_index >= base_q_size + base_P_->size())
+            {
+                throw out_of_range("digit_index or modulus_index is out of range");
+            }
+#endif
+            size_t digit_first = digit_index * digit_size_;
+            size_t digit_length = min(digit_size_, base_q_size - digit_first);
+            const Modulus &modulus =
+                modulus_index < base_q_size ? (*base_q_)[modulus_index] : (*base_P_)[modulus_index - base_q_size];
+            ConstCoeffIter digit_input = input[digit_first];
+
+            if (digit_length == 1)
+            {
+                // A single prime only needs a reduction
+                if ((*base_q_)[digit_first] <= modulus)
+                {
+                    set_uint(digit_input, coeff_count_, destination);
+                }
+                else
+                {
+                    modulo_poly_coeffs(digit_input, coeff_count_, modulus, destination);
+                }
+                return;
+            }
+
+            // sum_i [x_{i} * (Q_j / q_i)^(-1)]_{q_i} * (Q_j / q_i) mod m over the primes of the digit
+            multiply_accumulate_coeffmod(
+                digit_input.ptr(), digit_length, coeff_count_,
+                punctured_digit_prod_mod_qP_[modulus_index].get() + digit_first, modulus, destination.ptr());
+        }
+
+        void KSwitchTool::divide_and_round_P_delta(RNSIter input_P, RNSIter destination, MemoryPoolHandle pool) const
+        {
+#ifdef SEAL_DEBUG
+            if (!input_P || !destination)
+            {
+                throw invalid_argument("input_P and destination cannot be null");
+            }
+            if (input_P.poly_modulus_degree() != coeff_count_ || destination.poly_modulus_degree() != coeff_count_)
+            {
+                throw invalid_argument("input_P or destination is not valid for encryption parameters");
+            }
+            if (!pool)
+            {
+                throw invalid_argument("pool is uninitialized");
+            }
+#endif
+            size_t base_q_size = base_q_->size();
+            size_t base_P_size = base_P_->size();
+
+            // Add floor(P / 2) to change from flooring to rounding
+            SEAL_ITERATE(iter(input_P, base_P_->base(), half_prod_P_mod_P_), base_P_size, [&](auto I) {
+                SEAL_ITERATE(
+                    get<0>(I), coeff_count_, [&](auto &J) { J = barrett_reduce_64(J + get<2>(I), get<1>(I)); });
+            });
+
+            if (base_P_size == 1)
+            {
+                SEAL_ITERATE(iter(destination, base_q_->base()), base_q_size, [&](auto I) {
+                    // (ct mod p) mod qi
+                    if ((*base_P_)[0].value() > get<1>(I).value())
+                    {
+                        modulo_poly_coeffs(input_P[0], coeff_count_, get<1>(I), get<0>(I));
+                    }
+                    else
+                    {
+                        set_uint(input_P[0], coeff_count_, get<0>(I));
+                    }
+                });
+            }
+            else
+            {
+                base_P_to_q_conv_->fast_convert_array(input_P, destination, pool);
+            }
+
+            // Lazy subtraction of floor(P / 2), results in [0, 2 * qi)
+            SEAL_ITERATE(iter(destination, base_q_->base(), half_prod_P_mod_q_), base_q_size, [&](auto I) {
+                uint64_t fix = get<1>(I).value() - get<2>(I);
+                SEAL_ITERATE(get<0>(I), coeff_count_, [fix](auto &K) { K += fix; });
+            });
+        }
+
+        void KSwitchTool::mod_t_and_divide_P_delta(RNSIter input_P, RNSIter destination, MemoryPoolHandle pool) const
+        {
+#ifdef SEAL_DEBUG
+            if (!input_P || !destination)
+            {
+                throw invalid_argument("input_P and destination cannot be null");
+            }
+            if (input_P.poly_modulus_degree() != coeff_count_ || destination.poly_modulus_degree() != coeff_count_)
+            {
+                throw invalid_argument("input_P or destination is not valid for encryption parameters");
+            }
+            if (!pool)
+            {
+                throw invalid_argument("pool is uninitialized");
+            }
+#endif
+            if (t_.is_zero())
+            {
+                throw logic_error("plain_modulus is not set");
+            }
+
+            size_t base_q_size = base_q_->size();
+            size_t base_P_size = base_P_->size();
+            SEAL_ITERATE(iter(input_P, base_P_->base()), base_P_size, [&](auto I) {
+                modulo_poly_coeffs(get<0>(I), coeff_count_, get<1>(I), get<0>(I));
+            });
+
+            // The same representative y of x mod P is computed modulo t and modulo q; k = -y * P^(-1) mod t
+            SEAL_ALLOCATE_GET_COEFF_ITER(k, coeff_count_, pool);
+            if (base_P_size == 1)
+            {
+                modulo_poly_coeffs(input_P[0], coeff_count_, t_, k);
+                SEAL_ITERATE(iter(destination, base_q_->base()), base_q_size, [&](auto I) {
+                    modulo_poly_coeffs(input_P[0], coeff_count_, get<1>(I), get<0>(I));
+                });
+            }
+            else
+            {
+                base_P_to_t_conv_->fast_convert_array(input_P, RNSIter(k, coeff_count_), pool);
+                base_P_to_q_conv_->fast_convert_array(input_P, destination, pool);
+            }
+            multiply_poly_scalar_coeffmod(k, coeff_count_, neg_inv_prod_P_mod_t_, t_, k);
+
+            // delta = y + k * P mod qi, results in [0, 2 * qi)
+            SEAL_ALLOCATE_GET_COEFF_ITER(temp, coeff_count_, pool);
+            SEAL_ITERATE(iter(destination, base_q_->base(), prod_P_mod_q_), base_q_size, [&](auto I) {
+                modulo_poly_coeffs(k, coeff_count_, get<1>(I), temp);
+                multiply_poly_scalar_coeffmod(temp, coeff_count_, get<2>(I), get<1>(I), temp);
+                SEAL_ITERATE(iter(get<0>(I), temp), coeff_count_, [](auto J) { get<0>(J) += get<1>(J); });
+            });
+        }
+
+        void KSwitchTool::divide_and_round_P_inplace(RNSIter input, MemoryPoolHandle pool) const
+        {
+#ifdef SEAL_DEBUG
+            if (!input)
+            {
+                throw invalid_argument("input cannot be null");
+            }
+            if (input.poly_modulus_degree() != coeff_count_)
+            {
+                throw invalid_argument("input is not valid for encryption parameters");
+            }
+            if (!pool)
+            {
+                throw invalid_argument("pool is uninitialized");
+            }
+#endif
+            size_t base_q_size = base_q_->size();
+            SEAL_ALLOCATE_GET_RNS_ITER(delta, coeff_count_, base_q_size, pool);
+            divide_and_round_P_delta(input + base_q_size, delta, pool);
+
+            SEAL_ITERATE(iter(input, delta, base_q_->base(), inv_prod_P_mod_q_), base_q_size, [&](auto I) {
+                // ((ct mod qi) - delta) mod qi with output in [0, 3 * qi)
+                uint64_t qi_lazy = get<2>(I).value() << 1;
+                SEAL_ITERATE(
+                    iter(get<0>(I), get<1>(I)), coeff_count_, [&](auto J) { get<0>(J) += qi_lazy - get<1>(J); });
+
+                // P^(-1) * ((ct mod qi) - delta) mod qi
+                multiply_poly_scalar_coeffmod(get<0>(I), coeff_count_, get<3>(I), get<2>(I), get<0>(I));
+            });
+        }
+
+        void KSwitchTool::divide_and_round_P_ntt_inplace(
+            RNSIter input, ConstNTTTablesIter rns_ntt_tables, MemoryPoolHandle pool) const
+        {
+#ifdef SEAL_DEBUG
+            if (!input)
+            {
+                throw invalid_argument("input cannot be null");
+            }
+            if (input.poly_modulus_degree() != coeff_count_)
+            {
+                throw invalid_argument("input is not valid for encryption parameters");
+            }
+            if (!rns_ntt_tables)
+            {
+                throw invalid_argument("rns_ntt_tables cannot be null");
+            }
+            if (!pool)
+            {
+                throw invalid_argument("pool is uninitialized");
+            }
+#endif
+            size_t base_q_size = base_q_->size();
+
+            // Convert the components modulo P to non-NTT form; lazy outputs in [0, 2p)
+            RNSIter input_P = input + base_q_size;
+            inverse_ntt_negacyclic_harvey_lazy(input_P, base_P_->size(), rns_ntt_tables + base_q_size);
+
+            SEAL_ALLOCATE_GET_RNS_ITER(delta, coeff_count_, base_q_size, pool);
+            divide_and_round_P_delta(input_P, delta, pool);
+
+            // This ntt_negacyclic_harvey_lazy results in [0, 4 * qi)
+            ntt_negacyclic_harvey_lazy(delta, base_q_size, rns_ntt_tables);
+
+            SEAL_ITERATE(iter(input, delta, base_q_->base(), inv_prod_P_mod_q_), base_q_size, [&](auto I) {
+#if SEAL_USER_MOD_BIT_COUNT_MAX <= 60
+                // Since SEAL uses at most 60-bit moduli, 8*qi < 2^63.
+                uint64_t qi_lazy = get<2>(I).value() << 2;
+#else
+                // Reduce from [0, 4qi) to [0, 2qi)
+                uint64_t qi_lazy = get<2>(I).value() << 1;
+                SEAL_ITERATE(
+                    get<1>(I), coeff_count_, [&](auto &J) { J -= SEAL_COND_SELECT(J >= qi_lazy, qi_lazy, 0); });
+#endif
+                // ((ct mod qi) - delta) mod qi with output in [0, 2 * qi_lazy)
+                SEAL_ITERATE(
+                    iter(get<0>(I), get<1>(I)), coeff_count_, [&](auto J) { get<0>(J) += qi_lazy - get<1>(J); });
+
+                // P^(-1) * ((ct mod qi) - delta) mod qi
+                multiply_poly_scalar_coeffmod(get<0>(I), coeff_count_, get<3>(I), get<2>(I), get<0>(I));
+            });
+        }
+
+        void KSwitchTool::mod_t_and_divide_P_inplace(RNSIter input, MemoryPoolHandle pool) const
+        {
+#ifdef SEAL_DEBUG
+            if (!input)
+            {
+                throw invalid_argument("input cannot be null");
+            }
+            if (input.poly_modulus_degree() != coeff_count_)
+            {
+                throw invalid_argument("input is not valid for encryption parameters");
+            }
+            if (!pool)
+            {
+                throw invalid_argument("pool is uninitialized");
+            }
+#endif
+            size_t base_q_size = base_q_->size();
+            SEAL_ALLOCATE_GET_RNS_ITER(delta, coeff_count_, base_q_size, pool);
+            mod_t_and_divide_P_delta(input + base_q_size, delta, pool);
+
+            SEAL_ITERATE(iter(input, delta, base_q_->base(), inv_prod_P_mod_q_), base_q_size, [&](auto I) {
+                // ((ct mod qi) - delta) mod qi with output in [0, 3 * qi)
+                uint64_t qi_lazy = get<2>(I).value() << 1;
+                SEAL_ITERATE(
+                    iter(get<0>(I), get<1>(I)), coeff_count_, [&](auto J) { get<0>(J) += qi_lazy - get<1>(J); });
+
+                // P^(-1) * ((ct mod qi) - delta) mod qi
+                multiply_poly_scalar_coeffmod(get<0>(I), coeff_count_, get<3>(I), get<2>(I), get<0>(I));
+            });
+        }
     } // namespace util
 } // namespace seal
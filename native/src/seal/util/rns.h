@@ -12,6 +12,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
@@ -167,6 +168,10 @@ namespace seal
             // The exact base convertion function, only supports obase size of 1.
             void exact_convert_array(ConstRNSIter in, CoeffIter out, MemoryPoolHandle) const;
 
+            // The exact base conversion function for any obase size. The output is the centered representative of the
+            // input modulo prod(ibase), i.e., the value in [-prod(ibase) / 2, prod(ibase) / 2), reduced modulo obase.
+            void exact_convert_array(ConstRNSIter in, RNSIter out, MemoryPoolHandle pool) const;
+
         private:
             BaseConverter(const BaseConverter &copy) = delete;
 
@@ -185,19 +190,24 @@ namespace seal
             RNSBase obase_;
 
             Pointer<Pointer<std::uint64_t>> base_change_matrix_;
+
+            Pointer<Pointer<MultiplyUIntModOperand>> base_change_matrix_shoup_;
         };
 
         class RNSTool
         {
         public:
             /**
+            If use_hps is true, and plain_modulus is non-zero, the pre-computations for Halevi-Polyakov-Shoup (HPS)
+            multiplication are generated too.
+
             @throws std::invalid_argument if poly_modulus_degree is out of range, coeff_modulus is not valid, or pool is
             invalid.
             @throws std::logic_error if coeff_modulus and extended bases do not support NTT or are not coprime.
             */
             RNSTool(
                 std::size_t poly_modulus_degree, const RNSBase &coeff_modulus, const Modulus &plain_modulus,
-                MemoryPoolHandle pool);
+                MemoryPoolHandle pool, bool use_hps = false);
 
             /**
             @param[in] input Must be in RNS form, i.e. coefficient must be less than the associated modulus.
@@ -227,11 +237,35 @@ namespace seal
             */
             void fastbconv_m_tilde(ConstRNSIter input, RNSIter destination, MemoryPoolHandle pool) const;
 
+            /**
+            HPS exact base extension from q to P; computes the centered representative of the input modulo P
+            */
+            void hps_extend_q_to_P(ConstRNSIter input, RNSIter destination, MemoryPoolHandle pool) const;
+
+            /**
+            HPS scaling from q U P to P; computes round(t/q * x) mod P for x given by its components input_q in base q
+            and input_P in base P. Both may be in [0, 2q) and [0, 2P), respectively.
+            */
+            void hps_scale_and_round(
+                ConstRNSIter input_q, ConstRNSIter input_P, RNSIter destination, MemoryPoolHandle pool) const;
+
+            /**
+            HPS exact base conversion from P to q
+            */
+            void hps_convert_P_to_q(ConstRNSIter input, RNSIter destination, MemoryPoolHandle pool) const;
+
             /**
             Compute round(t/q * |input|_q) mod t exactly
             */
             void decrypt_scale_and_round(ConstRNSIter phase, CoeffIter destination, MemoryPoolHandle pool) const;
 
+            /**
+            Compute round(t/q * |input|_q) mod t exactly for count phases; destination holds count polynomials of
+            coeff_count coefficients one after the other
+            */
+            void decrypt_scale_and_round(
+                ConstPolyIter phase, std::size_t count, CoeffIter destination, MemoryPoolHandle pool) const;
+
             /**
             Remove the last q for bgv ciphertext
             */
@@ -240,7 +274,14 @@ namespace seal
             /**
             Compute mod t
             */
-            void decrypt_modt(RNSIter phase, CoeffIter destination, MemoryPoolHandle pool) const;
+            void decrypt_modt(ConstRNSIter phase, CoeffIter destination, MemoryPoolHandle pool) const;
+
+            /**
+            Compute mod t for count phases; destination holds count polynomials of coeff_count coefficients one after
+            the other
+            */
+            void decrypt_modt(
+                ConstPolyIter phase, std::size_t count, CoeffIter destination, MemoryPoolHandle pool) const;
 
             SEAL_NODISCARD inline auto inv_q_last_mod_q() const noexcept
             {
@@ -277,6 +318,16 @@ namespace seal
                 return base_t_gamma_.get();
             }
 
+            SEAL_NODISCARD inline auto base_P() const noexcept
+            {
+                return base_P_.get();
+            }
+
+            SEAL_NODISCARD inline auto base_P_ntt_tables() const noexcept
+            {
+                return base_P_ntt_tables_.get();
+            }
+
             SEAL_NODISCARD inline auto &m_tilde() const noexcept
             {
                 return m_tilde_;
@@ -321,6 +372,11 @@ namespace seal
             */
             void initialize(std::size_t poly_modulus_degree, const RNSBase &q, const Modulus &t);
 
+            /**
+            Generates the pre-computations for HPS multiplication.
+            */
+            void initialize_hps();
+
             MemoryPoolHandle pool_;
 
             std::size_t coeff_count_ = 0;
@@ -335,6 +391,8 @@ namespace seal
 
             Pointer<RNSBase> base_t_gamma_;
 
+            Pointer<RNSBase> base_P_;
+
             // Base converter: q --> B_sk
             Pointer<BaseConverter> base_q_to_Bsk_conv_;
 
@@ -347,12 +405,15 @@ namespace seal
             // Base converter: B --> {m_sk}
             Pointer<BaseConverter> base_B_to_m_sk_conv_;
 
-            // Base converter: q --> {t, gamma}
-            Pointer<BaseConverter> base_q_to_t_gamma_conv_;
-
             // Base converter: q --> t
             Pointer<BaseConverter> base_q_to_t_conv_;
 
+            // Base converter: q --> P
+            Pointer<BaseConverter> base_q_to_P_conv_;
+
+            // Base converter: P --> q
+            Pointer<BaseConverter> base_P_to_q_conv_;
+
             // prod(q)^(-1) mod Bsk
             Pointer<MultiplyUIntModOperand> inv_prod_q_mod_Bsk_;
 
@@ -374,17 +435,29 @@ namespace seal
             // prod(q) mod Bsk
             Pointer<std::uint64_t> prod_q_mod_Bsk_;
 
-            // -prod(q)^(-1) mod {t, gamma}
-            Pointer<MultiplyUIntModOperand> neg_inv_q_mod_t_gamma_;
+            // -q_i^(-1) mod {t, gamma}; one row of size |q| for each of t and gamma
+            Pointer<Pointer<MultiplyUIntModOperand>> neg_inv_q_mod_t_gamma_;
 
-            // prod({t, gamma}) mod q
-            Pointer<MultiplyUIntModOperand> prod_t_gamma_mod_q_;
+            // prod({t, gamma}) * (q / q_i)^(-1) mod q_i
+            Pointer<MultiplyUIntModOperand> prod_t_gamma_inv_punctured_q_mod_q_;
 
             // q[last]^(-1) mod q[i] for i = 0..last-1
             Pointer<MultiplyUIntModOperand> inv_q_last_mod_q_;
 
+            // -r_i * q_i^(-1) mod P for r_i = t * (q / q_i)^(-1) mod q_i; one row of size |q| per element of P
+            Pointer<Pointer<MultiplyUIntModOperand>> neg_r_inv_q_mod_P_;
+
+            // r_i / q_i as 64-bit fixed-point fractions, rounded
+            Pointer<std::uint64_t> r_div_q_frac_;
+
+            // t * prod(q)^(-1) mod P
+            Pointer<MultiplyUIntModOperand> t_inv_prod_q_mod_P_;
+
             // NTTTables for Bsk
-            Pointer<NTTTables> base_Bsk_ntt_tables_;
+            std::shared_ptr<const NTTTables> base_Bsk_ntt_tables_;
+
+            // NTTTables for P
+            std::shared_ptr<const NTTTables> base_P_ntt_tables_;
 
             Modulus m_tilde_;
 
@@ -398,5 +471,153 @@ namespace seal
 
             std::uint64_t q_last_mod_t_ = 1;
         };
+
+        /**
+        Pre-computations for hybrid key switching at one level of the modulus switching chain. The primes q_0, ...,
+        q_{L-1} of the first level are split into digits of digit_size consecutive primes each; at a level with fewer
+        primes the digits are cut off accordingly, so that the last one may be shorter. Key switching extends each
+        digit of the input from its own primes to the primes q of the level and the special primes P with a fast base
+        conversion, multiplies with the keys, and divides the result by prod(P). With one special prime and digits of
+        one prime this is the key switching of the original SEAL.
+        */
+        class KSwitchTool
+        {
+        public:
+            /**
+            @param[in] plain_modulus The plaintext modulus of BGV; zero for the other schemes
+            @throws std::invalid_argument if poly_modulus_degree is out of range, digit_size is zero, or pool is
+            invalid.
+            @throws std::logic_error if base_q and base_P are not coprime.
+            */
+            KSwitchTool(
+                std::size_t poly_modulus_degree, const RNSBase &base_q, const RNSBase &base_P, std::size_t digit_size,
+                const Modulus &plain_modulus, MemoryPoolHandle pool);
+
+            /**
+            Multiplies every component of input, in coefficient form, by (Q_j / q_i)^(-1) mod q_i, where Q_j is the
+            product of the primes of the digit that contains q_i. This does nothing if the digits have one prime.
+            */
+            void scale_digits_inplace(RNSIter input) const;
+
+            /**
+            Converts a digit of the output of scale_digits_inplace from its own primes to the modulus at index
+            modulus_index of q U P. The result is in coefficient form and fully reduced; it is congruent to the input
+            modulo the primes of the digit and exceeds its representative in [0, Q_j) by less than digit_size * Q_j.
+            */
+            void convert_digit(
+                ConstRNSIter input, std::size_t digit_index, std::size_t modulus_index, CoeffIter destination) const;
+
+            /**
+            Computes delta = [x + floor(P / 2)]_P - floor(P / 2) + e * P for a small non-negative e modulo each prime of
+            q, so that (x - delta) / P is an integer close to x / P. The input holds the components of x modulo P in
+            coefficient form with values in [0, 2 * p) and is overwritten; the output is in [0, 2 * q_i).
+            */
+            void divide_and_round_P_delta(RNSIter input_P, RNSIter destination, MemoryPoolHandle pool) const;
+
+            /**
+            Computes delta = y + k * P modulo each prime of q, where y is congruent to x modulo P and k is chosen such
+            that delta is divisible by the plaintext modulus t, so that (x - delta) / P is an integer congruent to x /
+            P modulo t. The input holds the components of x modulo P in coefficient form with values in [0, 2 * p) and
+            is overwritten; the output is in [0, 2 * q_i).
+            */
+            void mod_t_and_divide_P_delta(RNSIter input_P, RNSIter destination, MemoryPoolHandle pool) const;
+
+            /**
+            Divides the input in base q U P by prod(P) with rounding and stores the result in its first components.
+            */
+            void divide_and_round_P_inplace(RNSIter input, MemoryPoolHandle pool) const;
+
+            /**
+            Divides the input in base q U P in NTT form by prod(P) with rounding and stores the result in its first
+            components. The NTT tables are those of q U P.
+            */
+            void divide_and_round_P_ntt_inplace(
+                RNSIter input, ConstNTTTablesIter rns_ntt_tables, MemoryPoolHandle pool) const;
+
+            /**
+            Removes the special primes from a BGV ciphertext component in base q U P.
+            */
+            void mod_t_and_divide_P_inplace(RNSIter input, MemoryPoolHandle pool) const;
+
+            SEAL_NODISCARD inline std::size_t digit_size() const noexcept
+            {
+                return digit_size_;
+            }
+
+            SEAL_NODISCARD inline std::size_t digit_count() const noexcept
+            {
+                return digit_count_;
+            }
+
+            SEAL_NODISCARD inline auto base_q() const noexcept
+            {
+                return base_q_.get();
+            }
+
+            SEAL_NODISCARD inline auto base_P() const noexcept
+            {
+                return base_P_.get();
+            }
+
+            SEAL_NODISCARD inline auto prod_P_mod_q() const noexcept
+            {
+                return prod_P_mod_q_.get();
+            }
+
+            SEAL_NODISCARD inline auto inv_prod_P_mod_q() const noexcept
+            {
+                return inv_prod_P_mod_q_.get();
+            }
+
+        private:
+            KSwitchTool(const KSwitchTool &copy) = delete;
+
+            KSwitchTool(KSwitchTool &&source) = delete;
+
+            KSwitchTool &operator=(const KSwitchTool &assign) = delete;
+
+            KSwitchTool &operator=(KSwitchTool &&assign) = delete;
+
+            MemoryPoolHandle pool_;
+
+            std::size_t coeff_count_ = 0;
+
+            std::size_t digit_size_ = 0;
+
+            std::size_t digit_count_ = 0;
+
+            Pointer<RNSBase> base_q_;
+
+            Pointer<RNSBase> base_P_;
+
+            // Base converter: P --> q
+            Pointer<BaseConverter> base_P_to_q_conv_;
+
+            // Base converter: P --> {t}
+            Pointer<BaseConverter> base_P_to_t_conv_;
+
+            // (Q_j / q_i)^(-1) mod q_i for the digit j that contains q_i
+            Pointer<MultiplyUIntModOperand> inv_punctured_digit_prod_mod_q_;
+
+            // Q_j / q_i mod m for each modulus m of q U P; one row of size |q| per modulus
+            Pointer<Pointer<MultiplyUIntModOperand>> punctured_digit_prod_mod_qP_;
+
+            // prod(P) mod q
+            Pointer<std::uint64_t> prod_P_mod_q_;
+
+            // prod(P)^(-1) mod q
+            Pointer<MultiplyUIntModOperand> inv_prod_P_mod_q_;
+
+            // floor(prod(P) / 2) mod P
+            Pointer<std::uint64_t> half_prod_P_mod_P_;
+
+            // floor(prod(P) / 2) mod q
+            Pointer<std::uint64_t> half_prod_P_mod_q_;
+
+            Modulus t_;
+
+            // -prod(P)^(-1) mod t
+            MultiplyUIntModOperand neg_inv_prod_P_mod_t_;
+        };
     } // namespace util
 } // namespace seal
@@ -0,0 +1,177 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/defines.h"
+#include "seal/util/uintarithsmallmod.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace seal
+{
+    namespace util
+    {
+        // Vectorized kernels. Each instruction set lives in its own translation unit that is the only one compiled with
+        // the corresponding compiler flags, so nothing here may be called unless util::active_kernel_variant() reports
+        // a variant at least as capable. For the same reason the kernels take plain pointers and values only: an inline
+        // function from a header instantiated in one of these translation units could be picked by the linker for the
+        // rest of the library and crash on CPUs without the instruction set.
+        //
+        // The NTT kernels perform the same Harvey butterflies as DWTHandler, lane by lane: the forward transform
+        // outputs values in [0, 4q) and the inverse transform (which always merges the multiplication by n^(-1))
+        // outputs values in [0, 2q). The 64-bit kernels produce outputs identical to DWTHandler. The IFMA kernels
+        // compute the lazy products with 52-bit Shoup quotients, so their outputs are congruent but may differ from
+        // DWTHandler by q. Likewise the 32-bit lane kernels, for moduli of at most SEAL_SMALL_MOD_BIT_COUNT_MAX bits,
+        // use the 32-bit quotients of NTTTables::get_from_root_powers32(). They pack the polynomial into 32-bit words
+        // in place for the duration of the transform and widen it back at the end, so that each vector holds twice as
+        // many coefficients and the transform touches half the memory.
+        //
+        // The remaining kernels produce fully reduced outputs identical to the scalar code. The addition, subtraction,
+        // and negation kernels take fully reduced operands, as the scalar code does. The dyadic product kernel takes
+        // operands in [0, 4q) and the Barrett ratio floor(2^(2k) / q) for the bit count k of q; without IFMA the 64-bit
+        // lanes have no full-width multiplier and the scalar Barrett reduction is as fast, except for moduli of at most
+        // SEAL_SMALL_MOD_BIT_COUNT_MAX bits whose products fit in 64 bits. The dot product kernels take the same
+        // operands and compute result[i] = sum_j operand1[j][i] * operand2[j][i] mod q; the result may alias an
+        // operand. The multiply accumulate kernels compute result[j] = sum_i rows[i * coeff_count + j] * weights[i] mod
+        // q for any inputs.
+
+        /** Base-2 logarithm of the block size of blocked NTTs, chosen so that a block stays in the L1 cache. */
+        constexpr int ntt_block_coeff_count_power = 12;
+
+#ifdef SEAL_USE_AVX2
+        namespace avx2
+        {
+            // The kernels process two vectors of four coefficients at a time in the last stages.
+            constexpr int ntt_min_coeff_count_power = 3;
+
+            void ntt_negacyclic_harvey_lazy(
+                std::uint64_t *operand, int coeff_count_power, const MultiplyUIntModOperand *root_powers,
+                std::uint64_t modulus);
+
+            void inverse_ntt_negacyclic_harvey_lazy(
+                std::uint64_t *operand, int coeff_count_power, const MultiplyUIntModOperand *inv_root_powers,
+                MultiplyUIntModOperand inv_degree, MultiplyUIntModOperand scaled_inv_root, std::uint64_t modulus);
+
+            // The 32-bit lane kernels process two vectors of eight coefficients at a time in the last stages.
+            constexpr int ntt32_min_coeff_count_power = 4;
+
+            void ntt_negacyclic_harvey_lazy32(
+                std::uint64_t *operand, int coeff_count_power, const std::uint32_t *root_powers,
+                std::uint32_t modulus);
+
+            void inverse_ntt_negacyclic_harvey_lazy32(
+                std::uint64_t *operand, int coeff_count_power, const std::uint32_t *inv_root_powers,
+                MultiplyUIntModOperand inv_degree, MultiplyUIntModOperand scaled_inv_root, std::uint32_t modulus);
+
+            void dyadic_product_coeffmod32(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t coeff_count,
+                std::uint64_t modulus, int modulus_bit_count, std::uint64_t barrett_ratio, std::uint64_t *result);
+
+            void dot_product_coeffmod32(
+                const std::uint64_t *const *operand1, const std::uint64_t *const *operand2, std::size_t count,
+                std::size_t coeff_count, std::uint64_t modulus, int modulus_bit_count, std::uint64_t barrett_ratio,
+                std::uint64_t *result);
+
+            void add_poly_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t coeff_count,
+                std::uint64_t modulus, std::uint64_t *result);
+
+            void sub_poly_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t coeff_count,
+                std::uint64_t modulus, std::uint64_t *result);
+
+            void negate_poly_coeffmod(
+                const std::uint64_t *poly, std::size_t coeff_count, std::uint64_t modulus, std::uint64_t *result);
+
+            void multiply_poly_scalar_coeffmod(
+                const std::uint64_t *poly, std::size_t coeff_count, MultiplyUIntModOperand scalar,
+                std::uint64_t modulus, std::uint64_t *result);
+
+            void multiply_accumulate_coeffmod(
+                const std::uint64_t *rows, std::size_t row_count, std::size_t coeff_count,
+                const MultiplyUIntModOperand *weights, std::uint64_t modulus, std::uint64_t *result);
+        } // namespace avx2
+#endif
+#ifdef SEAL_USE_AVX512
+        namespace avx512
+        {
+            // The kernels process two vectors of eight coefficients at a time in the last stages.
+            constexpr int ntt_min_coeff_count_power = 4;
+
+            void ntt_negacyclic_harvey_lazy(
+                std::uint64_t *operand, int coeff_count_power, const MultiplyUIntModOperand *root_powers,
+                std::uint64_t modulus);
+
+            void inverse_ntt_negacyclic_harvey_lazy(
+                std::uint64_t *operand, int coeff_count_power, const MultiplyUIntModOperand *inv_root_powers,
+                MultiplyUIntModOperand inv_degree, MultiplyUIntModOperand scaled_inv_root, std::uint64_t modulus);
+
+            // The 32-bit lane kernels process two vectors of sixteen coefficients at a time in the last stages.
+            constexpr int ntt32_min_coeff_count_power = 5;
+
+            void ntt_negacyclic_harvey_lazy32(
+                std::uint64_t *operand, int coeff_count_power, const std::uint32_t *root_powers,
+                std::uint32_t modulus);
+
+            void inverse_ntt_negacyclic_harvey_lazy32(
+                std::uint64_t *operand, int coeff_count_power, const std::uint32_t *inv_root_powers,
+                MultiplyUIntModOperand inv_degree, MultiplyUIntModOperand scaled_inv_root, std::uint32_t modulus);
+
+            void dyadic_product_coeffmod32(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t coeff_count,
+                std::uint64_t modulus, int modulus_bit_count, std::uint64_t barrett_ratio, std::uint64_t *result);
+
+            void dot_product_coeffmod32(
+                const std::uint64_t *const *operand1, const std::uint64_t *const *operand2, std::size_t count,
+                std::size_t coeff_count, std::uint64_t modulus, int modulus_bit_count, std::uint64_t barrett_ratio,
+                std::uint64_t *result);
+
+            void add_poly_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t coeff_count,
+                std::uint64_t modulus, std::uint64_t *result);
+
+            void sub_poly_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t coeff_count,
+                std::uint64_t modulus, std::uint64_t *result);
+
+            void negate_poly_coeffmod(
+                const std::uint64_t *poly, std::size_t coeff_count, std::uint64_t modulus, std::uint64_t *result);
+
+            void multiply_poly_scalar_coeffmod(
+                const std::uint64_t *poly, std::size_t coeff_count, MultiplyUIntModOperand scalar,
+                std::uint64_t modulus, std::uint64_t *result);
+
+            void multiply_accumulate_coeffmod(
+                const std::uint64_t *rows, std::size_t row_count, std::size_t coeff_count,
+                const MultiplyUIntModOperand *weights, std::uint64_t modulus, std::uint64_t *result);
+        } // namespace avx512
+#endif
+#ifdef SEAL_USE_AVX512IFMA
+        namespace avx512ifma
+        {
+            constexpr int ntt_min_coeff_count_power = 4;
+
+            // Values up to 4q must fit in the 52-bit multiplier.
+            constexpr int max_modulus_bit_count = 50;
+
+            void ntt_negacyclic_harvey_lazy(
+                std::uint64_t *operand, int coeff_count_power, const MultiplyUIntModOperand *root_powers,
+                std::uint64_t modulus);
+
+            void inverse_ntt_negacyclic_harvey_lazy(
+                std::uint64_t *operand, int coeff_count_power, const MultiplyUIntModOperand *inv_root_powers,
+                MultiplyUIntModOperand inv_degree, MultiplyUIntModOperand scaled_inv_root, std::uint64_t modulus);
+
+            void dyadic_product_coeffmod(
+                const std::uint64_t *operand1, const std::uint64_t *operand2, std::size_t coeff_count,
+                std::uint64_t modulus, int modulus_bit_count, std::uint64_t barrett_ratio, std::uint64_t *result);
+
+            void dot_product_coeffmod(
+                const std::uint64_t *const *operand1, const std::uint64_t *const *operand2, std::size_t count,
+                std::size_t coeff_count, std::uint64_t modulus, int modulus_bit_count, std::uint64_t barrett_ratio,
+                std::uint64_t *result);
+        } // namespace avx512ifma
+#endif
+    } // namespace util
+} // namespace seal
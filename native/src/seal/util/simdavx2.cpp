@@ -0,0 +1,848 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/util/simd.h"
+#include <algorithm>
+#include <immintrin.h>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace avx2
+        {
+            namespace
+            {
+                inline __m256i load(const uint64_t *ptr)
+                {
+                    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+                }
+
+                inline __m256i load(const MultiplyUIntModOperand *ptr)
+                {
+                    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+                }
+
+                inline void store(uint64_t *ptr, __m256i value)
+                {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(ptr), value);
+                }
+
+                // Lanes below count are set; used for the remainders of the elementwise kernels
+                inline __m256i tail_mask(size_t count)
+                {
+                    return _mm256_cmpgt_epi64(
+                        _mm256_set1_epi64x(static_cast<long long>(count)), _mm256_set_epi64x(3, 2, 1, 0));
+                }
+
+                inline __m256i load(const uint64_t *ptr, __m256i mask)
+                {
+                    return _mm256_maskload_epi64(reinterpret_cast<const long long *>(ptr), mask);
+                }
+
+                inline void store(uint64_t *ptr, __m256i value, __m256i mask)
+                {
+                    _mm256_maskstore_epi64(reinterpret_cast<long long *>(ptr), mask, value);
+                }
+
+                // High 64 bits of the 128-bit products; AVX2 only has a 32x32-bit multiplier.
+                inline __m256i mul_hi(__m256i a, __m256i b)
+                {
+                    const __m256i lo_mask = _mm256_set1_epi64x(0xFFFFFFFF);
+                    __m256i a_hi = _mm256_srli_epi64(a, 32);
+                    __m256i b_hi = _mm256_srli_epi64(b, 32);
+                    __m256i lo_lo = _mm256_mul_epu32(a, b);
+                    __m256i hi_lo = _mm256_mul_epu32(a_hi, b);
+                    __m256i lo_hi = _mm256_mul_epu32(a, b_hi);
+                    __m256i hi_hi = _mm256_mul_epu32(a_hi, b_hi);
+
+                    // Neither sum can overflow: (2^32 - 1)^2 + 2 * (2^32 - 1) < 2^64
+                    __m256i mid = _mm256_add_epi64(hi_lo, _mm256_srli_epi64(lo_lo, 32));
+                    __m256i carry = _mm256_add_epi64(lo_hi, _mm256_and_si256(mid, lo_mask));
+                    return _mm256_add_epi64(
+                        _mm256_add_epi64(hi_hi, _mm256_srli_epi64(mid, 32)), _mm256_srli_epi64(carry, 32));
+                }
+
+                // Low 64 bits of the 128-bit products
+                inline __m256i mul_lo(__m256i a, __m256i b)
+                {
+                    __m256i cross = _mm256_add_epi64(
+                        _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+                    return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+                }
+
+                // Lane-wise multiply_uint_mod_lazy; outputs are in [0, 2q)
+                inline __m256i mul_root(__m256i x, __m256i w, __m256i w_quotient, __m256i q)
+                {
+                    return _mm256_sub_epi64(mul_lo(x, w), mul_lo(mul_hi(x, w_quotient), q));
+                }
+
+                // Subtracts bound from lanes that are not below it; lanes must be below 2^63
+                inline __m256i guard(__m256i x, __m256i bound)
+                {
+                    return _mm256_sub_epi64(x, _mm256_andnot_si256(_mm256_cmpgt_epi64(bound, x), bound));
+                }
+
+                inline void forward_butterfly(
+                    __m256i &x, __m256i &y, __m256i w, __m256i w_quotient, __m256i q, __m256i two_q)
+                {
+                    __m256i u = guard(x, two_q);
+                    __m256i v = mul_root(y, w, w_quotient, q);
+                    x = _mm256_add_epi64(u, v);
+                    y = _mm256_sub_epi64(_mm256_add_epi64(u, two_q), v);
+                }
+
+                inline void inverse_butterfly(
+                    __m256i &x, __m256i &y, __m256i w, __m256i w_quotient, __m256i q, __m256i two_q)
+                {
+                    __m256i u = x;
+                    __m256i v = y;
+                    x = guard(_mm256_add_epi64(u, v), two_q);
+                    y = mul_root(_mm256_sub_epi64(_mm256_add_epi64(u, two_q), v), w, w_quotient, q);
+                }
+
+                // Splits eight consecutive values into the x and y halves of the butterflies of the stage with the
+                // given gap; split and merge are inverses of each other. For gap 2 the lanes are in natural pair
+                // order; for gap 1 unpacking yields pairs in the order 0, 2, 1, 3.
+                template <size_t Gap>
+                inline void split(__m256i v0, __m256i v1, __m256i &x, __m256i &y);
+
+                template <>
+                inline void split<2>(__m256i v0, __m256i v1, __m256i &x, __m256i &y)
+                {
+                    x = _mm256_permute2x128_si256(v0, v1, 0x20);
+                    y = _mm256_permute2x128_si256(v0, v1, 0x31);
+                }
+
+                template <>
+                inline void split<1>(__m256i v0, __m256i v1, __m256i &x, __m256i &y)
+                {
+                    x = _mm256_unpacklo_epi64(v0, v1);
+                    y = _mm256_unpackhi_epi64(v0, v1);
+                }
+
+                template <size_t Gap>
+                inline void merge(__m256i x, __m256i y, __m256i &v0, __m256i &v1)
+                {
+                    split<Gap>(x, y, v0, v1);
+                }
+
+                // Loads the roots of the butterflies in the lane order produced by split
+                template <size_t Gap>
+                inline void load_roots(const MultiplyUIntModOperand *roots, __m256i &w, __m256i &w_quotient);
+
+                template <>
+                inline void load_roots<2>(const MultiplyUIntModOperand *roots, __m256i &w, __m256i &w_quotient)
+                {
+                    w = _mm256_set_epi64x(
+                        static_cast<long long>(roots[1].operand), static_cast<long long>(roots[1].operand),
+                        static_cast<long long>(roots[0].operand), static_cast<long long>(roots[0].operand));
+                    w_quotient = _mm256_set_epi64x(
+                        static_cast<long long>(roots[1].quotient), static_cast<long long>(roots[1].quotient),
+                        static_cast<long long>(roots[0].quotient), static_cast<long long>(roots[0].quotient));
+                }
+
+                template <>
+                inline void load_roots<1>(const MultiplyUIntModOperand *roots, __m256i &w, __m256i &w_quotient)
+                {
+                    // Unpacking the interleaved operands and quotients matches the lane order of split<1>
+                    __m256i a = load(roots);
+                    __m256i b = load(roots + 2);
+                    w = _mm256_unpacklo_epi64(a, b);
+                    w_quotient = _mm256_unpackhi_epi64(a, b);
+                }
+
+                // One stage of the forward transform where each butterfly group is shorter than a vector
+                template <size_t Gap>
+                inline void forward_stage_in_register(
+                    uint64_t *values, size_t n, const MultiplyUIntModOperand *roots, __m256i q, __m256i two_q)
+                {
+                    __m256i v0, v1, x, y, w, w_quotient;
+                    for (size_t offset = 0; offset < n; offset += 8)
+                    {
+                        split<Gap>(load(values + offset), load(values + offset + 4), x, y);
+                        load_roots<Gap>(roots, w, w_quotient);
+                        forward_butterfly(x, y, w, w_quotient, q, two_q);
+                        merge<Gap>(x, y, v0, v1);
+                        store(values + offset, v0);
+                        store(values + offset + 4, v1);
+                        roots += 4 / Gap;
+                    }
+                }
+
+                template <size_t Gap>
+                inline void inverse_stage_in_register(
+                    uint64_t *values, size_t n, const MultiplyUIntModOperand *roots, __m256i q, __m256i two_q)
+                {
+                    __m256i v0, v1, x, y, w, w_quotient;
+                    for (size_t offset = 0; offset < n; offset += 8)
+                    {
+                        split<Gap>(load(values + offset), load(values + offset + 4), x, y);
+                        load_roots<Gap>(roots, w, w_quotient);
+                        inverse_butterfly(x, y, w, w_quotient, q, two_q);
+                        merge<Gap>(x, y, v0, v1);
+                        store(values + offset, v0);
+                        store(values + offset + 4, v1);
+                        roots += 4 / Gap;
+                    }
+                }
+
+                // Values of the stages that span more than a block are processed in tiles of this many columns
+                constexpr size_t column_tile_size = 128;
+
+                // The kernels for moduli of at most SEAL_SMALL_MOD_BIT_COUNT_MAX bits compute with eight 32-bit lanes:
+                // values below 4q fit in 32 bits, and Shoup multiplication uses the quotients floor(w * 2^32 / q).
+                inline __m256i broadcast32(uint32_t value)
+                {
+                    return _mm256_set1_epi32(static_cast<int>(value));
+                }
+
+                inline __m256i load32(const uint32_t *ptr)
+                {
+                    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+                }
+
+                inline void store32(uint32_t *ptr, __m256i value)
+                {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(ptr), value);
+                }
+
+                inline __m256i guard32(__m256i x, __m256i bound)
+                {
+                    return _mm256_min_epu32(x, _mm256_sub_epi32(x, bound));
+                }
+
+                // High 32 bits of the 64-bit products
+                inline __m256i mul_hi32(__m256i a, __m256i b)
+                {
+                    __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(a, b), 32);
+                    __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+                    return _mm256_blend_epi32(even, odd, 0xAA);
+                }
+
+                // Lane-wise multiply_uint_mod_lazy for x below 2^32; outputs are in [0, 2q)
+                inline __m256i mul_root32(__m256i x, __m256i w, __m256i w_quotient, __m256i q)
+                {
+                    return _mm256_sub_epi32(
+                        _mm256_mullo_epi32(x, w), _mm256_mullo_epi32(mul_hi32(x, w_quotient), q));
+                }
+
+                inline void forward_butterfly32(
+                    __m256i &x, __m256i &y, __m256i w, __m256i w_quotient, __m256i q, __m256i two_q)
+                {
+                    __m256i u = guard32(x, two_q);
+                    __m256i v = mul_root32(y, w, w_quotient, q);
+                    x = _mm256_add_epi32(u, v);
+                    y = _mm256_sub_epi32(_mm256_add_epi32(u, two_q), v);
+                }
+
+                inline void inverse_butterfly32(
+                    __m256i &x, __m256i &y, __m256i w, __m256i w_quotient, __m256i q, __m256i two_q)
+                {
+                    __m256i u = x;
+                    __m256i v = y;
+                    x = guard32(_mm256_add_epi32(u, v), two_q);
+                    y = mul_root32(_mm256_sub_epi32(_mm256_add_epi32(u, two_q), v), w, w_quotient, q);
+                }
+
+                // Permutations between sixteen consecutive values and the x and y halves of the butterflies of the
+                // stage with the given gap. Lane l of x holds the x value of the l-th butterfly in natural order; the
+                // upper four butterflies always read the second vector.
+                template <size_t Gap>
+                struct InRegisterStage32
+                {
+                    static_assert(Gap == 1 || Gap == 2 || Gap == 4, "Gap");
+
+                    // Positions of the merged vectors that hold y values
+                    static constexpr int merge_y = (Gap == 4) ? 0xF0 : ((Gap == 2) ? 0xCC : 0xAA);
+
+                    InRegisterStage32()
+                    {
+                        alignas(32) uint32_t x_idx[8], y_idx[8], v0_idx[8], v1_idx[8], root_idx[8];
+                        for (uint32_t l = 0; l < 8; l++)
+                        {
+                            uint32_t position = static_cast<uint32_t>((l / Gap) * 2 * Gap + l % Gap);
+                            x_idx[l] = position % 8;
+                            y_idx[l] = (position + static_cast<uint32_t>(Gap)) % 8;
+                            for (uint32_t e : { l, l + 8 })
+                            {
+                                uint32_t lane = static_cast<uint32_t>((e / (2 * Gap)) * Gap + e % Gap);
+                                ((e < 8) ? v0_idx[l] : v1_idx[l]) = lane;
+                            }
+                            root_idx[l] = static_cast<uint32_t>(l / Gap);
+                        }
+                        split_x = _mm256_load_si256(reinterpret_cast<const __m256i *>(x_idx));
+                        split_y = _mm256_load_si256(reinterpret_cast<const __m256i *>(y_idx));
+                        merge_v0 = _mm256_load_si256(reinterpret_cast<const __m256i *>(v0_idx));
+                        merge_v1 = _mm256_load_si256(reinterpret_cast<const __m256i *>(v1_idx));
+                        root_lanes = _mm256_load_si256(reinterpret_cast<const __m256i *>(root_idx));
+                    }
+
+                    inline void split(__m256i v0, __m256i v1, __m256i &x, __m256i &y) const
+                    {
+                        x = _mm256_blend_epi32(
+                            _mm256_permutevar8x32_epi32(v0, split_x), _mm256_permutevar8x32_epi32(v1, split_x), 0xF0);
+                        y = _mm256_blend_epi32(
+                            _mm256_permutevar8x32_epi32(v0, split_y), _mm256_permutevar8x32_epi32(v1, split_y), 0xF0);
+                    }
+
+                    inline void merge(__m256i x, __m256i y, __m256i &v0, __m256i &v1) const
+                    {
+                        v0 = _mm256_blend_epi32(
+                            _mm256_permutevar8x32_epi32(x, merge_v0), _mm256_permutevar8x32_epi32(y, merge_v0),
+                            merge_y);
+                        v1 = _mm256_blend_epi32(
+                            _mm256_permutevar8x32_epi32(x, merge_v1), _mm256_permutevar8x32_epi32(y, merge_v1),
+                            merge_y);
+                    }
+
+                    // Reads exactly the 8 / Gap roots used by sixteen values
+                    inline __m256i load_roots(const uint32_t *roots) const
+                    {
+                        __m256i a;
+                        switch (Gap)
+                        {
+                        case 4:
+                            a = _mm256_castsi128_si256(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(roots)));
+                            break;
+                        case 2:
+                            a = _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(roots)));
+                            break;
+                        default:
+                            return load32(roots);
+                        }
+                        return _mm256_permutevar8x32_epi32(a, root_lanes);
+                    }
+
+                    __m256i split_x;
+                    __m256i split_y;
+                    __m256i merge_v0;
+                    __m256i merge_v1;
+                    __m256i root_lanes;
+                };
+
+                // The root operands are followed by their quotients at an offset of n
+                template <size_t Gap>
+                inline void forward_stage_in_register32(
+                    uint32_t *values, size_t n, const uint32_t *roots, __m256i q, __m256i two_q)
+                {
+                    const InRegisterStage32<Gap> stage;
+                    __m256i v0, v1, x, y;
+                    for (size_t offset = 0; offset < n; offset += 16, roots += 8 / Gap)
+                    {
+                        stage.split(load32(values + offset), load32(values + offset + 8), x, y);
+                        forward_butterfly32(x, y, stage.load_roots(roots), stage.load_roots(roots + n), q, two_q);
+                        stage.merge(x, y, v0, v1);
+                        store32(values + offset, v0);
+                        store32(values + offset + 8, v1);
+                    }
+                }
+
+                template <size_t Gap>
+                inline void inverse_stage_in_register32(
+                    uint32_t *values, size_t n, const uint32_t *roots, __m256i q, __m256i two_q)
+                {
+                    const InRegisterStage32<Gap> stage;
+                    __m256i v0, v1, x, y;
+                    for (size_t offset = 0; offset < n; offset += 16, roots += 8 / Gap)
+                    {
+                        stage.split(load32(values + offset), load32(values + offset + 8), x, y);
+                        inverse_butterfly32(x, y, stage.load_roots(roots), stage.load_roots(roots + n), q, two_q);
+                        stage.merge(x, y, v0, v1);
+                        store32(values + offset, v0);
+                        store32(values + offset + 8, v1);
+                    }
+                }
+
+                // Packs the values into 32-bit words at the start of the same array; each store only overwrites
+                // values that were already loaded
+                inline uint32_t *pack32(uint64_t *values, size_t n)
+                {
+                    const __m256i low_words = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+                    uint32_t *packed = reinterpret_cast<uint32_t *>(values);
+                    for (size_t i = 0; i < n; i += 8)
+                    {
+                        __m256i lo = _mm256_permutevar8x32_epi32(load(values + i), low_words);
+                        __m256i hi = _mm256_permutevar8x32_epi32(load(values + i + 4), low_words);
+                        store32(packed + i, _mm256_permute2x128_si256(lo, hi, 0x20));
+                    }
+                    return packed;
+                }
+
+                // Reverses pack32, from the end of the array
+                inline void unpack32(uint64_t *values, size_t n)
+                {
+                    const uint32_t *packed = reinterpret_cast<const uint32_t *>(values);
+                    for (size_t i = n; i > 0;)
+                    {
+                        i -= 8;
+                        __m256i v = load32(packed + i);
+                        __m256i lo = _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v));
+                        __m256i hi = _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1));
+                        store(values + i, lo);
+                        store(values + i + 4, hi);
+                    }
+                }
+
+                // With k bits in q, the products are below 2^(2k) and z / 2^(k - 1) and floor(2^(2k) / q) fit in
+                // 32 bits, so all products are single 32x32-bit multiplications
+                struct DyadicProduct32
+                {
+                    DyadicProduct32(uint64_t modulus, int modulus_bit_count, uint64_t barrett_ratio)
+                        : q(_mm256_set1_epi64x(static_cast<long long>(modulus))), two_q(_mm256_add_epi64(q, q)),
+                          ratio(_mm256_set1_epi64x(static_cast<long long>(barrett_ratio))),
+                          z_shift(_mm_cvtsi32_si128(modulus_bit_count - 1)),
+                          e_shift(_mm_cvtsi32_si128(modulus_bit_count + 1))
+                    {}
+
+                    inline __m256i operator()(__m256i x, __m256i y) const
+                    {
+                        x = guard(guard(x, two_q), q);
+                        y = guard(guard(y, two_q), q);
+                        __m256i z = _mm256_mul_epu32(x, y);
+                        __m256i e = _mm256_srl_epi64(_mm256_mul_epu32(_mm256_srl_epi64(z, z_shift), ratio), e_shift);
+
+                        // The remainder is in [0, 3q)
+                        __m256i r = _mm256_sub_epi64(z, _mm256_mul_epu32(e, q));
+                        return guard(guard(r, q), q);
+                    }
+
+                    __m256i q;
+                    __m256i two_q;
+                    __m256i ratio;
+                    __m128i z_shift;
+                    __m128i e_shift;
+                };
+            } // namespace
+
+            // Transforms larger than a block of 2^ntt_block_coeff_count_power values are computed in the order of
+            // DWTHandler::transform_to_rev_blocked and DWTHandler::transform_from_rev_blocked.
+            void ntt_negacyclic_harvey_lazy(
+                uint64_t *values, int coeff_count_power, const MultiplyUIntModOperand *roots, uint64_t modulus)
+            {
+                size_t n = size_t(1) << coeff_count_power;
+                const __m256i q = _mm256_set1_epi64x(static_cast<long long>(modulus));
+                const __m256i two_q = _mm256_add_epi64(q, q);
+                int log_block_count = max(coeff_count_power - ntt_block_coeff_count_power, 0);
+                size_t block_size = n >> log_block_count;
+                size_t block_count = size_t(1) << log_block_count;
+
+                // The i-th group of the stage with m groups uses roots[m + i]
+                for (size_t col = 0; col < block_size; col += column_tile_size)
+                {
+                    size_t gap = n >> 1;
+                    for (size_t m = 1; m < block_count; m <<= 1, gap >>= 1)
+                    {
+                        for (size_t i = 0; i < m; i++)
+                        {
+                            __m256i w = _mm256_set1_epi64x(static_cast<long long>(roots[m + i].operand));
+                            __m256i w_quotient = _mm256_set1_epi64x(static_cast<long long>(roots[m + i].quotient));
+                            for (size_t offset = col; offset < gap; offset += block_size)
+                            {
+                                uint64_t *x = values + 2 * gap * i + offset;
+                                uint64_t *y = x + gap;
+                                for (size_t j = 0; j < column_tile_size; j += 4, x += 4, y += 4)
+                                {
+                                    __m256i vx = load(x);
+                                    __m256i vy = load(y);
+                                    forward_butterfly(vx, vy, w, w_quotient, q, two_q);
+                                    store(x, vx);
+                                    store(y, vy);
+                                }
+                            }
+                        }
+                    }
+                }
+
+                for (size_t b = 0; b < block_count; b++)
+                {
+                    size_t m = block_count;
+                    size_t gap = block_size >> 1;
+                    for (; gap >= 4; m <<= 1, gap >>= 1)
+                    {
+                        size_t group_count = m >> log_block_count;
+                        for (size_t i = b * group_count; i < (b + 1) * group_count; i++)
+                        {
+                            __m256i w = _mm256_set1_epi64x(static_cast<long long>(roots[m + i].operand));
+                            __m256i w_quotient = _mm256_set1_epi64x(static_cast<long long>(roots[m + i].quotient));
+                            uint64_t *x = values + 2 * gap * i;
+                            uint64_t *y = x + gap;
+                            for (size_t j = 0; j < gap; j += 4, x += 4, y += 4)
+                            {
+                                __m256i vx = load(x);
+                                __m256i vy = load(y);
+                                forward_butterfly(vx, vy, w, w_quotient, q, two_q);
+                                store(x, vx);
+                                store(y, vy);
+                            }
+                        }
+                    }
+
+                    uint64_t *block_values = values + b * block_size;
+                    size_t root_offset = b * (block_size >> 2);
+                    forward_stage_in_register<2>(block_values, block_size, roots + m + root_offset, q, two_q);
+                    forward_stage_in_register<1>(block_values, block_size, roots + 2 * m + 2 * root_offset, q, two_q);
+                }
+            }
+
+            void inverse_ntt_negacyclic_harvey_lazy(
+                uint64_t *values, int coeff_count_power, const MultiplyUIntModOperand *inv_root_powers,
+                MultiplyUIntModOperand inv_degree, MultiplyUIntModOperand scaled_inv_root, uint64_t modulus)
+            {
+                size_t n = size_t(1) << coeff_count_power;
+                const __m256i q = _mm256_set1_epi64x(static_cast<long long>(modulus));
+                const __m256i two_q = _mm256_add_epi64(q, q);
+                int log_block_count = max(coeff_count_power - ntt_block_coeff_count_power, 0);
+                size_t block_size = n >> log_block_count;
+                size_t block_count = size_t(1) << log_block_count;
+
+                // Roots are stored in scrambled order: the i-th group of the stage with m groups uses
+                // inv_root_powers[n - 2 * m + 1 + i]
+                for (size_t b = 0; b < block_count; b++)
+                {
+                    uint64_t *block_values = values + b * block_size;
+                    size_t m = n >> 1;
+                    inverse_stage_in_register<1>(
+                        block_values, block_size, inv_root_powers + 1 + b * (block_size >> 1), q, two_q);
+                    m >>= 1;
+                    inverse_stage_in_register<2>(
+                        block_values, block_size, inv_root_powers + (n - 2 * m + 1) + b * (block_size >> 2), q,
+                        two_q);
+                    m >>= 1;
+
+                    for (size_t gap = 4; m >= max<size_t>(block_count, 2); m >>= 1, gap <<= 1)
+                    {
+                        size_t group_count = m >> log_block_count;
+                        const MultiplyUIntModOperand *roots = inv_root_powers + (n - 2 * m + 1);
+                        for (size_t i = b * group_count; i < (b + 1) * group_count; i++)
+                        {
+                            __m256i w = _mm256_set1_epi64x(static_cast<long long>(roots[i].operand));
+                            __m256i w_quotient = _mm256_set1_epi64x(static_cast<long long>(roots[i].quotient));
+                            uint64_t *x = values + 2 * gap * i;
+                            uint64_t *y = x + gap;
+                            for (size_t j = 0; j < gap; j += 4, x += 4, y += 4)
+                            {
+                                __m256i vx = load(x);
+                                __m256i vy = load(y);
+                                inverse_butterfly(vx, vy, w, w_quotient, q, two_q);
+                                store(x, vx);
+                                store(y, vy);
+                            }
+                        }
+                    }
+                }
+
+                // The last stage merges the multiplication by n^(-1); scaled_inv_root is the last root times n^(-1)
+                const __m256i s = _mm256_set1_epi64x(static_cast<long long>(inv_degree.operand));
+                const __m256i s_quotient = _mm256_set1_epi64x(static_cast<long long>(inv_degree.quotient));
+                const __m256i w_last = _mm256_set1_epi64x(static_cast<long long>(scaled_inv_root.operand));
+                const __m256i w_last_quotient = _mm256_set1_epi64x(static_cast<long long>(scaled_inv_root.quotient));
+
+                // With a single block only the last stage is left, and its butterflies span n / 2 columns
+                size_t column_count = min(block_size, n >> 1);
+                size_t tile_size = min(column_tile_size, column_count);
+                for (size_t col = 0; col < column_count; col += tile_size)
+                {
+                    size_t gap = block_size;
+                    for (size_t m = block_count >> 1; m > 1; m >>= 1, gap <<= 1)
+                    {
+                        const MultiplyUIntModOperand *roots = inv_root_powers + (n - 2 * m + 1);
+                        for (size_t i = 0; i < m; i++)
+                        {
+                            __m256i w = _mm256_set1_epi64x(static_cast<long long>(roots[i].operand));
+                            __m256i w_quotient = _mm256_set1_epi64x(static_cast<long long>(roots[i].quotient));
+                            for (size_t offset = col; offset < gap; offset += block_size)
+                            {
+                                uint64_t *x = values + 2 * gap * i + offset;
+                                uint64_t *y = x + gap;
+                                for (size_t j = 0; j < tile_size; j += 4, x += 4, y += 4)
+                                {
+                                    __m256i vx = load(x);
+                                    __m256i vy = load(y);
+                                    inverse_butterfly(vx, vy, w, w_quotient, q, two_q);
+                                    store(x, vx);
+                                    store(y, vy);
+                                }
+                            }
+                        }
+                    }
+
+                    for (size_t offset = col; offset < (n >> 1); offset += block_size)
+                    {
+                        uint64_t *x = values + offset;
+                        uint64_t *y = x + (n >> 1);
+                        for (size_t j = 0; j < tile_size; j += 4, x += 4, y += 4)
+                        {
+                            __m256i u = guard(load(x), two_q);
+                            __m256i v = load(y);
+                            store(x, mul_root(guard(_mm256_add_epi64(u, v), two_q), s, s_quotient, q));
+                            store(
+                                y, mul_root(
+                                       _mm256_sub_epi64(_mm256_add_epi64(u, two_q), v), w_last, w_last_quotient, q));
+                        }
+                    }
+                }
+            }
+
+            // The 32-bit values of a transform of up to 2^(ntt_block_coeff_count_power + 1) coefficients fit in the
+            // space of a 64-bit block, so the stages are applied to the whole array.
+            void ntt_negacyclic_harvey_lazy32(
+                uint64_t *operand, int coeff_count_power, const uint32_t *root_powers, uint32_t modulus)
+            {
+                size_t n = size_t(1) << coeff_count_power;
+                const uint32_t *root_quotients = root_powers + n;
+                const __m256i q = broadcast32(modulus);
+                const __m256i two_q = broadcast32(modulus << 1);
+                uint32_t *values = pack32(operand, n);
+
+                // The i-th group of the stage with m groups uses roots[m + i]
+                size_t m = 1;
+                for (size_t gap = n >> 1; gap >= 8; m <<= 1, gap >>= 1)
+                {
+                    for (size_t i = 0; i < m; i++)
+                    {
+                        __m256i w = broadcast32(root_powers[m + i]);
+                        __m256i w_quotient = broadcast32(root_quotients[m + i]);
+                        uint32_t *x = values + 2 * gap * i;
+                        uint32_t *y = x + gap;
+                        for (size_t j = 0; j < gap; j += 8, x += 8, y += 8)
+                        {
+                            __m256i vx = load32(x);
+                            __m256i vy = load32(y);
+                            forward_butterfly32(vx, vy, w, w_quotient, q, two_q);
+                            store32(x, vx);
+                            store32(y, vy);
+                        }
+                    }
+                }
+                forward_stage_in_register32<4>(values, n, root_powers + m, q, two_q);
+                forward_stage_in_register32<2>(values, n, root_powers + 2 * m, q, two_q);
+                forward_stage_in_register32<1>(values, n, root_powers + 4 * m, q, two_q);
+                unpack32(operand, n);
+            }
+
+            void inverse_ntt_negacyclic_harvey_lazy32(
+                uint64_t *operand, int coeff_count_power, const uint32_t *inv_root_powers,
+                MultiplyUIntModOperand inv_degree, MultiplyUIntModOperand scaled_inv_root, uint32_t modulus)
+            {
+                size_t n = size_t(1) << coeff_count_power;
+                const uint32_t *inv_root_quotients = inv_root_powers + n;
+                const __m256i q = broadcast32(modulus);
+                const __m256i two_q = broadcast32(modulus << 1);
+                uint32_t *values = pack32(operand, n);
+
+                // Roots are stored in scrambled order: the i-th group of the stage with m groups uses
+                // inv_root_powers[n - 2 * m + 1 + i]
+                inverse_stage_in_register32<1>(values, n, inv_root_powers + 1, q, two_q);
+                inverse_stage_in_register32<2>(values, n, inv_root_powers + (n - (n >> 1) + 1), q, two_q);
+                inverse_stage_in_register32<4>(values, n, inv_root_powers + (n - (n >> 2) + 1), q, two_q);
+                size_t gap = 8;
+                for (size_t m = n >> 4; m > 1; m >>= 1, gap <<= 1)
+                {
+                    for (size_t i = 0; i < m; i++)
+                    {
+                        __m256i w = broadcast32(inv_root_powers[n - 2 * m + 1 + i]);
+                        __m256i w_quotient = broadcast32(inv_root_quotients[n - 2 * m + 1 + i]);
+                        uint32_t *x = values + 2 * gap * i;
+                        uint32_t *y = x + gap;
+                        for (size_t j = 0; j < gap; j += 8, x += 8, y += 8)
+                        {
+                            __m256i vx = load32(x);
+                            __m256i vy = load32(y);
+                            inverse_butterfly32(vx, vy, w, w_quotient, q, two_q);
+                            store32(x, vx);
+                            store32(y, vy);
+                        }
+                    }
+                }
+
+                // The last stage merges the multiplication by n^(-1); the 32-bit quotients are the high words of
+                // the 64-bit ones
+                const __m256i s = broadcast32(static_cast<uint32_t>(inv_degree.operand));
+                const __m256i s_quotient = broadcast32(static_cast<uint32_t>(inv_degree.quotient >> 32));
+                const __m256i w_last = broadcast32(static_cast<uint32_t>(scaled_inv_root.operand));
+                const __m256i w_last_quotient = broadcast32(static_cast<uint32_t>(scaled_inv_root.quotient >> 32));
+                uint32_t *x = values;
+                uint32_t *y = values + gap;
+                for (size_t j = 0; j < gap; j += 8, x += 8, y += 8)
+                {
+                    __m256i u = guard32(load32(x), two_q);
+                    __m256i v = load32(y);
+                    store32(x, mul_root32(guard32(_mm256_add_epi32(u, v), two_q), s, s_quotient, q));
+                    store32(y, mul_root32(_mm256_sub_epi32(_mm256_add_epi32(u, two_q), v), w_last, w_last_quotient, q));
+                }
+                unpack32(operand, n);
+            }
+
+            void dyadic_product_coeffmod32(
+                const uint64_t *operand1, const uint64_t *operand2, size_t coeff_count, uint64_t modulus,
+                int modulus_bit_count, uint64_t barrett_ratio, uint64_t *result)
+            {
+                const DyadicProduct32 product(modulus, modulus_bit_count, barrett_ratio);
+                size_t i = 0;
+                for (; i + 4 <= coeff_count; i += 4)
+                {
+                    store(result + i, product(load(operand1 + i), load(operand2 + i)));
+                }
+                if (i < coeff_count)
+                {
+                    __m256i mask = tail_mask(coeff_count - i);
+                    store(result + i, product(load(operand1 + i, mask), load(operand2 + i, mask)), mask);
+                }
+            }
+
+            void dot_product_coeffmod32(
+                const uint64_t *const *operand1, const uint64_t *const *operand2, size_t count, size_t coeff_count,
+                uint64_t modulus, int modulus_bit_count, uint64_t barrett_ratio, uint64_t *result)
+            {
+                // Sums for a tile of coefficients are kept in registers, so that the result is written once after
+                // all operands of the tile were read and may alias any of them
+                constexpr size_t tile_size = 64;
+                constexpr size_t tile_vectors = tile_size / 4;
+                const DyadicProduct32 product(modulus, modulus_bit_count, barrett_ratio);
+                __m256i acc[tile_vectors];
+                for (size_t offset = 0; offset < coeff_count; offset += tile_size)
+                {
+                    size_t tile_count = min(tile_size, coeff_count - offset);
+                    size_t vector_count = (tile_count + 3) / 4;
+                    __m256i last_mask = tail_mask(tile_count - 4 * (vector_count - 1));
+                    for (size_t k = 0; k < vector_count; k++)
+                    {
+                        acc[k] = _mm256_setzero_si256();
+                    }
+                    for (size_t j = 0; j < count; j++)
+                    {
+                        const uint64_t *x = operand1[j] + offset;
+                        const uint64_t *y = operand2[j] + offset;
+                        for (size_t k = 0; k + 1 < vector_count; k++)
+                        {
+                            __m256i p = product(load(x + 4 * k), load(y + 4 * k));
+                            acc[k] = guard(_mm256_add_epi64(acc[k], p), product.q);
+                        }
+                        size_t k = vector_count - 1;
+                        __m256i p = product(load(x + 4 * k, last_mask), load(y + 4 * k, last_mask));
+                        acc[k] = guard(_mm256_add_epi64(acc[k], p), product.q);
+                    }
+                    for (size_t k = 0; k + 1 < vector_count; k++)
+                    {
+                        store(result + offset + 4 * k, acc[k]);
+                    }
+                    store(result + offset + 4 * (vector_count - 1), acc[vector_count - 1], last_mask);
+                }
+            }
+
+            void add_poly_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t coeff_count, uint64_t modulus,
+                uint64_t *result)
+            {
+                const __m256i q = _mm256_set1_epi64x(static_cast<long long>(modulus));
+                auto add = [&](__m256i x, __m256i y) { return guard(_mm256_add_epi64(x, y), q); };
+                size_t i = 0;
+                for (; i + 4 <= coeff_count; i += 4)
+                {
+                    store(result + i, add(load(operand1 + i), load(operand2 + i)));
+                }
+                if (i < coeff_count)
+                {
+                    __m256i mask = tail_mask(coeff_count - i);
+                    store(result + i, add(load(operand1 + i, mask), load(operand2 + i, mask)), mask);
+                }
+            }
+
+            void sub_poly_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t coeff_count, uint64_t modulus,
+                uint64_t *result)
+            {
+                // Operands are below q < 2^63, so signed comparison detects negative differences
+                const __m256i q = _mm256_set1_epi64x(static_cast<long long>(modulus));
+                auto sub = [&](__m256i x, __m256i y) {
+                    __m256i borrow = _mm256_and_si256(_mm256_cmpgt_epi64(y, x), q);
+                    return _mm256_add_epi64(_mm256_sub_epi64(x, y), borrow);
+                };
+                size_t i = 0;
+                for (; i + 4 <= coeff_count; i += 4)
+                {
+                    store(result + i, sub(load(operand1 + i), load(operand2 + i)));
+                }
+                if (i < coeff_count)
+                {
+                    __m256i mask = tail_mask(coeff_count - i);
+                    store(result + i, sub(load(operand1 + i, mask), load(operand2 + i, mask)), mask);
+                }
+            }
+
+            void negate_poly_coeffmod(const uint64_t *poly, size_t coeff_count, uint64_t modulus, uint64_t *result)
+            {
+                const __m256i q = _mm256_set1_epi64x(static_cast<long long>(modulus));
+                const __m256i zero = _mm256_setzero_si256();
+                auto negate = [&](__m256i x) {
+                    return _mm256_andnot_si256(_mm256_cmpeq_epi64(x, zero), _mm256_sub_epi64(q, x));
+                };
+                size_t i = 0;
+                for (; i + 4 <= coeff_count; i += 4)
+                {
+                    store(result + i, negate(load(poly + i)));
+                }
+                if (i < coeff_count)
+                {
+                    __m256i mask = tail_mask(coeff_count - i);
+                    store(result + i, negate(load(poly + i, mask)), mask);
+                }
+            }
+
+            void multiply_poly_scalar_coeffmod(
+                const uint64_t *poly, size_t coeff_count, MultiplyUIntModOperand scalar, uint64_t modulus,
+                uint64_t *result)
+            {
+                const __m256i q = _mm256_set1_epi64x(static_cast<long long>(modulus));
+                const __m256i s = _mm256_set1_epi64x(static_cast<long long>(scalar.operand));
+                const __m256i s_quotient = _mm256_set1_epi64x(static_cast<long long>(scalar.quotient));
+                size_t i = 0;
+                for (; i + 4 <= coeff_count; i += 4)
+                {
+                    store(result + i, guard(mul_root(load(poly + i), s, s_quotient, q), q));
+                }
+                if (i < coeff_count)
+                {
+                    __m256i mask = tail_mask(coeff_count - i);
+                    store(result + i, guard(mul_root(load(poly + i, mask), s, s_quotient, q), q), mask);
+                }
+            }
+
+            void multiply_accumulate_coeffmod(
+                const uint64_t *rows, size_t row_count, size_t coeff_count, const MultiplyUIntModOperand *weights,
+                uint64_t modulus, uint64_t *result)
+            {
+                const __m256i q = _mm256_set1_epi64x(static_cast<long long>(modulus));
+                const __m256i two_q = _mm256_add_epi64(q, q);
+
+                // The accumulator stays in [0, 2q) so the sums never exceed 4q
+                auto accumulate = [&](const uint64_t *row, auto load_row) {
+                    __m256i acc = _mm256_setzero_si256();
+                    for (size_t i = 0; i < row_count; i++, row += coeff_count)
+                    {
+                        __m256i w = _mm256_set1_epi64x(static_cast<long long>(weights[i].operand));
+                        __m256i w_quotient = _mm256_set1_epi64x(static_cast<long long>(weights[i].quotient));
+                        acc = guard(_mm256_add_epi64(acc, mul_root(load_row(row), w, w_quotient, q)), two_q);
+                    }
+                    return guard(acc, q);
+                };
+
+                size_t j = 0;
+                for (; j + 4 <= coeff_count; j += 4)
+                {
+                    store(result + j, accumulate(rows + j, [](const uint64_t *ptr) { return load(ptr); }));
+                }
+                if (j < coeff_count)
+                {
+                    __m256i mask = tail_mask(coeff_count - j);
+                    store(
+                        result + j, accumulate(rows + j, [mask](const uint64_t *ptr) { return load(ptr, mask); }),
+                        mask);
+                }
+            }
+        } // namespace avx2
+    } // namespace util
+} // namespace seal
@@ -0,0 +1,497 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/util/simdavx512ntt.h"
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace avx512
+        {
+            namespace
+            {
+                // High 64 bits of the 128-bit products; AVX-512F only has a 32x32-bit multiplier.
+                inline __m512i mul_hi(__m512i a, __m512i b)
+                {
+                    const __m512i lo_mask = _mm512_set1_epi64(0xFFFFFFFF);
+                    __m512i a_hi = _mm512_srli_epi64(a, 32);
+                    __m512i b_hi = _mm512_srli_epi64(b, 32);
+                    __m512i lo_lo = _mm512_mul_epu32(a, b);
+                    __m512i hi_lo = _mm512_mul_epu32(a_hi, b);
+                    __m512i lo_hi = _mm512_mul_epu32(a, b_hi);
+                    __m512i hi_hi = _mm512_mul_epu32(a_hi, b_hi);
+
+                    // Neither sum can overflow: (2^32 - 1)^2 + 2 * (2^32 - 1) < 2^64
+                    __m512i mid = _mm512_add_epi64(hi_lo, _mm512_srli_epi64(lo_lo, 32));
+                    __m512i carry = _mm512_add_epi64(lo_hi, _mm512_and_si512(mid, lo_mask));
+                    return _mm512_add_epi64(
+                        _mm512_add_epi64(hi_hi, _mm512_srli_epi64(mid, 32)), _mm512_srli_epi64(carry, 32));
+                }
+
+                // Lane-wise multiply_uint_mod_lazy; outputs are in [0, 2q)
+                inline __m512i mul_root(__m512i x, __m512i w, __m512i w_quotient, __m512i q)
+                {
+                    return _mm512_sub_epi64(_mm512_mullo_epi64(x, w), _mm512_mullo_epi64(mul_hi(x, w_quotient), q));
+                }
+
+                struct MulRoot64
+                {
+                    MulRoot64(uint64_t modulus) : q(broadcast(modulus))
+                    {}
+
+                    inline __m512i quotient(__m512i w_quotient) const
+                    {
+                        return w_quotient;
+                    }
+
+                    inline __m512i operator()(__m512i x, __m512i w, __m512i w_quotient) const
+                    {
+                        return mul_root(x, w, w_quotient, q);
+                    }
+
+                    __m512i q;
+                };
+
+                // The kernels for moduli of at most SEAL_SMALL_MOD_BIT_COUNT_MAX bits compute with sixteen 32-bit
+                // lanes: values below 4q fit in 32 bits, and Shoup multiplication uses the quotients
+                // floor(w * 2^32 / q).
+                inline __m512i broadcast32(std::uint32_t value)
+                {
+                    return _mm512_set1_epi32(static_cast<int>(value));
+                }
+
+                inline __m512i load32(const std::uint32_t *ptr)
+                {
+                    return _mm512_loadu_si512(ptr);
+                }
+
+                inline void store32(std::uint32_t *ptr, __m512i value)
+                {
+                    _mm512_storeu_si512(ptr, value);
+                }
+
+                inline __m512i guard32(__m512i x, __m512i bound)
+                {
+                    return _mm512_min_epu32(x, _mm512_sub_epi32(x, bound));
+                }
+
+                // High 32 bits of the 64-bit products
+                inline __m512i mul_hi32(__m512i a, __m512i b)
+                {
+                    __m512i even = _mm512_srli_epi64(_mm512_mul_epu32(a, b), 32);
+                    __m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+                    return _mm512_mask_blend_epi32(0xAAAA, even, odd);
+                }
+
+                // Lane-wise multiply_uint_mod_lazy for x below 2^32; outputs are in [0, 2q)
+                inline __m512i mul_root32(__m512i x, __m512i w, __m512i w_quotient, __m512i q)
+                {
+                    return _mm512_sub_epi32(
+                        _mm512_mullo_epi32(x, w), _mm512_mullo_epi32(mul_hi32(x, w_quotient), q));
+                }
+
+                inline void forward_butterfly32(
+                    __m512i &x, __m512i &y, __m512i w, __m512i w_quotient, __m512i q, __m512i two_q)
+                {
+                    __m512i u = guard32(x, two_q);
+                    __m512i v = mul_root32(y, w, w_quotient, q);
+                    x = _mm512_add_epi32(u, v);
+                    y = _mm512_sub_epi32(_mm512_add_epi32(u, two_q), v);
+                }
+
+                inline void inverse_butterfly32(
+                    __m512i &x, __m512i &y, __m512i w, __m512i w_quotient, __m512i q, __m512i two_q)
+                {
+                    __m512i u = x;
+                    __m512i v = y;
+                    x = guard32(_mm512_add_epi32(u, v), two_q);
+                    y = mul_root32(_mm512_sub_epi32(_mm512_add_epi32(u, two_q), v), w, w_quotient, q);
+                }
+
+                // The 32-bit counterpart of InRegisterStage for thirty-two consecutive values
+                template <std::size_t Gap>
+                struct InRegisterStage32
+                {
+                    static_assert(Gap == 1 || Gap == 2 || Gap == 4 || Gap == 8, "Gap");
+
+                    InRegisterStage32()
+                    {
+                        alignas(64) std::uint32_t x_idx[16], y_idx[16], v0_idx[16], v1_idx[16], root_idx[16];
+                        for (std::uint32_t l = 0; l < 16; l++)
+                        {
+                            x_idx[l] = static_cast<std::uint32_t>((l / Gap) * 2 * Gap + l % Gap);
+                            y_idx[l] = x_idx[l] + static_cast<std::uint32_t>(Gap);
+                            for (std::uint32_t e : { l, l + 16 })
+                            {
+                                std::uint32_t lane = static_cast<std::uint32_t>((e / (2 * Gap)) * Gap + e % Gap);
+                                ((e < 16) ? v0_idx[l] : v1_idx[l]) = (e % (2 * Gap) < Gap) ? lane : lane + 16;
+                            }
+                            root_idx[l] = static_cast<std::uint32_t>(l / Gap);
+                        }
+                        split_x = _mm512_load_si512(x_idx);
+                        split_y = _mm512_load_si512(y_idx);
+                        merge_v0 = _mm512_load_si512(v0_idx);
+                        merge_v1 = _mm512_load_si512(v1_idx);
+                        root_lanes = _mm512_load_si512(root_idx);
+                    }
+
+                    inline void split(__m512i v0, __m512i v1, __m512i &x, __m512i &y) const
+                    {
+                        x = _mm512_permutex2var_epi32(v0, split_x, v1);
+                        y = _mm512_permutex2var_epi32(v0, split_y, v1);
+                    }
+
+                    inline void merge(__m512i x, __m512i y, __m512i &v0, __m512i &v1) const
+                    {
+                        v0 = _mm512_permutex2var_epi32(x, merge_v0, y);
+                        v1 = _mm512_permutex2var_epi32(x, merge_v1, y);
+                    }
+
+                    // Reads exactly the 16 / Gap roots used by thirty-two values
+                    inline __m512i load_roots(const std::uint32_t *roots) const
+                    {
+                        const __mmask16 mask = static_cast<__mmask16>((1U << (16 / Gap)) - 1);
+                        return _mm512_permutexvar_epi32(root_lanes, _mm512_maskz_loadu_epi32(mask, roots));
+                    }
+
+                    __m512i split_x;
+                    __m512i split_y;
+                    __m512i merge_v0;
+                    __m512i merge_v1;
+                    __m512i root_lanes;
+                };
+
+                // The root operands are followed by their quotients at an offset of n
+                template <std::size_t Gap>
+                inline void forward_stage_in_register32(
+                    std::uint32_t *values, std::size_t n, const std::uint32_t *roots, __m512i q, __m512i two_q)
+                {
+                    const InRegisterStage32<Gap> stage;
+                    __m512i v0, v1, x, y;
+                    for (std::size_t offset = 0; offset < n; offset += 32, roots += 16 / Gap)
+                    {
+                        stage.split(load32(values + offset), load32(values + offset + 16), x, y);
+                        forward_butterfly32(x, y, stage.load_roots(roots), stage.load_roots(roots + n), q, two_q);
+                        stage.merge(x, y, v0, v1);
+                        store32(values + offset, v0);
+                        store32(values + offset + 16, v1);
+                    }
+                }
+
+                template <std::size_t Gap>
+                inline void inverse_stage_in_register32(
+                    std::uint32_t *values, std::size_t n, const std::uint32_t *roots, __m512i q, __m512i two_q)
+                {
+                    const InRegisterStage32<Gap> stage;
+                    __m512i v0, v1, x, y;
+                    for (std::size_t offset = 0; offset < n; offset += 32, roots += 16 / Gap)
+                    {
+                        stage.split(load32(values + offset), load32(values + offset + 16), x, y);
+                        inverse_butterfly32(x, y, stage.load_roots(roots), stage.load_roots(roots + n), q, two_q);
+                        stage.merge(x, y, v0, v1);
+                        store32(values + offset, v0);
+                        store32(values + offset + 16, v1);
+                    }
+                }
+
+                // Packs the values into 32-bit words at the start of the same array; each store only overwrites
+                // values that were already loaded
+                inline std::uint32_t *pack32(std::uint64_t *values, std::size_t n)
+                {
+                    std::uint32_t *packed = reinterpret_cast<std::uint32_t *>(values);
+                    for (std::size_t i = 0; i < n; i += 16)
+                    {
+                        __m256i lo = _mm512_cvtepi64_epi32(load(values + i));
+                        __m256i hi = _mm512_cvtepi64_epi32(load(values + i + 8));
+                        store32(packed + i, _mm512_inserti64x4(_mm512_castsi256_si512(lo), hi, 1));
+                    }
+                    return packed;
+                }
+
+                // Reverses pack32, from the end of the array
+                inline void unpack32(std::uint64_t *values, std::size_t n)
+                {
+                    const std::uint32_t *packed = reinterpret_cast<const std::uint32_t *>(values);
+                    for (std::size_t i = n; i > 0;)
+                    {
+                        i -= 16;
+                        __m512i v = load32(packed + i);
+                        __m512i lo = _mm512_cvtepu32_epi64(_mm512_castsi512_si256(v));
+                        __m512i hi = _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(v, 1));
+                        store(values + i, lo);
+                        store(values + i + 8, hi);
+                    }
+                }
+
+                // With k bits in q, the products are below 2^(2k) and z / 2^(k - 1) and floor(2^(2k) / q) fit in
+                // 32 bits, so all products are single 32x32-bit multiplications
+                struct DyadicProduct32
+                {
+                    DyadicProduct32(uint64_t modulus, int modulus_bit_count, uint64_t barrett_ratio)
+                        : q(broadcast(modulus)), two_q(_mm512_add_epi64(q, q)), ratio(broadcast(barrett_ratio)),
+                          z_shift(_mm_cvtsi32_si128(modulus_bit_count - 1)),
+                          e_shift(_mm_cvtsi32_si128(modulus_bit_count + 1))
+                    {}
+
+                    inline __m512i operator()(__m512i x, __m512i y) const
+                    {
+                        x = guard(guard(x, two_q), q);
+                        y = guard(guard(y, two_q), q);
+                        __m512i z = _mm512_mul_epu32(x, y);
+                        __m512i e = _mm512_srl_epi64(_mm512_mul_epu32(_mm512_srl_epi64(z, z_shift), ratio), e_shift);
+
+                        // The remainder is in [0, 3q)
+                        __m512i r = _mm512_sub_epi64(z, _mm512_mul_epu32(e, q));
+                        return guard(guard(r, q), q);
+                    }
+
+                    __m512i q;
+                    __m512i two_q;
+                    __m512i ratio;
+                    __m128i z_shift;
+                    __m128i e_shift;
+                };
+            } // namespace
+
+            void ntt_negacyclic_harvey_lazy(
+                uint64_t *operand, int coeff_count_power, const MultiplyUIntModOperand *root_powers, uint64_t modulus)
+            {
+                forward_transform<MulRoot64>(operand, coeff_count_power, root_powers, modulus);
+            }
+
+            void inverse_ntt_negacyclic_harvey_lazy(
+                uint64_t *operand, int coeff_count_power, const MultiplyUIntModOperand *inv_root_powers,
+                MultiplyUIntModOperand inv_degree, MultiplyUIntModOperand scaled_inv_root, uint64_t modulus)
+            {
+                inverse_transform<MulRoot64>(
+                    operand, coeff_count_power, inv_root_powers, inv_degree, scaled_inv_root, modulus);
+            }
+
+            // The 32-bit values of a transform of up to 2^(ntt_block_coeff_count_power + 1) coefficients fit in the
+            // space of a 64-bit block, so the stages are applied to the whole array.
+            void ntt_negacyclic_harvey_lazy32(
+                uint64_t *operand, int coeff_count_power, const uint32_t *root_powers, uint32_t modulus)
+            {
+                size_t n = size_t(1) << coeff_count_power;
+                const uint32_t *root_quotients = root_powers + n;
+                const __m512i q = broadcast32(modulus);
+                const __m512i two_q = broadcast32(modulus << 1);
+                uint32_t *values = pack32(operand, n);
+
+                // The i-th group of the stage with m groups uses roots[m + i]
+                size_t m = 1;
+                for (size_t gap = n >> 1; gap >= 16; m <<= 1, gap >>= 1)
+                {
+                    for (size_t i = 0; i < m; i++)
+                    {
+                        __m512i w = broadcast32(root_powers[m + i]);
+                        __m512i w_quotient = broadcast32(root_quotients[m + i]);
+                        uint32_t *x = values + 2 * gap * i;
+                        uint32_t *y = x + gap;
+                        for (size_t j = 0; j < gap; j += 16, x += 16, y += 16)
+                        {
+                            __m512i vx = load32(x);
+                            __m512i vy = load32(y);
+                            forward_butterfly32(vx, vy, w, w_quotient, q, two_q);
+                            store32(x, vx);
+                            store32(y, vy);
+                        }
+                    }
+                }
+                forward_stage_in_register32<8>(values, n, root_powers + m, q, two_q);
+                forward_stage_in_register32<4>(values, n, root_powers + 2 * m, q, two_q);
+                forward_stage_in_register32<2>(values, n, root_powers + 4 * m, q, two_q);
+                forward_stage_in_register32<1>(values, n, root_powers + 8 * m, q, two_q);
+                unpack32(operand, n);
+            }
+
+            void inverse_ntt_negacyclic_harvey_lazy32(
+                uint64_t *operand, int coeff_count_power, const uint32_t *inv_root_powers,
+                MultiplyUIntModOperand inv_degree, MultiplyUIntModOperand scaled_inv_root, uint32_t modulus)
+            {
+                size_t n = size_t(1) << coeff_count_power;
+                const uint32_t *inv_root_quotients = inv_root_powers + n;
+                const __m512i q = broadcast32(modulus);
+                const __m512i two_q = broadcast32(modulus << 1);
+                uint32_t *values = pack32(operand, n);
+
+                // Roots are stored in scrambled order: the i-th group of the stage with m groups uses
+                // inv_root_powers[n - 2 * m + 1 + i]
+                inverse_stage_in_register32<1>(values, n, inv_root_powers + 1, q, two_q);
+                inverse_stage_in_register32<2>(values, n, inv_root_powers + (n - (n >> 1) + 1), q, two_q);
+                inverse_stage_in_register32<4>(values, n, inv_root_powers + (n - (n >> 2) + 1), q, two_q);
+                inverse_stage_in_register32<8>(values, n, inv_root_powers + (n - (n >> 3) + 1), q, two_q);
+                size_t gap = 16;
+                for (size_t m = n >> 5; m > 1; m >>= 1, gap <<= 1)
+                {
+                    for (size_t i = 0; i < m; i++)
+                    {
+                        __m512i w = broadcast32(inv_root_powers[n - 2 * m + 1 + i]);
+                        __m512i w_quotient = broadcast32(inv_root_quotients[n - 2 * m + 1 + i]);
+                        uint32_t *x = values + 2 * gap * i;
+                        uint32_t *y = x + gap;
+                        for (size_t j = 0; j < gap; j += 16, x += 16, y += 16)
+                        {
+                            __m512i vx = load32(x);
+                            __m512i vy = load32(y);
+                            inverse_butterfly32(vx, vy, w, w_quotient, q, two_q);
+                            store32(x, vx);
+                            store32(y, vy);
+                        }
+                    }
+                }
+
+                // The last stage merges the multiplication by n^(-1); the 32-bit quotients are the high words of
+                // the 64-bit ones
+                const __m512i s = broadcast32(static_cast<uint32_t>(inv_degree.operand));
+                const __m512i s_quotient = broadcast32(static_cast<uint32_t>(inv_degree.quotient >> 32));
+                const __m512i w_last = broadcast32(static_cast<uint32_t>(scaled_inv_root.operand));
+                const __m512i w_last_quotient = broadcast32(static_cast<uint32_t>(scaled_inv_root.quotient >> 32));
+                uint32_t *x = values;
+                uint32_t *y = values + gap;
+                for (size_t j = 0; j < gap; j += 16, x += 16, y += 16)
+                {
+                    __m512i u = guard32(load32(x), two_q);
+                    __m512i v = load32(y);
+                    store32(x, mul_root32(guard32(_mm512_add_epi32(u, v), two_q), s, s_quotient, q));
+                    store32(y, mul_root32(_mm512_sub_epi32(_mm512_add_epi32(u, two_q), v), w_last, w_last_quotient, q));
+                }
+                unpack32(operand, n);
+            }
+
+            void dyadic_product_coeffmod32(
+                const uint64_t *operand1, const uint64_t *operand2, size_t coeff_count, uint64_t modulus,
+                int modulus_bit_count, uint64_t barrett_ratio, uint64_t *result)
+            {
+                const DyadicProduct32 product(modulus, modulus_bit_count, barrett_ratio);
+                size_t i = 0;
+                for (; i + 8 <= coeff_count; i += 8)
+                {
+                    store(result + i, product(load(operand1 + i), load(operand2 + i)));
+                }
+                if (i < coeff_count)
+                {
+                    __mmask8 mask = tail_mask(coeff_count - i);
+                    store(result + i, product(load(operand1 + i, mask), load(operand2 + i, mask)), mask);
+                }
+            }
+
+            void dot_product_coeffmod32(
+                const uint64_t *const *operand1, const uint64_t *const *operand2, size_t count, size_t coeff_count,
+                uint64_t modulus, int modulus_bit_count, uint64_t barrett_ratio, uint64_t *result)
+            {
+                const DyadicProduct32 product(modulus, modulus_bit_count, barrett_ratio);
+                dot_product_tiled(product, operand1, operand2, count, coeff_count, product.q, result);
+            }
+
+            void add_poly_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t coeff_count, uint64_t modulus,
+                uint64_t *result)
+            {
+                const __m512i q = broadcast(modulus);
+                auto add = [&](__m512i x, __m512i y) { return guard(_mm512_add_epi64(x, y), q); };
+                size_t i = 0;
+                for (; i + 8 <= coeff_count; i += 8)
+                {
+                    store(result + i, add(load(operand1 + i), load(operand2 + i)));
+                }
+                if (i < coeff_count)
+                {
+                    __mmask8 mask = tail_mask(coeff_count - i);
+                    store(result + i, add(load(operand1 + i, mask), load(operand2 + i, mask)), mask);
+                }
+            }
+
+            void sub_poly_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t coeff_count, uint64_t modulus,
+                uint64_t *result)
+            {
+                // A negative difference wraps around above 2^64 - q, and adding q brings it back to [0, q)
+                const __m512i q = broadcast(modulus);
+                auto sub = [&](__m512i x, __m512i y) {
+                    __m512i d = _mm512_sub_epi64(x, y);
+                    return _mm512_min_epu64(d, _mm512_add_epi64(d, q));
+                };
+                size_t i = 0;
+                for (; i + 8 <= coeff_count; i += 8)
+                {
+                    store(result + i, sub(load(operand1 + i), load(operand2 + i)));
+                }
+                if (i < coeff_count)
+                {
+                    __mmask8 mask = tail_mask(coeff_count - i);
+                    store(result + i, sub(load(operand1 + i, mask), load(operand2 + i, mask)), mask);
+                }
+            }
+
+            void negate_poly_coeffmod(const uint64_t *poly, size_t coeff_count, uint64_t modulus, uint64_t *result)
+            {
+                const __m512i q = broadcast(modulus);
+                auto negate = [&](__m512i x) { return _mm512_maskz_sub_epi64(_mm512_test_epi64_mask(x, x), q, x); };
+                size_t i = 0;
+                for (; i + 8 <= coeff_count; i += 8)
+                {
+                    store(result + i, negate(load(poly + i)));
+                }
+                if (i < coeff_count)
+                {
+                    __mmask8 mask = tail_mask(coeff_count - i);
+                    store(result + i, negate(load(poly + i, mask)), mask);
+                }
+            }
+
+            void multiply_poly_scalar_coeffmod(
+                const uint64_t *poly, size_t coeff_count, MultiplyUIntModOperand scalar, uint64_t modulus,
+                uint64_t *result)
+            {
+                const __m512i q = broadcast(modulus);
+                const __m512i s = broadcast(scalar.operand);
+                const __m512i s_quotient = broadcast(scalar.quotient);
+                size_t i = 0;
+                for (; i + 8 <= coeff_count; i += 8)
+                {
+                    store(result + i, guard(mul_root(load(poly + i), s, s_quotient, q), q));
+                }
+                if (i < coeff_count)
+                {
+                    __mmask8 mask = tail_mask(coeff_count - i);
+                    store(result + i, guard(mul_root(load(poly + i, mask), s, s_quotient, q), q), mask);
+                }
+            }
+
+            void multiply_accumulate_coeffmod(
+                const uint64_t *rows, size_t row_count, size_t coeff_count, const MultiplyUIntModOperand *weights,
+                uint64_t modulus, uint64_t *result)
+            {
+                const __m512i q = broadcast(modulus);
+                const __m512i two_q = _mm512_add_epi64(q, q);
+
+                // The accumulator stays in [0, 2q) so the sums never exceed 4q
+                auto accumulate = [&](const uint64_t *row, __mmask8 mask) {
+                    __m512i acc = _mm512_setzero_si512();
+                    for (size_t i = 0; i < row_count; i++, row += coeff_count)
+                    {
+                        __m512i w = broadcast(weights[i].operand);
+                        __m512i w_quotient = broadcast(weights[i].quotient);
+                        acc = guard(_mm512_add_epi64(acc, mul_root(load(row, mask), w, w_quotient, q)), two_q);
+                    }
+                    return guard(acc, q);
+                };
+
+                size_t j = 0;
+                for (; j + 8 <= coeff_count; j += 8)
+                {
+                    store(result + j, accumulate(rows + j, static_cast<__mmask8>(0xFF)));
+                }
+                if (j < coeff_count)
+                {
+                    __mmask8 mask = tail_mask(coeff_count - j);
+                    store(result + j, accumulate(rows + j, mask), mask);
+                }
+            }
+        } // namespace avx512
+    } // namespace util
+} // namespace seal
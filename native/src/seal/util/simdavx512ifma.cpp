@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/util/simdavx512ntt.h"
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace avx512ifma
+        {
+            namespace
+            {
+                using namespace avx512;
+
+                const uint64_t low52_mask = (uint64_t(1) << 52) - 1;
+
+                // Shoup multiplication with 52-bit quotients floor(w * 2^52 / q), which are the 64-bit quotients
+                // shifted right by 12 bits. Adding the product with 2^52 - q subtracts the product with q modulo 2^52.
+                struct MulRoot52
+                {
+                    MulRoot52(uint64_t modulus)
+                        : neg_q(broadcast((uint64_t(1) << 52) - modulus)), mask(broadcast(low52_mask))
+                    {}
+
+                    inline __m512i quotient(__m512i w_quotient) const
+                    {
+                        return _mm512_srli_epi64(w_quotient, 12);
+                    }
+
+                    inline __m512i operator()(__m512i x, __m512i w, __m512i w_quotient) const
+                    {
+                        const __m512i zero = _mm512_setzero_si512();
+                        __m512i e = _mm512_madd52hi_epu64(zero, x, w_quotient);
+                        __m512i r = _mm512_madd52lo_epu64(_mm512_madd52lo_epu64(zero, x, w), e, neg_q);
+                        return _mm512_and_si512(r, mask);
+                    }
+
+                    __m512i neg_q;
+                    __m512i mask;
+                };
+
+                // The Barrett reduction of the AVX-512 kernel with the products split at bit 52 instead of bit 64
+                struct DyadicProduct52
+                {
+                    DyadicProduct52(uint64_t modulus, int modulus_bit_count, uint64_t barrett_ratio)
+                        : q(broadcast(modulus)), two_q(_mm512_add_epi64(q, q)),
+                          neg_q(broadcast((uint64_t(1) << 52) - modulus)), ratio(broadcast(barrett_ratio)),
+                          mask(broadcast(low52_mask)), z_shift(_mm_cvtsi32_si128(modulus_bit_count - 1)),
+                          z_hi_shift(_mm_cvtsi32_si128(53 - modulus_bit_count)),
+                          e_shift(_mm_cvtsi32_si128(modulus_bit_count + 1)),
+                          e_hi_shift(_mm_cvtsi32_si128(51 - modulus_bit_count))
+                    {}
+
+                    inline __m512i operator()(__m512i x, __m512i y) const
+                    {
+                        const __m512i zero = _mm512_setzero_si512();
+                        x = guard(guard(x, two_q), q);
+                        y = guard(guard(y, two_q), q);
+                        __m512i z_lo = _mm512_madd52lo_epu64(zero, x, y);
+                        __m512i t = _mm512_or_si512(
+                            _mm512_sll_epi64(_mm512_madd52hi_epu64(zero, x, y), z_hi_shift),
+                            _mm512_srl_epi64(z_lo, z_shift));
+                        __m512i e = _mm512_or_si512(
+                            _mm512_sll_epi64(_mm512_madd52hi_epu64(zero, t, ratio), e_hi_shift),
+                            _mm512_srl_epi64(_mm512_madd52lo_epu64(zero, t, ratio), e_shift));
+
+                        // The remainder is in [0, 3q)
+                        __m512i r = _mm512_and_si512(_mm512_madd52lo_epu64(z_lo, e, neg_q), mask);
+                        return guard(guard(r, q), q);
+                    }
+
+                    __m512i q;
+                    __m512i two_q;
+                    __m512i neg_q;
+                    __m512i ratio;
+                    __m512i mask;
+                    __m128i z_shift;
+                    __m128i z_hi_shift;
+                    __m128i e_shift;
+                    __m128i e_hi_shift;
+                };
+            } // namespace
+
+            void ntt_negacyclic_harvey_lazy(
+                uint64_t *operand, int coeff_count_power, const MultiplyUIntModOperand *root_powers, uint64_t modulus)
+            {
+                forward_transform<MulRoot52>(operand, coeff_count_power, root_powers, modulus);
+            }
+
+            void inverse_ntt_negacyclic_harvey_lazy(
+                uint64_t *operand, int coeff_count_power, const MultiplyUIntModOperand *inv_root_powers,
+                MultiplyUIntModOperand inv_degree, MultiplyUIntModOperand scaled_inv_root, uint64_t modulus)
+            {
+                inverse_transform<MulRoot52>(
+                    operand, coeff_count_power, inv_root_powers, inv_degree, scaled_inv_root, modulus);
+            }
+
+            void dyadic_product_coeffmod(
+                const uint64_t *operand1, const uint64_t *operand2, size_t coeff_count, uint64_t modulus,
+                int modulus_bit_count, uint64_t barrett_ratio, uint64_t *result)
+            {
+                const DyadicProduct52 product(modulus, modulus_bit_count, barrett_ratio);
+                size_t i = 0;
+                for (; i + 8 <= coeff_count; i += 8)
+                {
+                    store(result + i, product(load(operand1 + i), load(operand2 + i)));
+                }
+                if (i < coeff_count)
+                {
+                    __mmask8 mask = tail_mask(coeff_count - i);
+                    store(result + i, product(load(operand1 + i, mask), load(operand2 + i, mask)), mask);
+                }
+            }
+
+            void dot_product_coeffmod(
+                const uint64_t *const *operand1, const uint64_t *const *operand2, size_t count, size_t coeff_count,
+                uint64_t modulus, int modulus_bit_count, uint64_t barrett_ratio, uint64_t *result)
+            {
+                const DyadicProduct52 product(modulus, modulus_bit_count, barrett_ratio);
+                dot_product_tiled(product, operand1, operand2, count, coeff_count, product.q, result);
+            }
+        } // namespace avx512ifma
+    } // namespace util
+} // namespace seal
@@ -0,0 +1,537 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/util/simd.h"
+#include <algorithm>
+#include <immintrin.h>
+
+// Shared by the AVX-512 and AVX-512 IFMA kernels and never installed: it may only be included by translation units
+// compiled with AVX-512 flags. Everything here has internal linkage so that the two translation units never share an
+// instantiation compiled for the wrong instruction set.
+
+namespace seal
+{
+    namespace util
+    {
+        namespace avx512
+        {
+            namespace
+            {
+                inline __m512i load(const std::uint64_t *ptr)
+                {
+                    return _mm512_loadu_si512(ptr);
+                }
+
+                inline void store(std::uint64_t *ptr, __m512i value)
+                {
+                    _mm512_storeu_si512(ptr, value);
+                }
+
+                // Lanes below count are set; used for the remainders of the elementwise kernels
+                inline __mmask8 tail_mask(std::size_t count)
+                {
+                    return static_cast<__mmask8>((1U << count) - 1);
+                }
+
+                inline __m512i load(const std::uint64_t *ptr, __mmask8 mask)
+                {
+                    return _mm512_maskz_loadu_epi64(mask, ptr);
+                }
+
+                inline void store(std::uint64_t *ptr, __m512i value, __mmask8 mask)
+                {
+                    _mm512_mask_storeu_epi64(ptr, mask, value);
+                }
+
+                // Subtracts bound from lanes that are not below it
+                inline __m512i guard(__m512i x, __m512i bound)
+                {
+                    return _mm512_min_epu64(x, _mm512_sub_epi64(x, bound));
+                }
+
+                // Permutations between sixteen consecutive values and the x and y halves of the butterflies of the
+                // stage with the given gap. Lane l of x holds the x value of the l-th butterfly in natural order.
+                template <std::size_t Gap>
+                struct InRegisterStage
+                {
+                    static_assert(Gap == 1 || Gap == 2 || Gap == 4, "Gap");
+
+                    InRegisterStage()
+                    {
+                        alignas(64) std::uint64_t x_idx[8], y_idx[8], v0_idx[8], v1_idx[8], op_idx[8], quo_idx[8];
+                        for (std::uint64_t l = 0; l < 8; l++)
+                        {
+                            // The l-th butterfly reads positions (l / Gap) * 2 * Gap + l % Gap and Gap after that
+                            x_idx[l] = (l / Gap) * 2 * Gap + l % Gap;
+                            y_idx[l] = x_idx[l] + Gap;
+
+                            // Position e is the x or y value of butterfly (e / (2 * Gap)) * Gap + e % Gap
+                            for (std::uint64_t e : { l, l + 8 })
+                            {
+                                std::uint64_t lane = (e / (2 * Gap)) * Gap + e % Gap;
+                                ((e < 8) ? v0_idx[l] : v1_idx[l]) = (e % (2 * Gap) < Gap) ? lane : lane + 8;
+                            }
+
+                            // Operands and quotients of the roots are interleaved in memory
+                            op_idx[l] = 2 * (l / Gap);
+                            quo_idx[l] = 2 * (l / Gap) + 1;
+                        }
+                        split_x = _mm512_load_si512(x_idx);
+                        split_y = _mm512_load_si512(y_idx);
+                        merge_v0 = _mm512_load_si512(v0_idx);
+                        merge_v1 = _mm512_load_si512(v1_idx);
+                        root_op = _mm512_load_si512(op_idx);
+                        root_quo = _mm512_load_si512(quo_idx);
+                    }
+
+                    inline void split(__m512i v0, __m512i v1, __m512i &x, __m512i &y) const
+                    {
+                        x = _mm512_permutex2var_epi64(v0, split_x, v1);
+                        y = _mm512_permutex2var_epi64(v0, split_y, v1);
+                    }
+
+                    inline void merge(__m512i x, __m512i y, __m512i &v0, __m512i &v1) const
+                    {
+                        v0 = _mm512_permutex2var_epi64(x, merge_v0, y);
+                        v1 = _mm512_permutex2var_epi64(x, merge_v1, y);
+                    }
+
+                    // Reads exactly the 8 / Gap roots used by sixteen values
+                    inline void load_roots(const MultiplyUIntModOperand *roots, __m512i &w, __m512i &w_quotient) const
+                    {
+                        __m512i a;
+                        __m512i b = _mm512_setzero_si512();
+                        const std::uint64_t *ptr = reinterpret_cast<const std::uint64_t *>(roots);
+                        switch (Gap)
+                        {
+                        case 4:
+                            a = _mm512_castsi256_si512(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr)));
+                            break;
+                        case 2:
+                            a = load(ptr);
+                            break;
+                        default:
+                            a = load(ptr);
+                            b = load(ptr + 8);
+                            break;
+                        }
+                        w = _mm512_permutex2var_epi64(a, root_op, b);
+                        w_quotient = _mm512_permutex2var_epi64(a, root_quo, b);
+                    }
+
+                    __m512i split_x;
+                    __m512i split_y;
+                    __m512i merge_v0;
+                    __m512i merge_v1;
+                    __m512i root_op;
+                    __m512i root_quo;
+                };
+
+                /*
+                The transforms are parameterized by the lane-wise lazy modular multiplication. MulRoot is constructed
+                from the modulus and provides quotient(), which converts the precomputed 64-bit Shoup quotients into
+                the form it expects, and operator()(x, w, w_quotient), which returns x * w mod q in [0, 2q) for x in
+                [0, 4q).
+                */
+                template <typename MulRoot>
+                inline void forward_butterfly(
+                    const MulRoot &mul_root, __m512i &x, __m512i &y, __m512i w, __m512i w_quotient, __m512i two_q)
+                {
+                    __m512i u = guard(x, two_q);
+                    __m512i v = mul_root(y, w, w_quotient);
+                    x = _mm512_add_epi64(u, v);
+                    y = _mm512_sub_epi64(_mm512_add_epi64(u, two_q), v);
+                }
+
+                template <typename MulRoot>
+                inline void inverse_butterfly(
+                    const MulRoot &mul_root, __m512i &x, __m512i &y, __m512i w, __m512i w_quotient, __m512i two_q)
+                {
+                    __m512i u = x;
+                    __m512i v = y;
+                    x = guard(_mm512_add_epi64(u, v), two_q);
+                    y = mul_root(_mm512_sub_epi64(_mm512_add_epi64(u, two_q), v), w, w_quotient);
+                }
+
+                template <std::size_t Gap, typename MulRoot>
+                inline void forward_stage_in_register(
+                    const MulRoot &mul_root, std::uint64_t *values, std::size_t n, const MultiplyUIntModOperand *roots,
+                    __m512i two_q)
+                {
+                    const InRegisterStage<Gap> stage;
+                    __m512i v0, v1, x, y, w, w_quotient;
+                    for (std::size_t offset = 0; offset < n; offset += 16)
+                    {
+                        stage.split(load(values + offset), load(values + offset + 8), x, y);
+                        stage.load_roots(roots, w, w_quotient);
+                        forward_butterfly(mul_root, x, y, w, mul_root.quotient(w_quotient), two_q);
+                        stage.merge(x, y, v0, v1);
+                        store(values + offset, v0);
+                        store(values + offset + 8, v1);
+                        roots += 8 / Gap;
+                    }
+                }
+
+                template <std::size_t Gap, typename MulRoot>
+                inline void inverse_stage_in_register(
+                    const MulRoot &mul_root, std::uint64_t *values, std::size_t n, const MultiplyUIntModOperand *roots,
+                    __m512i two_q)
+                {
+                    const InRegisterStage<Gap> stage;
+                    __m512i v0, v1, x, y, w, w_quotient;
+                    for (std::size_t offset = 0; offset < n; offset += 16)
+                    {
+                        stage.split(load(values + offset), load(values + offset + 8), x, y);
+                        stage.load_roots(roots, w, w_quotient);
+                        inverse_butterfly(mul_root, x, y, w, mul_root.quotient(w_quotient), two_q);
+                        stage.merge(x, y, v0, v1);
+                        store(values + offset, v0);
+                        store(values + offset + 8, v1);
+                        roots += 8 / Gap;
+                    }
+                }
+
+                inline __m512i broadcast(std::uint64_t value)
+                {
+                    return _mm512_set1_epi64(static_cast<long long>(value));
+                }
+
+                // Sums of count fully reduced lane-wise products for a tile of this many coefficients are kept in
+                // registers, so that the result is written once after all operands of the tile were read
+                constexpr std::size_t dot_product_tile_size = 128;
+
+                /*
+                Computes result[i] = sum_j product(operand1[j][i], operand2[j][i]) mod q, where product returns fully
+                reduced values. The result may alias any of the operands.
+                */
+                template <typename Product>
+                inline void dot_product_tiled(
+                    const Product &product, const std::uint64_t *const *operand1, const std::uint64_t *const *operand2,
+                    std::size_t count, std::size_t coeff_count, __m512i q, std::uint64_t *result)
+                {
+                    constexpr std::size_t tile_vectors = dot_product_tile_size / 8;
+                    __m512i acc[tile_vectors];
+                    for (std::size_t offset = 0; offset < coeff_count; offset += dot_product_tile_size)
+                    {
+                        std::size_t tile_count = std::min(dot_product_tile_size, coeff_count - offset);
+                        std::size_t vector_count = (tile_count + 7) / 8;
+                        __mmask8 last_mask = tail_mask(tile_count - 8 * (vector_count - 1));
+                        for (std::size_t k = 0; k < vector_count; k++)
+                        {
+                            acc[k] = _mm512_setzero_si512();
+                        }
+                        for (std::size_t j = 0; j < count; j++)
+                        {
+                            const std::uint64_t *x = operand1[j] + offset;
+                            const std::uint64_t *y = operand2[j] + offset;
+                            for (std::size_t k = 0; k + 1 < vector_count; k++)
+                            {
+                                __m512i p = product(load(x + 8 * k), load(y + 8 * k));
+                                acc[k] = guard(_mm512_add_epi64(acc[k], p), q);
+                            }
+                            std::size_t k = vector_count - 1;
+                            __m512i p = product(load(x + 8 * k, last_mask), load(y + 8 * k, last_mask));
+                            acc[k] = guard(_mm512_add_epi64(acc[k], p), q);
+                        }
+                        for (std::size_t k = 0; k + 1 < vector_count; k++)
+                        {
+                            store(result + offset + 8 * k, acc[k]);
+                        }
+                        store(result + offset + 8 * (vector_count - 1), acc[vector_count - 1], last_mask);
+                    }
+                }
+
+                // Values of the stages that span more than a block are processed in tiles of this many columns
+                constexpr std::size_t column_tile_size = 128;
+
+                template <typename MulRoot>
+                inline void forward_stage(
+                    const MulRoot &mul_root, std::uint64_t *values, std::size_t m, std::size_t gap,
+                    std::size_t group_begin, std::size_t group_end, const MultiplyUIntModOperand *roots, __m512i two_q)
+                {
+                    for (std::size_t i = group_begin; i < group_end; i++)
+                    {
+                        __m512i w = broadcast(roots[m + i].operand);
+                        __m512i w_quotient = mul_root.quotient(broadcast(roots[m + i].quotient));
+                        std::uint64_t *x = values + 2 * gap * i;
+                        std::uint64_t *y = x + gap;
+                        for (std::size_t j = 0; j < gap; j += 8, x += 8, y += 8)
+                        {
+                            __m512i vx = load(x);
+                            __m512i vy = load(y);
+                            forward_butterfly(mul_root, vx, vy, w, w_quotient, two_q);
+                            store(x, vx);
+                            store(y, vy);
+                        }
+                    }
+                }
+
+                template <typename MulRoot>
+                inline void inverse_stage(
+                    const MulRoot &mul_root, std::uint64_t *values, std::size_t gap, std::size_t group_begin,
+                    std::size_t group_end, const MultiplyUIntModOperand *roots, __m512i two_q)
+                {
+                    for (std::size_t i = group_begin; i < group_end; i++)
+                    {
+                        __m512i w = broadcast(roots[i].operand);
+                        __m512i w_quotient = mul_root.quotient(broadcast(roots[i].quotient));
+                        std::uint64_t *x = values + 2 * gap * i;
+                        std::uint64_t *y = x + gap;
+                        for (std::size_t j = 0; j < gap; j += 8, x += 8, y += 8)
+                        {
+                            __m512i vx = load(x);
+                            __m512i vy = load(y);
+                            inverse_butterfly(mul_root, vx, vy, w, w_quotient, two_q);
+                            store(x, vx);
+                            store(y, vy);
+                        }
+                    }
+                }
+
+                // Two consecutive stages in one pass: the stage with m groups and the next one with 2m groups
+                template <typename MulRoot>
+                inline void forward_stage_pair(
+                    const MulRoot &mul_root, std::uint64_t *values, std::size_t m, std::size_t gap,
+                    std::size_t group_begin, std::size_t group_end, const MultiplyUIntModOperand *roots, __m512i two_q)
+                {
+                    std::size_t half_gap = gap >> 1;
+                    for (std::size_t i = group_begin; i < group_end; i++)
+                    {
+                        __m512i w0 = broadcast(roots[m + i].operand);
+                        __m512i w0_quotient = mul_root.quotient(broadcast(roots[m + i].quotient));
+                        __m512i w1 = broadcast(roots[2 * (m + i)].operand);
+                        __m512i w1_quotient = mul_root.quotient(broadcast(roots[2 * (m + i)].quotient));
+                        __m512i w2 = broadcast(roots[2 * (m + i) + 1].operand);
+                        __m512i w2_quotient = mul_root.quotient(broadcast(roots[2 * (m + i) + 1].quotient));
+                        std::uint64_t *x = values + 2 * gap * i;
+                        for (std::size_t j = 0; j < half_gap; j += 8, x += 8)
+                        {
+                            __m512i v0 = load(x);
+                            __m512i v1 = load(x + half_gap);
+                            __m512i v2 = load(x + gap);
+                            __m512i v3 = load(x + gap + half_gap);
+                            forward_butterfly(mul_root, v0, v2, w0, w0_quotient, two_q);
+                            forward_butterfly(mul_root, v1, v3, w0, w0_quotient, two_q);
+                            forward_butterfly(mul_root, v0, v1, w1, w1_quotient, two_q);
+                            forward_butterfly(mul_root, v2, v3, w2, w2_quotient, two_q);
+                            store(x, v0);
+                            store(x + half_gap, v1);
+                            store(x + gap, v2);
+                            store(x + gap + half_gap, v3);
+                        }
+                    }
+                }
+
+                // Two consecutive stages in one pass: the stage with gap and the next one with 2 * gap, whose groups
+                // [group_begin, group_end) use roots[i]; prev_roots are the roots of the stage with gap.
+                template <typename MulRoot>
+                inline void inverse_stage_pair(
+                    const MulRoot &mul_root, std::uint64_t *values, std::size_t gap, std::size_t group_begin,
+                    std::size_t group_end, const MultiplyUIntModOperand *prev_roots,
+                    const MultiplyUIntModOperand *roots, __m512i two_q)
+                {
+                    for (std::size_t i = group_begin; i < group_end; i++)
+                    {
+                        __m512i w0 = broadcast(prev_roots[2 * i].operand);
+                        __m512i w0_quotient = mul_root.quotient(broadcast(prev_roots[2 * i].quotient));
+                        __m512i w1 = broadcast(prev_roots[2 * i + 1].operand);
+                        __m512i w1_quotient = mul_root.quotient(broadcast(prev_roots[2 * i + 1].quotient));
+                        __m512i w2 = broadcast(roots[i].operand);
+                        __m512i w2_quotient = mul_root.quotient(broadcast(roots[i].quotient));
+                        std::uint64_t *x = values + 4 * gap * i;
+                        for (std::size_t j = 0; j < gap; j += 8, x += 8)
+                        {
+                            __m512i v0 = load(x);
+                            __m512i v1 = load(x + gap);
+                            __m512i v2 = load(x + 2 * gap);
+                            __m512i v3 = load(x + 3 * gap);
+                            inverse_butterfly(mul_root, v0, v1, w0, w0_quotient, two_q);
+                            inverse_butterfly(mul_root, v2, v3, w1, w1_quotient, two_q);
+                            inverse_butterfly(mul_root, v0, v2, w2, w2_quotient, two_q);
+                            inverse_butterfly(mul_root, v1, v3, w2, w2_quotient, two_q);
+                            store(x, v0);
+                            store(x + gap, v1);
+                            store(x + 2 * gap, v2);
+                            store(x + 3 * gap, v3);
+                        }
+                    }
+                }
+
+                /*
+                Transforms larger than a block of 2^ntt_block_coeff_count_power values are computed in the order of
+                DWTHandler::transform_to_rev_blocked: the stages that span more than a block are applied to column
+                tiles, and each block then goes through all remaining stages before the next one is touched.
+                */
+                template <typename MulRoot>
+                void forward_transform(
+                    std::uint64_t *values, int coeff_count_power, const MultiplyUIntModOperand *roots,
+                    std::uint64_t modulus)
+                {
+                    const MulRoot mul_root(modulus);
+                    std::size_t n = std::size_t(1) << coeff_count_power;
+                    const __m512i two_q = broadcast(modulus << 1);
+                    int log_block_count = std::max(coeff_count_power - ntt_block_coeff_count_power, 0);
+                    std::size_t block_size = n >> log_block_count;
+                    std::size_t block_count = std::size_t(1) << log_block_count;
+
+                    // The i-th group of the stage with m groups uses roots[m + i]
+                    for (std::size_t col = 0; col < block_size; col += column_tile_size)
+                    {
+                        std::size_t gap = n >> 1;
+                        for (std::size_t m = 1; m < block_count; m <<= 1, gap >>= 1)
+                        {
+                            for (std::size_t i = 0; i < m; i++)
+                            {
+                                __m512i w = broadcast(roots[m + i].operand);
+                                __m512i w_quotient = mul_root.quotient(broadcast(roots[m + i].quotient));
+                                for (std::size_t offset = col; offset < gap; offset += block_size)
+                                {
+                                    std::uint64_t *x = values + 2 * gap * i + offset;
+                                    std::uint64_t *y = x + gap;
+                                    for (std::size_t j = 0; j < column_tile_size; j += 8, x += 8, y += 8)
+                                    {
+                                        __m512i vx = load(x);
+                                        __m512i vy = load(y);
+                                        forward_butterfly(mul_root, vx, vy, w, w_quotient, two_q);
+                                        store(x, vx);
+                                        store(y, vy);
+                                    }
+                                }
+                            }
+                        }
+                    }
+
+                    for (std::size_t b = 0; b < block_count; b++)
+                    {
+                        std::size_t m = block_count;
+                        std::size_t gap = block_size >> 1;
+                        for (; gap >= 16; m <<= 2, gap >>= 2)
+                        {
+                            std::size_t group_count = m >> log_block_count;
+                            forward_stage_pair(
+                                mul_root, values, m, gap, b * group_count, (b + 1) * group_count, roots, two_q);
+                        }
+                        if (gap == 8)
+                        {
+                            std::size_t group_count = m >> log_block_count;
+                            forward_stage(
+                                mul_root, values, m, gap, b * group_count, (b + 1) * group_count, roots, two_q);
+                            m <<= 1;
+                        }
+
+                        // A block holds block_size / 8 groups of the stage with gap 4 and twice as many of the next
+                        std::uint64_t *block_values = values + b * block_size;
+                        std::size_t root_offset = b * (block_size >> 3);
+                        forward_stage_in_register<4>(
+                            mul_root, block_values, block_size, roots + m + root_offset, two_q);
+                        forward_stage_in_register<2>(
+                            mul_root, block_values, block_size, roots + 2 * m + 2 * root_offset, two_q);
+                        forward_stage_in_register<1>(
+                            mul_root, block_values, block_size, roots + 4 * m + 4 * root_offset, two_q);
+                    }
+                }
+
+                template <typename MulRoot>
+                void inverse_transform(
+                    std::uint64_t *values, int coeff_count_power, const MultiplyUIntModOperand *inv_root_powers,
+                    MultiplyUIntModOperand inv_degree, MultiplyUIntModOperand scaled_inv_root, std::uint64_t modulus)
+                {
+                    const MulRoot mul_root(modulus);
+                    std::size_t n = std::size_t(1) << coeff_count_power;
+                    const __m512i two_q = broadcast(modulus << 1);
+                    int log_block_count = std::max(coeff_count_power - ntt_block_coeff_count_power, 0);
+                    std::size_t block_size = n >> log_block_count;
+                    std::size_t block_count = std::size_t(1) << log_block_count;
+
+                    // Roots are stored in scrambled order: the i-th group of the stage with m groups uses
+                    // inv_root_powers[n - 2 * m + 1 + i]
+                    for (std::size_t b = 0; b < block_count; b++)
+                    {
+                        std::uint64_t *block_values = values + b * block_size;
+                        std::size_t m = n >> 1;
+                        inverse_stage_in_register<1>(
+                            mul_root, block_values, block_size, inv_root_powers + 1 + b * (block_size >> 1), two_q);
+                        m >>= 1;
+                        inverse_stage_in_register<2>(
+                            mul_root, block_values, block_size,
+                            inv_root_powers + (n - 2 * m + 1) + b * (block_size >> 2), two_q);
+                        m >>= 1;
+                        inverse_stage_in_register<4>(
+                            mul_root, block_values, block_size,
+                            inv_root_powers + (n - 2 * m + 1) + b * (block_size >> 3), two_q);
+                        m >>= 1;
+
+                        std::size_t last_m = std::max<std::size_t>(block_count, 2);
+                        std::size_t gap = 8;
+                        for (; (m >> 1) >= last_m; m >>= 2, gap <<= 2)
+                        {
+                            std::size_t group_count = m >> (log_block_count + 1);
+                            inverse_stage_pair(
+                                mul_root, values, gap, b * group_count, (b + 1) * group_count,
+                                inv_root_powers + (n - 2 * m + 1), inv_root_powers + (n - m + 1), two_q);
+                        }
+                        if (m >= last_m)
+                        {
+                            std::size_t group_count = m >> log_block_count;
+                            inverse_stage(
+                                mul_root, values, gap, b * group_count, (b + 1) * group_count,
+                                inv_root_powers + (n - 2 * m + 1), two_q);
+                        }
+                    }
+
+                    // The last stage merges the multiplication by n^(-1); scaled_inv_root is the last root times n^(-1)
+                    const __m512i s = broadcast(inv_degree.operand);
+                    const __m512i s_quotient = mul_root.quotient(broadcast(inv_degree.quotient));
+                    const __m512i w_last = broadcast(scaled_inv_root.operand);
+                    const __m512i w_last_quotient = mul_root.quotient(broadcast(scaled_inv_root.quotient));
+                    // With a single block only the last stage is left, and its butterflies span n / 2 columns
+                    std::size_t column_count = std::min(block_size, n >> 1);
+                    std::size_t tile_size = std::min(column_tile_size, column_count);
+                    for (std::size_t col = 0; col < column_count; col += tile_size)
+                    {
+                        std::size_t gap = block_size;
+                        for (std::size_t m = block_count >> 1; m > 1; m >>= 1, gap <<= 1)
+                        {
+                            const MultiplyUIntModOperand *roots = inv_root_powers + (n - 2 * m + 1);
+                            for (std::size_t i = 0; i < m; i++)
+                            {
+                                __m512i w = broadcast(roots[i].operand);
+                                __m512i w_quotient = mul_root.quotient(broadcast(roots[i].quotient));
+                                for (std::size_t offset = col; offset < gap; offset += block_size)
+                                {
+                                    std::uint64_t *x = values + 2 * gap * i + offset;
+                                    std::uint64_t *y = x + gap;
+                                    for (std::size_t j = 0; j < tile_size; j += 8, x += 8, y += 8)
+                                    {
+                                        __m512i vx = load(x);
+                                        __m512i vy = load(y);
+                                        inverse_butterfly(mul_root, vx, vy, w, w_quotient, two_q);
+                                        store(x, vx);
+                                        store(y, vy);
+                                    }
+                                }
+                            }
+                        }
+
+                        for (std::size_t offset = col; offset < (n >> 1); offset += block_size)
+                        {
+                            std::uint64_t *x = values + offset;
+                            std::uint64_t *y = x + (n >> 1);
+                            for (std::size_t j = 0; j < tile_size; j += 8, x += 8, y += 8)
+                            {
+                                __m512i u = guard(load(x), two_q);
+                                __m512i v = load(y);
+                                store(x, mul_root(guard(_mm512_add_epi64(u, v), two_q), s, s_quotient));
+                                store(
+                                    y, mul_root(
+                                           _mm512_sub_epi64(_mm512_add_epi64(u, two_q), v), w_last, w_last_quotient));
+                            }
+                        }
+                    }
+                }
+            } // namespace
+        } // namespace avx512
+    } // namespace util
+} // namespace seal
@@ -0,0 +1,200 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/memorymanager.h"
+#include "seal/util/galois.h"
+#include "seal/util/locks.h"
+#include "seal/util/ntt.h"
+#include "seal/util/pointer.h"
+#include "seal/util/rns.h"
+#include "seal/util/tablecache.h"
+#include <algorithm>
+#include <map>
+#include <utility>
+
+using namespace std;
+
+namespace seal
+{
+    namespace util
+    {
+        namespace
+        {
+            using CacheKey = vector<uint64_t>;
+
+            // Transfers ownership of memory pool allocations to a shared_ptr
+            template <typename T>
+            shared_ptr<const T> share(Pointer<T> &&ptr)
+            {
+                auto holder = make_shared<Pointer<T>>(move(ptr));
+                return shared_ptr<const T>(holder, holder->get());
+            }
+
+            template <typename T>
+            class SharedCache
+            {
+            public:
+                // Returns a live object whose key equals key or, if allow_prefix is set, starts with key. Otherwise
+                // constructs a new one with create().
+                template <typename Create>
+                shared_ptr<const T> get(const CacheKey &key, bool allow_prefix, Create &&create)
+                {
+                    // Enable shared access to objects already present
+                    {
+                        ReaderLock reader_lock(locker_.acquire_read());
+                        if (auto found = find(key, allow_prefix))
+                        {
+                            return found;
+                        }
+                    }
+
+                    // Check again, since another thread may have added the object in the meantime
+                    WriterLock writer_lock(locker_.acquire_write());
+                    if (auto found = find(key, allow_prefix))
+                    {
+                        return found;
+                    }
+                    shared_ptr<const T> created = create();
+
+                    // Remove the entries of objects that were released
+                    for (auto it = entries_.begin(); it != entries_.end();)
+                    {
+                        it = it->second.expired() ? entries_.erase(it) : next(it);
+                    }
+                    entries_[key] = created;
+                    return created;
+                }
+
+                size_t size()
+                {
+                    ReaderLock reader_lock(locker_.acquire_read());
+                    return static_cast<size_t>(count_if(
+                        entries_.cbegin(), entries_.cend(), [](const auto &entry) { return !entry.second.expired(); }));
+                }
+
+            private:
+                shared_ptr<const T> find(const CacheKey &key, bool allow_prefix) const
+                {
+                    // Keys that start with key follow it directly in lexicographic order
+                    for (auto it = entries_.lower_bound(key); it != entries_.end(); ++it)
+                    {
+                        bool match = allow_prefix ? (it->first.size() >= key.size() &&
+                                                     equal(key.cbegin(), key.cend(), it->first.cbegin()))
+                                                  : (it->first == key);
+                        if (!match)
+                        {
+                            break;
+                        }
+                        if (auto found = it->second.lock())
+                        {
+                            return found;
+                        }
+                    }
+                    return nullptr;
+                }
+
+                map<CacheKey, weak_ptr<const T>> entries_;
+
+                ReaderWriterLocker locker_;
+            };
+
+            SharedCache<NTTTables> &ntt_tables_cache()
+            {
+                static SharedCache<NTTTables> cache;
+                return cache;
+            }
+
+            SharedCache<RNSBase> &rns_base_cache()
+            {
+                static SharedCache<RNSBase> cache;
+                return cache;
+            }
+
+            SharedCache<RNSTool> &rns_tool_cache()
+            {
+                static SharedCache<RNSTool> cache;
+                return cache;
+            }
+
+            SharedCache<GaloisTool> &galois_tool_cache()
+            {
+                static SharedCache<GaloisTool> cache;
+                return cache;
+            }
+
+            SharedCache<KSwitchTool> &kswitch_tool_cache()
+            {
+                static SharedCache<KSwitchTool> cache;
+                return cache;
+            }
+
+            void append_moduli(CacheKey &key, const Modulus *modulus, size_t count)
+            {
+                transform(modulus, modulus + count, back_inserter(key), [](const Modulus &m) { return m.value(); });
+            }
+        } // namespace
+
+        shared_ptr<const NTTTables> GetSharedNTTTables(int coeff_count_power, const vector<Modulus> &modulus)
+        {
+            CacheKey key{ static_cast<uint64_t>(coeff_count_power) };
+            append_moduli(key, modulus.data(), modulus.size());
+            return ntt_tables_cache().get(key, true, [&]() {
+                Pointer<NTTTables> tables;
+                CreateNTTTables(coeff_count_power, modulus, tables, MemoryPoolHandle::Global());
+                return share(move(tables));
+            });
+        }
+
+        shared_ptr<const RNSBase> GetSharedRNSBase(const vector<Modulus> &modulus)
+        {
+            CacheKey key;
+            append_moduli(key, modulus.data(), modulus.size());
+            return rns_base_cache().get(key, false, [&]() {
+                MemoryPoolHandle pool = MemoryPoolHandle::Global();
+                return share(allocate<RNSBase>(pool, modulus, pool));
+            });
+        }
+
+        shared_ptr<const RNSTool> GetSharedRNSTool(
+            size_t poly_modulus_degree, const RNSBase &coeff_modulus, const Modulus &plain_modulus, bool use_hps)
+        {
+            CacheKey key{ static_cast<uint64_t>(poly_modulus_degree), plain_modulus.value(),
+                          static_cast<uint64_t>(use_hps) };
+            append_moduli(key, coeff_modulus.base(), coeff_modulus.size());
+            return rns_tool_cache().get(key, false, [&]() {
+                MemoryPoolHandle pool = MemoryPoolHandle::Global();
+                return share(allocate<RNSTool>(pool, poly_modulus_degree, coeff_modulus, plain_modulus, pool, use_hps));
+            });
+        }
+
+        shared_ptr<const GaloisTool> GetSharedGaloisTool(int coeff_count_power)
+        {
+            CacheKey key{ static_cast<uint64_t>(coeff_count_power) };
+            return galois_tool_cache().get(key, false, [&]() {
+                MemoryPoolHandle pool = MemoryPoolHandle::Global();
+                return share(allocate<GaloisTool>(pool, coeff_count_power, pool));
+            });
+        }
+
+        shared_ptr<const KSwitchTool> GetSharedKSwitchTool(
+            size_t poly_modulus_degree, const RNSBase &base_q, const RNSBase &base_P, size_t digit_size,
+            const Modulus &plain_modulus)
+        {
+            CacheKey key{ static_cast<uint64_t>(poly_modulus_degree), plain_modulus.value(),
+                          static_cast<uint64_t>(digit_size), static_cast<uint64_t>(base_q.size()) };
+            append_moduli(key, base_q.base(), base_q.size());
+            append_moduli(key, base_P.base(), base_P.size());
+            return kswitch_tool_cache().get(key, false, [&]() {
+                MemoryPoolHandle pool = MemoryPoolHandle::Global();
+                return share(
+                    allocate<KSwitchTool>(pool, poly_modulus_degree, base_q, base_P, digit_size, plain_modulus, pool));
+            });
+        }
+
+        size_t shared_table_count()
+        {
+            return ntt_tables_cache().size() + rns_base_cache().size() + rns_tool_cache().size() +
+                   galois_tool_cache().size() + kswitch_tool_cache().size();
+        }
+    } // namespace util
+} // namespace seal
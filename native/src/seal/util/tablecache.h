@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/modulus.h"
+#include "seal/util/defines.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace seal
+{
+    namespace util
+    {
+        class NTTTables;
+
+        class RNSBase;
+
+        class RNSTool;
+
+        class GaloisTool;
+
+        class KSwitchTool;
+
+        // Process-wide cache of the precomputations that depend only on the encryption parameters. The cache holds its
+        // objects weakly: an object is shared by every ContextData (and RNSTool) that asks for the same parameters and
+        // is released when the last of them is destroyed. Cached objects are allocated from the global memory pool,
+        // since they may outlive the pool of the context that created them. All functions are thread-safe; an object
+        // is constructed only once even if several threads ask for it at the same time. Exceptions thrown by the
+        // constructors are propagated and nothing is cached in that case.
+
+        /**
+        Returns an array of NTTTables, one for each modulus. The tables of a modulus chain are shared by all of its
+        levels: a lookup for a prefix of a cached array of moduli returns that array.
+
+        @param[in] coeff_count_power The log2 of the polynomial modulus degree
+        @param[in] modulus The moduli
+        @throws std::invalid_argument if modulus is empty, modulus does not support NTT, or coeff_count_power is
+        invalid
+        */
+        SEAL_NODISCARD std::shared_ptr<const NTTTables> GetSharedNTTTables(
+            int coeff_count_power, const std::vector<Modulus> &modulus);
+
+        /**
+        Returns an RNSBase for the given moduli.
+
+        @param[in] modulus The moduli
+        @throws std::invalid_argument if the moduli are not valid or not pairwise coprime
+        */
+        SEAL_NODISCARD std::shared_ptr<const RNSBase> GetSharedRNSBase(const std::vector<Modulus> &modulus);
+
+        /**
+        Returns an RNSTool, together with the auxiliary bases and base converters it owns, for the given parameters.
+
+        @param[in] poly_modulus_degree The polynomial modulus degree
+        @param[in] coeff_modulus The coefficient modulus base
+        @param[in] plain_modulus The plaintext modulus (zero for CKKS)
+        @param[in] use_hps Whether to generate the pre-computations for HPS multiplication
+        @throws std::invalid_argument or std::logic_error if the RNSTool cannot be constructed
+        */
+        SEAL_NODISCARD std::shared_ptr<const RNSTool> GetSharedRNSTool(
+            std::size_t poly_modulus_degree, const RNSBase &coeff_modulus, const Modulus &plain_modulus,
+            bool use_hps = false);
+
+        /**
+        Returns a GaloisTool for the given degree. Its permutation tables are generated lazily and are shared too.
+
+        @param[in] coeff_count_power The log2 of the polynomial modulus degree
+        @throws std::invalid_argument if coeff_count_power is invalid
+        */
+        SEAL_NODISCARD std::shared_ptr<const GaloisTool> GetSharedGaloisTool(int coeff_count_power);
+
+        /**
+        Returns a KSwitchTool for one level of the modulus switching chain.
+
+        @param[in] poly_modulus_degree The polynomial modulus degree
+        @param[in] base_q The coefficient modulus base of the level
+        @param[in] base_P The special primes
+        @param[in] digit_size The number of primes in a digit of the key switching decomposition
+        @param[in] plain_modulus The plaintext modulus of BGV; zero for the other schemes
+        @throws std::invalid_argument or std::logic_error if the KSwitchTool cannot be constructed
+        */
+        SEAL_NODISCARD std::shared_ptr<const KSwitchTool> GetSharedKSwitchTool(
+            std::size_t poly_modulus_degree, const RNSBase &base_q, const RNSBase &base_P, std::size_t digit_size,
+            const Modulus &plain_modulus);
+
+        /**
+        Returns the number of objects in the cache that are still in use.
+        */
+        SEAL_NODISCARD std::size_t shared_table_count();
+    } // namespace util
+} // namespace seal
@@ -203,6 +203,48 @@ namespace seal
             return SEAL_COND_SELECT(tmp3 >= modulus.value(), tmp3 - modulus.value(), tmp3);
         }
 
+        /**
+        Returns -modulus^(-1) mod 2^64, the constant of Montgomery reduction with R = 2^64.
+        Correctness: modulus must be odd.
+        */
+        SEAL_NODISCARD inline std::uint64_t montgomery_neg_inverse(std::uint64_t modulus) noexcept
+        {
+            // modulus is its own inverse modulo 2^3 and each Newton step doubles the number of correct bits
+            std::uint64_t inverse = modulus;
+            for (int i = 0; i < 5; i++)
+            {
+                inverse *= 2 - modulus * inverse;
+            }
+            return 0 - inverse;
+        }
+
+        /**
+        Returns input * 2^(-64) mod modulus, where neg_inverse = montgomery_neg_inverse(modulus.value()).
+        Correctness: modulus must be odd and at most 63-bit, and input must be less than modulus * 2^64.
+        */
+        template <typename T, typename = std::enable_if_t<is_uint64_v<T>>>
+        SEAL_NODISCARD inline std::uint64_t montgomery_reduce_128(
+            const T *input, const Modulus &modulus, std::uint64_t neg_inverse)
+        {
+#ifdef SEAL_DEBUG
+            if (!input)
+            {
+                throw std::invalid_argument("input");
+            }
+            if (!(modulus.value() & 1))
+            {
+                throw std::invalid_argument("modulus");
+            }
+#endif
+            // input + m * modulus is divisible by 2^64: its low word sums to 2^64 unless input[0] is zero
+            unsigned long long mq[2];
+            multiply_uint64(input[0] * neg_inverse, modulus.value(), mq);
+            std::uint64_t result = static_cast<std::uint64_t>(input[1]) + mq[1] + (input[0] != 0);
+
+            // The result is less than 2 * modulus
+            return SEAL_COND_SELECT(result >= modulus.value(), result - modulus.value(), result);
+        }
+
         /**
         Returns input mod modulus. This is not standard Barrett reduction.
         Correctness: modulus must be at most 63-bit.
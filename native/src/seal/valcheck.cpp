@@ -11,6 +11,9 @@
 #include "seal/valcheck.h"
 #include "seal/util/common.h"
 #include "seal/util/defines.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 using namespace std;
 using namespace seal::util;
@@ -156,7 +159,10 @@ namespace seal
             return false;
         }
 
-        size_t decomp_mod_count = context.first_context_data()->parms().coeff_modulus().size();
+        // There is one key for each digit of the key switching decomposition at the first level
+        auto kswitch_tool = context.first_context_data()->kswitch_tool();
+        size_t decomp_mod_count = kswitch_tool ? kswitch_tool->digit_count()
+                                               : context.first_context_data()->parms().coeff_modulus().size();
         for (auto &a : in.data())
         {
             // Check that each highest level component has right size
@@ -175,6 +181,26 @@ namespace seal
             }
         }
 
+        // Keys in compact form are checked without sampling their second polynomials
+        auto &key_parms = context.key_context_data()->parms();
+        size_t coeff_count = key_parms.poly_modulus_degree();
+        size_t coeff_modulus_size = key_parms.coeff_modulus().size();
+        for (auto &a : in.compact_keys_)
+        {
+            if (a.size() && (a.size() != decomp_mod_count))
+            {
+                return false;
+            }
+            for (auto &b : a)
+            {
+                if (b.poly_modulus_degree != coeff_count || b.coeff_modulus_size != coeff_modulus_size ||
+                    b.data.size() != mul_safe(coeff_count, coeff_modulus_size) || !b.prng_info.has_valid_prng_type())
+                {
+                    return false;
+                }
+            }
+        }
+
         return true;
     }
 
@@ -251,10 +277,10 @@ namespace seal
         return is_buffer_valid(static_cast<const KSwitchKeys &>(in));
     }
 
-    bool is_data_valid_for(const Plaintext &in, const SEALContext &context)
+    bool is_data_valid_for(const Plaintext &in, const SEALContext &context, bool allow_pure_key_levels)
     {
         // Check metadata
-        if (!is_metadata_valid_for(in, context))
+        if (!is_metadata_valid_for(in, context, allow_pure_key_levels))
         {
             return false;
         }
@@ -427,6 +453,30 @@ namespace seal
             }
         }
 
+        // Keys in compact form are checked by their first polynomials, since the second ones are sampled
+        if (!is_metadata_valid_for(in, context))
+        {
+            return false;
+        }
+        auto &coeff_modulus = context.key_context_data()->parms().coeff_modulus();
+        for (auto &a : in.compact_keys_)
+        {
+            for (auto &b : a)
+            {
+                const uint64_t *ptr = b.data.cbegin();
+                for (auto &modulus : coeff_modulus)
+                {
+                    for (size_t poly_modulus_degree = b.poly_modulus_degree; poly_modulus_degree--; ptr++)
+                    {
+                        if (*ptr >= modulus.value())
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+
         return true;
     }
 
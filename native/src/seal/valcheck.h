@@ -192,8 +192,11 @@ namespace seal
 
     @param[in] in The plaintext to check
     @param[in] context The SEALContext
+    @param[in] allow_pure_key_levels Determines whether pure key levels (i.e.,
+    non-data levels) should be considered valid
     */
-    SEAL_NODISCARD bool is_data_valid_for(const Plaintext &in, const SEALContext &context);
+    SEAL_NODISCARD bool is_data_valid_for(
+        const Plaintext &in, const SEALContext &context, bool allow_pure_key_levels = false);
 
     /**
     Check whether the given ciphertext data and metadata are valid for a given SEALContext.
@@ -276,10 +279,13 @@ namespace seal
 
     @param[in] in The plaintext to check
     @param[in] context The SEALContext
+    @param[in] allow_pure_key_levels Determines whether pure key levels (i.e.,
+    non-data levels) should be considered valid
     */
-    SEAL_NODISCARD inline bool is_valid_for(const Plaintext &in, const SEALContext &context)
+    SEAL_NODISCARD inline bool is_valid_for(
+        const Plaintext &in, const SEALContext &context, bool allow_pure_key_levels = false)
     {
-        return is_buffer_valid(in) && is_data_valid_for(in, context);
+        return is_buffer_valid(in) && is_data_valid_for(in, context, allow_pure_key_levels);
     }
 
     /**
@@ -414,6 +414,45 @@ namespace sealtest
         }
     }
 
+    TEST(ContextTest, SpecialPrimes)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(4);
+        parms.set_coeff_modulus({ 41, 137, 193, 65537 });
+        parms.set_plain_modulus(73);
+        parms.set_special_prime_count(2);
+        SEALContext context(parms, true, sec_level_type::none);
+        ASSERT_TRUE(context.parameters_set());
+        ASSERT_TRUE(context.using_keyswitching());
+        ASSERT_EQ(size_t(1), context.key_context_data()->chain_index());
+        ASSERT_EQ(5617ULL, *context.first_context_data()->total_coeff_modulus());
+        ASSERT_EQ(context.key_parms_id(), context.first_context_data()->prev_context_data()->parms_id());
+
+        // There must be at least one prime that is not a special prime
+        parms.set_special_prime_count(4);
+        context = SEALContext(parms, true, sec_level_type::none);
+        ASSERT_FALSE(context.parameters_set());
+        ASSERT_FALSE(context.using_keyswitching());
+        ASSERT_STREQ(context.parameter_error_name(), "invalid_special_prime_count");
+        parms.set_special_prime_count(0);
+        context = SEALContext(parms, true, sec_level_type::none);
+        ASSERT_STREQ(context.parameter_error_name(), "invalid_special_prime_count");
+
+        // There cannot be more digits than primes
+        parms.set_special_prime_count(2);
+        parms.set_dnum(3);
+        context = SEALContext(parms, true, sec_level_type::none);
+        ASSERT_FALSE(context.parameters_set());
+        ASSERT_STREQ(context.parameter_error_name(), "invalid_dnum");
+        ASSERT_STREQ(
+            context.parameter_error_message(),
+            "dnum exceeds the count of coeff_modulus's primes that are not special primes");
+        parms.set_dnum(2);
+        context = SEALContext(parms, true, sec_level_type::none);
+        ASSERT_TRUE(context.parameters_set());
+        ASSERT_EQ(size_t(2), context.first_context_data()->kswitch_tool()->digit_count());
+    }
+
     TEST(EncryptionParameterQualifiersTest, BFVParameterError)
     {
         auto scheme = scheme_type::bfv;
@@ -61,6 +61,29 @@ namespace sealtest
         encryption_parameters_test(scheme_type::bgv);
     }
 
+    TEST(EncryptionParametersTest, EncryptionParametersBFVMulMethod)
+    {
+        // The BFV multiplication method does not change the parms_id
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 30, 30 }));
+        parms.set_plain_modulus(1 << 6);
+        parms.set_poly_modulus_degree(64);
+        ASSERT_TRUE(parms.bfv_mul_method() == bfv_mul_method_type::automatic);
+        parms_id_type default_parms_id = parms.parms_id();
+        parms.set_bfv_mul_method(bfv_mul_method_type::hps);
+        ASSERT_TRUE(parms.bfv_mul_method() == bfv_mul_method_type::hps);
+        ASSERT_EQ(default_parms_id, parms.parms_id());
+        parms.set_bfv_mul_method(bfv_mul_method_type::behz);
+        ASSERT_TRUE(parms.bfv_mul_method() == bfv_mul_method_type::behz);
+
+        // Only the automatic choice is allowed for other schemes
+        EncryptionParameters parms_ckks(scheme_type::ckks);
+        ASSERT_NO_THROW(parms_ckks.set_bfv_mul_method(bfv_mul_method_type::automatic));
+        ASSERT_THROW(parms_ckks.set_bfv_mul_method(bfv_mul_method_type::hps), logic_error);
+        EncryptionParameters parms_bgv(scheme_type::bgv);
+        ASSERT_THROW(parms_bgv.set_bfv_mul_method(bfv_mul_method_type::behz), logic_error);
+    }
+
     TEST(EncryptionParametersTest, EncryptionParametersCompare)
     {
         auto encryption_parameters_compare = [](scheme_type scheme) {
@@ -150,5 +173,47 @@ namespace sealtest
         };
         encryption_parameters_save_load(scheme_type::bfv);
         encryption_parameters_save_load(scheme_type::bgv);
+
+        // The option for Montgomery form keys is part of the parms_id and is saved
+        stringstream stream;
+        EncryptionParameters parms(scheme_type::ckks);
+        EncryptionParameters parms2(scheme_type::ckks);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 30, 30 }));
+        parms.set_poly_modulus_degree(64);
+        parms_id_type default_parms_id = parms.parms_id();
+        parms.set_use_montgomery_keys(true);
+        ASSERT_NE(default_parms_id, parms.parms_id());
+        parms.save(stream);
+        parms2.load(stream);
+        ASSERT_TRUE(parms2.use_montgomery_keys());
+        ASSERT_TRUE(parms == parms2);
+        parms.set_use_montgomery_keys(false);
+        ASSERT_EQ(default_parms_id, parms.parms_id());
+        parms.save(stream);
+        parms2.load(stream);
+        ASSERT_FALSE(parms2.use_montgomery_keys());
+        ASSERT_TRUE(parms == parms2);
+
+        // So are the key switching parameters
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 30, 30, 30, 30 }));
+        default_parms_id = parms.parms_id();
+        parms.set_special_prime_count(2);
+        ASSERT_NE(default_parms_id, parms.parms_id());
+        parms_id_type special_parms_id = parms.parms_id();
+        parms.set_dnum(1);
+        ASSERT_NE(special_parms_id, parms.parms_id());
+        parms.save(stream);
+        parms2.load(stream);
+        ASSERT_EQ(size_t(2), parms2.special_prime_count());
+        ASSERT_EQ(size_t(1), parms2.dnum());
+        ASSERT_TRUE(parms == parms2);
+        parms.set_special_prime_count(1);
+        parms.set_dnum(0);
+        ASSERT_EQ(default_parms_id, parms.parms_id());
+        parms.save(stream);
+        parms2.load(stream);
+        ASSERT_EQ(size_t(1), parms2.special_prime_count());
+        ASSERT_EQ(size_t(0), parms2.dnum());
+        ASSERT_TRUE(parms == parms2);
     }
 } // namespace sealtest
@@ -6,11 +6,14 @@
 #include "seal/context.h"
 #include "seal/decryptor.h"
 #include "seal/encryptor.h"
+#include "seal/evaluator.h"
 #include "seal/keygenerator.h"
 #include "seal/modulus.h"
 #include <cstddef>
 #include <cstdint>
 #include <ctime>
+#include <random>
+#include <vector>
 #include "gtest/gtest.h"
 
 using namespace seal;
@@ -1052,4 +1055,90 @@ namespace sealtest
             ASSERT_TRUE(pt.is_zero());
         }
     }
+
+    TEST(EncryptorTest, DecryptMany)
+    {
+        auto decrypt_many_test = [](scheme_type scheme) {
+            EncryptionParameters parms(scheme);
+            parms.set_poly_modulus_degree(128);
+            parms.set_coeff_modulus(CoeffModulus::Create(128, { 40, 40, 40 }));
+            if (scheme != scheme_type::ckks)
+            {
+                parms.set_plain_modulus(PlainModulus::Batching(128, 20));
+            }
+            SEALContext context(parms, true, sec_level_type::none);
+            KeyGenerator keygen(context);
+            PublicKey pk;
+            keygen.create_public_key(pk);
+
+            Encryptor encryptor(context, pk);
+            Evaluator evaluator(context);
+            Decryptor decryptor(context, keygen.secret_key());
+
+            // Enough ciphertexts for more than one batch, with a run at a lower level in the middle
+            mt19937_64 engine(scheme == scheme_type::ckks ? 1 : 2);
+            vector<Ciphertext> encrypteds(40);
+            for (size_t i = 0; i < encrypteds.size(); i++)
+            {
+                Plaintext plain;
+                if (scheme == scheme_type::ckks)
+                {
+                    CKKSEncoder encoder(context);
+                    vector<double> values(encoder.slot_count());
+                    generate(values.begin(), values.end(), [&]() { return static_cast<double>(engine() % 100); });
+                    encoder.encode(values, pow(2.0, 20), plain);
+                }
+                else
+                {
+                    BatchEncoder encoder(context);
+                    vector<uint64_t> values(encoder.slot_count());
+                    generate(values.begin(), values.end(), [&]() { return engine() % parms.plain_modulus().value(); });
+                    encoder.encode(values, plain);
+                }
+                encryptor.encrypt(plain, encrypteds[i]);
+                if (i >= 10 && i < 15)
+                {
+                    evaluator.mod_switch_to_next_inplace(encrypteds[i]);
+                }
+            }
+
+            vector<Plaintext> plains;
+            decryptor.decrypt_many(encrypteds, plains);
+            ASSERT_EQ(encrypteds.size(), plains.size());
+            for (size_t i = 0; i < encrypteds.size(); i++)
+            {
+                Plaintext plain;
+                decryptor.decrypt(encrypteds[i], plain);
+                ASSERT_TRUE(plain == plains[i]);
+            }
+
+            // The destination is resized
+            decryptor.decrypt_many(vector<Ciphertext>(encrypteds.begin(), encrypteds.begin() + 3), plains);
+            ASSERT_EQ(size_t(3), plains.size());
+
+            // A ciphertext that is not in the default NTT form is rejected before any output is written
+            vector<Plaintext> expected = plains;
+            vector<Ciphertext> wrong_form(encrypteds.begin(), encrypteds.begin() + 20);
+            if (scheme == scheme_type::ckks)
+            {
+                evaluator.transform_from_ntt_inplace(wrong_form.back());
+            }
+            else
+            {
+                evaluator.transform_to_ntt_inplace(wrong_form.back());
+            }
+            ASSERT_THROW(decryptor.decrypt_many(wrong_form, plains), invalid_argument);
+            ASSERT_EQ(expected.size(), plains.size());
+            for (size_t i = 0; i < expected.size(); i++)
+            {
+                ASSERT_TRUE(expected[i] == plains[i]);
+            }
+
+            decryptor.decrypt_many(vector<Ciphertext>(), plains);
+            ASSERT_TRUE(plains.empty());
+        };
+        decrypt_many_test(scheme_type::bfv);
+        decrypt_many_test(scheme_type::bgv);
+        decrypt_many_test(scheme_type::ckks);
+    }
 } // namespace sealtest
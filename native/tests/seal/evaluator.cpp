@@ -9,10 +9,15 @@
 #include "seal/evaluator.h"
 #include "seal/keygenerator.h"
 #include "seal/modulus.h"
+#include "seal/valcheck.h"
+#include "seal/util/uintarithsmallmod.h"
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <ctime>
 #include <string>
+#include <vector>
 #include "gtest/gtest.h"
 
 using namespace seal;
@@ -20,6 +25,50 @@ using namespace std;
 
 namespace sealtest
 {
+    namespace
+    {
+        // Key switching parameters for the tests of hybrid key switching and the operations built on it
+        struct KeySwitchingConfig
+        {
+            size_t special_prime_count;
+            size_t dnum;
+            bool use_montgomery_keys;
+            bfv_mul_method_type bfv_mul_method = bfv_mul_method_type::automatic;
+        };
+
+        // Parameters of degree 1024 with primes of 60, 40, 40 and 40 bits for ciphertexts, followed by the 60-bit
+        // special primes of config
+        EncryptionParameters make_key_switching_parms(scheme_type scheme, const KeySwitchingConfig &config)
+        {
+            EncryptionParameters parms(scheme);
+            size_t poly_modulus_degree = 1024;
+            parms.set_poly_modulus_degree(poly_modulus_degree);
+            vector<int> bit_sizes{ 60, 40, 40, 40 };
+            bit_sizes.insert(bit_sizes.end(), config.special_prime_count, 60);
+            parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, bit_sizes));
+            if (scheme != scheme_type::ckks)
+            {
+                parms.set_plain_modulus(PlainModulus::Batching(poly_modulus_degree, 20));
+            }
+            parms.set_special_prime_count(config.special_prime_count);
+            parms.set_dnum(config.dnum);
+            parms.set_use_montgomery_keys(config.use_montgomery_keys);
+            if (scheme == scheme_type::bfv)
+            {
+                parms.set_bfv_mul_method(config.bfv_mul_method);
+            }
+            return parms;
+        }
+
+        // Whether two ciphertexts have the same metadata and the same data
+        bool is_same_ciphertext(const Ciphertext &a, const Ciphertext &b)
+        {
+            return a.parms_id() == b.parms_id() && a.size() == b.size() && a.scale() == b.scale() &&
+                   a.correction_factor() == b.correction_factor() &&
+                   equal(a.dyn_array().cbegin(), a.dyn_array().cend(), b.dyn_array().cbegin(), b.dyn_array().cend());
+        }
+    } // namespace
+
     TEST(EvaluatorTest, BFVEncryptNegateDecrypt)
     {
         EncryptionParameters parms(scheme_type::bfv);
@@ -1638,6 +1687,129 @@ namespace sealtest
         }
     }
 
+    TEST(EvaluatorTest, BFVEncryptMultiplyDecryptMulMethods)
+    {
+        auto multiply_test = [](bfv_mul_method_type mul_method) {
+            EncryptionParameters parms(scheme_type::bfv);
+            Modulus plain_modulus(1 << 8);
+            parms.set_poly_modulus_degree(128);
+            parms.set_plain_modulus(plain_modulus);
+            parms.set_coeff_modulus(CoeffModulus::Create(128, { 40, 40, 40 }));
+            parms.set_bfv_mul_method(mul_method);
+
+            SEALContext context(parms, false, sec_level_type::none);
+            ASSERT_EQ(
+                mul_method == bfv_mul_method_type::hps, context.first_context_data()->qualifiers().using_hps_multiply);
+            KeyGenerator keygen(context);
+            PublicKey pk;
+            keygen.create_public_key(pk);
+
+            Encryptor encryptor(context, pk);
+            Evaluator evaluator(context);
+            Decryptor decryptor(context, keygen.secret_key());
+
+            Ciphertext encrypted1, encrypted2, encrypted3;
+            Plaintext plain, plain1;
+            string expected_square = "1x^12 + 2x^11 + 3x^10 + 4x^9 + 3x^8 + 4x^7 + 5x^6 + 4x^5 + 4x^4 + 2x^3 + 1x^2 + "
+                                     "2x^1 + 1";
+            string expected_fourth = "1x^24 + 4x^23 + Ax^22 + 14x^21 + 1Fx^20 + 2Cx^19 + 3Cx^18 + 4Cx^17 + 5Fx^16 + "
+                                     "6Cx^15 + 70x^14 + 74x^13 + 71x^12 + 6Cx^11 + 64x^10 + 50x^9 + 40x^8 + 34x^7 + "
+                                     "26x^6 + 1Cx^5 + 11x^4 + 8x^3 + 6x^2 + 4x^1 + 1";
+
+            plain1 = "1x^6 + 1x^5 + 1x^4 + 1x^3 + 1x^1 + 1";
+            encryptor.encrypt(plain1, encrypted1);
+            encryptor.encrypt(plain1, encrypted2);
+
+            // Size 2 times size 2
+            evaluator.multiply(encrypted1, encrypted2, encrypted3);
+            decryptor.decrypt(encrypted3, plain);
+            ASSERT_EQ(plain.to_string(), expected_square);
+            ASSERT_EQ(size_t(3), encrypted3.size());
+
+            // Size 3 times size 3, squaring
+            evaluator.square_inplace(encrypted3);
+            decryptor.decrypt(encrypted3, plain);
+            ASSERT_EQ(plain.to_string(), expected_fourth);
+            ASSERT_EQ(size_t(5), encrypted3.size());
+
+            // Size 3 times size 2, in both orders
+            evaluator.multiply(encrypted1, encrypted2, encrypted3);
+            evaluator.multiply_inplace(encrypted3, encrypted1);
+            evaluator.multiply_inplace(encrypted3, encrypted2);
+            decryptor.decrypt(encrypted3, plain);
+            ASSERT_EQ(plain.to_string(), expected_fourth);
+            evaluator.multiply(encrypted1, encrypted2, encrypted3);
+            evaluator.multiply_inplace(encrypted1, encrypted3);
+            evaluator.multiply_inplace(encrypted1, encrypted2);
+            decryptor.decrypt(encrypted1, plain);
+            ASSERT_EQ(plain.to_string(), expected_fourth);
+
+            // Size 2 squaring
+            encryptor.encrypt(plain1, encrypted1);
+            evaluator.square_inplace(encrypted1);
+            decryptor.decrypt(encrypted1, plain);
+            ASSERT_EQ(plain.to_string(), expected_square);
+            ASSERT_TRUE(encrypted1.parms_id() == context.first_parms_id());
+        };
+        multiply_test(bfv_mul_method_type::automatic);
+        multiply_test(bfv_mul_method_type::behz);
+        multiply_test(bfv_mul_method_type::hps);
+    }
+
+    TEST(EvaluatorTest, BFVMulMethodsDefaultParameters)
+    {
+        // Both methods give the same products at the default parameter sizes, and the automatic choice is BEHZ
+        for (size_t poly_modulus_degree : { 8192, 16384 })
+        {
+            vector<uint64_t> values(poly_modulus_degree);
+            vector<uint64_t> expected(poly_modulus_degree);
+            Modulus plain_modulus = PlainModulus::Batching(poly_modulus_degree, 20);
+            for (size_t i = 0; i < poly_modulus_degree; i++)
+            {
+                values[i] = (i * 7919 + 17) % plain_modulus.value();
+                expected[i] = util::multiply_uint_mod(
+                    util::multiply_uint_mod(values[i], values[i], plain_modulus), values[i], plain_modulus);
+            }
+
+            for (auto mul_method : { bfv_mul_method_type::automatic, bfv_mul_method_type::behz,
+                                     bfv_mul_method_type::hps })
+            {
+                EncryptionParameters parms(scheme_type::bfv);
+                parms.set_poly_modulus_degree(poly_modulus_degree);
+                parms.set_coeff_modulus(CoeffModulus::BFVDefault(poly_modulus_degree));
+                parms.set_plain_modulus(plain_modulus);
+                parms.set_bfv_mul_method(mul_method);
+                SEALContext context(parms);
+                ASSERT_EQ(
+                    mul_method == bfv_mul_method_type::hps,
+                    context.first_context_data()->qualifiers().using_hps_multiply);
+
+                KeyGenerator keygen(context);
+                PublicKey pk;
+                keygen.create_public_key(pk);
+                RelinKeys rlk;
+                keygen.create_relin_keys(rlk);
+                BatchEncoder encoder(context);
+                Encryptor encryptor(context, pk);
+                Evaluator evaluator(context);
+                Decryptor decryptor(context, keygen.secret_key());
+
+                Plaintext plain;
+                encoder.encode(values, plain);
+                Ciphertext encrypted, product;
+                encryptor.encrypt(plain, encrypted);
+                evaluator.square(encrypted, product);
+                evaluator.relinearize_inplace(product, rlk);
+                evaluator.multiply_inplace(product, encrypted);
+                ASSERT_GT(decryptor.invariant_noise_budget(product), 0);
+                decryptor.decrypt(product, plain);
+                vector<uint64_t> result;
+                encoder.decode(plain, result);
+                ASSERT_EQ(expected, result);
+            }
+        }
+    }
+
     TEST(EvaluatorTest, BGVEncryptSubDecrypt)
     {
         EncryptionParameters parms(scheme_type::bgv);
@@ -6149,4 +6321,757 @@ namespace sealtest
         ASSERT_TRUE(encrypted.parms_id() == parms_id);
         ASSERT_TRUE(plain.to_string() == "5x^64 + Ax^5");
     }
+
+    TEST(EvaluatorTest, HybridKeySwitching)
+    {
+        // The special primes are at least as large as a digit, so that key switching adds little noise
+        vector<KeySwitchingConfig> configs{
+            { 1, 0, false }, { 2, 2, false }, { 2, 2, true }, { 3, 1, false }, { 3, 3, false }, { 1, 4, true }
+        };
+
+        for (auto &config : configs)
+        {
+            SCOPED_TRACE(to_string(config.special_prime_count) + " special primes, dnum " + to_string(config.dnum));
+
+            // Four primes are left for ciphertexts; digits have ceil(4 / dnum) primes
+            size_t digit_size = config.dnum ? (3 + config.dnum) / config.dnum : 1;
+            size_t digit_count = (3 + digit_size) / digit_size;
+
+            for (auto scheme : { scheme_type::bfv, scheme_type::bgv })
+            {
+                SEALContext context(make_key_switching_parms(scheme, config), true, sec_level_type::none);
+                ASSERT_TRUE(context.parameters_set());
+                ASSERT_EQ(size_t(4), context.first_context_data()->parms().coeff_modulus().size());
+                ASSERT_EQ(digit_count, context.first_context_data()->kswitch_tool()->digit_count());
+
+                KeyGenerator keygen(context);
+                PublicKey pk;
+                keygen.create_public_key(pk);
+                RelinKeys rlk;
+                keygen.create_relin_keys(rlk);
+                GaloisKeys glk;
+                keygen.create_galois_keys(vector<int>{ 1 }, glk);
+                ASSERT_EQ(digit_count, rlk.key(2).size());
+
+                BatchEncoder encoder(context);
+                Encryptor encryptor(context, pk);
+                Decryptor decryptor(context, keygen.secret_key());
+                Evaluator evaluator(context);
+                size_t row_size = encoder.slot_count() / 2;
+                uint64_t plain_modulus = context.first_context_data()->parms().plain_modulus().value();
+
+                vector<uint64_t> values(encoder.slot_count());
+                for (size_t i = 0; i < values.size(); i++)
+                {
+                    values[i] = i % 1000;
+                }
+                Plaintext plain;
+                encoder.encode(values, plain);
+
+                // Key switching at the first level and at a level where the last digit is shorter
+                Ciphertext encrypted;
+                encryptor.encrypt(plain, encrypted);
+                for (size_t level = 0; level < 2; level++)
+                {
+                    evaluator.square_inplace(encrypted);
+                    evaluator.relinearize_inplace(encrypted, rlk);
+                    evaluator.rotate_rows_inplace(encrypted, 1, glk);
+                    for (size_t i = 0; i < row_size; i++)
+                    {
+                        values[i] = (values[i] * values[i]) % plain_modulus;
+                        values[i + row_size] = (values[i + row_size] * values[i + row_size]) % plain_modulus;
+                    }
+                    rotate(values.begin(), values.begin() + 1, values.begin() + static_cast<ptrdiff_t>(row_size));
+                    rotate(values.begin() + static_cast<ptrdiff_t>(row_size),
+                           values.begin() + static_cast<ptrdiff_t>(row_size + 1), values.end());
+
+                    Plaintext plain_result;
+                    decryptor.decrypt(encrypted, plain_result);
+                    vector<uint64_t> result;
+                    encoder.decode(plain_result, result);
+                    ASSERT_EQ(values, result);
+                    ASSERT_GT(decryptor.invariant_noise_budget(encrypted), 0);
+                    evaluator.mod_switch_to_next_inplace(encrypted);
+                }
+            }
+
+            SEALContext context(make_key_switching_parms(scheme_type::ckks, config), true, sec_level_type::none);
+            ASSERT_TRUE(context.parameters_set());
+            KeyGenerator keygen(context);
+            PublicKey pk;
+            keygen.create_public_key(pk);
+            RelinKeys rlk;
+            keygen.create_relin_keys(rlk);
+            GaloisKeys glk;
+            keygen.create_galois_keys(vector<int>{ 1 }, glk);
+            ASSERT_EQ(digit_count, rlk.key(2).size());
+
+            CKKSEncoder encoder(context);
+            Encryptor encryptor(context, pk);
+            Decryptor decryptor(context, keygen.secret_key());
+            Evaluator evaluator(context);
+            size_t slot_count = encoder.slot_count();
+            double scale = pow(2.0, 40);
+
+            vector<double> values(slot_count);
+            for (size_t i = 0; i < slot_count; i++)
+            {
+                values[i] = static_cast<double>(i % 7) / 4.0;
+            }
+            Plaintext plain;
+            encoder.encode(values, scale, plain);
+            Ciphertext encrypted;
+            encryptor.encrypt(plain, encrypted);
+            for (size_t level = 0; level < 2; level++)
+            {
+                evaluator.square_inplace(encrypted);
+                evaluator.relinearize_inplace(encrypted, rlk);
+                evaluator.rescale_to_next_inplace(encrypted);
+                evaluator.rotate_vector_inplace(encrypted, 1, glk);
+                for (auto &value : values)
+                {
+                    value *= value;
+                }
+                rotate(values.begin(), values.begin() + 1, values.end());
+
+                Plaintext plain_result;
+                decryptor.decrypt(encrypted, plain_result);
+                vector<double> result;
+                encoder.decode(plain_result, result);
+                for (size_t i = 0; i < slot_count; i++)
+                {
+                    ASSERT_NEAR(values[i], result[i], 0.001);
+                }
+                encrypted.scale() = scale;
+            }
+        }
+    }
+
+    TEST(EvaluatorTest, HybridKeySwitchingParameters)
+    {
+        EncryptionParameters parms(scheme_type::ckks);
+        parms.set_poly_modulus_degree(64);
+        parms.set_coeff_modulus(CoeffModulus::Create(64, { 30, 30, 30, 30 }));
+
+        // Fewer digits give smaller keys
+        parms.set_special_prime_count(2);
+        parms.set_dnum(1);
+        SEALContext context(parms, true, sec_level_type::none);
+        ASSERT_TRUE(context.using_keyswitching());
+        ASSERT_EQ(size_t(2), context.first_context_data()->parms().coeff_modulus().size());
+        ASSERT_EQ(size_t(1), context.first_context_data()->kswitch_tool()->digit_count());
+        ASSERT_EQ(size_t(1), context.last_context_data()->kswitch_tool()->digit_count());
+        ASSERT_EQ(nullptr, context.key_context_data()->kswitch_tool());
+        KeyGenerator keygen(context);
+        RelinKeys rlk;
+        keygen.create_relin_keys(rlk);
+        ASSERT_EQ(size_t(1), rlk.key(2).size());
+
+        // Keys are not valid for other decompositions
+        parms.set_dnum(2);
+        SEALContext context2(parms, true, sec_level_type::none);
+        ASSERT_EQ(size_t(2), context2.first_context_data()->kswitch_tool()->digit_count());
+        ASSERT_FALSE(is_valid_for(rlk, context2));
+    }
+
+    TEST(EvaluatorTest, RotateMany)
+    {
+        vector<KeySwitchingConfig> configs{ { 1, 0, false }, { 2, 2, true }, { 3, 1, false } };
+
+        // Step 5 has no key of its own and is composed of the rotations by 4 and 1
+        vector<int> key_steps{ 0, 1, -3, 4 };
+        vector<int> steps{ 1, 0, -3, 5, 4 };
+
+        for (auto &config : configs)
+        {
+            SCOPED_TRACE(to_string(config.special_prime_count) + " special primes, dnum " + to_string(config.dnum));
+            for (auto scheme : { scheme_type::bfv, scheme_type::bgv })
+            {
+                SEALContext context(make_key_switching_parms(scheme, config), true, sec_level_type::none);
+                KeyGenerator keygen(context);
+                PublicKey pk;
+                keygen.create_public_key(pk);
+                GaloisKeys glk;
+                keygen.create_galois_keys(key_steps, glk);
+
+                BatchEncoder encoder(context);
+                Encryptor encryptor(context, pk);
+                Decryptor decryptor(context, keygen.secret_key());
+                Evaluator evaluator(context);
+                size_t row_size = encoder.slot_count() / 2;
+
+                vector<uint64_t> values(encoder.slot_count());
+                for (size_t i = 0; i < values.size(); i++)
+                {
+                    values[i] = i;
+                }
+                Plaintext plain;
+                encoder.encode(values, plain);
+                Ciphertext encrypted;
+                encryptor.encrypt(plain, encrypted);
+
+                for (size_t level = 0; level < 2; level++)
+                {
+                    vector<Ciphertext> rotated;
+                    evaluator.rotate_rows_many(encrypted, steps, glk, rotated);
+                    ASSERT_EQ(steps.size(), rotated.size());
+                    for (size_t i = 0; i < steps.size(); i++)
+                    {
+                        ASSERT_EQ(encrypted.parms_id(), rotated[i].parms_id());
+                        Plaintext plain_result;
+                        decryptor.decrypt(rotated[i], plain_result);
+                        vector<uint64_t> result;
+                        encoder.decode(plain_result, result);
+                        size_t shift = static_cast<size_t>(steps[i] + static_cast<int>(row_size)) % row_size;
+                        for (size_t j = 0; j < row_size; j++)
+                        {
+                            ASSERT_EQ(values[(j + shift) % row_size], result[j]);
+                            ASSERT_EQ(values[row_size + (j + shift) % row_size], result[row_size + j]);
+                        }
+                    }
+
+                    // The row swap and a rotation applied to the same ciphertext, which is one of the destinations
+                    uint32_t swap_elt = context.key_context_data()->galois_tool()->get_elt_from_step(0);
+                    uint32_t rotate_elt = context.key_context_data()->galois_tool()->get_elt_from_step(1);
+                    Ciphertext expected_swap;
+                    evaluator.apply_galois(encrypted, swap_elt, glk, expected_swap);
+                    rotated.assign(1, encrypted);
+                    evaluator.apply_galois_many(rotated[0], { swap_elt, rotate_elt }, glk, rotated);
+                    ASSERT_EQ(size_t(2), rotated.size());
+                    Plaintext plain_result;
+                    Plaintext plain_expected;
+                    decryptor.decrypt(rotated[0], plain_result);
+                    decryptor.decrypt(expected_swap, plain_expected);
+                    ASSERT_EQ(plain_expected.to_string(), plain_result.to_string());
+                    ASSERT_GT(decryptor.invariant_noise_budget(rotated[1]), 0);
+
+                    evaluator.mod_switch_to_next_inplace(encrypted);
+                }
+            }
+
+            SEALContext context(make_key_switching_parms(scheme_type::ckks, config), true, sec_level_type::none);
+            KeyGenerator keygen(context);
+            PublicKey pk;
+            keygen.create_public_key(pk);
+            GaloisKeys glk;
+            keygen.create_galois_keys(key_steps, glk);
+
+            CKKSEncoder encoder(context);
+            Encryptor encryptor(context, pk);
+            Decryptor decryptor(context, keygen.secret_key());
+            Evaluator evaluator(context);
+            size_t slot_count = encoder.slot_count();
+
+            vector<double> values(slot_count);
+            for (size_t i = 0; i < slot_count; i++)
+            {
+                values[i] = static_cast<double>(i % 7) / 4.0;
+            }
+            Plaintext plain;
+            encoder.encode(values, pow(2.0, 40), plain);
+            Ciphertext encrypted;
+            encryptor.encrypt(plain, encrypted);
+
+            for (size_t level = 0; level < 2; level++)
+            {
+                vector<Ciphertext> rotated;
+                evaluator.rotate_vector_many(encrypted, steps, glk, rotated);
+                ASSERT_EQ(steps.size(), rotated.size());
+                for (size_t i = 0; i < steps.size(); i++)
+                {
+                    Plaintext plain_result;
+                    decryptor.decrypt(rotated[i], plain_result);
+                    vector<double> result;
+                    encoder.decode(plain_result, result);
+                    size_t shift = static_cast<size_t>(steps[i] + static_cast<int>(slot_count)) % slot_count;
+                    for (size_t j = 0; j < slot_count; j++)
+                    {
+                        ASSERT_NEAR(values[(j + shift) % slot_count], result[j], 0.001);
+                    }
+                }
+                evaluator.mod_switch_to_next_inplace(encrypted);
+            }
+
+            // Nothing to do
+            vector<Ciphertext> rotated(3);
+            evaluator.rotate_vector_many(encrypted, {}, glk, rotated);
+            ASSERT_TRUE(rotated.empty());
+            ASSERT_THROW(evaluator.rotate_vector_many(encrypted, { 2 }, glk, rotated), invalid_argument);
+            ASSERT_THROW(evaluator.rotate_rows_many(encrypted, { 1 }, glk, rotated), logic_error);
+        }
+    }
+
+    TEST(EvaluatorTest, ExtendedKeySwitching)
+    {
+        vector<KeySwitchingConfig> configs{ { 1, 0, false }, { 2, 2, true } };
+
+        // Step 5 has no key of its own and is composed of the rotations by 4 and 1
+        vector<int> key_steps{ 1, -3, 4 };
+        vector<int> steps{ 1, 0, -3, 5 };
+
+        for (auto &config : configs)
+        {
+            SCOPED_TRACE(to_string(config.special_prime_count) + " special primes, dnum " + to_string(config.dnum));
+            for (auto scheme : { scheme_type::bfv, scheme_type::bgv })
+            {
+                SEALContext context(make_key_switching_parms(scheme, config), true, sec_level_type::none);
+                KeyGenerator keygen(context);
+                PublicKey pk;
+                keygen.create_public_key(pk);
+                GaloisKeys glk;
+                keygen.create_galois_keys(key_steps, glk);
+
+                BatchEncoder encoder(context);
+                Encryptor encryptor(context, pk);
+                Decryptor decryptor(context, keygen.secret_key());
+                Evaluator evaluator(context);
+                size_t row_size = encoder.slot_count() / 2;
+                uint64_t plain_modulus = context.first_context_data()->parms().plain_modulus().value();
+
+                vector<uint64_t> values(encoder.slot_count());
+                for (size_t i = 0; i < values.size(); i++)
+                {
+                    values[i] = i;
+                }
+                Plaintext plain;
+                encoder.encode(values, plain);
+                Ciphertext encrypted;
+                encryptor.encrypt(plain, encrypted);
+
+                for (size_t level = 0; level < 2; level++)
+                {
+                    // sum_i weights_i * rotate(values, steps_i), with one division by P
+                    vector<ExtendedCiphertext> rotated;
+                    evaluator.rotate_rows_many_extended(encrypted, steps, glk, rotated);
+                    ASSERT_EQ(steps.size(), rotated.size());
+                    vector<uint64_t> expected(values.size(), 0);
+                    for (size_t i = 0; i < steps.size(); i++)
+                    {
+                        // Include weights in the upper half, which stand for negative numbers
+                        vector<uint64_t> weights(values.size());
+                        for (size_t j = 0; j < weights.size(); j++)
+                        {
+                            weights[j] = (j * (i + 1) % 3) ? (j + i) % 5 : plain_modulus - 1 - i;
+                        }
+                        Plaintext plain_weights;
+                        encoder.encode(weights, plain_weights);
+                        evaluator.multiply_plain_extended_inplace(rotated[i], plain_weights);
+                        if (i)
+                        {
+                            evaluator.add_extended_inplace(rotated[0], rotated[i]);
+                        }
+
+                        size_t shift = static_cast<size_t>(steps[i] + static_cast<int>(row_size)) % row_size;
+                        for (size_t j = 0; j < row_size; j++)
+                        {
+                            for (size_t row = 0; row < 2; row++)
+                            {
+                                uint64_t value = values[row * row_size + (j + shift) % row_size];
+                                uint64_t &sum = expected[row * row_size + j];
+                                sum = (sum + value * weights[row * row_size + j]) % plain_modulus;
+                            }
+                        }
+                    }
+                    Ciphertext sum;
+                    evaluator.transform_from_extended(rotated[0], sum);
+                    ASSERT_EQ(encrypted.parms_id(), sum.parms_id());
+                    ASSERT_FALSE(sum.is_ntt_form());
+
+                    Plaintext plain_result;
+                    decryptor.decrypt(sum, plain_result);
+                    vector<uint64_t> result;
+                    encoder.decode(plain_result, result);
+                    ASSERT_EQ(expected, result);
+                    ASSERT_GT(decryptor.invariant_noise_budget(sum), 0);
+
+                    // Transforming to the extended modulus and back gives the same ciphertext, up to the error of
+                    // the fast base conversion from the special primes
+                    ExtendedCiphertext extended;
+                    evaluator.transform_to_extended(encrypted, extended);
+                    Ciphertext transformed;
+                    evaluator.transform_from_extended(extended, transformed);
+                    decryptor.decrypt(transformed, plain_result);
+                    ASSERT_EQ(plain.to_string(), plain_result.to_string());
+
+                    evaluator.mod_switch_to_next_inplace(encrypted);
+                }
+            }
+
+            SEALContext context(make_key_switching_parms(scheme_type::ckks, config), true, sec_level_type::none);
+            KeyGenerator keygen(context);
+            PublicKey pk;
+            keygen.create_public_key(pk);
+            GaloisKeys glk;
+            keygen.create_galois_keys(key_steps, glk);
+
+            CKKSEncoder encoder(context);
+            Encryptor encryptor(context, pk);
+            Decryptor decryptor(context, keygen.secret_key());
+            Evaluator evaluator(context);
+            size_t slot_count = encoder.slot_count();
+            double scale = pow(2.0, 40);
+
+            vector<double> values(slot_count);
+            for (size_t i = 0; i < slot_count; i++)
+            {
+                values[i] = static_cast<double>(i % 7) / 4.0;
+            }
+            Plaintext plain;
+            encoder.encode(values, scale, plain);
+            Ciphertext encrypted;
+            encryptor.encrypt(plain, encrypted);
+
+            for (size_t level = 0; level < 2; level++)
+            {
+                vector<ExtendedCiphertext> rotated;
+                evaluator.rotate_vector_many_extended(encrypted, steps, glk, rotated);
+                vector<double> expected(slot_count, 0.0);
+                vector<Plaintext> plain_weights(steps.size());
+                for (size_t i = 0; i < steps.size(); i++)
+                {
+                    vector<double> weights(slot_count);
+                    for (size_t j = 0; j < slot_count; j++)
+                    {
+                        weights[j] = static_cast<double>((j + i) % 5) - 2.0;
+                    }
+
+                    // The plaintexts are encoded at the key level
+                    encoder.encode(weights, context.key_parms_id(), scale, plain_weights[i]);
+                    ASSERT_THROW(evaluator.multiply_plain_extended_inplace(rotated[i], plain), invalid_argument);
+                    evaluator.multiply_plain_extended_inplace(rotated[i], plain_weights[i]);
+                    if (i)
+                    {
+                        evaluator.add_extended_inplace(rotated[0], rotated[i]);
+                    }
+                    size_t shift = static_cast<size_t>(steps[i] + static_cast<int>(slot_count)) % slot_count;
+                    for (size_t j = 0; j < slot_count; j++)
+                    {
+                        expected[j] += values[(j + shift) % slot_count] * weights[j];
+                    }
+                }
+                Ciphertext sum;
+                evaluator.transform_from_extended(rotated[0], sum);
+                ASSERT_TRUE(sum.is_ntt_form());
+                ASSERT_DOUBLE_EQ(scale * scale, sum.scale());
+                evaluator.rescale_to_next_inplace(sum);
+
+                Plaintext plain_result;
+                decryptor.decrypt(sum, plain_result);
+                vector<double> result;
+                encoder.decode(plain_result, result);
+                for (size_t j = 0; j < slot_count; j++)
+                {
+                    ASSERT_NEAR(expected[j], result[j], 0.001);
+                }
+                evaluator.mod_switch_to_next_inplace(encrypted);
+            }
+
+            // Terms at different levels cannot be added
+            vector<ExtendedCiphertext> rotated;
+            evaluator.rotate_vector_many_extended(encrypted, { 1 }, glk, rotated);
+            ExtendedCiphertext other;
+            Ciphertext fresh;
+            encryptor.encrypt(plain, fresh);
+            evaluator.transform_to_extended(fresh, other);
+            ASSERT_THROW(evaluator.add_extended_inplace(rotated[0], other), invalid_argument);
+            ASSERT_THROW(evaluator.transform_from_extended(ExtendedCiphertext(), fresh), invalid_argument);
+        }
+    }
+
+    TEST(EvaluatorTest, KeySwitchMany)
+    {
+        vector<KeySwitchingConfig> configs{ { 1, 0, false }, { 2, 2, true } };
+
+        for (auto &config : configs)
+        {
+            SCOPED_TRACE(to_string(config.special_prime_count) + " special primes, dnum " + to_string(config.dnum));
+            for (auto scheme : { scheme_type::bfv, scheme_type::bgv, scheme_type::ckks })
+            {
+                SEALContext context(make_key_switching_parms(scheme, config), true, sec_level_type::none);
+                KeyGenerator keygen(context);
+                PublicKey pk;
+                keygen.create_public_key(pk);
+                RelinKeys rlk;
+                keygen.create_relin_keys(rlk);
+                GaloisKeys glk;
+                keygen.create_galois_keys(vector<int>{ 3 }, glk);
+                uint32_t galois_elt = context.key_context_data()->galois_tool()->get_elt_from_step(3);
+                Encryptor encryptor(context, pk);
+                Evaluator evaluator(context);
+
+                // More ciphertexts than fit in one tile, at two levels
+                Plaintext plain("1x^3 + 2x^1 + 3");
+                if (scheme == scheme_type::ckks)
+                {
+                    CKKSEncoder encoder(context);
+                    encoder.encode(1.5, pow(2.0, 30), plain);
+                }
+                vector<Ciphertext> encrypteds(19);
+                for (size_t i = 0; i < encrypteds.size(); i++)
+                {
+                    encryptor.encrypt(plain, encrypteds[i]);
+                    if (i % 3 == 0)
+                    {
+                        evaluator.mod_switch_to_next_inplace(encrypteds[i]);
+                    }
+                }
+
+                vector<Ciphertext> rotated = encrypteds;
+                evaluator.apply_galois_many_inplace(rotated, galois_elt, glk);
+                for (size_t i = 0; i < encrypteds.size(); i++)
+                {
+                    Ciphertext expected;
+                    evaluator.apply_galois(encrypteds[i], galois_elt, glk, expected);
+                    ASSERT_TRUE(is_same_ciphertext(expected, rotated[i]));
+                }
+
+                vector<Ciphertext> products;
+                for (size_t i = 0; i < encrypteds.size(); i++)
+                {
+                    Ciphertext product;
+                    evaluator.multiply(encrypteds[i], encrypteds[i], product);
+                    products.push_back(i % 5 == 4 ? encrypteds[i] : product);
+                }
+                vector<Ciphertext> relinearized = products;
+                evaluator.relinearize_many_inplace(relinearized, rlk);
+                for (size_t i = 0; i < products.size(); i++)
+                {
+                    Ciphertext expected;
+                    evaluator.relinearize(products[i], rlk, expected);
+                    ASSERT_EQ(size_t(2), relinearized[i].size());
+                    ASSERT_TRUE(is_same_ciphertext(expected, relinearized[i]));
+                }
+
+                // Nothing is changed if any ciphertext is invalid
+                vector<Ciphertext> empty;
+                evaluator.relinearize_many_inplace(empty, rlk);
+                evaluator.apply_galois_many_inplace(empty, galois_elt, glk);
+                vector<Ciphertext> invalid = products;
+                invalid.back().resize(context, invalid.back().parms_id(), 4);
+                ASSERT_THROW(evaluator.relinearize_many_inplace(invalid, rlk), invalid_argument);
+                for (size_t i = 0; i + 1 < products.size(); i++)
+                {
+                    ASSERT_TRUE(is_same_ciphertext(products[i], invalid[i]));
+                }
+                ASSERT_THROW(evaluator.apply_galois_many_inplace(invalid, galois_elt, glk), invalid_argument);
+                ASSERT_THROW(
+                    evaluator.apply_galois_many_inplace(encrypteds, galois_elt + 2, glk), invalid_argument);
+            }
+        }
+    }
+
+    TEST(EvaluatorTest, MultiplyRelin)
+    {
+        for (auto scheme : { scheme_type::bfv, scheme_type::bgv, scheme_type::ckks })
+        {
+            for (auto bfv_mul_method : { bfv_mul_method_type::behz, bfv_mul_method_type::hps })
+            {
+                if (scheme != scheme_type::bfv && bfv_mul_method != bfv_mul_method_type::behz)
+                {
+                    continue;
+                }
+                for (size_t special_prime_count : { 1, 2 })
+                {
+                    KeySwitchingConfig config{ special_prime_count, 0, false, bfv_mul_method };
+                    SEALContext context(make_key_switching_parms(scheme, config), true, sec_level_type::none);
+                    KeyGenerator keygen(context);
+                    PublicKey pk;
+                    keygen.create_public_key(pk);
+                    RelinKeys rlk;
+                    keygen.create_relin_keys(rlk);
+                    Encryptor encryptor(context, pk);
+                    Decryptor decryptor(context, keygen.secret_key());
+                    Evaluator evaluator(context);
+
+                    Plaintext plain1("1x^3 + 2x^1 + 3");
+                    Plaintext plain2("5x^2 + 1");
+                    if (scheme == scheme_type::ckks)
+                    {
+                        CKKSEncoder encoder(context);
+                        encoder.encode(1.5, pow(2.0, 40), plain1);
+                        encoder.encode(-2.0, pow(2.0, 40), plain2);
+                    }
+                    Ciphertext encrypted1, encrypted2;
+                    encryptor.encrypt(plain1, encrypted1);
+                    encryptor.encrypt(plain2, encrypted2);
+
+                    Ciphertext expected, result;
+                    evaluator.multiply(encrypted1, encrypted2, expected);
+                    evaluator.relinearize_inplace(expected, rlk);
+                    evaluator.multiply_relin(encrypted1, encrypted2, rlk, result);
+                    ASSERT_TRUE(is_same_ciphertext(expected, result));
+                    result = encrypted2;
+                    evaluator.multiply_relin(encrypted1, result, rlk, result);
+                    ASSERT_TRUE(is_same_ciphertext(expected, result));
+
+                    evaluator.square(encrypted1, expected);
+                    evaluator.relinearize_inplace(expected, rlk);
+                    result = encrypted1;
+                    evaluator.square_relin_inplace(result, rlk);
+                    ASSERT_TRUE(is_same_ciphertext(expected, result));
+
+                    // Larger ciphertexts are multiplied and relinearized separately, which needs more keys here
+                    Ciphertext encrypted3;
+                    evaluator.multiply(encrypted1, encrypted2, encrypted3);
+                    ASSERT_THROW(evaluator.multiply_relin(encrypted3, encrypted1, rlk, result), invalid_argument);
+
+                    if (scheme == scheme_type::ckks)
+                    {
+                        evaluator.multiply(encrypted1, encrypted2, expected);
+                        evaluator.relinearize_inplace(expected, rlk);
+                        evaluator.rescale_to_next_inplace(expected);
+                        evaluator.multiply_relin_rescale(encrypted1, encrypted2, rlk, result);
+                        ASSERT_TRUE(is_same_ciphertext(expected, result));
+
+                        evaluator.square(encrypted2, expected);
+                        evaluator.relinearize_inplace(expected, rlk);
+                        evaluator.rescale_to_next_inplace(expected);
+                        evaluator.square_relin_rescale(encrypted2, rlk, result);
+                        ASSERT_TRUE(is_same_ciphertext(expected, result));
+
+                        // Nothing is changed if the result cannot be rescaled
+                        evaluator.mod_switch_to_inplace(encrypted1, context.last_parms_id());
+                        result = encrypted1;
+                        ASSERT_THROW(evaluator.square_relin_rescale_inplace(result, rlk), invalid_argument);
+                        ASSERT_TRUE(is_same_ciphertext(encrypted1, result));
+                    }
+                    else
+                    {
+                        Plaintext plain_expected, plain_result;
+                        decryptor.decrypt(encrypted3, plain_expected);
+                        evaluator.multiply_relin(encrypted1, encrypted2, rlk, result);
+                        decryptor.decrypt(result, plain_result);
+                        ASSERT_EQ(plain_expected, plain_result);
+
+                        result = encrypted1;
+                        ASSERT_THROW(
+                            evaluator.multiply_relin_rescale_inplace(result, encrypted2, rlk), invalid_argument);
+                        ASSERT_TRUE(is_same_ciphertext(encrypted1, result));
+                    }
+                }
+            }
+        }
+    }
+
+    TEST(EvaluatorTest, LinearTransformationBSGS)
+    {
+        EncryptionParameters parms(scheme_type::ckks);
+        size_t poly_modulus_degree = 1024;
+        parms.set_poly_modulus_degree(poly_modulus_degree);
+        parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        CKKSEncoder encoder(context);
+        Encryptor encryptor(context, pk);
+        Decryptor decryptor(context, keygen.secret_key());
+        Evaluator evaluator(context);
+        size_t slot_count = encoder.slot_count();
+        double scale = pow(2.0, 40);
+
+        int width = 16;
+        size_t stride = slot_count / static_cast<size_t>(width);
+        ASSERT_EQ(vector<int>({ 32, 64, 96, 128, 256, 384 }), evaluator.linear_transformation_bsgs_steps(16, width));
+        ASSERT_EQ(vector<int>({ 32, 64, 96, 128, 256 }), evaluator.linear_transformation_bsgs_steps(10, width));
+        ASSERT_EQ(vector<int>{}, evaluator.linear_transformation_bsgs_steps(1, width));
+        ASSERT_THROW(auto steps = evaluator.linear_transformation_bsgs_steps(17, width), invalid_argument);
+        ASSERT_THROW(auto steps = evaluator.linear_transformation_bsgs_steps(0, width), invalid_argument);
+        ASSERT_THROW(auto steps = evaluator.linear_transformation_bsgs_steps(3, 3), invalid_argument);
+
+        GaloisKeys glk;
+        keygen.create_galois_keys(evaluator.linear_transformation_bsgs_steps(16, width), glk);
+
+        vector<double> values(slot_count);
+        for (size_t i = 0; i < slot_count; i++)
+        {
+            values[i] = static_cast<double>(i % 7) - 3.0;
+        }
+        Plaintext plain;
+        encoder.encode(values, scale, plain);
+        Ciphertext encrypted;
+        encryptor.encrypt(plain, encrypted);
+
+        for (size_t diagonal_count : { 1, 4, 10, 16 })
+        {
+            SCOPED_TRACE(to_string(diagonal_count) + " diagonals");
+            vector<vector<double>> diagonal_values(diagonal_count, vector<double>(slot_count));
+            vector<double> expected(slot_count, 0.0);
+            for (size_t i = 0; i < diagonal_count; i++)
+            {
+                for (size_t j = 0; j < slot_count; j++)
+                {
+                    diagonal_values[i][j] = static_cast<double>((i + 2 * j) % 5) * 0.25;
+                    expected[j] += diagonal_values[i][j] * values[(j + i * stride) % slot_count];
+                }
+            }
+
+            // Diagonals at the level of encrypted and at the key level
+            for (auto parms_id : { encrypted.parms_id(), context.key_parms_id() })
+            {
+                vector<Plaintext> diagonals(diagonal_count);
+                for (size_t i = 0; i < diagonal_count; i++)
+                {
+                    encoder.encode(diagonal_values[i], parms_id, scale, diagonals[i]);
+                }
+                vector<int> steps = evaluator.linear_transformation_bsgs_steps(diagonal_count, width);
+                GaloisKeys exact_glk;
+                if (!steps.empty())
+                {
+                    keygen.create_galois_keys(steps, exact_glk);
+                }
+                else
+                {
+                    exact_glk = glk;
+                }
+
+                Ciphertext result;
+                evaluator.linear_transformation_bsgs(encrypted, diagonals, width, exact_glk, result);
+                ASSERT_EQ(context.first_context_data()->next_context_data()->parms_id(), result.parms_id());
+                Plaintext plain_result;
+                decryptor.decrypt(result, plain_result);
+                vector<double> decoded;
+                encoder.decode(plain_result, decoded);
+                for (size_t j = 0; j < slot_count; j++)
+                {
+                    ASSERT_NEAR(expected[j], decoded[j], 0.01);
+                }
+
+                // The diagonal method with one rotation per diagonal gives the same result at the same level
+                vector<int> diagonal_steps;
+                for (size_t i = 1; i < diagonal_count; i++)
+                {
+                    diagonal_steps.push_back(static_cast<int>(i * stride));
+                }
+                GaloisKeys diagonal_glk;
+                keygen.create_galois_keys(diagonal_steps.empty() ? vector<int>{ 1 } : diagonal_steps, diagonal_glk);
+                evaluator.linear_transformation(
+                    encrypted, diagonals, static_cast<int>(diagonal_count), width, diagonal_glk, result);
+                ASSERT_EQ(context.first_context_data()->next_context_data()->parms_id(), result.parms_id());
+
+                // The sum is rescaled once
+                double last_prime =
+                    static_cast<double>(context.first_context_data()->parms().coeff_modulus().back().value());
+                ASSERT_DOUBLE_EQ(encrypted.scale() * scale / last_prime, result.scale());
+                decryptor.decrypt(result, plain_result);
+                encoder.decode(plain_result, decoded);
+                for (size_t j = 0; j < slot_count; j++)
+                {
+                    ASSERT_NEAR(expected[j], decoded[j], 0.01);
+                }
+            }
+        }
+
+        vector<Plaintext> diagonals(2);
+        encoder.encode(values, scale, diagonals[0]);
+        encoder.encode(values, context.key_parms_id(), scale, diagonals[1]);
+        Ciphertext result;
+        ASSERT_THROW(evaluator.linear_transformation_bsgs(encrypted, diagonals, width, glk, result), invalid_argument);
+        encoder.encode(values, scale, diagonals[1]);
+        ASSERT_THROW(evaluator.linear_transformation(encrypted, diagonals, 0, width, glk, result), invalid_argument);
+        ASSERT_THROW(evaluator.linear_transformation(encrypted, diagonals, 2, 0, glk, result), invalid_argument);
+        ASSERT_THROW(evaluator.linear_transformation(encrypted, diagonals, 3, width, glk, result), invalid_argument);
+        evaluator.mod_switch_to_inplace(encrypted, context.last_parms_id());
+        ASSERT_THROW(evaluator.linear_transformation_bsgs(encrypted, diagonals, width, glk, result), invalid_argument);
+    }
 } // namespace sealtest
@@ -1,12 +1,17 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT license.
 
+#include "seal/batchencoder.h"
 #include "seal/context.h"
+#include "seal/decryptor.h"
+#include "seal/encryptor.h"
+#include "seal/evaluator.h"
 #include "seal/galoiskeys.h"
 #include "seal/keygenerator.h"
 #include "seal/modulus.h"
 #include "seal/util/polyarithsmallmod.h"
 #include "seal/util/uintcore.h"
+#include <sstream>
 #include <vector>
 #include "gtest/gtest.h"
 
@@ -216,4 +221,110 @@ namespace sealtest
         galoiskey_seeded_save_load(scheme_type::bfv);
         galoiskey_seeded_save_load(scheme_type::bgv);
     }
+
+    TEST(GaloisKeysTest, GaloisKeysCompactLoad)
+    {
+        EncryptionParameters parms(scheme_type::bfv);
+        parms.set_poly_modulus_degree(256);
+        parms.set_plain_modulus(PlainModulus::Batching(256, 20));
+        parms.set_coeff_modulus(CoeffModulus::Create(256, { 60, 50, 60 }));
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        vector<int> steps{ 1, -3 };
+        auto get_elt = [&](int step) { return context.key_context_data()->galois_tool()->get_elt_from_step(step); };
+
+        stringstream stream;
+        auto seeded_size = keygen.create_galois_keys(steps).save(stream, compr_mode_type::none);
+        GaloisKeys glk;
+        glk.load(context, stream, true);
+        ASSERT_EQ(size_t(2), glk.size());
+        for (auto step : steps)
+        {
+            size_t index = GaloisKeys::get_index(get_elt(step));
+            ASSERT_TRUE(glk.is_compact(index));
+            ASSERT_TRUE(glk.has_key(get_elt(step)));
+            ASSERT_TRUE(glk.data()[index].empty());
+        }
+        ASSERT_FALSE(glk.has_key(get_elt(2)));
+        ASSERT_THROW(auto key = glk.expanded_data(context, GaloisKeys::get_index(get_elt(2))),
+                     invalid_argument);
+        ASSERT_TRUE(is_valid_for(glk, context));
+
+        // Saving compact keys gives the seeded serialization back
+        ASSERT_EQ(seeded_size, glk.save_size(compr_mode_type::none));
+        stringstream compact_stream;
+        ASSERT_EQ(seeded_size, glk.save(compact_stream, compr_mode_type::none));
+        GaloisKeys expanded_glk;
+        expanded_glk.load(context, compact_stream);
+        for (auto step : steps)
+        {
+            size_t index = GaloisKeys::get_index(get_elt(step));
+            ASSERT_FALSE(expanded_glk.is_compact(index));
+            auto key = glk.expanded_data(context, index);
+            ASSERT_EQ(key->size(), expanded_glk.data()[index].size());
+            for (size_t j = 0; j < key->size(); j++)
+            {
+                auto &a = (*key)[j].data().dyn_array();
+                auto &b = expanded_glk.data()[index][j].data().dyn_array();
+                ASSERT_TRUE(equal(a.cbegin(), a.cend(), b.cbegin(), b.cend()));
+            }
+        }
+
+        BatchEncoder encoder(context);
+        Encryptor encryptor(context, pk);
+        Decryptor decryptor(context, keygen.secret_key());
+        Evaluator evaluator(context);
+        size_t row_size = encoder.slot_count() / 2;
+        vector<uint64_t> values(encoder.slot_count());
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            values[i] = i;
+        }
+        Plaintext plain;
+        encoder.encode(values, plain);
+        Ciphertext encrypted;
+        encryptor.encrypt(plain, encrypted);
+
+        // Without a cache every use expands the key; with a cache the expanded keys are kept
+        for (size_t byte_count : { size_t(0), size_t(1) << 30 })
+        {
+            glk.set_expansion_cache_byte_count(byte_count);
+            ASSERT_EQ(byte_count, glk.expansion_cache_byte_count());
+            for (size_t round = 0; round < 2; round++)
+            {
+                for (auto step : steps)
+                {
+                    Ciphertext rotated;
+                    evaluator.rotate_rows(encrypted, step, glk, rotated);
+                    Plaintext plain_result;
+                    decryptor.decrypt(rotated, plain_result);
+                    vector<uint64_t> result;
+                    encoder.decode(plain_result, result);
+                    size_t shift = static_cast<size_t>(step + static_cast<int>(row_size)) % row_size;
+                    for (size_t j = 0; j < row_size; j++)
+                    {
+                        ASSERT_EQ(values[(j + shift) % row_size], result[j]);
+                    }
+                }
+            }
+            size_t index = GaloisKeys::get_index(get_elt(1));
+            ASSERT_EQ(
+                byte_count != 0, glk.expanded_data(context, index).get() == glk.expanded_data(context, index).get());
+        }
+
+        // Loading without the compact flag expands all keys
+        stringstream seeded_stream;
+        keygen.create_galois_keys(steps).save(seeded_stream);
+        GaloisKeys full_glk;
+        full_glk.load(context, seeded_stream);
+        ASSERT_EQ(size_t(2), full_glk.size());
+        for (auto step : steps)
+        {
+            size_t index = GaloisKeys::get_index(get_elt(step));
+            ASSERT_FALSE(full_glk.is_compact(index));
+            ASSERT_FALSE(full_glk.data()[index].empty());
+        }
+    }
 } // namespace sealtest
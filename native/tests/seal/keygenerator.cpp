@@ -7,6 +7,7 @@
 #include "seal/evaluator.h"
 #include "seal/keygenerator.h"
 #include "seal/valcheck.h"
+#include <sstream>
 #include "gtest/gtest.h"
 
 using namespace seal;
@@ -516,4 +517,65 @@ namespace sealtest
         constructors(scheme_type::bfv);
         constructors(scheme_type::bgv);
     }
+
+    TEST(KeyGeneratorTest, MontgomeryKeys)
+    {
+        auto montgomery_keys = [](scheme_type scheme) {
+            EncryptionParameters parms(scheme);
+            parms.set_poly_modulus_degree(128);
+            parms.set_plain_modulus(65537);
+            parms.set_coeff_modulus(CoeffModulus::Create(128, { 60, 50, 40 }));
+            parms.set_use_montgomery_keys(true);
+            SEALContext context(parms, false, sec_level_type::none);
+            Evaluator evaluator(context);
+
+            KeyGenerator keygen(context);
+            PublicKey pk;
+            keygen.create_public_key(pk);
+            RelinKeys rlk;
+            keygen.create_relin_keys(rlk);
+            GaloisKeys galk;
+            keygen.create_galois_keys(vector<uint32_t>{ 3 }, galk);
+
+            // Seeded keys are expanded in Montgomery form when loaded
+            stringstream stream;
+            keygen.create_relin_keys().save(stream);
+            RelinKeys rlk_loaded;
+            rlk_loaded.load(context, stream);
+            keygen.create_galois_keys(vector<uint32_t>{ 3 }).save(stream);
+            GaloisKeys galk_loaded;
+            galk_loaded.load(context, stream);
+
+            Encryptor encryptor(context, pk);
+            Decryptor decryptor(context, keygen.secret_key());
+            Plaintext pt("1x^2 + 2"), ptres;
+            for (const RelinKeys *relin_keys : { &rlk, &rlk_loaded })
+            {
+                Ciphertext ct;
+                encryptor.encrypt(pt, ct);
+                evaluator.square_inplace(ct);
+                evaluator.relinearize_inplace(ct, *relin_keys);
+                decryptor.decrypt(ct, ptres);
+                ASSERT_EQ("1x^4 + 4x^2 + 4", ptres.to_string());
+            }
+            for (const GaloisKeys *galois_keys : { &galk, &galk_loaded })
+            {
+                Ciphertext ct;
+                encryptor.encrypt(pt, ct);
+                evaluator.apply_galois_inplace(ct, 3, *galois_keys);
+                decryptor.decrypt(ct, ptres);
+                ASSERT_EQ("1x^6 + 2", ptres.to_string());
+            }
+
+            // Keys in Montgomery form are not valid for parameters without the option
+            parms.set_use_montgomery_keys(false);
+            SEALContext context2(parms, false, sec_level_type::none);
+            ASSERT_FALSE(is_valid_for(rlk, context2));
+            stream.seekg(0);
+            ASSERT_THROW(rlk_loaded.load(context2, stream), logic_error);
+        };
+
+        montgomery_keys(scheme_type::bfv);
+        montgomery_keys(scheme_type::bgv);
+    }
 } // namespace sealtest
@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/ckks.h"
+#include "seal/context.h"
+#include "seal/decryptor.h"
+#include "seal/encryptor.h"
+#include "seal/evaluator.h"
+#include "seal/keygenerator.h"
+#include "seal/linearTrans.h"
+#include "seal/modulus.h"
+#include "lineartransformtest.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace seal;
+using namespace std;
+
+namespace sealtest
+{
+    namespace
+    {
+        // Checks that lt() multiplies by the matrix. Tall and square matrices take the input repeated in the slots
+        // and wide matrices take it padded; row r of the result is in slot r times the number of slots divided by the
+        // larger of the height and the width.
+        void check_lt(
+            const SEALContext &context, KeyGenerator &keygen, int method, const vector<vector<double>> &matrix)
+        {
+            LinearTransformTester tester(context, keygen);
+            double scale = pow(2.0, 40);
+
+            int height = static_cast<int>(matrix.size());
+            int width = static_cast<int>(matrix[0].size());
+            vector<double> input(static_cast<size_t>(width));
+            for (int c = 0; c < width; c++)
+            {
+                input[c] = static_cast<double>(c % 5) * 0.1 - 0.2;
+            }
+            Plaintext plain;
+            if (height >= width)
+            {
+                ntEncoding(tester.encoder, scale, input, plain, height, width);
+            }
+            else
+            {
+                ntEncoding(tester.encoder, scale, input, plain);
+            }
+            Ciphertext encrypted;
+            tester.encryptor.encrypt(plain, encrypted);
+
+            Ciphertext result = lt(
+                method, encrypted, matrix, height, width, tester.encoder, scale, tester.evaluator, tester.galois_keys);
+
+            // The products are summed at the scale of the product and rescaled once
+            auto &context_data = *context.get_context_data(encrypted.parms_id());
+            ASSERT_EQ(context_data.next_context_data()->parms_id(), result.parms_id());
+            double last_prime = static_cast<double>(context_data.parms().coeff_modulus().back().value());
+            ASSERT_DOUBLE_EQ(encrypted.scale() * scale / last_prime, result.scale());
+
+            // Only the slots of the rows are compared, since lt() does not clear the other slots
+            auto output = tester.decrypt(result);
+            size_t slot_count = tester.encoder.slot_count();
+            size_t stride = slot_count / static_cast<size_t>(max(height, width));
+            auto expected = expected_product(matrix, input, slot_count, stride);
+            for (int r = 0; r < height; r++)
+            {
+                ASSERT_NEAR(expected[r * stride], output[r * stride], 1e-3);
+            }
+        }
+    } // namespace
+
+    TEST(LinearTransTest, NonzeroDiagonals)
+    {
+        vector<vector<double>> tiled{ { 0.0, 0.0 }, { 1.0, 0.0 }, { 0.0, 0.0 }, { 0.0, -2.0 } };
+        ASSERT_EQ((vector<int>{ 1, 3 }), nonzeroDiagonals(tiled, 4));
+        ASSERT_EQ((vector<int>{ 1 }), nonzeroDiagonals(tiled, 3));
+        ASSERT_EQ((vector<int>{ 1, 3 }), nonzeroDiagonals(tiled, 8));
+
+        // The first diagonal is kept for a zero matrix
+        ASSERT_EQ((vector<int>{ 0 }), nonzeroDiagonals(vector<vector<double>>(3, vector<double>(3, 0.0)), 3));
+
+        auto matrix = make_test_matrix(8, 8, true);
+        ASSERT_EQ((vector<int>{ 0, 2, 4, 6 }), nonzeroDiagonals(tillingMatrix(matrix, 8, 8), 8));
+        matrix = make_test_matrix(4, 16, true);
+        ASSERT_EQ((vector<int>{ 0, 2 }), nonzeroDiagonals(tillingMatrix(matrix, 4, 16), 4));
+    }
+
+    TEST(LinearTransTest, Methods)
+    {
+        SEALContext context(make_ckks_test_parms(256), true, sec_level_type::none);
+        KeyGenerator keygen(context);
+
+        struct Shape
+        {
+            int height;
+            int width;
+        };
+        for (int method : { 1, 2, 3 })
+        {
+            for (auto shape : vector<Shape>{ { 8, 8 }, { 16, 4 }, { 4, 16 }, { 32, 2 } })
+            {
+                // The first method does not sum the partial results of a wide matrix
+                if (method == 1 && shape.height < shape.width)
+                {
+                    continue;
+                }
+                for (bool sparse : { false, true })
+                {
+                    SCOPED_TRACE(
+                        "method " + to_string(method) + ", " + to_string(shape.height) + "x" + to_string(shape.width) +
+                        (sparse ? ", sparse" : ""));
+                    auto matrix = make_test_matrix(shape.height, shape.width, sparse);
+                    check_lt(context, keygen, method, matrix);
+                }
+            }
+        }
+
+        LinearTransformTester tester(context, keygen);
+        Ciphertext encrypted;
+        tester.encryptor.encrypt_zero(encrypted);
+        auto matrix = make_test_matrix(4, 4);
+        ASSERT_THROW(
+            lt(4, encrypted, matrix, 4, 4, tester.encoder, pow(2.0, 40), tester.evaluator, tester.galois_keys),
+            invalid_argument);
+    }
+} // namespace sealtest
@@ -0,0 +1,323 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/ckks.h"
+#include "seal/context.h"
+#include "seal/decryptor.h"
+#include "seal/encryptor.h"
+#include "seal/evaluator.h"
+#include "seal/keygenerator.h"
+#include "seal/lineartransformplan.h"
+#include "seal/modulus.h"
+#include "lineartransformtest.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace seal;
+using namespace std;
+
+namespace sealtest
+{
+    namespace
+    {
+        // Checks that the plan multiplies by the matrix
+        void check_plan(
+            const SEALContext &context, KeyGenerator &keygen, const LinearTransformPlan &plan,
+            const vector<vector<double>> &matrix)
+        {
+            LinearTransformTester tester(context, keygen, plan.steps());
+            size_t slot_count = tester.encoder.slot_count();
+            size_t stride = slot_count / plan.dimension();
+            vector<double> input(matrix[0].size());
+            vector<double> values(slot_count, 0.0);
+            for (size_t c = 0; c < input.size(); c++)
+            {
+                input[c] = static_cast<double>(c % 5) - 2.0;
+                values[c * stride] = input[c];
+            }
+
+            Ciphertext result;
+            tester.evaluator.linear_transformation(
+                tester.encrypt(values, plan.scale()), plan, tester.galois_keys, result);
+            ASSERT_EQ(context.first_context_data()->next_context_data()->parms_id(), result.parms_id());
+            auto output = tester.decrypt(result);
+            auto expected = expected_product(matrix, input, slot_count, stride);
+            for (size_t s = 0; s < slot_count; s++)
+            {
+                ASSERT_NEAR(expected[s], output[s], 0.01);
+            }
+        }
+    } // namespace
+
+    TEST(LinearTransformPlanTest, Create)
+    {
+        SEALContext context(make_ckks_test_parms(1024), true, sec_level_type::none);
+        CKKSEncoder encoder(context);
+        double scale = pow(2.0, 40);
+
+        LinearTransformPlan plan(encoder, make_test_matrix(10, 6), context.first_parms_id(), scale);
+        ASSERT_EQ(size_t(10), plan.height());
+        ASSERT_EQ(size_t(6), plan.width());
+        ASSERT_EQ(size_t(16), plan.dimension());
+        ASSERT_EQ(context.first_parms_id(), plan.parms_id());
+        ASSERT_EQ(scale, plan.scale());
+        ASSERT_EQ(vector<int>({ 32, 64, 96, 128, 256, 384 }), plan.steps());
+        for (auto &diagonal : plan.diagonals())
+        {
+            ASSERT_TRUE(diagonal.is_ntt_form());
+            ASSERT_EQ(context.first_parms_id(), diagonal.parms_id());
+        }
+
+        LinearTransformPlan vector_plan(encoder, make_test_matrix(1, 1), context.key_parms_id(), scale);
+        ASSERT_EQ(size_t(1), vector_plan.dimension());
+        ASSERT_TRUE(vector_plan.steps().empty());
+
+        ASSERT_EQ(size_t(0), LinearTransformPlan::BabyStepCount(0));
+        ASSERT_EQ(size_t(1), LinearTransformPlan::BabyStepCount(1));
+        ASSERT_EQ(size_t(3), LinearTransformPlan::BabyStepCount(9));
+        ASSERT_EQ(size_t(4), LinearTransformPlan::BabyStepCount(10));
+        ASSERT_EQ(vector<int>({ 2, 4, 6, 8, 16 }), LinearTransformPlan::RotationSteps(10, 2));
+
+        ASSERT_THROW(LinearTransformPlan(encoder, {}, context.first_parms_id(), scale), invalid_argument);
+        ASSERT_THROW(LinearTransformPlan(encoder, { {} }, context.first_parms_id(), scale), invalid_argument);
+        ASSERT_THROW(
+            LinearTransformPlan(encoder, { { 1.0 }, { 1.0, 2.0 } }, context.first_parms_id(), scale), invalid_argument);
+        ASSERT_THROW(
+            LinearTransformPlan(encoder, make_test_matrix(1, 513), context.first_parms_id(), scale), invalid_argument);
+        ASSERT_THROW(LinearTransformPlan(encoder, make_test_matrix(2, 2), parms_id_zero, scale), invalid_argument);
+    }
+
+    TEST(LinearTransformPlanTest, Evaluate)
+    {
+        SEALContext context(make_ckks_test_parms(1024), true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        CKKSEncoder encoder(context);
+        double scale = pow(2.0, 40);
+
+        struct Shape
+        {
+            size_t height;
+            size_t width;
+        };
+        for (auto shape : vector<Shape>{ { 1, 1 }, { 16, 16 }, { 5, 12 }, { 20, 3 }, { 512, 512 } })
+        {
+            SCOPED_TRACE(to_string(shape.height) + "x" + to_string(shape.width));
+            auto matrix = make_test_matrix(shape.height, shape.width);
+            for (auto parms_id : { context.first_parms_id(), context.key_parms_id() })
+            {
+                LinearTransformPlan plan(encoder, matrix, parms_id, scale);
+                check_plan(context, keygen, plan, matrix);
+            }
+        }
+
+        LinearTransformTester tester(context, keygen);
+        Ciphertext encrypted, result;
+        tester.encryptor.encrypt_zero(encrypted);
+        ASSERT_THROW(
+            tester.evaluator.linear_transformation(encrypted, LinearTransformPlan(), tester.galois_keys, result),
+            invalid_argument);
+    }
+
+    TEST(LinearTransformPlanTest, Structured)
+    {
+        SEALContext context(make_ckks_test_parms(1024), true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        CKKSEncoder encoder(context);
+        double scale = pow(2.0, 40);
+        auto dense_key_switch_count = [&](const vector<vector<double>> &matrix) {
+            auto dense = make_test_matrix(matrix.size(), matrix[0].size());
+            return LinearTransformPlan(encoder, dense, context.first_parms_id(), scale).key_switch_count();
+        };
+
+        // A tridiagonal matrix needs one rotation for each off-diagonal
+        size_t n = 64;
+        vector<vector<double>> banded(n, vector<double>(n, 0.0));
+        map<int, vector<double>> diagonals{ { -1, vector<double>(n) },
+                                            { 0, vector<double>(n) },
+                                            { 1, vector<double>(n) } };
+        for (size_t r = 0; r < n; r++)
+        {
+            diagonals[-1][r] = static_cast<double>(r % 3) - 1.0;
+            diagonals[0][r] = 2.0;
+            diagonals[1][r] = 0.5 * static_cast<double>(r % 4);
+            banded[r][(r + n - 1) % n] = diagonals[-1][r];
+            banded[r][r] = diagonals[0][r];
+            banded[r][(r + 1) % n] = diagonals[1][r];
+        }
+        for (auto parms_id : { context.first_parms_id(), context.key_parms_id() })
+        {
+            auto plan = LinearTransformPlan::Diagonals(encoder, n, diagonals, parms_id, scale);
+            ASSERT_EQ(size_t(3), plan.diagonals().size());
+            ASSERT_EQ(size_t(2), plan.key_switch_count());
+            ASSERT_EQ(size_t(2), plan.steps().size());
+            check_plan(context, keygen, plan, banded);
+        }
+        LinearTransformPlan banded_plan(encoder, banded, context.first_parms_id(), scale);
+        ASSERT_EQ(size_t(2), banded_plan.key_switch_count());
+        ASSERT_GT(dense_key_switch_count(banded), size_t(10));
+        check_plan(context, keygen, banded_plan, banded);
+
+        // A circulant matrix with a band of four diagonals
+        vector<double> first_row(32, 0.0);
+        first_row[0] = 1.0;
+        first_row[1] = -0.5;
+        first_row[2] = 0.25;
+        first_row[31] = 0.75;
+        vector<vector<double>> circulant(32, vector<double>(32));
+        for (size_t r = 0; r < 32; r++)
+        {
+            for (size_t c = 0; c < 32; c++)
+            {
+                circulant[r][c] = first_row[(c + 32 - r) % 32];
+            }
+        }
+        auto circulant_plan = LinearTransformPlan::Circulant(encoder, first_row, context.first_parms_id(), scale);
+        ASSERT_EQ(size_t(4), circulant_plan.diagonals().size());
+        ASSERT_GE(size_t(3), circulant_plan.key_switch_count());
+        check_plan(context, keygen, circulant_plan, circulant);
+
+        // A Toeplitz matrix is padded to a power of two
+        size_t m = 12;
+        vector<double> values(2 * m - 1, 0.0);
+        values[m - 2] = 1.5;
+        values[m - 1] = -1.0;
+        values[m] = 0.5;
+        values[m + 3] = 0.25;
+        vector<vector<double>> toeplitz(m, vector<double>(m));
+        for (size_t r = 0; r < m; r++)
+        {
+            for (size_t c = 0; c < m; c++)
+            {
+                toeplitz[r][c] = values[m - 1 + c - r];
+            }
+        }
+        auto toeplitz_plan = LinearTransformPlan::Toeplitz(encoder, m, values, context.first_parms_id(), scale);
+        ASSERT_EQ(size_t(16), toeplitz_plan.dimension());
+        ASSERT_GT(dense_key_switch_count(toeplitz), toeplitz_plan.key_switch_count());
+        check_plan(context, keygen, toeplitz_plan, toeplitz);
+
+        // A block-diagonal matrix only touches the diagonals within the size of its largest block
+        vector<vector<vector<double>>> blocks{ make_test_matrix(4, 4), make_test_matrix(2, 2), make_test_matrix(4, 4),
+                                               make_test_matrix(4, 4), make_test_matrix(2, 2) };
+        vector<vector<double>> block_diagonal(16, vector<double>(16, 0.0));
+        size_t block_start = 0;
+        for (auto &block : blocks)
+        {
+            for (size_t r = 0; r < block.size(); r++)
+            {
+                for (size_t c = 0; c < block.size(); c++)
+                {
+                    block_diagonal[block_start + r][block_start + c] = block[r][c];
+                }
+            }
+            block_start += block.size();
+        }
+        auto block_plan = LinearTransformPlan::BlockDiagonal(encoder, blocks, context.first_parms_id(), scale);
+        ASSERT_EQ(size_t(16), block_plan.dimension());
+        // The diagonals -3 to 3 without -3, which is zero in make_test_matrix(4, 4)
+        ASSERT_EQ(size_t(6), block_plan.diagonals().size());
+        ASSERT_GT(dense_key_switch_count(block_diagonal), block_plan.key_switch_count());
+        check_plan(context, keygen, block_plan, block_diagonal);
+
+        // A zero matrix keeps one diagonal and needs no rotations
+        auto zero_plan = LinearTransformPlan::Diagonals(encoder, 8, {}, context.first_parms_id(), scale);
+        ASSERT_EQ(size_t(1), zero_plan.diagonals().size());
+        ASSERT_TRUE(zero_plan.steps().empty());
+
+        ASSERT_THROW(
+            auto plan = LinearTransformPlan::Diagonals(encoder, 12, {}, context.first_parms_id(), scale),
+            invalid_argument);
+        ASSERT_THROW(
+            auto plan = LinearTransformPlan::Diagonals(
+                encoder, 8, { { 8, vector<double>(8) } }, context.first_parms_id(), scale),
+            invalid_argument);
+        ASSERT_THROW(
+            auto plan = LinearTransformPlan::Diagonals(
+                encoder, 8, { { -1, vector<double>(8) }, { 7, vector<double>(8) } }, context.first_parms_id(), scale),
+            invalid_argument);
+        ASSERT_THROW(
+            auto plan = LinearTransformPlan::Diagonals(
+                encoder, 8, { { 1, vector<double>(4) } }, context.first_parms_id(), scale),
+            invalid_argument);
+        ASSERT_THROW(
+            auto plan = LinearTransformPlan::Toeplitz(encoder, 4, vector<double>(8), context.first_parms_id(), scale),
+            invalid_argument);
+        ASSERT_THROW(
+            auto plan = LinearTransformPlan::Circulant(encoder, vector<double>(6), context.first_parms_id(), scale),
+            invalid_argument);
+        ASSERT_THROW(
+            auto plan = LinearTransformPlan::BlockDiagonal(
+                encoder, { make_test_matrix(2, 3) }, context.first_parms_id(), scale),
+            invalid_argument);
+    }
+
+    TEST(LinearTransformPlanTest, SaveLoad)
+    {
+        SEALContext context(make_ckks_test_parms(1024), true, sec_level_type::none);
+        CKKSEncoder encoder(context);
+        double scale = pow(2.0, 30);
+
+        map<int, vector<double>> band{ { -2, vector<double>(16, 1.0) }, { 3, vector<double>(16, 2.0) } };
+        for (auto parms_id : { context.first_parms_id(), context.key_parms_id() })
+        {
+            vector<LinearTransformPlan> plans{ LinearTransformPlan(encoder, make_test_matrix(7, 12), parms_id, scale),
+                                               LinearTransformPlan::Diagonals(encoder, 16, band, parms_id, scale) };
+            for (auto &plan : plans)
+            {
+                stringstream stream;
+                auto out_size = plan.save(stream);
+                ASSERT_GE(plan.save_size(), out_size);
+
+                LinearTransformPlan loaded;
+                auto in_size = loaded.load(context, stream);
+                ASSERT_EQ(out_size, in_size);
+                ASSERT_EQ(plan.height(), loaded.height());
+                ASSERT_EQ(plan.width(), loaded.width());
+                ASSERT_EQ(plan.parms_id(), loaded.parms_id());
+                ASSERT_EQ(plan.scale(), loaded.scale());
+                ASSERT_EQ(plan.steps(), loaded.steps());
+                ASSERT_EQ(plan.dimension(), loaded.dimension());
+                ASSERT_EQ(plan.indices(), loaded.indices());
+                ASSERT_EQ(plan.offset(), loaded.offset());
+                ASSERT_EQ(plan.baby_step_count(), loaded.baby_step_count());
+                ASSERT_EQ(plan.key_switch_count(), loaded.key_switch_count());
+                ASSERT_EQ(plan.diagonals().size(), loaded.diagonals().size());
+                for (size_t i = 0; i < plan.diagonals().size(); i++)
+                {
+                    ASSERT_EQ(plan.diagonals()[i], loaded.diagonals()[i]);
+                    ASSERT_TRUE(loaded.diagonals()[i].is_ntt_form());
+                }
+
+                vector<seal_byte> buffer(static_cast<size_t>(plan.save_size(compr_mode_type::none)));
+                out_size = plan.save(buffer.data(), buffer.size(), compr_mode_type::none);
+                LinearTransformPlan loaded_from_buffer;
+                ASSERT_EQ(out_size, loaded_from_buffer.load(context, buffer.data(), buffer.size()));
+                ASSERT_EQ(plan.steps(), loaded_from_buffer.steps());
+            }
+        }
+
+        // A plan does not load for other encryption parameters
+        LinearTransformPlan plan(encoder, make_test_matrix(4, 4), context.first_parms_id(), scale);
+        stringstream stream;
+        plan.save(stream);
+        auto parms = make_ckks_test_parms(1024);
+        parms.set_coeff_modulus(CoeffModulus::Create(1024, { 60, 40, 60 }));
+        SEALContext other_context(parms, true, sec_level_type::none);
+        LinearTransformPlan loaded;
+        ASSERT_THROW(loaded.load(other_context, stream), logic_error);
+
+        // A plan does not load if a coefficient of a diagonal is not reduced modulo the coefficient modulus; the last
+        // eight bytes of an uncompressed plan are the last coefficient of its last diagonal
+        vector<seal_byte> buffer(static_cast<size_t>(plan.save_size(compr_mode_type::none)));
+        auto out_size = static_cast<size_t>(plan.save(buffer.data(), buffer.size(), compr_mode_type::none));
+        ASSERT_NO_THROW(loaded.load(context, buffer.data(), out_size));
+        fill_n(
+            buffer.begin() + static_cast<ptrdiff_t>(out_size - sizeof(uint64_t)), sizeof(uint64_t),
+            static_cast<seal_byte>(0xFF));
+        ASSERT_THROW(loaded.load(context, buffer.data(), out_size), logic_error);
+    }
+} // namespace sealtest
@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "seal/ckks.h"
+#include "seal/context.h"
+#include "seal/decryptor.h"
+#include "seal/encryptor.h"
+#include "seal/evaluator.h"
+#include "seal/galoiskeys.h"
+#include "seal/keygenerator.h"
+#include "seal/modulus.h"
+#include "seal/publickey.h"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace sealtest
+{
+    // CKKS parameters for the tests of linear transforms, with one level to rescale the product to
+    inline seal::EncryptionParameters make_ckks_test_parms(std::size_t poly_modulus_degree)
+    {
+        seal::EncryptionParameters parms(seal::scheme_type::ckks);
+        parms.set_poly_modulus_degree(poly_modulus_degree);
+        parms.set_coeff_modulus(seal::CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+        return parms;
+    }
+
+    // A dense matrix, or a sparse one whose tiled diagonals with odd indices are zero
+    inline std::vector<std::vector<double>> make_test_matrix(
+        std::size_t height, std::size_t width, bool sparse = false)
+    {
+        std::size_t min_len = std::min(height, width);
+        std::vector<std::vector<double>> matrix(height, std::vector<double>(width));
+        for (std::size_t r = 0; r < height; r++)
+        {
+            for (std::size_t c = 0; c < width; c++)
+            {
+                if (!sparse || !((c + min_len - r % min_len) % min_len % 2))
+                {
+                    matrix[r][c] = static_cast<double>((3 * r + c) % 7) * 0.25 - 0.5;
+                }
+            }
+        }
+        return matrix;
+    }
+
+    // The slots of the product of the matrix and the input when the rows from first_row on are in the slots with
+    // indices r times the stride, and the other slots are zero
+    inline std::vector<double> expected_product(
+        const std::vector<std::vector<double>> &matrix, const std::vector<double> &input, std::size_t slot_count,
+        std::size_t stride, std::size_t first_row = 0)
+    {
+        std::vector<double> expected(slot_count, 0.0);
+        for (std::size_t r = first_row; r < matrix.size() && (r - first_row) * stride < slot_count; r++)
+        {
+            for (std::size_t c = 0; c < input.size(); c++)
+            {
+                expected[(r - first_row) * stride] += matrix[r][c] * input[c];
+            }
+        }
+        return expected;
+    }
+
+    // The keys and tools that the tests of linear transforms encrypt, evaluate, and decrypt with; Galois keys are
+    // created for the given steps, or for the powers of two if there are none
+    class LinearTransformTester
+    {
+    public:
+        LinearTransformTester(
+            const seal::SEALContext &context, seal::KeyGenerator &keygen, const std::vector<int> &steps = {})
+            : encoder(context), encryptor(context, keygen.secret_key()), decryptor(context, keygen.secret_key()),
+              evaluator(context)
+        {
+            seal::PublicKey public_key;
+            keygen.create_public_key(public_key);
+            encryptor.set_public_key(public_key);
+            if (steps.empty())
+            {
+                keygen.create_galois_keys(galois_keys);
+            }
+            else
+            {
+                keygen.create_galois_keys(steps, galois_keys);
+            }
+        }
+
+        seal::Ciphertext encrypt(const std::vector<double> &values, double scale)
+        {
+            seal::Plaintext plain;
+            encoder.encode(values, scale, plain);
+            seal::Ciphertext encrypted;
+            encryptor.encrypt(plain, encrypted);
+            return encrypted;
+        }
+
+        std::vector<double> decrypt(const seal::Ciphertext &encrypted)
+        {
+            seal::Plaintext plain;
+            decryptor.decrypt(encrypted, plain);
+            std::vector<double> values;
+            encoder.decode(plain, values);
+            return values;
+        }
+
+        seal::CKKSEncoder encoder;
+
+        seal::Encryptor encryptor;
+
+        seal::Decryptor decryptor;
+
+        seal::Evaluator evaluator;
+
+        seal::GaloisKeys galois_keys;
+    };
+} // namespace sealtest
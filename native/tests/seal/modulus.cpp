@@ -298,4 +298,30 @@ namespace sealtest
         ASSERT_EQ(3133441ULL, cm[0].value());
         ASSERT_EQ(3655681ULL, cm[1].value());
     }
+
+    TEST(CoeffModTest, CreateSmallTest)
+    {
+        ASSERT_THROW(auto modulus = CoeffModulus::CreateSmall(1024, 0), invalid_argument);
+        ASSERT_THROW(auto modulus = CoeffModulus::CreateSmall(1023, 60), invalid_argument);
+
+        auto cm = CoeffModulus::CreateSmall(1024, 30);
+        ASSERT_EQ(1, cm.size());
+        ASSERT_EQ(30, get_significant_bit_count(cm[0].value()));
+
+        cm = CoeffModulus::CreateSmall(4096, 218);
+        ASSERT_EQ(8, cm.size());
+        int bit_count = 0;
+        for (size_t i = 0; i < cm.size(); i++)
+        {
+            int size = get_significant_bit_count(cm[i].value());
+            ASSERT_TRUE(size == 27 || size == 28);
+            ASSERT_EQ(1ULL, cm[i].value() % 8192);
+            for (size_t j = 0; j < i; j++)
+            {
+                ASSERT_NE(cm[i].value(), cm[j].value());
+            }
+            bit_count += size;
+        }
+        ASSERT_EQ(218, bit_count);
+    }
 } // namespace sealtest
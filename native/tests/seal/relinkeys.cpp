@@ -2,11 +2,17 @@
 // Licensed under the MIT license.
 
 #include "seal/context.h"
+#include "seal/decryptor.h"
+#include "seal/encryptor.h"
+#include "seal/evaluator.h"
 #include "seal/keygenerator.h"
 #include "seal/modulus.h"
 #include "seal/relinkeys.h"
 #include "seal/util/polyarithsmallmod.h"
 #include "seal/util/uintcore.h"
+#include <cstring>
+#include <sstream>
+#include <string>
 #include "gtest/gtest.h"
 
 using namespace seal;
@@ -15,6 +21,51 @@ using namespace std;
 
 namespace sealtest
 {
+    namespace
+    {
+        // Rewrites keyswitching keys saved without compression by this version in the format of Microsoft SEAL 3.6,
+        // which has no correction factor in the keys
+        string to_seal_3_6(const string &saved)
+        {
+            size_t header_size = Serialization::seal_header_size;
+            size_t pos = header_size + sizeof(parms_id_type);
+            uint64_t keys_dim1 = 0;
+            memcpy(&keys_dim1, saved.data() + pos, sizeof(uint64_t));
+            pos += sizeof(uint64_t);
+            string members = saved.substr(header_size, pos - header_size);
+            for (uint64_t index = 0; index < keys_dim1; index++)
+            {
+                uint64_t keys_dim2 = 0;
+                memcpy(&keys_dim2, saved.data() + pos, sizeof(uint64_t));
+                members.append(saved, pos, sizeof(uint64_t));
+                pos += sizeof(uint64_t);
+                for (uint64_t j = 0; j < keys_dim2; j++)
+                {
+                    Serialization::SEALHeader header;
+                    memcpy(&header, saved.data() + pos, header_size);
+                    size_t key_end = pos + static_cast<size_t>(header.size);
+                    size_t correction_factor_pos =
+                        pos + header_size + sizeof(parms_id_type) + 1 + 3 * sizeof(uint64_t) + sizeof(double);
+                    header.version_major = 3;
+                    header.version_minor = 6;
+                    header.size -= sizeof(uint64_t);
+                    members.append(reinterpret_cast<const char *>(&header), header_size);
+                    members.append(saved, pos + header_size, correction_factor_pos - pos - header_size);
+                    size_t rest_pos = correction_factor_pos + sizeof(uint64_t);
+                    members.append(saved, rest_pos, key_end - rest_pos);
+                    pos = key_end;
+                }
+            }
+
+            Serialization::SEALHeader header;
+            memcpy(&header, saved.data(), header_size);
+            header.version_major = 3;
+            header.version_minor = 6;
+            header.size = header_size + members.size();
+            return string(reinterpret_cast<const char *>(&header), header_size) + members;
+        }
+    } // namespace
+
     TEST(RelinKeysTest, RelinKeysSaveLoad)
     {
         auto relin_keys_save_load = [](scheme_type scheme) {
@@ -201,4 +252,104 @@ namespace sealtest
         relin_keys_seeded_save_load(scheme_type::bfv);
         relin_keys_seeded_save_load(scheme_type::bgv);
     }
+
+    TEST(RelinKeysTest, RelinKeysCompactLoad)
+    {
+        EncryptionParameters parms(scheme_type::bgv);
+        parms.set_poly_modulus_degree(256);
+        parms.set_plain_modulus(65537);
+        parms.set_coeff_modulus(CoeffModulus::Create(256, { 60, 50, 60 }));
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+
+        stringstream stream;
+        keygen.create_relin_keys().save(stream);
+        RelinKeys rlk;
+        rlk.load(context, stream, true);
+        ASSERT_EQ(size_t(1), rlk.size());
+        ASSERT_TRUE(rlk.has_key(2));
+        ASSERT_TRUE(rlk.is_compact(RelinKeys::get_index(2)));
+        ASSERT_TRUE(rlk.data()[RelinKeys::get_index(2)].empty());
+        ASSERT_FALSE(rlk.has_key(3));
+
+        // The copy keeps the keys compact
+        RelinKeys rlk_copy = rlk;
+        ASSERT_TRUE(rlk_copy.is_compact(RelinKeys::get_index(2)));
+
+        Encryptor encryptor(context, pk);
+        Decryptor decryptor(context, keygen.secret_key());
+        Evaluator evaluator(context);
+        Plaintext plain("1x^10 + 2x^1 + 3");
+        Ciphertext encrypted;
+        encryptor.encrypt(plain, encrypted);
+        for (size_t byte_count : { size_t(0), size_t(1) << 30 })
+        {
+            rlk_copy.set_expansion_cache_byte_count(byte_count);
+            for (size_t round = 0; round < 2; round++)
+            {
+                Ciphertext squared;
+                evaluator.square(encrypted, squared);
+                evaluator.relinearize_inplace(squared, rlk_copy);
+                ASSERT_EQ(size_t(2), squared.size());
+                Plaintext plain_result;
+                decryptor.decrypt(squared, plain_result);
+                ASSERT_EQ("1x^20 + 4x^11 + 6x^10 + 4x^2 + Cx^1 + 9", plain_result.to_string());
+            }
+        }
+    }
+
+    TEST(RelinKeysTest, RelinKeysCompactLoadVersion)
+    {
+        EncryptionParameters parms(scheme_type::bgv);
+        parms.set_poly_modulus_degree(256);
+        parms.set_plain_modulus(65537);
+        parms.set_coeff_modulus(CoeffModulus::Create(256, { 60, 50, 60 }));
+        SEALContext context(parms, true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        size_t index = RelinKeys::get_index(2);
+
+        stringstream stream;
+        keygen.create_relin_keys().save(stream, compr_mode_type::none);
+        string saved = stream.str();
+        RelinKeys rlk;
+        rlk.load(context, stream, true);
+        ASSERT_TRUE(rlk.is_compact(index));
+
+        // Compact keys are saved with the version that their seeds were loaded from
+        stringstream compact_stream;
+        rlk.save(compact_stream, compr_mode_type::none);
+        ASSERT_EQ(saved, compact_stream.str());
+
+        // Seeds saved by an older version are sampled as that version did, and saved in the current format
+        stringstream old_stream(to_seal_3_6(saved));
+        RelinKeys old_rlk;
+        old_rlk.load(context, old_stream, true);
+        ASSERT_FALSE(old_rlk.is_compact(index));
+        stringstream resaved_stream;
+        old_rlk.save(resaved_stream, compr_mode_type::none);
+        RelinKeys resaved_rlk;
+        resaved_rlk.load(context, resaved_stream, true);
+        auto key = rlk.expanded_data(context, index);
+        for (auto &loaded : { old_rlk.data()[index], resaved_rlk.data()[index] })
+        {
+            ASSERT_EQ(key->size(), loaded.size());
+            for (size_t j = 0; j < key->size(); j++)
+            {
+                auto &a = (*key)[j].data().dyn_array();
+                auto &b = loaded[j].data().dyn_array();
+                ASSERT_TRUE(equal(a.cbegin(), a.cend(), b.cbegin(), b.cend()));
+            }
+        }
+
+        // The first polynomials of compact keys are validated on load
+        size_t first_coeff_pos = 2 * Serialization::seal_header_size + 2 * sizeof(parms_id_type) + 1 +
+                                 7 * sizeof(uint64_t) + sizeof(double);
+        string corrupted = saved;
+        fill_n(corrupted.begin() + static_cast<ptrdiff_t>(first_coeff_pos), sizeof(uint64_t), '\xFF');
+        stringstream corrupted_stream(corrupted);
+        RelinKeys corrupted_rlk;
+        ASSERT_THROW(corrupted_rlk.load(context, corrupted_stream, true), logic_error);
+    }
 } // namespace sealtest
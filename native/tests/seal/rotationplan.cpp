@@ -0,0 +1,249 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/batchencoder.h"
+#include "seal/ckks.h"
+#include "seal/context.h"
+#include "seal/decryptor.h"
+#include "seal/encryptor.h"
+#include "seal/evaluator.h"
+#include "seal/keygenerator.h"
+#include "seal/modulus.h"
+#include "seal/rotationplan.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace seal;
+using namespace std;
+
+namespace sealtest
+{
+    namespace
+    {
+        EncryptionParameters make_parms(scheme_type scheme)
+        {
+            EncryptionParameters parms(scheme);
+            size_t poly_modulus_degree = 1024;
+            parms.set_poly_modulus_degree(poly_modulus_degree);
+            parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+            if (scheme != scheme_type::ckks)
+            {
+                parms.set_plain_modulus(PlainModulus::Batching(poly_modulus_degree, 20));
+            }
+            return parms;
+        }
+
+        // Checks that the nodes compose the requested steps and are ordered as documented
+        void check_plan(const RotationPlan &plan, size_t row_size)
+        {
+            auto &nodes = plan.nodes();
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                auto &key_steps = plan.key_steps();
+                ASSERT_NE(key_steps.cend(), find(key_steps.cbegin(), key_steps.cend(), nodes[i].key_step));
+                int parent_step = 0;
+                if (nodes[i].parent != RotationPlan::input_index)
+                {
+                    ASSERT_LT(nodes[i].parent, i);
+                    parent_step = nodes[nodes[i].parent].step;
+                }
+                int row = static_cast<int>(row_size);
+                ASSERT_EQ(nodes[i].step, ((parent_step + nodes[i].key_step) % row + row) % row);
+                if (i && nodes[i - 1].parent != nodes[i].parent)
+                {
+                    for (size_t j = 0; j + 1 < i; j++)
+                    {
+                        ASSERT_NE(nodes[j].parent, nodes[i].parent);
+                    }
+                }
+            }
+
+            ASSERT_EQ(plan.steps().size(), plan.outputs().size());
+            size_t depth = 0;
+            for (size_t i = 0; i < plan.steps().size(); i++)
+            {
+                size_t output = plan.outputs()[i];
+                if (plan.steps()[i] == 0)
+                {
+                    ASSERT_EQ(RotationPlan::input_index, output);
+                    continue;
+                }
+                int row = static_cast<int>(row_size);
+                ASSERT_EQ((plan.steps()[i] + row) % row, nodes[output].step);
+                size_t node_depth = 0;
+                for (; output != RotationPlan::input_index; output = nodes[output].parent)
+                {
+                    node_depth++;
+                }
+                depth = max(depth, node_depth);
+            }
+            ASSERT_EQ(depth, plan.depth());
+        }
+    } // namespace
+
+    TEST(RotationPlanTest, Create)
+    {
+        SEALContext context(make_parms(scheme_type::bfv), true, sec_level_type::none);
+        size_t row_size = 512;
+        vector<int> steps{ 1, 2, 3, 5, -1, 0, 17, 3, 100, -200 };
+
+        // A key for each distinct step
+        RotationPlan plan(context, steps, 8);
+        check_plan(plan, row_size);
+        ASSERT_EQ(vector<int>({ 1, 2, 3, 5, -1, 17, 100, -200 }), plan.key_steps());
+        ASSERT_EQ(size_t(8), plan.key_switch_count());
+        ASSERT_EQ(size_t(1), plan.depth());
+
+        // Fewer keys cost more key switches
+        size_t key_switch_count = plan.key_switch_count();
+        for (size_t max_key_count : { 7, 4, 2, 1 })
+        {
+            RotationPlan smaller_plan(context, steps, max_key_count);
+            check_plan(smaller_plan, row_size);
+            ASSERT_LE(smaller_plan.key_count(), max_key_count);
+            ASSERT_GE(smaller_plan.key_switch_count(), key_switch_count);
+            key_switch_count = smaller_plan.key_switch_count();
+        }
+
+        // Consecutive steps are composed of a few keys
+        vector<int> baby_steps;
+        for (int i = 1; i <= 16; i++)
+        {
+            baby_steps.push_back(i);
+        }
+        RotationPlan baby_plan(context, baby_steps, 4);
+        check_plan(baby_plan, row_size);
+        ASSERT_LE(baby_plan.key_count(), size_t(4));
+        ASSERT_LE(baby_plan.key_switch_count(), size_t(16));
+
+        RotationPlan zero_plan(context, { 0, 0 }, 0);
+        ASSERT_EQ(size_t(0), zero_plan.key_count());
+        ASSERT_EQ(size_t(0), zero_plan.key_switch_count());
+
+        ASSERT_THROW(RotationPlan(context, { 1 }, 0), invalid_argument);
+        ASSERT_THROW(RotationPlan(context, { 512 }, 1), invalid_argument);
+        ASSERT_THROW(RotationPlan(context, { -512 }, 1), invalid_argument);
+
+        // The byte count agrees with the size of generated keys
+        KeyGenerator keygen(context);
+        GaloisKeys glk;
+        keygen.create_galois_keys(plan.key_steps(), glk);
+        size_t byte_count = 0;
+        for (auto &key : glk.data())
+        {
+            for (auto &key_component : key)
+            {
+                byte_count += key_component.data().dyn_array().size() * sizeof(uint64_t);
+            }
+        }
+        ASSERT_EQ(byte_count, plan.key_count() * RotationPlan::GaloisKeyByteCount(context));
+        ASSERT_EQ(size_t(3), RotationPlan::MaxKeyCount(context, 3 * RotationPlan::GaloisKeyByteCount(context) + 1));
+    }
+
+    TEST(RotationPlanTest, Execute)
+    {
+        vector<int> steps{ 1, 0, 3, 5, -1, 7, 3, 100 };
+        size_t max_key_count = 3;
+        for (auto scheme : { scheme_type::bfv, scheme_type::bgv })
+        {
+            SEALContext context(make_parms(scheme), true, sec_level_type::none);
+            RotationPlan plan(context, steps, max_key_count);
+            ASSERT_EQ(max_key_count, plan.key_count());
+            KeyGenerator keygen(context);
+            PublicKey pk;
+            keygen.create_public_key(pk);
+            GaloisKeys glk;
+            keygen.create_galois_keys(plan.key_steps(), glk);
+
+            BatchEncoder encoder(context);
+            Encryptor encryptor(context, pk);
+            Decryptor decryptor(context, keygen.secret_key());
+            Evaluator evaluator(context);
+            size_t row_size = encoder.slot_count() / 2;
+
+            vector<uint64_t> values(encoder.slot_count());
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                values[i] = i;
+            }
+            Plaintext plain;
+            encoder.encode(values, plain);
+            Ciphertext encrypted;
+            encryptor.encrypt(plain, encrypted);
+
+            vector<Ciphertext> rotated;
+            evaluator.rotate_rows_many(encrypted, plan, glk, rotated);
+            ASSERT_EQ(steps.size(), rotated.size());
+            for (size_t i = 0; i < steps.size(); i++)
+            {
+                Plaintext plain_result;
+                decryptor.decrypt(rotated[i], plain_result);
+                vector<uint64_t> result;
+                encoder.decode(plain_result, result);
+                size_t shift = static_cast<size_t>(steps[i] + static_cast<int>(row_size)) % row_size;
+                for (size_t j = 0; j < row_size; j++)
+                {
+                    ASSERT_EQ(values[(j + shift) % row_size], result[j]);
+                    ASSERT_EQ(values[row_size + (j + shift) % row_size], result[row_size + j]);
+                }
+            }
+
+            ASSERT_THROW(evaluator.rotate_vector_many(encrypted, plan, glk, rotated), logic_error);
+            GaloisKeys missing_glk;
+            keygen.create_galois_keys(vector<int>{ plan.key_steps()[0] }, missing_glk);
+            ASSERT_THROW(evaluator.rotate_rows_many(encrypted, plan, missing_glk, rotated), invalid_argument);
+        }
+
+        SEALContext context(make_parms(scheme_type::ckks), true, sec_level_type::none);
+        RotationPlan plan(context, steps, max_key_count);
+        KeyGenerator keygen(context);
+        PublicKey pk;
+        keygen.create_public_key(pk);
+        GaloisKeys glk;
+        keygen.create_galois_keys(plan.key_steps(), glk);
+
+        CKKSEncoder encoder(context);
+        Encryptor encryptor(context, pk);
+        Decryptor decryptor(context, keygen.secret_key());
+        Evaluator evaluator(context);
+        size_t slot_count = encoder.slot_count();
+
+        vector<complex<double>> values(slot_count);
+        for (size_t i = 0; i < slot_count; i++)
+        {
+            values[i] = complex<double>(static_cast<double>(i % 16), 1.0);
+        }
+        Plaintext plain;
+        encoder.encode(values, pow(2.0, 40), plain);
+        Ciphertext encrypted;
+        encryptor.encrypt(plain, encrypted);
+
+        vector<Ciphertext> rotated;
+        evaluator.rotate_vector_many(encrypted, plan, glk, rotated);
+        ASSERT_EQ(steps.size(), rotated.size());
+        for (size_t i = 0; i < steps.size(); i++)
+        {
+            Plaintext plain_result;
+            decryptor.decrypt(rotated[i], plain_result);
+            vector<complex<double>> result;
+            encoder.decode(plain_result, result);
+            size_t shift = static_cast<size_t>(steps[i] + static_cast<int>(slot_count)) % slot_count;
+            for (size_t j = 0; j < slot_count; j++)
+            {
+                ASSERT_NEAR(values[(j + shift) % slot_count].real(), result[j].real(), 0.01);
+                ASSERT_NEAR(values[(j + shift) % slot_count].imag(), result[j].imag(), 0.01);
+            }
+        }
+
+        // A plan for another degree
+        auto parms = make_parms(scheme_type::ckks);
+        parms.set_poly_modulus_degree(2048);
+        parms.set_coeff_modulus(CoeffModulus::Create(2048, { 60, 40, 40, 60 }));
+        SEALContext other_context(parms, true, sec_level_type::none);
+        RotationPlan other_plan(other_context, steps, max_key_count);
+        ASSERT_THROW(evaluator.rotate_vector_many(encrypted, other_plan, glk, rotated), invalid_argument);
+    }
+} // namespace sealtest
@@ -0,0 +1,197 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/ckks.h"
+#include "seal/context.h"
+#include "seal/decryptor.h"
+#include "seal/encryptor.h"
+#include "seal/evaluator.h"
+#include "seal/keygenerator.h"
+#include "seal/modulus.h"
+#include "seal/tiledlineartransformplan.h"
+#include "lineartransformtest.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace seal;
+using namespace std;
+
+namespace sealtest
+{
+    namespace
+    {
+        // Checks that the plan multiplies by the matrix
+        void check_plan(
+            const SEALContext &context, KeyGenerator &keygen, const TiledLinearTransformPlan &plan,
+            const vector<vector<double>> &matrix)
+        {
+            LinearTransformTester tester(context, keygen, plan.steps());
+            size_t slot_count = tester.encoder.slot_count();
+            size_t n = plan.tile_dimension();
+            size_t stride = slot_count / n;
+
+            size_t width = matrix[0].size();
+            vector<double> input(width);
+            vector<Ciphertext> encrypted;
+            for (size_t q = 0; q < plan.input_count(); q++)
+            {
+                vector<double> values(slot_count, 0.0);
+                for (size_t c = 0; c < n && q * n + c < width; c++)
+                {
+                    input[q * n + c] = static_cast<double>((q * n + c) % 5) - 2.0;
+                    values[c * stride] = input[q * n + c];
+                }
+                encrypted.push_back(tester.encrypt(values, plan.scale()));
+            }
+
+            vector<Ciphertext> result;
+            tester.evaluator.linear_transformation(encrypted, plan, tester.galois_keys, result);
+            ASSERT_EQ(plan.output_count(), result.size());
+            for (size_t p = 0; p < plan.output_count(); p++)
+            {
+                ASSERT_EQ(context.first_context_data()->next_context_data()->parms_id(), result[p].parms_id());
+                auto output = tester.decrypt(result[p]);
+                auto expected = expected_product(matrix, input, slot_count, stride, p * n);
+                for (size_t s = 0; s < slot_count; s++)
+                {
+                    ASSERT_NEAR(expected[s], output[s], 0.01);
+                }
+            }
+        }
+    } // namespace
+
+    TEST(TiledLinearTransformPlanTest, Create)
+    {
+        SEALContext context(make_ckks_test_parms(256), true, sec_level_type::none);
+        CKKSEncoder encoder(context);
+        double scale = pow(2.0, 40);
+
+        TiledLinearTransformPlan plan(encoder, make_test_matrix(200, 300), context.first_parms_id(), scale);
+        ASSERT_EQ(size_t(200), plan.height());
+        ASSERT_EQ(size_t(300), plan.width());
+        ASSERT_EQ(size_t(128), plan.tile_dimension());
+        ASSERT_EQ(size_t(2), plan.output_count());
+        ASSERT_EQ(size_t(3), plan.input_count());
+        ASSERT_EQ(context.first_parms_id(), plan.parms_id());
+        ASSERT_EQ(scale, plan.scale());
+
+        // The baby steps are shared by the two tiles of a column and the giant steps by the three tiles of a row
+        size_t g = plan.baby_step_count();
+        size_t giant_step_count = (128 + g - 1) / g;
+        ASSERT_EQ(3 * (g - 1) + 2 * (giant_step_count - 1), plan.key_switch_count());
+        ASSERT_EQ(g - 1 + giant_step_count - 1, plan.steps().size());
+        for (size_t p = 0; p < 2; p++)
+        {
+            for (size_t q = 0; q < 3; q++)
+            {
+                ASSERT_EQ(g, plan.tile(p, q).baby_step_count());
+                ASSERT_EQ(size_t(0), plan.tile(p, q).offset());
+                ASSERT_EQ(size_t(128), plan.tile(p, q).dimension());
+            }
+        }
+        ASSERT_THROW(static_cast<void>(plan.tile(2, 0)), out_of_range);
+        ASSERT_THROW(static_cast<void>(plan.tile(0, 3)), out_of_range);
+
+        // A matrix that fits in the slots has one tile of the padded dimension
+        TiledLinearTransformPlan small_plan(encoder, make_test_matrix(5, 12), context.first_parms_id(), scale);
+        ASSERT_EQ(size_t(16), small_plan.tile_dimension());
+        ASSERT_EQ(size_t(1), small_plan.output_count());
+        ASSERT_EQ(size_t(1), small_plan.input_count());
+
+        // Tiles that are zero are empty
+        auto block_diagonal = make_test_matrix(256, 256);
+        for (size_t r = 0; r < 256; r++)
+        {
+            for (size_t c = 0; c < 256; c++)
+            {
+                if (r / 128 != c / 128)
+                {
+                    block_diagonal[r][c] = 0.0;
+                }
+            }
+        }
+        TiledLinearTransformPlan block_plan(encoder, block_diagonal, context.first_parms_id(), scale);
+        ASSERT_EQ(size_t(0), block_plan.tile(0, 1).dimension());
+        ASSERT_EQ(size_t(0), block_plan.tile(1, 0).dimension());
+        ASSERT_EQ(size_t(128), block_plan.tile(1, 1).dimension());
+
+        ASSERT_THROW(TiledLinearTransformPlan(encoder, {}, context.first_parms_id(), scale), invalid_argument);
+        ASSERT_THROW(
+            TiledLinearTransformPlan(encoder, { { 1.0 }, { 1.0, 2.0 } }, context.first_parms_id(), scale),
+            invalid_argument);
+        ASSERT_THROW(TiledLinearTransformPlan(encoder, make_test_matrix(2, 2), parms_id_zero, scale), invalid_argument);
+
+        // The output ciphertext of a row of tiles that is zero would be transparent
+        auto zero_tile_row = make_test_matrix(200, 300);
+        for (size_t r = 128; r < 200; r++)
+        {
+            fill(zero_tile_row[r].begin(), zero_tile_row[r].end(), 0.0);
+        }
+        ASSERT_THROW(
+            TiledLinearTransformPlan(encoder, zero_tile_row, context.first_parms_id(), scale), invalid_argument);
+        zero_tile_row.resize(128);
+        TiledLinearTransformPlan truncated_plan(encoder, zero_tile_row, context.first_parms_id(), scale);
+        ASSERT_EQ(size_t(1), truncated_plan.output_count());
+    }
+
+    TEST(TiledLinearTransformPlanTest, Evaluate)
+    {
+        SEALContext context(make_ckks_test_parms(256), true, sec_level_type::none);
+        KeyGenerator keygen(context);
+        CKKSEncoder encoder(context);
+        double scale = pow(2.0, 40);
+
+        struct Shape
+        {
+            size_t height;
+            size_t width;
+        };
+        for (auto shape : vector<Shape>{ { 1, 1 }, { 5, 12 }, { 128, 384 }, { 300, 100 }, { 200, 300 } })
+        {
+            SCOPED_TRACE(to_string(shape.height) + "x" + to_string(shape.width));
+            auto matrix = make_test_matrix(shape.height, shape.width);
+            for (auto parms_id : { context.first_parms_id(), context.key_parms_id() })
+            {
+                TiledLinearTransformPlan plan(encoder, matrix, parms_id, scale);
+                check_plan(context, keygen, plan, matrix);
+            }
+        }
+
+        // Rows that are zero are fine as long as every row of tiles has a nonzero entry
+        auto zero_rows = make_test_matrix(200, 300);
+        for (size_t r = 100; r < 150; r++)
+        {
+            fill(zero_rows[r].begin(), zero_rows[r].end(), 0.0);
+        }
+        for (auto parms_id : { context.first_parms_id(), context.key_parms_id() })
+        {
+            TiledLinearTransformPlan plan(encoder, zero_rows, parms_id, scale);
+            check_plan(context, keygen, plan, zero_rows);
+        }
+
+        // A banded matrix needs rotations only for its band
+        vector<vector<double>> banded(256, vector<double>(512, 0.0));
+        for (size_t r = 0; r < 256; r++)
+        {
+            banded[r][r] = 1.0 + static_cast<double>(r % 3);
+            banded[r][r + 1] = -0.5;
+            banded[r][r + 256] = 0.25;
+        }
+        TiledLinearTransformPlan banded_plan(encoder, banded, context.first_parms_id(), scale);
+        ASSERT_GE(size_t(3), banded_plan.key_switch_count());
+        check_plan(context, keygen, banded_plan, banded);
+
+        LinearTransformTester tester(context, keygen);
+        vector<Ciphertext> encrypted(2), result;
+        tester.encryptor.encrypt_zero(encrypted[0]);
+        tester.encryptor.encrypt_zero(encrypted[1]);
+        ASSERT_THROW(
+            tester.evaluator.linear_transformation(encrypted, TiledLinearTransformPlan(), tester.galois_keys, result),
+            invalid_argument);
+        TiledLinearTransformPlan plan(encoder, make_test_matrix(300, 100), context.first_parms_id(), scale);
+        ASSERT_THROW(
+            tester.evaluator.linear_transformation(encrypted, plan, tester.galois_keys, result), invalid_argument);
+    }
+} // namespace sealtest
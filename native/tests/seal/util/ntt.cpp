@@ -2,6 +2,7 @@
 // Licensed under the MIT license.
 
 #include "seal/modulus.h"
+#include "seal/util/dispatch.h"
 #include "seal/util/ntt.h"
 #include "seal/util/numth.h"
 #include "seal/util/polycore.h"
@@ -131,5 +132,329 @@ namespace sealtest
                 ASSERT_EQ(temp[i], poly[i]);
             }
         }
+
+        TEST(NTTTablesTest, NegacyclicNTTNewTest)
+        {
+            MemoryPoolHandle pool = MemoryPoolHandle::Global();
+            Pointer<NTTTables> tables;
+            random_device rd;
+            mt19937_64 engine(rd());
+            KernelVariantGuard guard;
+
+            for (kernel_variant variant : { kernel_variant::scalar, kernel_variant::avx2, kernel_variant::avx512,
+                                            kernel_variant::avx512ifma })
+            {
+                if (!is_kernel_variant_supported(variant))
+                {
+                    continue;
+                }
+                set_active_kernel_variant(variant);
+
+                // Sizes above 2^ntt_block_coeff_count_power are computed block by block
+                for (int coeff_count_power = 1; coeff_count_power <= 16; coeff_count_power++)
+                {
+                    size_t n = size_t(1) << coeff_count_power;
+                    for (int bit_size : { 20, 30, 31, 40, 50, 60, 61 })
+                    {
+                        Modulus modulus(get_prime(uint64_t(2) << coeff_count_power, bit_size));
+                        uint64_t q = modulus.value();
+                        ASSERT_NO_THROW(tables = allocate<NTTTables>(pool, coeff_count_power, modulus, pool));
+                        auto poly(allocate_poly(n, 1, pool));
+                        auto expected(allocate_poly(n, 1, pool));
+
+                        // Forward transform accepts inputs in [0, 4q) and must agree with DWTHandler modulo q
+                        uniform_int_distribution<uint64_t> forward_dist(0, 4 * q - 1);
+                        for (size_t i = 0; i < n; i++)
+                        {
+                            poly[i] = forward_dist(engine);
+                            expected[i] = poly[i];
+                        }
+                        ntt_negacyclic_harvey_new(poly.get(), *tables);
+                        tables->ntt_handler().transform_to_rev(
+                            expected.get(), coeff_count_power, tables->get_from_root_powers());
+                        // The IFMA and 32-bit lane kernels use shorter Shoup quotients
+                        bool exact = variant == kernel_variant::scalar ||
+                                     (variant != kernel_variant::avx512ifma && bit_size > SEAL_SMALL_MOD_BIT_COUNT_MAX);
+                        for (size_t i = 0; i < n; i++)
+                        {
+                            ASSERT_EQ(expected[i] % q, poly[i] % q);
+                            ASSERT_GT(4 * q, poly[i]);
+                            if (exact)
+                            {
+                                ASSERT_EQ(expected[i], poly[i]);
+                            }
+                        }
+
+                        // Inverse transform accepts inputs in [0, 2q) and must agree with DWTHandler modulo q
+                        uniform_int_distribution<uint64_t> inverse_dist(0, 2 * q - 1);
+                        for (size_t i = 0; i < n; i++)
+                        {
+                            poly[i] = inverse_dist(engine);
+                            expected[i] = poly[i];
+                        }
+                        MultiplyUIntModOperand inv_degree_modulo = tables->inv_degree_modulo();
+                        inverse_ntt_negacyclic_harvey_new(poly.get(), *tables);
+                        tables->ntt_handler().transform_from_rev(
+                            expected.get(), coeff_count_power, tables->get_from_inv_root_powers(),
+                            &inv_degree_modulo);
+                        for (size_t i = 0; i < n; i++)
+                        {
+                            ASSERT_EQ(expected[i] % q, poly[i] % q);
+                            ASSERT_GT(2 * q, poly[i]);
+                            if (exact)
+                            {
+                                ASSERT_EQ(expected[i], poly[i]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST(NTTTablesTest, BlockedNTTTest)
+        {
+            MemoryPoolHandle pool = MemoryPoolHandle::Global();
+            Pointer<NTTTables> tables;
+            random_device rd;
+            mt19937_64 engine(rd());
+
+            for (int coeff_count_power : { 3, 8, 15, 16 })
+            {
+                size_t n = size_t(1) << coeff_count_power;
+                Modulus modulus(get_prime(uint64_t(2) << coeff_count_power, 60));
+                uint64_t q = modulus.value();
+                ASSERT_NO_THROW(tables = allocate<NTTTables>(pool, coeff_count_power, modulus, pool));
+                MultiplyUIntModOperand inv_degree_modulo = tables->inv_degree_modulo();
+                auto poly(allocate_poly(n, 1, pool));
+                auto expected(allocate_poly(n, 1, pool));
+                uniform_int_distribution<uint64_t> dist(0, 2 * q - 1);
+
+                // Any block size from a single pair of values up to the whole transform gives identical outputs
+                for (int log_block = 1; log_block <= coeff_count_power; log_block++)
+                {
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        poly[i] = dist(engine);
+                        expected[i] = poly[i];
+                    }
+                    tables->ntt_handler().transform_to_rev_blocked(
+                        poly.get(), coeff_count_power, tables->get_from_root_powers(), log_block);
+                    tables->ntt_handler().transform_to_rev(
+                        expected.get(), coeff_count_power, tables->get_from_root_powers());
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        ASSERT_EQ(expected[i], poly[i]);
+                    }
+
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        poly[i] = dist(engine);
+                        expected[i] = poly[i];
+                    }
+                    tables->ntt_handler().transform_from_rev_blocked(
+                        poly.get(), coeff_count_power, tables->get_from_inv_root_powers(), log_block,
+                        &inv_degree_modulo);
+                    tables->ntt_handler().transform_from_rev(
+                        expected.get(), coeff_count_power, tables->get_from_inv_root_powers(), &inv_degree_modulo);
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        ASSERT_EQ(expected[i], poly[i]);
+                    }
+                }
+            }
+        }
+
+        TEST(NTTTablesTest, RadixNTTTest)
+        {
+            MemoryPoolHandle pool = MemoryPoolHandle::Global();
+            Pointer<NTTTables> tables;
+            random_device rd;
+            mt19937_64 engine(rd());
+
+            for (int coeff_count_power = 1; coeff_count_power <= 13; coeff_count_power++)
+            {
+                size_t n = size_t(1) << coeff_count_power;
+                Modulus modulus(get_prime(uint64_t(2) << coeff_count_power, 60));
+                uint64_t q = modulus.value();
+                ASSERT_NO_THROW(tables = allocate<NTTTables>(pool, coeff_count_power, modulus, pool));
+                MultiplyUIntModOperand inv_degree_modulo = tables->inv_degree_modulo();
+                auto input(allocate_poly(n, 1, pool));
+                auto expected(allocate_poly(n, 1, pool));
+                auto radix4(allocate_poly(n, 1, pool));
+                auto radix8(allocate_poly(n, 1, pool));
+                uniform_int_distribution<uint64_t> dist(0, 2 * q - 1);
+                auto reset = [&]() {
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        expected[i] = radix4[i] = radix8[i] = input[i];
+                    }
+                };
+                auto check = [&]() {
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        ASSERT_EQ(expected[i], radix4[i]);
+                        ASSERT_EQ(expected[i], radix8[i]);
+                    }
+                };
+
+                // Merging stages does not change any butterfly, so the outputs are identical
+                for (size_t i = 0; i < n; i++)
+                {
+                    input[i] = dist(engine);
+                }
+                reset();
+                const auto &handler = tables->ntt_handler();
+                handler.transform_to_rev(expected.get(), coeff_count_power, tables->get_from_root_powers());
+                handler.transform_to_rev_radix<2>(radix4.get(), coeff_count_power, tables->get_from_root_powers());
+                handler.transform_to_rev_radix<3>(radix8.get(), coeff_count_power, tables->get_from_root_powers());
+                check();
+
+                reset();
+                handler.transform_from_rev(expected.get(), coeff_count_power, tables->get_from_inv_root_powers());
+                handler.transform_from_rev_radix<2>(
+                    radix4.get(), coeff_count_power, tables->get_from_inv_root_powers());
+                handler.transform_from_rev_radix<3>(
+                    radix8.get(), coeff_count_power, tables->get_from_inv_root_powers());
+                check();
+
+                reset();
+                handler.transform_from_rev(
+                    expected.get(), coeff_count_power, tables->get_from_inv_root_powers(), &inv_degree_modulo);
+                handler.transform_from_rev_radix<2>(
+                    radix4.get(), coeff_count_power, tables->get_from_inv_root_powers(), &inv_degree_modulo);
+                handler.transform_from_rev_radix<3>(
+                    radix8.get(), coeff_count_power, tables->get_from_inv_root_powers(), &inv_degree_modulo);
+                check();
+            }
+        }
+
+        TEST(NTTTablesTest, BatchedNTTTest)
+        {
+            MemoryPoolHandle pool = MemoryPoolHandle::Global();
+            Pointer<NTTTables> tables;
+            random_device rd;
+            mt19937_64 engine(rd());
+
+            int coeff_count_power = 12;
+            size_t n = size_t(1) << coeff_count_power;
+            vector<Modulus> moduli = CoeffModulus::Create(n, { 60, 50, 40 });
+            size_t moduli_count = moduli.size();
+            ASSERT_NO_THROW(CreateNTTTables(coeff_count_power, moduli, tables, pool));
+            ConstNTTTablesIter tables_iter(tables.get());
+
+            // Three polynomials with one component per modulus
+            size_t size = 3;
+            auto poly(allocate_poly_array(size, n, moduli_count, pool));
+            auto expected(allocate_poly_array(size, n, moduli_count, pool));
+            auto reset = [&]() {
+                for (size_t p = 0; p < size; p++)
+                {
+                    for (size_t j = 0; j < moduli_count; j++)
+                    {
+                        uniform_int_distribution<uint64_t> dist(0, moduli[j].value() - 1);
+                        for (size_t i = 0; i < n; i++)
+                        {
+                            uint64_t value = dist(engine);
+                            poly[(p * moduli_count + j) * n + i] = value;
+                            expected[(p * moduli_count + j) * n + i] = value;
+                        }
+                    }
+                }
+            };
+            auto check = [&]() {
+                for (size_t i = 0; i < size * moduli_count * n; i++)
+                {
+                    ASSERT_EQ(expected[i], poly[i]);
+                }
+            };
+            PolyIter poly_iter(poly.get(), n, moduli_count);
+
+            reset();
+            ntt_negacyclic_harvey_lazy(poly_iter, size, tables_iter);
+            for (size_t p = 0; p < size; p++)
+            {
+                for (size_t j = 0; j < moduli_count; j++)
+                {
+                    ntt_negacyclic_harvey_lazy(expected.get() + (p * moduli_count + j) * n, tables[j]);
+                }
+            }
+            check();
+
+            reset();
+            ntt_negacyclic_harvey(poly_iter, size, tables_iter);
+            for (size_t p = 0; p < size; p++)
+            {
+                for (size_t j = 0; j < moduli_count; j++)
+                {
+                    ntt_negacyclic_harvey(expected.get() + (p * moduli_count + j) * n, tables[j]);
+                }
+            }
+            check();
+
+            reset();
+            inverse_ntt_negacyclic_harvey_lazy(poly_iter, size, tables_iter);
+            for (size_t p = 0; p < size; p++)
+            {
+                for (size_t j = 0; j < moduli_count; j++)
+                {
+                    inverse_ntt_negacyclic_harvey_lazy(expected.get() + (p * moduli_count + j) * n, tables[j]);
+                }
+            }
+            check();
+
+            reset();
+            inverse_ntt_negacyclic_harvey(poly_iter, size, tables_iter);
+            for (size_t p = 0; p < size; p++)
+            {
+                for (size_t j = 0; j < moduli_count; j++)
+                {
+                    inverse_ntt_negacyclic_harvey(expected.get() + (p * moduli_count + j) * n, tables[j]);
+                }
+            }
+            check();
+
+            // Consecutive polynomials modulo a single prime; all values are reduced modulo the smallest prime
+            size_t count = size * moduli_count;
+            RNSIter rns_iter(poly.get(), n);
+            auto reset_single = [&]() {
+                uniform_int_distribution<uint64_t> dist(0, moduli[2].value() - 1);
+                for (size_t i = 0; i < count * n; i++)
+                {
+                    poly[i] = expected[i] = dist(engine);
+                }
+            };
+
+            reset_single();
+            ntt_negacyclic_harvey_lazy(rns_iter, count, tables[0]);
+            for (size_t k = 0; k < count; k++)
+            {
+                ntt_negacyclic_harvey_lazy(expected.get() + k * n, tables[0]);
+            }
+            check();
+
+            reset_single();
+            ntt_negacyclic_harvey(rns_iter, count, tables[0]);
+            for (size_t k = 0; k < count; k++)
+            {
+                ntt_negacyclic_harvey(expected.get() + k * n, tables[0]);
+            }
+            check();
+
+            reset_single();
+            inverse_ntt_negacyclic_harvey_lazy(rns_iter, count, tables[0]);
+            for (size_t k = 0; k < count; k++)
+            {
+                inverse_ntt_negacyclic_harvey_lazy(expected.get() + k * n, tables[0]);
+            }
+            check();
+
+            reset_single();
+            inverse_ntt_negacyclic_harvey(rns_iter, count, tables[0]);
+            for (size_t k = 0; k < count; k++)
+            {
+                inverse_ntt_negacyclic_harvey(expected.get() + k * n, tables[0]);
+            }
+            check();
+        }
     } // namespace util
 } // namespace sealtest
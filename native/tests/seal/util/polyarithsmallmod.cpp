@@ -2,11 +2,16 @@
 // Licensed under the MIT license.
 
 #include "seal/util/defines.h"
+#include "seal/util/dispatch.h"
 #include "seal/util/polyarithsmallmod.h"
 #include "seal/util/polycore.h"
+#include "seal/util/uintarithsmallmod.h"
 #include "seal/util/uintcore.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <random>
+#include <vector>
 #include "gtest/gtest.h"
 
 using namespace seal;
@@ -639,6 +644,161 @@ namespace sealtest
             }
         }
 
+        TEST(PolyArithSmallMod, KernelVariants)
+        {
+            MemoryPool &pool = *global_variables::global_memory_pool;
+            random_device rd;
+            mt19937_64 engine(rd());
+            KernelVariantGuard guard;
+
+            for (kernel_variant variant : { kernel_variant::scalar, kernel_variant::avx2, kernel_variant::avx512,
+                                            kernel_variant::avx512ifma })
+            {
+                if (!is_kernel_variant_supported(variant))
+                {
+                    continue;
+                }
+                set_active_kernel_variant(variant);
+
+                // Lengths that are not multiples of the vector width exercise the remainders
+                for (size_t coeff_count : { 1, 7, 8, 37, 64 })
+                {
+                    for (uint64_t modulus_value :
+                         { uint64_t(3), uint64_t(1) << 20, (uint64_t(1) << 30) - 35, (uint64_t(1) << 30) + 3,
+                           (uint64_t(1) << 50) - 27, uint64_t(1) << 50, (uint64_t(1) << 61) - 1 })
+                    {
+                        Modulus mod(modulus_value);
+                        SEAL_ALLOCATE_GET_COEFF_ITER(poly1, coeff_count, pool);
+                        SEAL_ALLOCATE_GET_COEFF_ITER(poly2, coeff_count, pool);
+                        SEAL_ALLOCATE_GET_COEFF_ITER(result, coeff_count, pool);
+                        uniform_int_distribution<uint64_t> dist(0, modulus_value - 1);
+                        for (size_t i = 0; i < coeff_count; i++)
+                        {
+                            poly1[i] = dist(engine);
+                            poly2[i] = dist(engine);
+                        }
+
+                        dyadic_product_coeffmod(poly1, poly2, coeff_count, mod, result);
+                        for (size_t i = 0; i < coeff_count; i++)
+                        {
+                            ASSERT_EQ(multiply_uint_mod(poly1[i], poly2[i], mod), result[i]);
+                        }
+
+                        add_poly_coeffmod(poly1, poly2, coeff_count, mod, result);
+                        for (size_t i = 0; i < coeff_count; i++)
+                        {
+                            ASSERT_EQ(add_uint_mod(poly1[i], poly2[i], mod), result[i]);
+                        }
+                        sub_poly_coeffmod(poly1, poly2, coeff_count, mod, result);
+                        for (size_t i = 0; i < coeff_count; i++)
+                        {
+                            ASSERT_EQ(sub_uint_mod(poly1[i], poly2[i], mod), result[i]);
+                        }
+                        poly1[coeff_count / 2] = 0;
+                        negate_poly_coeffmod(poly1, coeff_count, mod, result);
+                        for (size_t i = 0; i < coeff_count; i++)
+                        {
+                            ASSERT_EQ(negate_uint_mod(poly1[i], mod), result[i]);
+                        }
+
+                        // The scalar multiplication reduces arbitrary inputs
+                        poly1[0] = 0xFFFFFFFFFFFFFFFFULL;
+                        MultiplyUIntModOperand scalar;
+                        scalar.set(dist(engine), mod);
+                        multiply_poly_scalar_coeffmod(poly1, coeff_count, scalar, mod, result);
+                        for (size_t i = 0; i < coeff_count; i++)
+                        {
+                            ASSERT_EQ(multiply_uint_mod(poly1[i], scalar, mod), result[i]);
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST(PolyArithSmallMod, DotProductCoeffMod)
+        {
+            random_device rd;
+            mt19937_64 engine(rd());
+            KernelVariantGuard guard;
+
+            for (kernel_variant variant : { kernel_variant::scalar, kernel_variant::avx2, kernel_variant::avx512,
+                                            kernel_variant::avx512ifma })
+            {
+                if (!is_kernel_variant_supported(variant))
+                {
+                    continue;
+                }
+                set_active_kernel_variant(variant);
+
+                // Lengths that exceed the tiles of the kernels, and more products than the scalar code can sum for
+                // 61-bit moduli without reduction
+                for (size_t coeff_count : { 1, 37, 200 })
+                {
+                    for (size_t count : { 0, 1, 2, 5, 70 })
+                    {
+                        for (uint64_t modulus_value :
+                             { uint64_t(3), (uint64_t(1) << 30) - 35, (uint64_t(1) << 30) + 3,
+                               (uint64_t(1) << 50) - 27, (uint64_t(1) << 61) - 1 })
+                        {
+                            Modulus mod(modulus_value);
+                            vector<vector<uint64_t>> polys1(count, vector<uint64_t>(coeff_count));
+                            vector<vector<uint64_t>> polys2(count, vector<uint64_t>(coeff_count));
+                            vector<const uint64_t *> operands1, operands2;
+                            vector<uint64_t> expected(coeff_count, 0);
+
+                            // The operands may be lazily reduced
+                            uniform_int_distribution<uint64_t> dist(0, 4 * modulus_value - 1);
+                            for (size_t j = 0; j < count; j++)
+                            {
+                                for (size_t i = 0; i < coeff_count; i++)
+                                {
+                                    polys1[j][i] = dist(engine);
+                                    polys2[j][i] = dist(engine);
+                                    uint64_t x = barrett_reduce_64(polys1[j][i], mod);
+                                    uint64_t y = barrett_reduce_64(polys2[j][i], mod);
+                                    expected[i] = add_uint_mod(expected[i], multiply_uint_mod(x, y, mod), mod);
+                                }
+                                operands1.push_back(polys1[j].data());
+                                operands2.push_back(polys2[j].data());
+                            }
+
+                            vector<uint64_t> result(coeff_count, 1);
+                            dot_product_coeffmod(
+                                operands1.data(), operands2.data(), count, coeff_count, mod, result.data());
+                            ASSERT_EQ(expected, result);
+
+                            // The same with the operands operand2 in Montgomery form
+                            uint64_t r[2]{ 0, 1 };
+                            uint64_t r_mod = barrett_reduce_128(r, mod);
+                            vector<vector<uint64_t>> polys2_montgomery(polys2);
+                            vector<const uint64_t *> operands2_montgomery;
+                            for (auto &poly : polys2_montgomery)
+                            {
+                                for (auto &coeff : poly)
+                                {
+                                    coeff = multiply_uint_mod(coeff, r_mod, mod);
+                                }
+                                operands2_montgomery.push_back(poly.data());
+                            }
+                            fill(result.begin(), result.end(), 1);
+                            dot_product_montgomery_coeffmod(
+                                operands1.data(), operands2_montgomery.data(), count, coeff_count, mod, result.data());
+                            ASSERT_EQ(expected, result);
+
+                            // The result may overwrite an operand
+                            if (count)
+                            {
+                                uint64_t *overwritten = polys1[count - 1].data();
+                                dot_product_coeffmod(
+                                    operands1.data(), operands2.data(), count, coeff_count, mod, overwritten);
+                                ASSERT_EQ(expected, polys1[count - 1]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
         TEST(PolyArithSmallMod, PolyInftyNormCoeffMod)
         {
             MemoryPool &pool = *global_variables::global_memory_pool;
@@ -2,10 +2,15 @@
 // Licensed under the MIT license.
 
 #include "seal/memorymanager.h"
+#include "seal/modulus.h"
+#include "seal/util/dispatch.h"
 #include "seal/util/numth.h"
 #include "seal/util/rns.h"
+#include "seal/util/uintarith.h"
 #include "seal/util/uintarithmod.h"
 #include "seal/util/uintarithsmallmod.h"
+#include <algorithm>
+#include <random>
 #include <stdexcept>
 #include <vector>
 #include "gtest/gtest.h"
@@ -437,6 +442,60 @@ namespace sealtest
             }
         }
 
+        TEST(BaseConverterTest, ConvertArrayKernelVariants)
+        {
+            auto pool = MemoryManager::GetPool();
+            random_device rd;
+            mt19937_64 engine(rd());
+            KernelVariantGuard guard;
+
+            auto primes = CoeffModulus::Create(64, { 60, 60, 50, 40, 30, 60, 45, 20, 60 });
+            RNSBase ibase(vector<Modulus>(primes.begin(), primes.begin() + 5), pool);
+            RNSBase obase(vector<Modulus>(primes.begin() + 5, primes.end()), pool);
+            BaseConverter bct(ibase, obase, pool);
+
+            // Odd coefficient counts exercise the remainders of the vectorized kernels and of the tiles
+            for (size_t count : { size_t(37), size_t(1000) })
+            {
+                vector<uint64_t> in(count * ibase.size());
+                for (size_t i = 0; i < ibase.size(); i++)
+                {
+                    uniform_int_distribution<uint64_t> dist(0, ibase[i].value() - 1);
+                    generate(in.begin() + count * i, in.begin() + count * (i + 1), [&]() { return dist(engine); });
+                }
+
+                // Convert each coefficient separately
+                vector<uint64_t> expected(count * obase.size());
+                vector<uint64_t> in_coeff(ibase.size());
+                vector<uint64_t> out_coeff(obase.size());
+                for (size_t j = 0; j < count; j++)
+                {
+                    for (size_t i = 0; i < ibase.size(); i++)
+                    {
+                        in_coeff[i] = in[i * count + j];
+                    }
+                    bct.fast_convert(in_coeff.data(), out_coeff.data(), pool);
+                    for (size_t i = 0; i < obase.size(); i++)
+                    {
+                        expected[i * count + j] = out_coeff[i];
+                    }
+                }
+
+                for (kernel_variant variant : { kernel_variant::scalar, kernel_variant::avx2, kernel_variant::avx512,
+                                                kernel_variant::avx512ifma })
+                {
+                    if (!is_kernel_variant_supported(variant))
+                    {
+                        continue;
+                    }
+                    set_active_kernel_variant(variant);
+                    vector<uint64_t> out(count * obase.size());
+                    bct.fast_convert_array(ConstRNSIter(in.data(), count), RNSIter(out.data(), count), pool);
+                    ASSERT_EQ(expected, out);
+                }
+            }
+        }
+
         TEST(RNSToolTest, Initialize)
         {
             auto pool = MemoryManager::GetPool();
@@ -901,6 +960,188 @@ namespace sealtest
 #endif
         }
 
+        TEST(RNSToolTest, HPSScaleAndRound)
+        {
+            // These functions extend an input exactly from base q to base P, compute round(t/q * input) in base P
+            // from the input in base q U P, and convert the result exactly back to base q.
+
+            auto pool = MemoryManager::GetPool();
+            Pointer<RNSTool> rns_tool;
+            size_t poly_modulus_degree = 4;
+            Modulus plain_t = 3;
+            ASSERT_NO_THROW(
+                rns_tool = allocate<RNSTool>(pool, poly_modulus_degree, RNSBase({ 5, 7 }, pool), plain_t, pool, true));
+            ASSERT_NE(nullptr, rns_tool->base_P());
+            ASSERT_NE(nullptr, rns_tool->base_P_ntt_tables());
+            const RNSBase &base_q = *rns_tool->base_q();
+            const RNSBase &base_P = *rns_tool->base_P();
+
+            auto residue = [](int64_t value, const Modulus &modulus) {
+                int64_t m = static_cast<int64_t>(modulus.value());
+                return static_cast<uint64_t>(((value % m) + m) % m);
+            };
+
+            // The exact extension outputs the centered representative of the input modulo q
+            vector<int64_t> values{ 0, 1, 17, 34 };
+            vector<uint64_t> in_q(poly_modulus_degree * base_q.size());
+            vector<uint64_t> in_P(poly_modulus_degree * base_P.size());
+            for (size_t i = 0; i < base_q.size(); i++)
+            {
+                for (size_t j = 0; j < poly_modulus_degree; j++)
+                {
+                    in_q[i * poly_modulus_degree + j] = residue(values[j], base_q[i]);
+                }
+            }
+            rns_tool->hps_extend_q_to_P(
+                ConstRNSIter(in_q.data(), poly_modulus_degree), RNSIter(in_P.data(), poly_modulus_degree), pool);
+            vector<int64_t> centered{ 0, 1, 17, -1 };
+            for (size_t i = 0; i < base_P.size(); i++)
+            {
+                for (size_t j = 0; j < poly_modulus_degree; j++)
+                {
+                    ASSERT_EQ(residue(centered[j], base_P[i]), in_P[i * poly_modulus_degree + j]);
+                }
+            }
+
+            // Scale and round values of both signs in base q U P; 29 * 3 / 35 rounds to 2 and 30 * 3 / 35 to 3
+            values = { 29, 30, -29, -1000000007 };
+            vector<int64_t> expected{ 2, 3, -2, -85714286 };
+            for (size_t i = 0; i < base_q.size(); i++)
+            {
+                for (size_t j = 0; j < poly_modulus_degree; j++)
+                {
+                    in_q[i * poly_modulus_degree + j] = residue(values[j], base_q[i]);
+                }
+            }
+            for (size_t i = 0; i < base_P.size(); i++)
+            {
+                for (size_t j = 0; j < poly_modulus_degree; j++)
+                {
+                    in_P[i * poly_modulus_degree + j] = residue(values[j], base_P[i]);
+                }
+            }
+            vector<uint64_t> out_P(poly_modulus_degree * base_P.size());
+            rns_tool->hps_scale_and_round(
+                ConstRNSIter(in_q.data(), poly_modulus_degree), ConstRNSIter(in_P.data(), poly_modulus_degree),
+                RNSIter(out_P.data(), poly_modulus_degree), pool);
+            for (size_t i = 0; i < base_P.size(); i++)
+            {
+                for (size_t j = 0; j < poly_modulus_degree; j++)
+                {
+                    ASSERT_EQ(residue(expected[j], base_P[i]), out_P[i * poly_modulus_degree + j]);
+                }
+            }
+
+            vector<uint64_t> out_q(poly_modulus_degree * base_q.size());
+            rns_tool->hps_convert_P_to_q(
+                ConstRNSIter(out_P.data(), poly_modulus_degree), RNSIter(out_q.data(), poly_modulus_degree), pool);
+            for (size_t i = 0; i < base_q.size(); i++)
+            {
+                for (size_t j = 0; j < poly_modulus_degree; j++)
+                {
+                    ASSERT_EQ(residue(expected[j], base_q[i]), out_q[i * poly_modulus_degree + j]);
+                }
+            }
+
+            // The pre-computations are only generated on request
+            ASSERT_NO_THROW(
+                rns_tool = allocate<RNSTool>(pool, poly_modulus_degree, RNSBase({ 5, 7 }, pool), plain_t, pool));
+            ASSERT_EQ(nullptr, rns_tool->base_P());
+        }
+
+        TEST(RNSToolTest, DecryptMany)
+        {
+            // The batch functions decrypt phases one after the other; the phases are Delta * m + e (BFV) or m + t * e
+            // (BGV) for small e of both signs.
+
+            auto pool = MemoryManager::GetPool();
+            size_t poly_modulus_degree = 64;
+            size_t count = 3;
+            Modulus plain_t = 65537;
+            RNSBase base_q(CoeffModulus::Create(poly_modulus_degree, { 40, 40, 40 }), pool);
+            Pointer<RNSTool> rns_tool;
+            ASSERT_NO_THROW(rns_tool = allocate<RNSTool>(pool, poly_modulus_degree, base_q, plain_t, pool));
+            size_t base_q_size = base_q.size();
+
+            // floor(q / t) mod q_i
+            vector<uint64_t> delta(base_q_size);
+            {
+                vector<uint64_t> q(base_q.base_prod(), base_q.base_prod() + base_q_size);
+                vector<uint64_t> quotient(base_q_size);
+                vector<uint64_t> t_wide(base_q_size, 0);
+                t_wide[0] = plain_t.value();
+                divide_uint_inplace(q.data(), t_wide.data(), base_q_size, quotient.data(), pool);
+                for (size_t i = 0; i < base_q_size; i++)
+                {
+                    delta[i] = modulo_uint(quotient.data(), base_q_size, base_q[i]);
+                }
+            }
+
+            mt19937_64 engine(3);
+            vector<uint64_t> messages(count * poly_modulus_degree);
+            vector<int64_t> errors(count * poly_modulus_degree);
+            for (size_t j = 0; j < messages.size(); j++)
+            {
+                messages[j] = engine() % plain_t.value();
+                errors[j] = static_cast<int64_t>(engine() % 2001) - 1000;
+            }
+
+            vector<uint64_t> bfv_phases(count * base_q_size * poly_modulus_degree);
+            vector<uint64_t> bgv_phases(count * base_q_size * poly_modulus_degree);
+            for (size_t k = 0; k < count; k++)
+            {
+                for (size_t i = 0; i < base_q_size; i++)
+                {
+                    const Modulus &q_i = base_q[i];
+                    for (size_t j = 0; j < poly_modulus_degree; j++)
+                    {
+                        size_t index = k * poly_modulus_degree + j;
+                        uint64_t e = static_cast<uint64_t>(errors[index] < 0 ? -errors[index] : errors[index]);
+                        if (errors[index] < 0)
+                        {
+                            e = negate_uint_mod(e, q_i);
+                        }
+                        uint64_t m = barrett_reduce_64(messages[index], q_i);
+                        size_t phase_index = (k * base_q_size + i) * poly_modulus_degree + j;
+                        bfv_phases[phase_index] = add_uint_mod(multiply_uint_mod(delta[i], m, q_i), e, q_i);
+                        bgv_phases[phase_index] =
+                            add_uint_mod(m, multiply_uint_mod(e, barrett_reduce_64(plain_t.value(), q_i), q_i), q_i);
+                    }
+                }
+            }
+
+            // Every supported kernel variant must produce the same results
+            KernelVariantGuard guard;
+            for (kernel_variant variant : { kernel_variant::scalar, kernel_variant::avx2, kernel_variant::avx512,
+                                            kernel_variant::avx512ifma })
+            {
+                if (!is_kernel_variant_supported(variant))
+                {
+                    continue;
+                }
+                set_active_kernel_variant(variant);
+
+                vector<uint64_t> out(count * poly_modulus_degree);
+                rns_tool->decrypt_scale_and_round(
+                    ConstPolyIter(bfv_phases.data(), poly_modulus_degree, base_q_size), count, out.data(), pool);
+                ASSERT_TRUE(messages == out);
+                for (size_t k = 0; k < count; k++)
+                {
+                    const uint64_t *phase = bfv_phases.data() + k * base_q_size * poly_modulus_degree;
+                    auto expected = messages.begin() + static_cast<ptrdiff_t>(k * poly_modulus_degree);
+                    vector<uint64_t> single_out(poly_modulus_degree);
+                    rns_tool->decrypt_scale_and_round(
+                        ConstRNSIter(phase, poly_modulus_degree), single_out.data(), pool);
+                    ASSERT_TRUE(equal(single_out.begin(), single_out.end(), expected));
+                }
+
+                fill(out.begin(), out.end(), 0);
+                rns_tool->decrypt_modt(
+                    ConstPolyIter(bgv_phases.data(), poly_modulus_degree, base_q_size), count, out.data(), pool);
+                ASSERT_TRUE(messages == out);
+            }
+        }
+
         TEST(RNSToolTest, DivideAndRoundQLastInplace)
         {
             // This function approximately divides the input values by the last prime in the base q.
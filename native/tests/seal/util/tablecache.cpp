@@ -0,0 +1,116 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "seal/context.h"
+#include "seal/modulus.h"
+#include "seal/util/galois.h"
+#include "seal/util/ntt.h"
+#include "seal/util/rns.h"
+#include "seal/util/tablecache.h"
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace seal;
+using namespace seal::util;
+using namespace std;
+
+namespace sealtest
+{
+    namespace util
+    {
+        TEST(TableCacheTest, SharedNTTTables)
+        {
+            vector<Modulus> moduli = CoeffModulus::Create(1024, { 40, 40, 40 });
+            auto tables = GetSharedNTTTables(10, moduli);
+            ASSERT_EQ(tables, GetSharedNTTTables(10, moduli));
+            for (size_t i = 0; i < moduli.size(); i++)
+            {
+                ASSERT_EQ(moduli[i], tables.get()[i].modulus());
+                ASSERT_EQ(10, tables.get()[i].coeff_count_power());
+            }
+
+            // Prefixes of the moduli share the same array
+            ASSERT_EQ(tables, GetSharedNTTTables(10, { moduli[0], moduli[1] }));
+            ASSERT_NE(tables, GetSharedNTTTables(10, { moduli[1], moduli[2] }));
+            ASSERT_NE(tables, GetSharedNTTTables(9, moduli));
+
+            // Objects are released with their last user
+            weak_ptr<const NTTTables> weak_tables = tables;
+            tables.reset();
+            ASSERT_TRUE(weak_tables.expired());
+
+            ASSERT_THROW(auto failed = GetSharedNTTTables(10, {}), invalid_argument);
+            ASSERT_THROW(auto failed = GetSharedNTTTables(10, { Modulus(13) }), invalid_argument);
+        }
+
+        TEST(TableCacheTest, SharedTools)
+        {
+            vector<Modulus> moduli = CoeffModulus::Create(1024, { 40, 40 });
+            auto base = GetSharedRNSBase(moduli);
+            ASSERT_EQ(base, GetSharedRNSBase(moduli));
+            ASSERT_EQ(2, base->size());
+            ASSERT_THROW(auto failed = GetSharedRNSBase({ Modulus(6), Modulus(9) }), invalid_argument);
+
+            auto rns_tool = GetSharedRNSTool(1024, *base, Modulus(65537));
+            ASSERT_EQ(rns_tool, GetSharedRNSTool(1024, *base, Modulus(65537)));
+            ASSERT_NE(rns_tool, GetSharedRNSTool(1024, *base, Modulus(0)));
+
+            auto galois_tool = GetSharedGaloisTool(10);
+            ASSERT_EQ(galois_tool, GetSharedGaloisTool(10));
+            ASSERT_NE(galois_tool, GetSharedGaloisTool(11));
+            ASSERT_LE(4, shared_table_count());
+        }
+
+        TEST(TableCacheTest, SharedAcrossContexts)
+        {
+            EncryptionParameters parms(scheme_type::bfv);
+            parms.set_poly_modulus_degree(1024);
+            parms.set_coeff_modulus(CoeffModulus::Create(1024, { 30, 30, 30 }));
+            parms.set_plain_modulus(PlainModulus::Batching(1024, 20));
+
+            weak_ptr<const NTTTables> weak_tables;
+            {
+                SEALContext context1(parms, true, sec_level_type::none);
+                SEALContext context2(parms, true, sec_level_type::none);
+                auto key_data = context1.key_context_data();
+                auto first_data = context1.first_context_data();
+                auto last_data = context1.last_context_data();
+
+                // Every level and every context uses the tables of the key level
+                ASSERT_EQ(key_data->small_ntt_tables(), first_data->small_ntt_tables());
+                ASSERT_EQ(key_data->small_ntt_tables(), last_data->small_ntt_tables());
+                ASSERT_EQ(key_data->small_ntt_tables(), context2.key_context_data()->small_ntt_tables());
+                ASSERT_EQ(key_data->plain_ntt_tables(), last_data->plain_ntt_tables());
+                ASSERT_EQ(key_data->galois_tool(), last_data->galois_tool());
+                ASSERT_EQ(first_data->rns_tool(), context2.first_context_data()->rns_tool());
+                ASSERT_NE(first_data->rns_tool(), last_data->rns_tool());
+
+                weak_tables = GetSharedNTTTables(10, parms.coeff_modulus());
+                ASSERT_EQ(key_data->small_ntt_tables(), weak_tables.lock().get());
+            }
+            ASSERT_TRUE(weak_tables.expired());
+        }
+
+        TEST(TableCacheTest, Concurrent)
+        {
+            vector<Modulus> moduli = CoeffModulus::Create(4096, { 50, 50, 50, 50 });
+            vector<shared_ptr<const NTTTables>> results(4);
+            vector<thread> threads;
+            for (size_t i = 0; i < results.size(); i++)
+            {
+                threads.emplace_back([&, i]() { results[i] = GetSharedNTTTables(12, moduli); });
+            }
+            for (auto &t : threads)
+            {
+                t.join();
+            }
+            for (auto &result : results)
+            {
+                ASSERT_EQ(results[0], result);
+            }
+        }
+    } // namespace util
+} // namespace sealtest
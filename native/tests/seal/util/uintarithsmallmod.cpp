@@ -183,6 +183,40 @@ namespace sealtest
             ASSERT_EQ(1010101010101ULL, barrett_reduce_128(input, mod));
         }
 
+        TEST(UIntArithSmallMod, MontgomeryReduce128)
+        {
+            for (uint64_t modulus_value : { uint64_t(3), uint64_t(13131313131313), (uint64_t(1) << 61) - 1 })
+            {
+                Modulus mod(modulus_value);
+                uint64_t neg_inverse = montgomery_neg_inverse(modulus_value);
+                ASSERT_EQ(0ULL, neg_inverse * modulus_value + 1);
+
+                // 2^64 * 2^(-64) = 1
+                uint64_t input[2]{ 0, 1 };
+                ASSERT_EQ(1ULL, montgomery_reduce_128(input, mod, neg_inverse));
+
+                // Reducing the product with 2^64 mod q undoes the factor 2^(-64)
+                input[1] = 0;
+                uint64_t r[2]{ 0, 1 };
+                uint64_t r_mod = barrett_reduce_128(r, mod);
+                for (uint64_t value : { uint64_t(0), uint64_t(1), modulus_value - 1 })
+                {
+                    unsigned long long product[2];
+                    multiply_uint64(value, r_mod, product);
+                    ASSERT_EQ(value, montgomery_reduce_128(product, mod, neg_inverse));
+                }
+
+                // The largest input
+                input[0] = 0xFFFFFFFFFFFFFFFFULL;
+                input[1] = modulus_value - 1;
+                uint64_t r_inverse;
+                try_invert_uint_mod(r_mod, mod, r_inverse);
+                ASSERT_EQ(
+                    multiply_uint_mod(barrett_reduce_128(input, mod), r_inverse, mod),
+                    montgomery_reduce_128(input, mod, neg_inverse));
+            }
+        }
+
         TEST(UIntArithSmallMod, MultiplyUIntMod)
         {
             Modulus mod(2);